@@ -0,0 +1,177 @@
+#include "accountledger.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+AccountLedger::AccountLedger(std::int64_t defaultOpeningBalance,
+                             std::chrono::milliseconds holdTimeToLive,
+                             std::size_t stripeCount,
+                             std::chrono::milliseconds tick)
+    : m_defaultOpeningBalance(defaultOpeningBalance),
+      m_holdTimeToLive(holdTimeToLive),
+      m_nextGeneration(1),
+      m_holdsPlaced(0),
+      m_holdsDeclined(0),
+      m_captures(0),
+      m_releases(0),
+      m_expirations(0),
+      m_openHolds(0),
+      m_expiryTimers(tick, 0) {
+    stripeCount = std::max<std::size_t>(1, stripeCount);
+    m_stripes.reserve(stripeCount);
+    for (std::size_t i = 0; i < stripeCount; ++i) {
+        m_stripes.push_back(std::make_unique<Stripe>());
+    }
+}
+
+void AccountLedger::setBalance(const std::string& accountId, std::int64_t balance) {
+    Stripe& stripe = stripeFor(accountId);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    accountLocked(stripe, accountId).balance = balance;
+}
+
+AccountBalance AccountLedger::getBalance(const std::string& accountId) const {
+    Stripe& stripe = stripeFor(accountId);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+
+    auto it = stripe.accounts.find(accountId);
+    if (it == stripe.accounts.end()) {
+        return AccountBalance{m_defaultOpeningBalance, 0, m_defaultOpeningBalance};
+    }
+
+    const Account& account = it->second;
+    return AccountBalance{account.balance, account.held, account.balance - account.held};
+}
+
+bool AccountLedger::placeHold(const std::string& accountId, const std::string& holdId, std::int64_t amount) {
+    std::uint64_t generation = m_nextGeneration++;
+    {
+        Stripe& stripe = stripeFor(accountId);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+
+        Account& account = accountLocked(stripe, accountId);
+        if (amount < 0 || account.balance - account.held < amount ||
+            account.holds.count(holdId) != 0) {
+            ++m_holdsDeclined;
+            return false;
+        }
+
+        TimingWheel::TimerId timer = m_expiryTimers.schedule(m_holdTimeToLive, [this, accountId, holdId, generation]() {
+            expire(accountId, holdId, generation);
+        });
+        account.held += amount;
+        account.holds.emplace(holdId, Hold{amount, generation, timer});
+    }
+
+    ++m_holdsPlaced;
+    ++m_openHolds;
+    return true;
+}
+
+bool AccountLedger::capture(const std::string& accountId, const std::string& holdId, std::int64_t amount) {
+    Stripe& stripe = stripeFor(accountId);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+
+    auto accountIt = stripe.accounts.find(accountId);
+    if (accountIt == stripe.accounts.end()) {
+        return false;
+    }
+
+    Account& account = accountIt->second;
+    auto holdIt = account.holds.find(holdId);
+    if (holdIt == account.holds.end()) {
+        return false;
+    }
+
+    // Any part of the hold not captured goes back to the available balance
+    std::int64_t held = holdIt->second.amount;
+    std::int64_t debit = amount < 0 ? held : std::min(amount, held);
+    account.held -= held;
+    account.balance -= debit;
+    m_expiryTimers.cancel(holdIt->second.expiryTimer);
+    account.holds.erase(holdIt);
+
+    ++m_captures;
+    --m_openHolds;
+    return true;
+}
+
+bool AccountLedger::release(const std::string& accountId, const std::string& holdId) {
+    Stripe& stripe = stripeFor(accountId);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+
+    auto accountIt = stripe.accounts.find(accountId);
+    if (accountIt == stripe.accounts.end()) {
+        return false;
+    }
+
+    Account& account = accountIt->second;
+    auto holdIt = account.holds.find(holdId);
+    if (holdIt == account.holds.end()) {
+        return false;
+    }
+
+    account.held -= holdIt->second.amount;
+    m_expiryTimers.cancel(holdIt->second.expiryTimer);
+    account.holds.erase(holdIt);
+
+    ++m_releases;
+    --m_openHolds;
+    return true;
+}
+
+LedgerStatistics AccountLedger::getStatistics() const {
+    std::size_t accounts = 0;
+    for (const auto& stripe : m_stripes) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        accounts += stripe->accounts.size();
+    }
+
+    return LedgerStatistics{
+        m_holdsPlaced.load(),
+        m_holdsDeclined.load(),
+        m_captures.load(),
+        m_releases.load(),
+        m_expirations.load(),
+        accounts,
+        m_openHolds.load()
+    };
+}
+
+std::int64_t AccountLedger::toCents(double amount) {
+    return static_cast<std::int64_t>(std::llround(amount * 100.0));
+}
+
+AccountLedger::Stripe& AccountLedger::stripeFor(const std::string& accountId) const {
+    return *m_stripes[std::hash<std::string>{}(accountId) % m_stripes.size()];
+}
+
+AccountLedger::Account& AccountLedger::accountLocked(Stripe& stripe, const std::string& accountId) {
+    auto it = stripe.accounts.find(accountId);
+    if (it == stripe.accounts.end()) {
+        it = stripe.accounts.emplace(accountId, Account{m_defaultOpeningBalance, 0, {}}).first;
+    }
+    return it->second;
+}
+
+void AccountLedger::expire(const std::string& accountId, const std::string& holdId, std::uint64_t generation) {
+    Stripe& stripe = stripeFor(accountId);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+
+    auto accountIt = stripe.accounts.find(accountId);
+    if (accountIt == stripe.accounts.end()) {
+        return;
+    }
+
+    Account& account = accountIt->second;
+    auto holdIt = account.holds.find(holdId);
+    if (holdIt == account.holds.end() || holdIt->second.generation != generation) {
+        return; // Captured or released in the meantime
+    }
+
+    account.held -= holdIt->second.amount;
+    account.holds.erase(holdIt);
+
+    ++m_expirations;
+    --m_openHolds;
+}
@@ -0,0 +1,178 @@
+#ifndef ACCOUNTLEDGER_H
+#define ACCOUNTLEDGER_H
+
+#include "timingwheel.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct AccountBalance
+ * @brief Balance of one ledger account, in cents
+ */
+struct AccountBalance {
+    std::int64_t balance;   ///< Settled funds
+    std::int64_t held;      ///< Funds reserved by outstanding authorization holds
+    std::int64_t available; ///< balance - held
+};
+
+/**
+ * @struct LedgerStatistics
+ * @brief Counters describing ledger activity
+ */
+struct LedgerStatistics {
+    std::uint64_t holdsPlaced;
+    std::uint64_t holdsDeclined;   ///< Refused for insufficient available funds
+    std::uint64_t captures;
+    std::uint64_t releases;
+    std::uint64_t expirations;
+    std::size_t accounts;
+    std::size_t openHolds;
+};
+
+/**
+ * @class AccountLedger
+ * @brief Per-account balances with authorization holds for the simulated acquirer
+ *
+ * Accounts and their holds are spread over lock stripes chosen by account
+ * key, so authorizations against different accounts rarely contend while
+ * everything touching one account is serialized on its stripe. Unknown
+ * accounts are opened on first use with the default opening balance.
+ *
+ * Every hold arms an expiry timer on the ledger's own TimingWheel, and a
+ * capture or release cancels it, so placing and settling holds stay O(1)
+ * however many are outstanding. Expiry runs on the wheel's driver thread.
+ */
+class AccountLedger {
+public:
+    /**
+     * @brief Constructor; starts the expiry timer thread
+     * @param defaultOpeningBalance Balance, in cents, given to accounts opened on first use
+     * @param holdTimeToLive How long an uncaptured hold reserves funds
+     * @param stripeCount Number of independently locked stripes
+     * @param tick Resolution of hold expiry
+     */
+    explicit AccountLedger(std::int64_t defaultOpeningBalance = 500000,
+                           std::chrono::milliseconds holdTimeToLive = std::chrono::hours(168),
+                           std::size_t stripeCount = 64,
+                           std::chrono::milliseconds tick = std::chrono::milliseconds(100));
+
+    AccountLedger(const AccountLedger&) = delete;
+    AccountLedger& operator=(const AccountLedger&) = delete;
+
+    /**
+     * @brief Set an account's settled balance, opening it if needed
+     * @param accountId The account key
+     * @param balance The balance in cents
+     */
+    void setBalance(const std::string& accountId, std::int64_t balance);
+
+    /**
+     * @brief Get an account's balance
+     * @param accountId The account key
+     * @return The balance; an unknown account reports the default opening balance
+     */
+    AccountBalance getBalance(const std::string& accountId) const;
+
+    /**
+     * @brief Reserve funds for an authorization
+     * @param accountId The account key
+     * @param holdId Unique ID of the hold, normally the transaction ID
+     * @param amount The amount to reserve, in cents
+     * @return False if the available balance is too low or the hold ID is already in use
+     */
+    bool placeHold(const std::string& accountId, const std::string& holdId, std::int64_t amount);
+
+    /**
+     * @brief Turn a hold into a debit
+     * @param accountId The account key
+     * @param holdId The hold ID
+     * @param amount Amount to debit, in cents, at most the held amount; a negative value captures it all
+     * @return False if the hold does not exist (already captured, released or expired)
+     */
+    bool capture(const std::string& accountId, const std::string& holdId, std::int64_t amount = -1);
+
+    /**
+     * @brief Cancel a hold, returning its funds to the available balance
+     * @param accountId The account key
+     * @param holdId The hold ID
+     * @return False if the hold does not exist
+     */
+    bool release(const std::string& accountId, const std::string& holdId);
+
+    /**
+     * @brief Get activity counters
+     * @return Snapshot of the ledger statistics
+     */
+    LedgerStatistics getStatistics() const;
+
+    /**
+     * @brief Convert a currency amount to cents
+     * @param amount The amount
+     * @return The amount rounded to the nearest cent
+     */
+    static std::int64_t toCents(double amount);
+
+private:
+    struct Hold {
+        std::int64_t amount;
+        std::uint64_t generation; ///< Distinguishes a hold from a later one reusing its ID
+        TimingWheel::TimerId expiryTimer;
+    };
+
+    struct Account {
+        std::int64_t balance;
+        std::int64_t held;
+        std::unordered_map<std::string, Hold> holds;
+    };
+
+    struct Stripe {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Account> accounts;
+    };
+
+    /**
+     * @brief Select the stripe responsible for an account
+     * @param accountId The account key
+     * @return Reference to the stripe
+     */
+    Stripe& stripeFor(const std::string& accountId) const;
+
+    /**
+     * @brief Find or open an account; caller holds the stripe lock
+     * @param stripe The account's stripe
+     * @param accountId The account key
+     * @return Reference to the account
+     */
+    Account& accountLocked(Stripe& stripe, const std::string& accountId);
+
+    /**
+     * @brief Release a hold whose time is up, if it is still open
+     * @param accountId The account key
+     * @param holdId The hold ID
+     * @param generation Generation of the hold the timer was armed for
+     */
+    void expire(const std::string& accountId, const std::string& holdId, std::uint64_t generation);
+
+    std::int64_t m_defaultOpeningBalance;
+    std::chrono::milliseconds m_holdTimeToLive;
+    std::vector<std::unique_ptr<Stripe>> m_stripes;
+
+    std::atomic<std::uint64_t> m_nextGeneration;
+    std::atomic<std::uint64_t> m_holdsPlaced;
+    std::atomic<std::uint64_t> m_holdsDeclined;
+    std::atomic<std::uint64_t> m_captures;
+    std::atomic<std::uint64_t> m_releases;
+    std::atomic<std::uint64_t> m_expirations;
+    std::atomic<std::size_t> m_openHolds;
+
+    // Declared last so it stops, and no expiry can run, before the stripes go away
+    TimingWheel m_expiryTimers;
+};
+
+#endif // ACCOUNTLEDGER_H
@@ -0,0 +1,109 @@
+#include "addressmatcher.h"
+#include <cctype>
+#include <queue>
+
+AddressMatcher::AddressMatcher(const std::vector<std::string>& tokens)
+    : m_byteClass{},
+      m_classCount(1),
+      m_tokens(tokens) {
+    // Give every byte that appears in a token its own column, upper and lower case sharing one
+    for (const std::string& token : m_tokens) {
+        for (unsigned char c : token) {
+            unsigned char lower = static_cast<unsigned char>(std::tolower(c));
+            if (m_byteClass[lower] == 0) {
+                m_byteClass[lower] = static_cast<std::uint8_t>(m_classCount++);
+                m_byteClass[static_cast<unsigned char>(std::toupper(lower))] = m_byteClass[lower];
+            }
+        }
+    }
+
+    // Trie of the tokens; state 0 is the root and 0 also means "no edge" since no edge leads back to it
+    std::vector<std::uint32_t> edges(m_classCount, 0);
+    m_outputs.assign(1, -1);
+    for (std::size_t i = 0; i < m_tokens.size(); ++i) {
+        std::uint32_t state = 0;
+        for (unsigned char c : m_tokens[i]) {
+            std::uint32_t& next = edges[state * m_classCount + m_byteClass[c]];
+            if (next == 0) {
+                next = static_cast<std::uint32_t>(m_outputs.size());
+                m_outputs.push_back(-1);
+                edges.resize(edges.size() + m_classCount, 0);
+            }
+            state = edges[state * m_classCount + m_byteClass[c]];
+        }
+        if (state != 0 && m_outputs[state] < 0) {
+            m_outputs[state] = static_cast<std::int32_t>(i);
+        }
+    }
+
+    // Breadth-first over the trie: a missing edge takes the transition of the failure state, and a
+    // state whose failure state completes a token completes it too
+    const std::size_t stateCount = m_outputs.size();
+    std::vector<std::uint32_t> failure(stateCount, 0);
+    std::queue<std::uint32_t> pending;
+    for (std::uint32_t c = 0; c < m_classCount; ++c) {
+        if (edges[c] != 0) {
+            pending.push(edges[c]);
+        }
+    }
+    while (!pending.empty()) {
+        std::uint32_t state = pending.front();
+        pending.pop();
+        if (m_outputs[state] < 0) {
+            m_outputs[state] = m_outputs[failure[state]];
+        }
+        for (std::uint32_t c = 0; c < m_classCount; ++c) {
+            std::uint32_t& next = edges[state * m_classCount + c];
+            if (next != 0) {
+                failure[next] = edges[failure[state] * m_classCount + c];
+                pending.push(next);
+            } else {
+                next = edges[failure[state] * m_classCount + c];
+            }
+        }
+    }
+
+    m_transitions.resize(edges.size());
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        std::uint32_t target = edges[i];
+        m_transitions[i] = target * m_classCount | (m_outputs[target] >= 0 ? kMatchFlag : 0);
+    }
+}
+
+bool AddressMatcher::matches(const std::string& text) const {
+    return scan(text) != 0;
+}
+
+bool AddressMatcher::findFirst(const std::string& text, std::size_t& token) const {
+    std::uint32_t entry = scan(text);
+    if (entry == 0) {
+        return false;
+    }
+    token = static_cast<std::size_t>(m_outputs[(entry & ~kMatchFlag) / m_classCount]);
+    return true;
+}
+
+const std::string& AddressMatcher::getToken(std::size_t token) const {
+    return m_tokens.at(token);
+}
+
+std::size_t AddressMatcher::size() const {
+    return m_tokens.size();
+}
+
+std::uint32_t AddressMatcher::scan(const std::string& text) const {
+    if (m_transitions.size() == m_classCount) {
+        return 0; // Root only: no tokens
+    }
+
+    const std::uint32_t* transitions = m_transitions.data();
+    std::uint32_t offset = 0;
+    for (unsigned char c : text) {
+        std::uint32_t entry = transitions[offset + m_byteClass[c]];
+        if (entry & kMatchFlag) {
+            return entry;
+        }
+        offset = entry;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#ifndef ADDRESSMATCHER_H
+#define ADDRESSMATCHER_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class AddressMatcher
+ * @brief Immutable case-insensitive matcher for many substrings at once
+ *
+ * The tokens are compiled into an Aho–Corasick automaton whose failure
+ * links are folded into a dense transition table, so scanning an address
+ * is one table lookup per byte, in a single pass, whatever the number of
+ * tokens. Bytes that occur in no token share one column of the table,
+ * which keeps it small, and ASCII letters are folded to lower case when
+ * the table is built rather than when the address is read.
+ */
+class AddressMatcher {
+public:
+    /**
+     * @brief Build a matcher
+     * @param tokens The substrings to look for; empty tokens are ignored
+     */
+    explicit AddressMatcher(const std::vector<std::string>& tokens = {});
+
+    /**
+     * @brief Check whether any token occurs in a text
+     * @param text The text to scan, typically a billing address
+     * @return True if at least one token occurs, ignoring ASCII case
+     */
+    bool matches(const std::string& text) const;
+
+    /**
+     * @brief Find the token that ends earliest in a text
+     * @param text The text to scan
+     * @param token Receives the index of the token in the list given to the constructor
+     * @return False if no token occurs
+     */
+    bool findFirst(const std::string& text, std::size_t& token) const;
+
+    /**
+     * @brief Get a token
+     * @param token Index of the token
+     * @return The token as given to the constructor
+     */
+    const std::string& getToken(std::size_t token) const;
+
+    /**
+     * @brief Get the number of tokens
+     * @return The token count, including ignored empty ones
+     */
+    std::size_t size() const;
+
+private:
+    /// Set on a transition whose target state completes at least one token
+    static constexpr std::uint32_t kMatchFlag = 0x80000000u;
+
+    /**
+     * @brief Run the automaton over a text until a token completes
+     * @param text The text to scan
+     * @return The flagged transition entry at the first match, or 0
+     */
+    std::uint32_t scan(const std::string& text) const;
+
+    std::array<std::uint8_t, 256> m_byteClass;  ///< Column of each byte; 0 for bytes in no token
+    std::uint32_t m_classCount;
+    std::vector<std::uint32_t> m_transitions;   ///< Target state times m_classCount, plus kMatchFlag
+    std::vector<std::int32_t> m_outputs;        ///< Token completed at each state, or -1
+    std::vector<std::string> m_tokens;
+};
+
+#endif // ADDRESSMATCHER_H
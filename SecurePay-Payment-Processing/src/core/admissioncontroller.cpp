@@ -0,0 +1,165 @@
+#include "admissioncontroller.h"
+#include <algorithm>
+#include <mutex>
+
+// TokenBucket implementation
+TokenBucket::TokenBucket(double ratePerSecond, double burst)
+    : m_intervalNanos(0),
+      m_toleranceNanos(0),
+      m_theoreticalArrival(0) {
+    if (ratePerSecond > 0.0) {
+        m_intervalNanos = std::max<std::int64_t>(1, static_cast<std::int64_t>(1e9 / ratePerSecond));
+        m_toleranceNanos = static_cast<std::int64_t>((std::max(1.0, burst) - 1.0) * static_cast<double>(m_intervalNanos));
+    }
+}
+
+bool TokenBucket::tryAcquire() {
+    if (m_intervalNanos == 0) {
+        return true;
+    }
+
+    std::int64_t now = nowNanos();
+    std::int64_t arrival = m_theoreticalArrival.load(std::memory_order_relaxed);
+    for (;;) {
+        std::int64_t start = std::max(arrival, now);
+        if (start - now > m_toleranceNanos) {
+            return false;
+        }
+
+        if (m_theoreticalArrival.compare_exchange_weak(arrival, start + m_intervalNanos,
+                                                       std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+void TokenBucket::release() {
+    if (m_intervalNanos != 0) {
+        m_theoreticalArrival.fetch_sub(m_intervalNanos, std::memory_order_relaxed);
+    }
+}
+
+std::int64_t TokenBucket::nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// AdmissionController implementation
+AdmissionController::AdmissionController(const AdmissionConfig& config)
+    : m_config(config),
+      m_globalBucket(std::make_unique<TokenBucket>(config.globalRatePerSecond, config.globalBurst)),
+      m_inFlight(0),
+      m_admitted(0),
+      m_merchantRateLimited(0),
+      m_globalRateLimited(0),
+      m_overloaded(0) {
+}
+
+AdmissionDecision AdmissionController::tryAdmit(const std::string& merchantName) {
+    for (;;) {
+        {
+            std::shared_lock<std::shared_mutex> lock(m_configMutex);
+            auto it = m_merchantBuckets.find(merchantName);
+            if (it != m_merchantBuckets.end()) {
+                return admitLocked(*it->second);
+            }
+        }
+
+        // First request from this merchant since the last reconfiguration
+        std::unique_lock<std::shared_mutex> lock(m_configMutex);
+        auto& bucket = m_merchantBuckets[merchantName];
+        if (!bucket) {
+            bucket = std::make_unique<TokenBucket>(m_config.merchantRatePerSecond, m_config.merchantBurst);
+        }
+    }
+}
+
+AdmissionDecision AdmissionController::admitLocked(TokenBucket& merchant) {
+    if (!merchant.tryAcquire()) {
+        ++m_merchantRateLimited;
+        return AdmissionDecision::MERCHANT_RATE_LIMITED;
+    }
+
+    if (!m_globalBucket->tryAcquire()) {
+        merchant.release();
+        ++m_globalRateLimited;
+        return AdmissionDecision::GLOBAL_RATE_LIMITED;
+    }
+
+    std::size_t inFlight = m_inFlight.fetch_add(1) + 1;
+    if (m_config.maxInFlight != 0 && inFlight > m_config.maxInFlight) {
+        --m_inFlight;
+        m_globalBucket->release();
+        merchant.release();
+        ++m_overloaded;
+        return AdmissionDecision::OVERLOADED;
+    }
+
+    ++m_admitted;
+    return AdmissionDecision::ADMITTED;
+}
+
+void AdmissionController::release() {
+    --m_inFlight;
+}
+
+void AdmissionController::configure(const AdmissionConfig& config) {
+    std::unique_lock<std::shared_mutex> lock(m_configMutex);
+
+    m_config = config;
+    m_globalBucket = std::make_unique<TokenBucket>(config.globalRatePerSecond, config.globalBurst);
+
+    // Overridden merchants keep their own limits; the rest pick up the new default lazily
+    m_merchantBuckets.clear();
+    for (const auto& entry : m_merchantOverrides) {
+        m_merchantBuckets[entry.first] = std::make_unique<TokenBucket>(entry.second.ratePerSecond, entry.second.burst);
+    }
+}
+
+void AdmissionController::setMerchantLimit(const std::string& merchantName, double ratePerSecond, double burst) {
+    std::unique_lock<std::shared_mutex> lock(m_configMutex);
+
+    m_merchantOverrides[merchantName] = MerchantLimit{ratePerSecond, burst};
+    m_merchantBuckets[merchantName] = std::make_unique<TokenBucket>(ratePerSecond, burst);
+}
+
+AdmissionStatistics AdmissionController::getStatistics() const {
+    return AdmissionStatistics{
+        m_admitted.load(),
+        m_merchantRateLimited.load(),
+        m_globalRateLimited.load(),
+        m_overloaded.load(),
+        m_inFlight.load()
+    };
+}
+
+std::string AdmissionController::decisionToString(AdmissionDecision decision) {
+    switch (decision) {
+        case AdmissionDecision::ADMITTED:
+            return "Admitted";
+        case AdmissionDecision::MERCHANT_RATE_LIMITED:
+            return "Merchant rate limit exceeded";
+        case AdmissionDecision::GLOBAL_RATE_LIMITED:
+            return "Gateway rate limit exceeded";
+        case AdmissionDecision::OVERLOADED:
+            return "Gateway overloaded";
+        default:
+            return "Unknown";
+    }
+}
+
+AdmissionSlot::AdmissionSlot(AdmissionController& controller)
+    : m_controller(controller),
+      m_held(true) {
+}
+
+AdmissionSlot::~AdmissionSlot() {
+    release();
+}
+
+void AdmissionSlot::release() {
+    if (m_held) {
+        m_held = false;
+        m_controller.release();
+    }
+}
@@ -0,0 +1,208 @@
+#ifndef ADMISSIONCONTROLLER_H
+#define ADMISSIONCONTROLLER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @class TokenBucket
+ * @brief Lock-free token bucket for rate limiting
+ *
+ * Implemented as the equivalent virtual-scheduling form: a single atomic
+ * holds the theoretical arrival time of the next request, and each admitted
+ * request pushes it forward by one emission interval. A request is refused
+ * when that would put it more than the burst allowance ahead of now, so
+ * refills need no background thread and concurrent callers only race on
+ * one compare-and-swap.
+ */
+class TokenBucket {
+public:
+    /**
+     * @brief Constructor
+     * @param ratePerSecond Sustained number of requests admitted per second; 0 or less means unlimited
+     * @param burst Number of requests that may be admitted back to back when the bucket is full
+     */
+    TokenBucket(double ratePerSecond, double burst);
+
+    /**
+     * @brief Take one token if one is available
+     * @return True if the request is admitted
+     */
+    bool tryAcquire();
+
+    /**
+     * @brief Give back a token taken by tryAcquire() for a request that was then refused elsewhere
+     */
+    void release();
+
+private:
+    static std::int64_t nowNanos();
+
+    std::int64_t m_intervalNanos;  ///< Time one token takes to refill
+    std::int64_t m_toleranceNanos; ///< How far ahead of now the schedule may run
+    std::atomic<std::int64_t> m_theoreticalArrival;
+};
+
+/**
+ * @struct AdmissionConfig
+ * @brief Limits applied by AdmissionController; a rate of 0 disables that limit
+ */
+struct AdmissionConfig {
+    double globalRatePerSecond = 0.0;    ///< Requests per second across all merchants
+    double globalBurst = 100.0;
+    double merchantRatePerSecond = 0.0;  ///< Default requests per second for each merchant
+    double merchantBurst = 20.0;
+    std::size_t maxInFlight = 0;         ///< Admitted requests not yet completed; 0 = unbounded
+};
+
+/**
+ * @enum AdmissionDecision
+ * @brief Outcome of an admission check
+ */
+enum class AdmissionDecision {
+    ADMITTED,
+    MERCHANT_RATE_LIMITED,
+    GLOBAL_RATE_LIMITED,
+    OVERLOADED
+};
+
+/**
+ * @struct AdmissionStatistics
+ * @brief Counters describing admission control decisions
+ */
+struct AdmissionStatistics {
+    std::uint64_t admitted;
+    std::uint64_t merchantRateLimited;
+    std::uint64_t globalRateLimited;
+    std::uint64_t overloaded;
+    std::size_t inFlight;
+};
+
+/**
+ * @class AdmissionController
+ * @brief Per-merchant and global admission control for the payment gateway
+ *
+ * A request must clear its merchant's bucket, then the global bucket, then
+ * the in-flight bound. The merchant bucket is checked first so a merchant
+ * over its own limit is turned away without spending global capacity that
+ * other merchants need. Every check is a handful of atomic operations;
+ * nothing waits, so excess load is refused immediately rather than queued.
+ *
+ * Every ADMITTED decision must be paired with a call to release() once the
+ * request completes; an AdmissionSlot does that even if processing throws.
+ */
+class AdmissionController {
+public:
+    /**
+     * @brief Constructor
+     * @param config The limits to apply
+     */
+    explicit AdmissionController(const AdmissionConfig& config = AdmissionConfig());
+
+    /**
+     * @brief Decide whether a request for a merchant may proceed
+     * @param merchantName The merchant the request is for
+     * @return ADMITTED, or the limit that refused it
+     */
+    AdmissionDecision tryAdmit(const std::string& merchantName);
+
+    /**
+     * @brief Mark an admitted request as complete
+     */
+    void release();
+
+    /**
+     * @brief Replace the limits; per-merchant overrides are kept and every bucket starts full
+     * @param config The new limits
+     */
+    void configure(const AdmissionConfig& config);
+
+    /**
+     * @brief Give a merchant a limit other than the default
+     * @param merchantName The merchant name
+     * @param ratePerSecond Sustained requests per second; 0 disables the merchant limit
+     * @param burst Requests that may be admitted back to back
+     */
+    void setMerchantLimit(const std::string& merchantName, double ratePerSecond, double burst);
+
+    /**
+     * @brief Get decision counters
+     * @return Snapshot of the admission statistics
+     */
+    AdmissionStatistics getStatistics() const;
+
+    /**
+     * @brief Convert an admission decision to a string
+     * @param decision The decision
+     * @return The decision as a string
+     */
+    static std::string decisionToString(AdmissionDecision decision);
+
+private:
+    struct MerchantLimit {
+        double ratePerSecond;
+        double burst;
+    };
+
+    /**
+     * @brief Run the bucket and in-flight checks; caller holds m_configMutex shared
+     * @param merchant The merchant's bucket
+     * @return ADMITTED, or the limit that refused the request
+     */
+    AdmissionDecision admitLocked(TokenBucket& merchant);
+
+    // Buckets are looked up under a shared lock and only created or replaced under the exclusive one
+    mutable std::shared_mutex m_configMutex;
+    AdmissionConfig m_config;
+    std::unique_ptr<TokenBucket> m_globalBucket;
+    std::unordered_map<std::string, std::unique_ptr<TokenBucket>> m_merchantBuckets;
+    std::unordered_map<std::string, MerchantLimit> m_merchantOverrides;
+
+    std::atomic<std::size_t> m_inFlight;
+
+    std::atomic<std::uint64_t> m_admitted;
+    std::atomic<std::uint64_t> m_merchantRateLimited;
+    std::atomic<std::uint64_t> m_globalRateLimited;
+    std::atomic<std::uint64_t> m_overloaded;
+};
+
+/**
+ * @class AdmissionSlot
+ * @brief Holds one ADMITTED request's slot and releases it exactly once
+ *
+ * The slot is released by release() or, failing that, by the destructor,
+ * so a request that throws on its way to the bank still gives its slot back.
+ */
+class AdmissionSlot {
+public:
+    /**
+     * @brief Constructor
+     * @param controller The controller that admitted the request
+     */
+    explicit AdmissionSlot(AdmissionController& controller);
+
+    /**
+     * @brief Destructor; releases the slot if release() was not called
+     */
+    ~AdmissionSlot();
+
+    AdmissionSlot(const AdmissionSlot&) = delete;
+    AdmissionSlot& operator=(const AdmissionSlot&) = delete;
+
+    /**
+     * @brief Release the slot now; later calls do nothing
+     */
+    void release();
+
+private:
+    AdmissionController& m_controller;
+    bool m_held;
+};
+
+#endif // ADMISSIONCONTROLLER_H
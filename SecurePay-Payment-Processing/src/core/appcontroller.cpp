@@ -1,11 +1,29 @@
 #include "appcontroller.h"
+#include "fraudsystem.h"
+#include "sqlitedatamanager.h"
+#include <fstream>
 #include <iostream>
 
-AppController::AppController() : m_paymentGateway(std::make_unique<PaymentGateway>()) {
+AppController::AppController(const std::string& databasePath, const std::string& profilesPath)
+    : m_paymentGateway(std::make_unique<PaymentGateway>()),
+      m_profilesPath(profilesPath.empty() ? databasePath + ".profiles" : profilesPath) {
     std::cout << "AppController initialized" << std::endl;
     
     m_paymentGateway->addObserver(this);
     
+    auto dataManager = std::make_unique<SQLiteDataManager>(databasePath);
+    if (dataManager->initialize()) {
+        m_dataManager = std::move(dataManager);
+        FraudSystem::getInstance().getAlertStore().setDataManager(m_dataManager.get());
+    } else {
+        std::cerr << "Fraud alerts will not be saved" << std::endl;
+    }
+    
+    // A first run has no snapshot yet, and every customer starts without history
+    if (std::ifstream(m_profilesPath).good()) {
+        FraudSystem::getInstance().loadProfiles(m_profilesPath);
+    }
+    
     // Add sample customers
     addCustomer(Customer("Alice Smith", "alice@example.com", "123 Main St, San Francisco, CA"));
     addCustomer(Customer("Bob Johnson", "bob@example.com", "456 Oak Ave, New York, NY"));
@@ -19,6 +37,15 @@ AppController::~AppController() {
     if (m_paymentGateway) {
         m_paymentGateway->removeObserver(this);
     }
+    
+    FraudSystem::getInstance().saveProfiles(m_profilesPath);
+    
+    // The fraud system outlives this controller, so detach the data manager before it is destroyed
+    if (m_dataManager) {
+        FraudAlertStore& alertStore = FraudSystem::getInstance().getAlertStore();
+        alertStore.flush();
+        alertStore.setDataManager(nullptr);
+    }
 }
 
 void AppController::addCustomer(const Customer& customer) {
@@ -49,12 +76,9 @@ std::unique_ptr<Transaction> AppController::createTransaction(
     const std::string& paymentDetails4,
     double amount) {
     
-    auto paymentMethod = createPaymentMethod(
-        paymentMethodType, 
-        paymentDetails1, 
-        paymentDetails2, 
-        paymentDetails3, 
-        paymentDetails4);
+    auto paymentMethod = PaymentMethodFactory::createPaymentMethod(
+        paymentMethodType,
+        {paymentDetails1, paymentDetails2, paymentDetails3, paymentDetails4});
     
     if (!paymentMethod) {
         std::cerr << "Failed to create payment method" << std::endl;
@@ -71,10 +95,15 @@ void AppController::processTransaction(std::unique_ptr<Transaction> transaction)
     }
 }
 
-const std::vector<std::unique_ptr<Transaction>>& AppController::getTransactionHistory() const {
+std::vector<Transaction*> AppController::getTransactionHistory() const {
     return m_paymentGateway->getTransactions();
 }
 
+const Transaction* AppController::findTransaction(const std::string& transactionId) const {
+    const PaymentGateway& paymentGateway = *m_paymentGateway;
+    return paymentGateway.findTransaction(transactionId);
+}
+
 void AppController::onTransactionUpdated(const Transaction& transaction) {
     std::cout << "Transaction updated: " << transaction.getTransactionId() 
               << " - Status: " << Transaction::statusToString(transaction.getStatus()) 
@@ -85,38 +114,26 @@ void AppController::onTransactionUpdated(const Transaction& transaction) {
     }
 }
 
+void AppController::onTransactionsUpdated(const std::vector<const Transaction*>& transactions) {
+    if (!m_transactionBatchUpdateCallback) {
+        TransactionObserver::onTransactionsUpdated(transactions);
+        return;
+    }
+    
+    for (const Transaction* transaction : transactions) {
+        std::cout << "Transaction updated: " << transaction->getTransactionId() 
+                  << " - Status: " << Transaction::statusToString(transaction->getStatus()) 
+                  << std::endl;
+    }
+    
+    m_transactionBatchUpdateCallback(transactions);
+}
+
 void AppController::setTransactionUpdateCallback(std::function<void(const Transaction&)> callback) {
     m_transactionUpdateCallback = callback;
 }
 
-std::unique_ptr<PaymentMethod> AppController::createPaymentMethod(
-    const std::string& paymentMethodType,
-    const std::string& details1,
-    const std::string& details2,
-    const std::string& details3,
-    const std::string& details4) {
-    
-    if (paymentMethodType == "Credit Card") {
-        return PaymentMethodFactory::createCreditCard(
-            details1,
-            details2,
-            details3,
-            details4
-        );
-    } else if (paymentMethodType == "Debit Card") {
-        return PaymentMethodFactory::createDebitCard(
-            details1,
-            details2,
-            details3,
-            details4
-        );
-    } else if (paymentMethodType == "Digital Wallet") {
-        return PaymentMethodFactory::createDigitalWallet(
-            details1,
-            details2
-        );
-    }
-    
-    std::cerr << "Unknown payment method type: " << paymentMethodType << std::endl;
-    return nullptr;
+void AppController::setTransactionBatchUpdateCallback(
+    std::function<void(const std::vector<const Transaction*>&)> callback) {
+    m_transactionBatchUpdateCallback = callback;
 }
@@ -9,11 +9,14 @@
 #include "transaction.h"
 #include "paymentmethod.h"
 #include "paymentgateway.h"
+#include "datamanager.h"
 
 // Controller class for the application
 class AppController : public TransactionObserver {
 public:
-    AppController();
+    // Transactions and fraud alerts are saved to the SQLite database at databasePath; customer
+    // fraud profiles are loaded from profilesPath on start and saved back there on destruction
+    explicit AppController(const std::string& databasePath, const std::string& profilesPath = "");
     ~AppController();
     
 
@@ -37,14 +40,24 @@ public:
     void processTransaction(std::unique_ptr<Transaction> transaction);
     
     
-    const std::vector<std::unique_ptr<Transaction>>& getTransactionHistory() const;
+    std::vector<Transaction*> getTransactionHistory() const;
+    
+    
+    const Transaction* findTransaction(const std::string& transactionId) const;
     
     
     void onTransactionUpdated(const Transaction& transaction) override;
     
+    // Delivered on the gateway's event bus thread, one call per coalesced batch
+    void onTransactionsUpdated(const std::vector<const Transaction*>& transactions) override;
+    
     
     void setTransactionUpdateCallback(std::function<void(const Transaction&)> callback);
     
+    // Takes precedence over the per-transaction callback so a batch costs a single UI refresh
+    void setTransactionBatchUpdateCallback(
+        std::function<void(const std::vector<const Transaction*>&)> callback);
+    
 private:
  
     std::vector<Customer> m_customers;
@@ -53,16 +66,15 @@ private:
  
     std::unique_ptr<PaymentGateway> m_paymentGateway;
     
+    // Fraud alerts are written here; null if the database could not be opened
+    std::unique_ptr<DataManager> m_dataManager;
     
-    std::function<void(const Transaction&)> m_transactionUpdateCallback;
+    // Defaults to databasePath with ".profiles" appended
+    std::string m_profilesPath;
     
     
-    std::unique_ptr<PaymentMethod> createPaymentMethod(
-        const std::string& paymentMethodType,
-        const std::string& details1,
-        const std::string& details2,
-        const std::string& details3,
-        const std::string& details4);
+    std::function<void(const Transaction&)> m_transactionUpdateCallback;
+    std::function<void(const std::vector<const Transaction*>&)> m_transactionBatchUpdateCallback;
 };
 
 #endif
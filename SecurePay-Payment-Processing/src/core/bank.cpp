@@ -1,4 +1,8 @@
 #include "bank.h"
+#include "timingwheel.h"
+#include "bintable.h"
+#include <algorithm>
+#include <future>
 #include <iostream>
 
 Bank& Bank::getInstance() {
@@ -6,21 +10,168 @@ Bank& Bank::getInstance() {
     return instance;
 }
 
-Bank::Bank() {
+Bank::Bank()
+    : m_backend(std::make_shared<InstantBankBackend>()),
+      m_timeoutMs(0),
+      m_requests(0),
+      m_approved(0),
+      m_declined(0),
+      m_errors(0),
+      m_timeouts(0),
+      m_totalLatencyMicros(0),
+      m_inFlight(0),
+      m_peakInFlight(0) {
     std::cout << "Bank initialized" << std::endl;
 }
 
 AuthorizationResult Bank::authorizeTransaction(const Transaction& transaction, 
                                               FraudRiskLevel fraudRiskLevel) {
+    std::promise<AuthorizationResult> promise;
+    std::future<AuthorizationResult> result = promise.get_future();
+    
+    authorizeTransactionAsync(transaction, fraudRiskLevel,
+        [&promise](AuthorizationResult authResult) {
+            promise.set_value(authResult);
+        });
+    
+    return result.get();
+}
+
+void Bank::authorizeTransactionAsync(const Transaction& transaction,
+                                     FraudRiskLevel fraudRiskLevel,
+                                     std::function<void(AuthorizationResult)> callback) {
     std::cout << "Authorizing transaction " << transaction.getTransactionId() << std::endl;
     
-    if (!isCardValid(transaction.getPaymentMethod())) {
-        std::cout << "Card validation failed" << std::endl;
-        return AuthorizationResult::DECLINED;
+    BankAuthorizationRequest request = buildRequest(transaction);
+    
+    // Shared between the backend answer and the timeout; whichever lands first completes it
+    struct PendingAuthorization {
+        std::atomic<bool> completed{false};
+        TimingWheel::TimerId timeoutId = 0;
+        std::function<void(AuthorizationResult)> callback;
+    };
+    auto pending = std::make_shared<PendingAuthorization>();
+    pending->callback = std::move(callback);
+    
+    ++m_requests;
+    std::size_t inFlight = ++m_inFlight;
+    std::size_t peak = m_peakInFlight.load();
+    while (inFlight > peak && !m_peakInFlight.compare_exchange_weak(peak, inFlight)) {
+    }
+    
+    std::int64_t timeoutMs = m_timeoutMs.load();
+    if (timeoutMs > 0) {
+        std::string transactionId = request.transactionId;
+        pending->timeoutId = TimingWheel::getInstance().schedule(
+            std::chrono::milliseconds(timeoutMs),
+            [this, pending, transactionId]() {
+                if (pending->completed.exchange(true)) {
+                    return;
+                }
+                --m_inFlight;
+                ++m_timeouts;
+                ++m_declined;
+                std::cout << "Authorization timed out for " << transactionId << std::endl;
+                pending->callback(AuthorizationResult::DECLINED);
+            });
+    }
+    
+    std::shared_ptr<BankBackend> backend = getBackend();
+    backend->authorize(request,
+        [this, pending, fraudRiskLevel, backend, request](const BankAuthorizationResponse& response) {
+            if (pending->completed.exchange(true)) {
+                // Already declined by the timeout; a late approval must not keep its hold
+                if (response.code == BankResponseCode::APPROVED) {
+                    backend->reverse(request);
+                }
+                return;
+            }
+            if (pending->timeoutId != 0) {
+                TimingWheel::getInstance().cancel(pending->timeoutId);
+            }
+            --m_inFlight;
+            recordResponse(response.code, response.latency);
+            
+            // Approvals are captured at once; a hold sent for review waits for the reviewer's decision
+            AuthorizationResult result = decide(request.transactionId, response.code, fraudRiskLevel);
+            if (result == AuthorizationResult::APPROVED) {
+                backend->capture(request);
+            }
+            pending->callback(result);
+        });
+}
+
+void Bank::captureAuthorization(const Transaction& transaction) {
+    getBackend()->capture(buildRequest(transaction));
+}
+
+void Bank::releaseAuthorization(const Transaction& transaction) {
+    getBackend()->reverse(buildRequest(transaction));
+}
+
+void Bank::setBackend(std::shared_ptr<BankBackend> backend) {
+    if (!backend) {
+        return;
     }
     
-    if (!hasSufficientFunds(transaction)) {
-        std::cout << "Insufficient funds" << std::endl;
+    std::lock_guard<std::mutex> lock(m_backendMutex);
+    std::cout << "Bank backend set to " << backend->getName() << std::endl;
+    m_backend = std::move(backend);
+}
+
+std::shared_ptr<BankBackend> Bank::getBackend() const {
+    std::lock_guard<std::mutex> lock(m_backendMutex);
+    return m_backend;
+}
+
+void Bank::setAuthorizationTimeout(std::chrono::milliseconds timeout) {
+    m_timeoutMs = std::max<std::int64_t>(0, timeout.count());
+}
+
+BankStatistics Bank::getStatistics() const {
+    std::uint64_t answered = m_approved.load() + m_declined.load() - m_timeouts.load();
+    double averageLatencyMs = answered > 0
+        ? static_cast<double>(m_totalLatencyMicros.load()) / answered / 1000.0
+        : 0.0;
+    
+    return BankStatistics{
+        m_requests.load(),
+        m_approved.load(),
+        m_declined.load(),
+        m_errors.load(),
+        m_timeouts.load(),
+        m_inFlight.load(),
+        m_peakInFlight.load(),
+        averageLatencyMs
+    };
+}
+
+BankAuthorizationRequest Bank::buildRequest(const Transaction& transaction) const {
+    const PaymentMethod& paymentMethod = transaction.getPaymentMethod();
+    BankAuthorizationRequest request{
+        transaction.getTransactionId(),
+        paymentMethod.getType(),
+        transaction.getAmount(),
+        paymentMethod.getBin(),
+        "",
+        paymentMethod.getFingerprint()
+    };
+    if (!request.bin.empty()) {
+        // Held for the lookup; a concurrent reload frees the table the BinInfo points into
+        std::shared_ptr<const BinTable> binTable = BinManager::getInstance().getTable();
+        if (const BinInfo* binInfo = binTable->lookup(request.bin)) {
+            request.cardNetwork = binInfo->network;
+        }
+    }
+    return request;
+}
+
+AuthorizationResult Bank::decide(const std::string& transactionId,
+                                 BankResponseCode code,
+                                 FraudRiskLevel fraudRiskLevel) const {
+    if (code != BankResponseCode::APPROVED) {
+        std::cout << "Bank declined " << transactionId << ": "
+                  << BankBackend::responseCodeToString(code) << std::endl;
         return AuthorizationResult::DECLINED;
     }
     
@@ -36,12 +187,17 @@ AuthorizationResult Bank::authorizeTransaction(const Transaction& transaction,
     return AuthorizationResult::APPROVED;
 }
 
-bool Bank::isCardValid(const PaymentMethod& paymentMethod) const {
-    return true;
-}
-
-bool Bank::hasSufficientFunds(const Transaction& transaction) const {
-    return transaction.getAmount() < 5000.0;
+void Bank::recordResponse(BankResponseCode code, std::chrono::microseconds latency) {
+    m_totalLatencyMicros += static_cast<std::uint64_t>(std::max<std::int64_t>(0, latency.count()));
+    
+    if (code == BankResponseCode::APPROVED) {
+        ++m_approved;
+    } else {
+        ++m_declined;
+        if (code == BankResponseCode::ERROR) {
+            ++m_errors;
+        }
+    }
 }
 
 std::string Bank::resultToString(AuthorizationResult result) {
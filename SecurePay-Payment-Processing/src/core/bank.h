@@ -1,8 +1,15 @@
 #ifndef BANK_H
 #define BANK_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include "transaction.h"
 #include "fraudsystem.h"
+#include "bankbackend.h"
 
 // Enum for authorization result
 enum class AuthorizationResult {
@@ -11,6 +18,18 @@ enum class AuthorizationResult {
     REVIEW_REQUIRED
 };
 
+// Counters for authorizations sent to the bank backend
+struct BankStatistics {
+    std::uint64_t requests;
+    std::uint64_t approved;
+    std::uint64_t declined;
+    std::uint64_t errors;
+    std::uint64_t timeouts;
+    std::size_t inFlight;
+    std::size_t peakInFlight;
+    double averageLatencyMs;
+};
+
 // Singleton class for bank authorization
 class Bank {
 public:
@@ -21,10 +40,30 @@ public:
     Bank(const Bank&) = delete;
     Bank& operator=(const Bank&) = delete;
     
-    
+    // Blocks until the backend answers or the authorization timeout expires
     AuthorizationResult authorizeTransaction(const Transaction& transaction, 
                                             FraudRiskLevel fraudRiskLevel);
     
+    // Completion-style authorization; callback receives the result once the bank answers
+    void authorizeTransactionAsync(const Transaction& transaction,
+                                   FraudRiskLevel fraudRiskLevel,
+                                   std::function<void(AuthorizationResult)> callback);
+    
+    // Settle or cancel the hold placed for a transaction that was sent for review, once the
+    // reviewer has decided. Holds for approvals are captured as they are answered.
+    void captureAuthorization(const Transaction& transaction);
+    void releaseAuthorization(const Transaction& transaction);
+    
+    // Swaps the acquirer backend; authorizations already sent finish on the old one
+    void setBackend(std::shared_ptr<BankBackend> backend);
+    std::shared_ptr<BankBackend> getBackend() const;
+    
+    // A backend answer slower than this is treated as declined; zero disables the timeout
+    void setAuthorizationTimeout(std::chrono::milliseconds timeout);
+    
+    
+    BankStatistics getStatistics() const;
+    
     
     static std::string resultToString(AuthorizationResult result);
     
@@ -32,9 +71,29 @@ private:
     
     Bank();
     
-  
-    bool hasSufficientFunds(const Transaction& transaction) const;
-    bool isCardValid(const PaymentMethod& paymentMethod) const;
+    // Copies what the backend needs from the transaction; the account is keyed by the payment method's fingerprint
+    BankAuthorizationRequest buildRequest(const Transaction& transaction) const;
+    
+    // Maps the backend's answer and the fraud risk level to the gateway-facing result
+    AuthorizationResult decide(const std::string& transactionId,
+                               BankResponseCode code,
+                               FraudRiskLevel fraudRiskLevel) const;
+    
+    void recordResponse(BankResponseCode code, std::chrono::microseconds latency);
+    
+    
+    mutable std::mutex m_backendMutex;
+    std::shared_ptr<BankBackend> m_backend;
+    std::atomic<std::int64_t> m_timeoutMs;
+    
+    std::atomic<std::uint64_t> m_requests;
+    std::atomic<std::uint64_t> m_approved;
+    std::atomic<std::uint64_t> m_declined;
+    std::atomic<std::uint64_t> m_errors;
+    std::atomic<std::uint64_t> m_timeouts;
+    std::atomic<std::uint64_t> m_totalLatencyMicros;
+    std::atomic<std::size_t> m_inFlight;
+    std::atomic<std::size_t> m_peakInFlight;
 };
 
 #endif
@@ -0,0 +1,38 @@
+#include "bankbackend.h"
+
+void BankBackend::capture(const BankAuthorizationRequest& /*request*/) {
+}
+
+void BankBackend::reverse(const BankAuthorizationRequest& /*request*/) {
+}
+
+std::string BankBackend::responseCodeToString(BankResponseCode code) {
+    switch (code) {
+        case BankResponseCode::APPROVED:
+            return "Approved";
+        case BankResponseCode::INSUFFICIENT_FUNDS:
+            return "Insufficient Funds";
+        case BankResponseCode::ERROR:
+            return "Error";
+        case BankResponseCode::TIMEOUT:
+            return "Timeout";
+        default:
+            return "Unknown";
+    }
+}
+
+// InstantBankBackend implementation
+InstantBankBackend::InstantBankBackend(double approvalLimit)
+    : m_approvalLimit(approvalLimit) {
+}
+
+void InstantBankBackend::authorize(const BankAuthorizationRequest& request, Callback callback) {
+    BankResponseCode code = request.amount < m_approvalLimit
+        ? BankResponseCode::APPROVED
+        : BankResponseCode::INSUFFICIENT_FUNDS;
+    callback(BankAuthorizationResponse{code, std::chrono::microseconds(0)});
+}
+
+std::string InstantBankBackend::getName() const {
+    return "Instant";
+}
@@ -0,0 +1,115 @@
+#ifndef BANKBACKEND_H
+#define BANKBACKEND_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+/**
+ * @enum BankResponseCode
+ * @brief Answer returned by an acquiring bank backend
+ */
+enum class BankResponseCode {
+    APPROVED,
+    INSUFFICIENT_FUNDS,
+    ERROR,
+    TIMEOUT
+};
+
+/**
+ * @struct BankAuthorizationRequest
+ * @brief Data sent to a bank backend for authorization
+ *
+ * Holds copies rather than a Transaction reference so a backend may keep the
+ * request for as long as the authorization is outstanding.
+ */
+struct BankAuthorizationRequest {
+    std::string transactionId;
+    std::string paymentMethodType;
+    double amount;
+    std::string bin;         ///< Leading card digits; empty for non-card methods
+    std::string cardNetwork; ///< Network from the BIN table; empty if unknown
+    std::string accountId;   ///< Payment method fingerprint identifying the funding account; never the raw card number
+};
+
+/**
+ * @struct BankAuthorizationResponse
+ * @brief Result of a bank backend authorization
+ */
+struct BankAuthorizationResponse {
+    BankResponseCode code;
+    std::chrono::microseconds latency;
+};
+
+/**
+ * @class BankBackend
+ * @brief Interface to an acquiring bank (Strategy Pattern)
+ *
+ * Implementations may answer inline or from another thread; either way the
+ * callback is invoked exactly once per request.
+ */
+class BankBackend {
+public:
+    using Callback = std::function<void(const BankAuthorizationResponse&)>;
+
+    virtual ~BankBackend() = default;
+
+    /**
+     * @brief Request authorization
+     * @param request The authorization request
+     * @param callback Invoked once with the response
+     */
+    virtual void authorize(const BankAuthorizationRequest& request, Callback callback) = 0;
+
+    /**
+     * @brief Settle an approved authorization, turning the hold it placed into a debit
+     *
+     * The default does nothing, for backends that place no holds.
+     *
+     * @param request The request that was approved
+     */
+    virtual void capture(const BankAuthorizationRequest& request);
+
+    /**
+     * @brief Cancel an authorization that will not be settled, freeing the hold it placed
+     *
+     * The default does nothing, for backends that place no holds.
+     *
+     * @param request The request to reverse
+     */
+    virtual void reverse(const BankAuthorizationRequest& request);
+
+    /**
+     * @brief Get the backend name, used in logs and statistics
+     * @return The backend name
+     */
+    virtual std::string getName() const = 0;
+
+    /**
+     * @brief Convert a response code to a string
+     * @param code The response code
+     * @return The response code as a string
+     */
+    static std::string responseCodeToString(BankResponseCode code);
+};
+
+/**
+ * @class InstantBankBackend
+ * @brief Backend that answers inline with a fixed per-transaction funds limit
+ */
+class InstantBankBackend : public BankBackend {
+public:
+    /**
+     * @brief Constructor
+     * @param approvalLimit Amounts at or above this limit are declined for insufficient funds
+     */
+    explicit InstantBankBackend(double approvalLimit = 5000.0);
+
+    void authorize(const BankAuthorizationRequest& request, Callback callback) override;
+    std::string getName() const override;
+
+private:
+    double m_approvalLimit;
+};
+
+#endif // BANKBACKEND_H
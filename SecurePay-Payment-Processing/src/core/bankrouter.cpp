@@ -0,0 +1,191 @@
+#include "bankrouter.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+BankRouter::BankRouter(double smoothing, std::uint64_t explorationInterval)
+    : m_smoothing(std::clamp(smoothing, 0.001, 1.0)),
+      m_explorationInterval(explorationInterval),
+      m_requestCounter(0),
+      m_routeCount(0) {
+}
+
+bool BankRouter::addBackend(std::shared_ptr<BankBackend> backend, const BankRouteRule& rule) {
+    if (!backend) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    std::size_t count = m_routeCount.load(std::memory_order_relaxed);
+    if (count == kMaxRoutes) {
+        std::cerr << "Bank router is full, cannot add " << backend->getName() << std::endl;
+        return false;
+    }
+
+    auto route = std::make_unique<Route>();
+    route->backend = std::move(backend);
+    route->rule = rule;
+    std::cout << "Bank router added backend " << route->backend->getName() << std::endl;
+
+    m_routes[count] = std::move(route);
+    m_routeCount.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+void BankRouter::authorize(const BankAuthorizationRequest& request, Callback callback) {
+    Route* route = selectRoute(request);
+    if (!route) {
+        std::cout << "No bank backend accepts " << request.paymentMethodType
+                  << " with BIN " << request.bin << std::endl;
+        callback(BankAuthorizationResponse{BankResponseCode::ERROR, std::chrono::microseconds(0)});
+        return;
+    }
+
+    ++route->requests;
+    ++route->inFlight;
+
+    // Routes live as long as the router, which the callback keeps alive
+    auto self = shared_from_this();
+    auto started = std::chrono::steady_clock::now();
+    route->backend->authorize(request,
+        [self, route, started, callback = std::move(callback)](const BankAuthorizationResponse& response) {
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - started);
+            self->recordResponse(*route, response.code, latency);
+            --route->inFlight;
+            callback(response);
+        });
+}
+
+void BankRouter::capture(const BankAuthorizationRequest& request) {
+    std::size_t count = m_routeCount.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (accepts(*m_routes[i], request)) {
+            m_routes[i]->backend->capture(request);
+        }
+    }
+}
+
+void BankRouter::reverse(const BankAuthorizationRequest& request) {
+    std::size_t count = m_routeCount.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (accepts(*m_routes[i], request)) {
+            m_routes[i]->backend->reverse(request);
+        }
+    }
+}
+
+std::string BankRouter::getName() const {
+    return "Router";
+}
+
+std::vector<BankRouteStatistics> BankRouter::getStatistics() const {
+    std::vector<BankRouteStatistics> result;
+
+    std::size_t count = m_routeCount.load(std::memory_order_acquire);
+    result.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Route& route = *m_routes[i];
+        result.push_back(BankRouteStatistics{
+            route.backend->getName(),
+            route.requests.load(),
+            route.inFlight.load(),
+            route.latencyMicros.load() / 1000.0,
+            route.approvalRate.load()
+        });
+    }
+
+    return result;
+}
+
+BankRouter::Route* BankRouter::selectRoute(const BankAuthorizationRequest& request) {
+    std::size_t count = m_routeCount.load(std::memory_order_acquire);
+    std::uint64_t sequence = m_requestCounter.fetch_add(1, std::memory_order_relaxed);
+
+    // Exploration: rotate through the eligible backends regardless of score
+    if (m_explorationInterval != 0 && sequence % m_explorationInterval == 0 && count > 0) {
+        std::size_t start = static_cast<std::size_t>(sequence / m_explorationInterval) % count;
+        for (std::size_t i = 0; i < count; ++i) {
+            Route* route = m_routes[(start + i) % count].get();
+            if (accepts(*route, request)) {
+                return route;
+            }
+        }
+        return nullptr;
+    }
+
+    Route* best = nullptr;
+    Route* unanswered = nullptr;
+    double bestCost = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < count; ++i) {
+        Route* route = m_routes[i].get();
+        if (!accepts(*route, request)) {
+            continue;
+        }
+
+        if (!route->sampled.load(std::memory_order_relaxed)) {
+            // One probe per new backend; a slow first answer must not draw all traffic to it
+            if (!route->probed.load(std::memory_order_relaxed) &&
+                !route->probed.exchange(true, std::memory_order_relaxed)) {
+                return route;
+            }
+            if (!unanswered || route->inFlight.load(std::memory_order_relaxed) <
+                               unanswered->inFlight.load(std::memory_order_relaxed)) {
+                unanswered = route;
+            }
+            continue;
+        }
+
+        double latency = route->latencyMicros.load(std::memory_order_relaxed);
+        double approval = std::max(0.01, route->approvalRate.load(std::memory_order_relaxed));
+        double load = 1.0 + static_cast<double>(route->inFlight.load(std::memory_order_relaxed));
+        double cost = latency * load / approval;
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = route;
+        }
+    }
+
+    return best ? best : unanswered;
+}
+
+bool BankRouter::accepts(const Route& route, const BankAuthorizationRequest& request) {
+    const auto& types = route.rule.paymentMethodTypes;
+    if (!types.empty() && std::find(types.begin(), types.end(), request.paymentMethodType) == types.end()) {
+        return false;
+    }
+
+    const auto& networks = route.rule.cardNetworks;
+    if (!networks.empty() && std::find(networks.begin(), networks.end(), request.cardNetwork) == networks.end()) {
+        return false;
+    }
+
+    const auto& prefixes = route.rule.binPrefixes;
+    if (prefixes.empty()) {
+        return true;
+    }
+    return std::any_of(prefixes.begin(), prefixes.end(), [&request](const std::string& prefix) {
+        return request.bin.compare(0, prefix.length(), prefix) == 0;
+    });
+}
+
+void BankRouter::recordResponse(Route& route, BankResponseCode code, std::chrono::microseconds latency) {
+    double latencySample = static_cast<double>(latency.count());
+    double approvalSample = code == BankResponseCode::APPROVED ? 1.0 : 0.0;
+
+    // The first answer seeds the latency, which has no sensible prior; approvals always blend
+    // into the prior so a single decline moves the rate by the smoothing weight, not to zero
+    if (!route.sampled.exchange(true)) {
+        route.latencyMicros = latencySample;
+    } else {
+        double current = route.latencyMicros.load(std::memory_order_relaxed);
+        while (!route.latencyMicros.compare_exchange_weak(current,
+                current + m_smoothing * (latencySample - current), std::memory_order_relaxed)) {
+        }
+    }
+
+    double current = route.approvalRate.load(std::memory_order_relaxed);
+    while (!route.approvalRate.compare_exchange_weak(current,
+            current + m_smoothing * (approvalSample - current), std::memory_order_relaxed)) {
+    }
+}
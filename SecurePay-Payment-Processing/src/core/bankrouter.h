@@ -0,0 +1,141 @@
+#ifndef BANKROUTER_H
+#define BANKROUTER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "bankbackend.h"
+
+/**
+ * @struct BankRouteRule
+ * @brief Which requests a routed backend may receive; empty lists match everything
+ */
+struct BankRouteRule {
+    std::vector<std::string> paymentMethodTypes; ///< e.g. "Credit Card", "Debit Card"
+    std::vector<std::string> binPrefixes;        ///< Leading card digits, e.g. "4" or "510510"
+    std::vector<std::string> cardNetworks;       ///< Networks from the BIN table, e.g. "Visa"
+};
+
+/**
+ * @struct BankRouteStatistics
+ * @brief Live routing figures for one backend
+ */
+struct BankRouteStatistics {
+    std::string name;
+    std::uint64_t requests;
+    std::size_t inFlight;
+    double latencyMs;     ///< Exponentially weighted moving average
+    double approvalRate;  ///< Exponentially weighted moving average, 0..1
+};
+
+/**
+ * @class BankRouter
+ * @brief Backend that spreads authorizations over several acquirers (Strategy Pattern)
+ *
+ * Each request goes to one backend whose rule accepts the payment method
+ * type, card BIN and card network. Among those, the router picks the lowest expected
+ * cost: the backend's EWMA latency scaled by its outstanding requests and
+ * divided by its EWMA approval rate. A backend with no history is sent a
+ * single probe request; until that answer arrives it only gets requests
+ * that no answered backend can take. Approval rates start from a prior
+ * rather than the first answer, so one early decline does not shut a
+ * backend out. A small share of traffic is sent round-robin so a backend
+ * that was slow once is sampled again.
+ *
+ * Captures and reversals go to every backend whose rule accepts the
+ * request; only the one it was routed to holds anything for it.
+ *
+ * Routing reads a fixed-size route table and a few relaxed atomics per
+ * candidate; there are no locks or allocations on that path. Backends are
+ * added at configuration time, up to kMaxRoutes, and stay in place for the
+ * life of the router.
+ *
+ * Outstanding requests keep the router alive, so it must be owned by a
+ * std::shared_ptr.
+ */
+class BankRouter : public BankBackend,
+                   public std::enable_shared_from_this<BankRouter> {
+public:
+    static constexpr std::size_t kMaxRoutes = 16;
+
+    /// Approval rate a backend starts with; answers are blended into it like any later ones
+    static constexpr double kApprovalPrior = 0.9;
+
+    /**
+     * @brief Constructor
+     * @param smoothing Weight of the newest sample in the moving averages
+     * @param explorationInterval Every this many requests is routed round-robin; 0 disables
+     */
+    explicit BankRouter(double smoothing = 0.1, std::uint64_t explorationInterval = 100);
+
+    /**
+     * @brief Add a backend to the route table
+     * @param backend The acquirer backend
+     * @param rule Which requests it may receive
+     * @return False if the route table is full
+     */
+    bool addBackend(std::shared_ptr<BankBackend> backend, const BankRouteRule& rule = BankRouteRule());
+
+    void authorize(const BankAuthorizationRequest& request, Callback callback) override;
+    void capture(const BankAuthorizationRequest& request) override;
+    void reverse(const BankAuthorizationRequest& request) override;
+    std::string getName() const override;
+
+    /**
+     * @brief Get routing figures for every backend
+     * @return One entry per backend, in the order they were added
+     */
+    std::vector<BankRouteStatistics> getStatistics() const;
+
+private:
+    struct Route {
+        std::shared_ptr<BankBackend> backend;
+        BankRouteRule rule;
+        std::atomic<std::uint64_t> requests{0};
+        std::atomic<std::size_t> inFlight{0};
+        std::atomic<double> latencyMicros{0.0};
+        std::atomic<double> approvalRate{kApprovalPrior};
+        std::atomic<bool> probed{false};    ///< Set when the first request is dispatched
+        std::atomic<bool> sampled{false};   ///< Set when the first answer arrives
+    };
+
+    /**
+     * @brief Pick the backend for a request
+     * @param request The authorization request
+     * @return The chosen route, or nullptr if no backend accepts the request
+     */
+    Route* selectRoute(const BankAuthorizationRequest& request);
+
+    /**
+     * @brief Check whether a route accepts a request
+     * @param route The route
+     * @param request The authorization request
+     * @return True if the route's rule matches
+     */
+    static bool accepts(const Route& route, const BankAuthorizationRequest& request);
+
+    /**
+     * @brief Fold an answer into a route's moving averages
+     * @param route The route that answered
+     * @param code The response code
+     * @param latency The observed latency
+     */
+    void recordResponse(Route& route, BankResponseCode code, std::chrono::microseconds latency);
+
+    double m_smoothing;
+    std::uint64_t m_explorationInterval;
+    std::atomic<std::uint64_t> m_requestCounter;
+
+    // Slots below m_routeCount are fully built before the count is published; writers hold m_writeMutex
+    std::mutex m_writeMutex;
+    std::array<std::unique_ptr<Route>, kMaxRoutes> m_routes;
+    std::atomic<std::size_t> m_routeCount;
+};
+
+#endif // BANKROUTER_H
@@ -0,0 +1,221 @@
+#include "bintable.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <sstream>
+#include <tuple>
+
+namespace {
+// Keys are the first eight digits of the card number
+constexpr std::size_t kKeyDigits = 8;
+
+std::string trim(const std::string& text) {
+    auto begin = std::find_if_not(text.begin(), text.end(), [](unsigned char c) { return std::isspace(c); });
+    auto end = std::find_if_not(text.rbegin(), text.rend(), [](unsigned char c) { return std::isspace(c); }).base();
+    return begin < end ? std::string(begin, end) : std::string();
+}
+}
+
+// BinTable implementation
+BinTable::BinTable(const std::vector<BinRange>& ranges) {
+    // Normalized input: (low, high, row); rows later in the input win ties
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> normalized;
+    normalized.reserve(ranges.size());
+    m_infos.reserve(ranges.size());
+
+    for (const auto& range : ranges) {
+        std::uint32_t low = 0;
+        std::uint32_t high = 0;
+        if (!toKey(range.low, '0', low) || !toKey(range.high, '9', high) || low > high) {
+            std::cerr << "Skipping malformed BIN range " << range.low << "-" << range.high << std::endl;
+            continue;
+        }
+        normalized.emplace_back(low, high, static_cast<std::uint32_t>(m_infos.size()));
+        m_infos.push_back(range.info);
+    }
+
+    std::sort(normalized.begin(), normalized.end());
+
+    // Every point where the covering set can change
+    std::vector<std::uint64_t> boundaries;
+    boundaries.reserve(normalized.size() * 2);
+    for (const auto& range : normalized) {
+        boundaries.push_back(std::get<0>(range));
+        boundaries.push_back(static_cast<std::uint64_t>(std::get<1>(range)) + 1);
+    }
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+    // Sweep the boundaries keeping the covering ranges ordered narrowest first;
+    // ranges that have ended are dropped lazily when they reach the top
+    using Active = std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>; // width, row, high
+    auto narrower = [](const Active& a, const Active& b) {
+        if (std::get<0>(a) != std::get<0>(b)) {
+            return std::get<0>(a) > std::get<0>(b);
+        }
+        return std::get<1>(a) < std::get<1>(b);
+    };
+    std::priority_queue<Active, std::vector<Active>, decltype(narrower)> active(narrower);
+
+    std::size_t next = 0;
+    for (std::size_t i = 0; i + 1 < boundaries.size(); ++i) {
+        std::uint64_t start = boundaries[i];
+        while (next < normalized.size() && std::get<0>(normalized[next]) == start) {
+            const auto& range = normalized[next++];
+            active.emplace(std::get<1>(range) - std::get<0>(range), std::get<2>(range), std::get<1>(range));
+        }
+        while (!active.empty() && std::get<2>(active.top()) < start) {
+            active.pop();
+        }
+        if (active.empty()) {
+            continue;
+        }
+
+        std::uint32_t row = std::get<1>(active.top());
+        std::uint32_t end = static_cast<std::uint32_t>(boundaries[i + 1] - 1);
+        if (!m_ends.empty() && m_ends.back() + 1 == start && m_infoIndex.back() == row) {
+            m_ends.back() = end;
+        } else {
+            m_starts.push_back(static_cast<std::uint32_t>(start));
+            m_ends.push_back(end);
+            m_infoIndex.push_back(row);
+        }
+    }
+}
+
+const BinInfo* BinTable::lookup(const std::string& cardNumber) const {
+    std::uint32_t key = 0;
+    if (m_starts.empty() || !toKey(cardNumber, '0', key)) {
+        return nullptr;
+    }
+
+    auto it = std::upper_bound(m_starts.begin(), m_starts.end(), key);
+    if (it == m_starts.begin()) {
+        return nullptr;
+    }
+
+    std::size_t segment = static_cast<std::size_t>(it - m_starts.begin()) - 1;
+    return key <= m_ends[segment] ? &m_infos[m_infoIndex[segment]] : nullptr;
+}
+
+std::size_t BinTable::size() const {
+    return m_starts.size();
+}
+
+bool BinTable::empty() const {
+    return m_starts.empty();
+}
+
+std::string BinTable::cardTypeToString(CardType cardType) {
+    switch (cardType) {
+        case CardType::CREDIT:
+            return "Credit";
+        case CardType::DEBIT:
+            return "Debit";
+        case CardType::PREPAID:
+            return "Prepaid";
+        default:
+            return "Unknown";
+    }
+}
+
+CardType BinTable::cardTypeFromString(const std::string& text) {
+    std::string lower = trim(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (lower == "credit") {
+        return CardType::CREDIT;
+    } else if (lower == "debit") {
+        return CardType::DEBIT;
+    } else if (lower == "prepaid") {
+        return CardType::PREPAID;
+    }
+    return CardType::UNKNOWN;
+}
+
+bool BinTable::toKey(const std::string& digits, char padDigit, std::uint32_t& key) {
+    std::uint32_t value = 0;
+    std::size_t count = 0;
+    for (char c : digits) {
+        if (count == kKeyDigits) {
+            break;
+        }
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + static_cast<std::uint32_t>(c - '0');
+            ++count;
+        } else if (c != ' ' && c != '-') {
+            return false;
+        }
+    }
+
+    if (count == 0) {
+        return false;
+    }
+
+    for (; count < kKeyDigits; ++count) {
+        value = value * 10 + static_cast<std::uint32_t>(padDigit - '0');
+    }
+
+    key = value;
+    return true;
+}
+
+// BinManager implementation
+BinManager& BinManager::getInstance() {
+    static BinManager instance;
+    return instance;
+}
+
+BinManager::BinManager() : m_table(std::make_shared<const BinTable>()) {
+}
+
+bool BinManager::loadFromFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open BIN table " << filePath << std::endl;
+        return false;
+    }
+
+    std::vector<BinRange> ranges;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) {
+            fields.push_back(trim(field));
+        }
+
+        // Header or short row
+        if (fields.size() < 6 || !std::isdigit(static_cast<unsigned char>(fields[0][0]))) {
+            continue;
+        }
+
+        ranges.push_back(BinRange{
+            fields[0],
+            fields[1],
+            BinInfo{fields[3], fields[2], BinTable::cardTypeFromString(fields[4]), fields[5]}
+        });
+    }
+
+    load(ranges);
+    std::cout << "Loaded " << ranges.size() << " BIN ranges from " << filePath << std::endl;
+    return true;
+}
+
+void BinManager::load(const std::vector<BinRange>& ranges) {
+    std::shared_ptr<const BinTable> table = std::make_shared<const BinTable>(ranges);
+    std::atomic_store(&m_table, table);
+}
+
+std::shared_ptr<const BinTable> BinManager::getTable() const {
+    return std::atomic_load(&m_table);
+}
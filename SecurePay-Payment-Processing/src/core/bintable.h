@@ -0,0 +1,160 @@
+#ifndef BINTABLE_H
+#define BINTABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @enum CardType
+ * @brief Funding type of a card as published by the issuer
+ */
+enum class CardType {
+    UNKNOWN,
+    CREDIT,
+    DEBIT,
+    PREPAID
+};
+
+/**
+ * @struct BinInfo
+ * @brief Issuer details for a range of card numbers
+ */
+struct BinInfo {
+    std::string issuer;
+    std::string network;  ///< e.g. "Visa", "Mastercard"
+    CardType cardType;
+    std::string country;  ///< ISO 3166 alpha-2 code
+};
+
+/**
+ * @struct BinRange
+ * @brief One row of a BIN table as loaded from a file
+ *
+ * Bounds are digit prefixes of up to eight digits; "4" to "4" covers every
+ * card starting with 4, "510000" to "559999" every card from 510000xx to
+ * 559999xx.
+ */
+struct BinRange {
+    std::string low;
+    std::string high;
+    BinInfo info;
+};
+
+/**
+ * @class BinTable
+ * @brief Immutable BIN range table with O(log n) lookup
+ *
+ * Ranges are normalized to eight-digit keys and flattened into disjoint
+ * segments when the table is built, the narrowest range winning where
+ * ranges overlap (a specific issuer range inside a whole-network range).
+ * Segment starts are kept in their own contiguous array so a lookup is a
+ * binary search over packed integers followed by one bounds check.
+ */
+class BinTable {
+public:
+    /**
+     * @brief Build a table
+     * @param ranges The ranges to index; malformed rows are skipped
+     */
+    explicit BinTable(const std::vector<BinRange>& ranges = {});
+
+    /**
+     * @brief Find the issuer details for a card number or BIN
+     * @param cardNumber Card number or leading digits; separators are ignored
+     * @return The details, or nullptr if no range covers the number; valid while the table is alive
+     */
+    const BinInfo* lookup(const std::string& cardNumber) const;
+
+    /**
+     * @brief Get the number of disjoint segments in the table
+     * @return The segment count
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Check whether the table has no ranges
+     * @return True if empty
+     */
+    bool empty() const;
+
+    /**
+     * @brief Convert a card type to a string
+     * @param cardType The card type
+     * @return The card type as a string
+     */
+    static std::string cardTypeToString(CardType cardType);
+
+    /**
+     * @brief Parse a card type
+     * @param text "Credit", "Debit" or "Prepaid", case-insensitive
+     * @return The card type, UNKNOWN if not recognised
+     */
+    static CardType cardTypeFromString(const std::string& text);
+
+private:
+    /**
+     * @brief Turn a digit prefix into an eight-digit key
+     * @param digits The digits, separators allowed
+     * @param padDigit Digit used to fill out short prefixes
+     * @param key Receives the key
+     * @return False if the text has no digits
+     */
+    static bool toKey(const std::string& digits, char padDigit, std::uint32_t& key);
+
+    std::vector<std::uint32_t> m_starts;   ///< Segment start keys, ascending
+    std::vector<std::uint32_t> m_ends;     ///< Inclusive segment end keys
+    std::vector<std::uint32_t> m_infoIndex; ///< Index into m_infos per segment
+    std::vector<BinInfo> m_infos;
+};
+
+/**
+ * @class BinManager
+ * @brief Singleton holding the live BIN table
+ *
+ * Readers take a snapshot with getTable() and keep it for as long as they
+ * use the BinInfo pointers it hands out; reloading publishes a new table
+ * without disturbing lookups already in progress.
+ */
+class BinManager {
+public:
+    /**
+     * @brief Get the singleton instance
+     * @return Reference to the BIN manager
+     */
+    static BinManager& getInstance();
+
+    BinManager(const BinManager&) = delete;
+    BinManager& operator=(const BinManager&) = delete;
+
+    /**
+     * @brief Load a BIN table from a CSV file and make it live
+     *
+     * Each line is low,high,network,issuer,type,country. Blank lines, lines
+     * starting with '#' and a header line are ignored.
+     *
+     * @param filePath The file to load
+     * @return True if the file was read and the table replaced
+     */
+    bool loadFromFile(const std::string& filePath);
+
+    /**
+     * @brief Replace the live table with the given ranges
+     * @param ranges The ranges to index
+     */
+    void load(const std::vector<BinRange>& ranges);
+
+    /**
+     * @brief Get the live table
+     * @return Snapshot of the current table; never null
+     */
+    std::shared_ptr<const BinTable> getTable() const;
+
+private:
+    BinManager();
+
+    std::shared_ptr<const BinTable> m_table; ///< Accessed with std::atomic_load / std::atomic_store
+};
+
+#endif // BINTABLE_H
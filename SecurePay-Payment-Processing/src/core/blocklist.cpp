@@ -0,0 +1,234 @@
+#include "blocklist.h"
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// Values up to this length are normalized on the stack
+constexpr std::size_t kInlineKeyLength = 256;
+
+bool execute(sqlite3* database, const char* sql) {
+    char* errorMessage = nullptr;
+    if (sqlite3_exec(database, sql, nullptr, nullptr, &errorMessage) != SQLITE_OK) {
+        std::cerr << "SQL error: " << errorMessage << std::endl;
+        sqlite3_free(errorMessage);
+        return false;
+    }
+    return true;
+}
+
+// URI that opens a database read-only without file locking; '%', '?' and '#' in the path are escaped
+std::string immutableUri(const std::string& path) {
+    std::string uri = "file:";
+    for (char c : path) {
+        if (c == '%' || c == '?' || c == '#') {
+            static const char hex[] = "0123456789ABCDEF";
+            uri += '%';
+            uri += hex[static_cast<unsigned char>(c) >> 4];
+            uri += hex[static_cast<unsigned char>(c) & 15];
+        } else {
+            uri += c;
+        }
+    }
+    return uri + "?immutable=1";
+}
+
+} // namespace
+
+Blocklist::Blocklist(BlocklistType type)
+    : m_type(type),
+      m_entryCount(0),
+      m_filter(0),
+      m_database(nullptr),
+      m_lookup(nullptr),
+      m_exactLookups(0),
+      m_hits(0) {
+}
+
+Blocklist::~Blocklist() {
+    if (m_lookup) {
+        sqlite3_finalize(m_lookup);
+    }
+    if (m_database) {
+        sqlite3_close(m_database);
+    }
+}
+
+std::shared_ptr<const Blocklist> Blocklist::build(BlocklistType type,
+                                                  const std::string& entriesPath,
+                                                  const std::string& databasePath,
+                                                  unsigned bitsPerEntry) {
+    std::ifstream file(entriesPath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open blocklist " << entriesPath << std::endl;
+        return nullptr;
+    }
+
+    // The exact set is built aside and renamed into place when complete
+    const std::string buildPath = databasePath + ".building";
+    std::remove(buildPath.c_str());
+
+    sqlite3* database = nullptr;
+    if (sqlite3_open(buildPath.c_str(), &database) != SQLITE_OK) {
+        std::cerr << "Cannot open database: " << sqlite3_errmsg(database) << std::endl;
+        sqlite3_close(database);
+        return nullptr;
+    }
+
+    // A half-built file is thrown away, so it needs no journal or syncing
+    sqlite3_stmt* insert = nullptr;
+    bool success = execute(database, "PRAGMA journal_mode = OFF;") &&
+                   execute(database, "PRAGMA synchronous = OFF;") &&
+                   execute(database, "PRAGMA cache_size = -65536;") &&
+                   execute(database, "CREATE TABLE entries (value TEXT PRIMARY KEY) WITHOUT ROWID;") &&
+                   execute(database, "BEGIN TRANSACTION;") &&
+                   sqlite3_prepare_v2(database, "INSERT OR IGNORE INTO entries (value) VALUES (?);",
+                                      -1, &insert, nullptr) == SQLITE_OK;
+
+    std::vector<std::uint64_t> hashes;
+    std::string line;
+    while (success && std::getline(file, line)) {
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        std::string key = normalize(type, line);
+        if (key.empty()) {
+            continue;
+        }
+
+        sqlite3_bind_text(insert, 1, key.data(), static_cast<int>(key.size()), SQLITE_TRANSIENT);
+        if (sqlite3_step(insert) != SQLITE_DONE) {
+            std::cerr << "SQL error: " << sqlite3_errmsg(database) << std::endl;
+            success = false;
+            break;
+        }
+        sqlite3_reset(insert);
+
+        if (sqlite3_changes(database) == 1) {
+            hashes.push_back(BloomFilter::hashKey(key.data(), key.size()));
+        }
+    }
+
+    sqlite3_finalize(insert);
+    success = success && execute(database, "COMMIT;");
+    sqlite3_close(database);
+
+    if (!success || std::rename(buildPath.c_str(), databasePath.c_str()) != 0) {
+        std::cerr << "Failed to build blocklist database " << databasePath << std::endl;
+        std::remove(buildPath.c_str());
+        return nullptr;
+    }
+
+    std::shared_ptr<Blocklist> blocklist = std::make_shared<Blocklist>(type);
+    blocklist->m_entryCount = hashes.size();
+    blocklist->m_filter = BloomFilter(hashes.size(), bitsPerEntry);
+    for (std::uint64_t hash : hashes) {
+        blocklist->m_filter.add(hash);
+    }
+
+    // The file never changes once renamed into place, so SQLite can skip locking it on every lookup
+    if (sqlite3_open_v2(immutableUri(databasePath).c_str(), &blocklist->m_database,
+                        SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(blocklist->m_database, "SELECT 1 FROM entries WHERE value = ?;",
+                           -1, &blocklist->m_lookup, nullptr) != SQLITE_OK) {
+        std::cerr << "Cannot open database: " << sqlite3_errmsg(blocklist->m_database) << std::endl;
+        return nullptr;
+    }
+
+    std::cout << "Loaded " << hashes.size() << " " << typeToString(type) << " blocklist entries from "
+              << entriesPath << " (" << blocklist->m_filter.sizeInBytes() / 1024 << " KiB filter)" << std::endl;
+    return blocklist;
+}
+
+bool Blocklist::contains(const std::string& value) const {
+    if (m_entryCount == 0) {
+        return false;
+    }
+
+    char inlineKey[kInlineKeyLength];
+    std::string longKey;
+    char* key = inlineKey;
+    if (value.size() > kInlineKeyLength) {
+        longKey.resize(value.size());
+        key = &longKey[0];
+    }
+
+    std::size_t length = normalizeInto(m_type, value, key);
+    if (length == 0 || !m_filter.mightContain(BloomFilter::hashKey(key, length))) {
+        return false;
+    }
+    return containsExact(key, length);
+}
+
+BlocklistType Blocklist::getType() const {
+    return m_type;
+}
+
+std::size_t Blocklist::size() const {
+    return m_entryCount;
+}
+
+BlocklistStatistics Blocklist::getStatistics() const {
+    return BlocklistStatistics{m_entryCount, m_filter.sizeInBytes(), m_exactLookups.load(), m_hits.load()};
+}
+
+std::string Blocklist::normalize(BlocklistType type, const std::string& value) {
+    std::string key(value.size(), '\0');
+    key.resize(normalizeInto(type, value, &key[0]));
+    return key;
+}
+
+std::string Blocklist::typeToString(BlocklistType type) {
+    switch (type) {
+        case BlocklistType::CARD:
+            return "Card";
+        case BlocklistType::WALLET:
+            return "Wallet";
+        case BlocklistType::EMAIL:
+            return "Email";
+        default:
+            return "Unknown";
+    }
+}
+
+std::size_t Blocklist::normalizeInto(BlocklistType type, const std::string& value, char* out) {
+    std::size_t length = 0;
+    if (type == BlocklistType::CARD) {
+        for (char c : value) {
+            if (c >= '0' && c <= '9') {
+                out[length++] = c;
+            }
+        }
+        return length;
+    }
+
+    std::size_t begin = value.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return 0;
+    }
+    std::size_t end = value.find_last_not_of(" \t\r\n") + 1;
+    for (std::size_t i = begin; i < end; ++i) {
+        char c = value[i];
+        out[length++] = type == BlocklistType::EMAIL ? static_cast<char>(std::tolower(static_cast<unsigned char>(c))) : c;
+    }
+    return length;
+}
+
+bool Blocklist::containsExact(const char* key, std::size_t length) const {
+    std::lock_guard<std::mutex> lock(m_databaseMutex);
+    ++m_exactLookups;
+
+    sqlite3_bind_text(m_lookup, 1, key, static_cast<int>(length), SQLITE_STATIC);
+    bool found = sqlite3_step(m_lookup) == SQLITE_ROW;
+    sqlite3_reset(m_lookup);
+    sqlite3_clear_bindings(m_lookup);
+
+    if (found) {
+        ++m_hits;
+    }
+    return found;
+}
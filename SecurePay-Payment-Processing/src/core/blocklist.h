@@ -0,0 +1,146 @@
+#ifndef BLOCKLIST_H
+#define BLOCKLIST_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sqlite3.h>
+#include <string>
+#include "bloomfilter.h"
+
+/**
+ * @enum BlocklistType
+ * @brief What a blocklist holds, which decides how entries are normalized
+ */
+enum class BlocklistType {
+    CARD,       ///< Card numbers; only digits are kept
+    WALLET,     ///< Digital wallet IDs; surrounding whitespace is dropped
+    EMAIL       ///< Customer emails; trimmed and lower-cased
+};
+
+/**
+ * @struct BlocklistStatistics
+ * @brief Size and lookup counters of one blocklist
+ */
+struct BlocklistStatistics {
+    std::size_t entries;
+    std::size_t filterBytes;
+    std::uint64_t exactLookups;     ///< Lookups the filter passed through to the database
+    std::uint64_t hits;             ///< Lookups found in the database
+};
+
+/**
+ * @class Blocklist
+ * @brief Immutable blocklist with an in-memory Bloom filter in front of an exact SQLite set
+ *
+ * Lookups hash the normalized value and test the filter first; a value
+ * that was never listed is rejected there, without touching the
+ * database, in the time of one cache miss. Only values that pass the
+ * filter (listed ones and about one percent of the rest) are confirmed
+ * with an indexed query against the on-disk set. The database is written
+ * once when the list is built and only read afterwards.
+ */
+class Blocklist {
+public:
+    /**
+     * @brief Create an empty blocklist that contains nothing
+     * @param type The kind of value the list holds
+     */
+    explicit Blocklist(BlocklistType type);
+
+    ~Blocklist();
+
+    Blocklist(const Blocklist&) = delete;
+    Blocklist& operator=(const Blocklist&) = delete;
+
+    /**
+     * @brief Build a blocklist from a text file
+     *
+     * The file holds one value per line; blank lines and lines starting
+     * with '#' are ignored. The exact set is written to a temporary file
+     * next to databasePath and renamed over it once complete, so a list
+     * still in use keeps reading the file it opened.
+     *
+     * @param type The kind of value the file holds
+     * @param entriesPath The text file to read
+     * @param databasePath Where to keep the exact set
+     * @param bitsPerEntry Filter bits per entry; 10 gives about one percent false positives
+     * @return The blocklist, or nullptr if a file could not be read or written
+     */
+    static std::shared_ptr<const Blocklist> build(BlocklistType type,
+                                                  const std::string& entriesPath,
+                                                  const std::string& databasePath,
+                                                  unsigned bitsPerEntry = 10);
+
+    /**
+     * @brief Check whether a value is on the list
+     * @param value A card number, wallet ID or email, in any formatting normalize() accepts
+     * @return True if the normalized value is listed
+     */
+    bool contains(const std::string& value) const;
+
+    /**
+     * @brief Get the kind of value the list holds
+     * @return The blocklist type
+     */
+    BlocklistType getType() const;
+
+    /**
+     * @brief Get the number of distinct entries
+     * @return The entry count
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Get the size and lookup counters
+     * @return The statistics
+     */
+    BlocklistStatistics getStatistics() const;
+
+    /**
+     * @brief Normalize a value the way entries and lookups are compared
+     * @param type The kind of value
+     * @param value The raw value
+     * @return The normalized value; empty if nothing is left
+     */
+    static std::string normalize(BlocklistType type, const std::string& value);
+
+    /**
+     * @brief Convert a blocklist type to a string
+     * @param type The blocklist type
+     * @return The type as a string
+     */
+    static std::string typeToString(BlocklistType type);
+
+private:
+    /**
+     * @brief Normalize into a caller-provided buffer
+     * @param type The kind of value
+     * @param value The raw value
+     * @param out Receives the normalized bytes; needs room for value.size() characters
+     * @return Number of bytes written
+     */
+    static std::size_t normalizeInto(BlocklistType type, const std::string& value, char* out);
+
+    /**
+     * @brief Look a normalized value up in the database
+     * @param key The normalized value
+     * @param length Its length
+     * @return True if the value is listed
+     */
+    bool containsExact(const char* key, std::size_t length) const;
+
+    BlocklistType m_type;
+    std::size_t m_entryCount;
+    BloomFilter m_filter;
+
+    mutable std::mutex m_databaseMutex;
+    sqlite3* m_database;
+    sqlite3_stmt* m_lookup;
+
+    mutable std::atomic<std::uint64_t> m_exactLookups;
+    mutable std::atomic<std::uint64_t> m_hits;
+};
+
+#endif // BLOCKLIST_H
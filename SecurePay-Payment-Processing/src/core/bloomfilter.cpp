@@ -0,0 +1,63 @@
+#include "bloomfilter.h"
+#include <algorithm>
+#include <cmath>
+
+BloomFilter::BloomFilter(std::size_t expectedEntries, unsigned bitsPerEntry) {
+    bitsPerEntry = std::max(1u, bitsPerEntry);
+    std::size_t bits = std::max<std::size_t>(1, expectedEntries) * bitsPerEntry;
+    m_blocks.assign((bits + 511) / 512, Block{});
+
+    // k = bits per key * ln 2 minimises the false positive rate
+    m_hashCount = std::min(16u, std::max(1u, static_cast<unsigned>(std::lround(bitsPerEntry * 0.693))));
+}
+
+void BloomFilter::add(std::uint64_t hash) {
+    Block& block = m_blocks[blockFor(hash)];
+    std::uint32_t position = static_cast<std::uint32_t>(hash);
+    const std::uint32_t step = probeStep(hash);
+    for (unsigned i = 0; i < m_hashCount; ++i) {
+        block.words[(position >> 6) & 7] |= std::uint64_t(1) << (position & 63);
+        position += step;
+    }
+}
+
+bool BloomFilter::mightContain(std::uint64_t hash) const {
+    const Block& block = m_blocks[blockFor(hash)];
+    std::uint32_t position = static_cast<std::uint32_t>(hash);
+    const std::uint32_t step = probeStep(hash);
+    for (unsigned i = 0; i < m_hashCount; ++i) {
+        if ((block.words[(position >> 6) & 7] & (std::uint64_t(1) << (position & 63))) == 0) {
+            return false;
+        }
+        position += step;
+    }
+    return true;
+}
+
+std::size_t BloomFilter::sizeInBytes() const {
+    return m_blocks.size() * sizeof(Block);
+}
+
+std::uint64_t BloomFilter::hashKey(const char* data, std::size_t length) {
+    // FNV-1a, then a splitmix64 finalizer so every output bit depends on every input byte
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < length; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+    }
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+std::uint32_t BloomFilter::probeStep(std::uint64_t hash) {
+    // Remixed so the step does not share bits with the block index; odd so probes cycle the block
+    return static_cast<std::uint32_t>((hash * 0x9e3779b97f4a7c15ULL) >> 32) | 1;
+}
+
+std::size_t BloomFilter::blockFor(std::uint64_t hash) const {
+    // Multiply-shift maps the high 32 bits onto the block count without a division
+    return static_cast<std::size_t>(((hash >> 32) * m_blocks.size()) >> 32);
+}
@@ -0,0 +1,77 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class BloomFilter
+ * @brief Cache-blocked Bloom filter over 64-bit key hashes
+ *
+ * The bit array is divided into 512-bit blocks, each one cache line. A key
+ * selects one block with the high half of its hash and sets or tests all
+ * of its bits inside that block, so a lookup costs at most one cache miss
+ * however large the filter grows. At ten bits per key the false positive
+ * rate is around one percent. There are no false negatives.
+ */
+class BloomFilter {
+public:
+    /**
+     * @brief Constructor
+     * @param expectedEntries Number of keys the filter is sized for
+     * @param bitsPerEntry Filter bits per expected key; more bits, fewer false positives
+     */
+    explicit BloomFilter(std::size_t expectedEntries = 0, unsigned bitsPerEntry = 10);
+
+    /**
+     * @brief Add a key
+     * @param hash The key's hash, from hashKey()
+     */
+    void add(std::uint64_t hash);
+
+    /**
+     * @brief Test a key
+     * @param hash The key's hash, from hashKey()
+     * @return False if the key was definitely never added
+     */
+    bool mightContain(std::uint64_t hash) const;
+
+    /**
+     * @brief Get the memory used by the bit array
+     * @return Size in bytes
+     */
+    std::size_t sizeInBytes() const;
+
+    /**
+     * @brief Hash a key for add() and mightContain()
+     * @param data The key bytes
+     * @param length Number of bytes
+     * @return A well-mixed 64-bit hash
+     */
+    static std::uint64_t hashKey(const char* data, std::size_t length);
+
+private:
+    struct alignas(64) Block {
+        std::uint64_t words[8];
+    };
+
+    /**
+     * @brief Select the block for a key
+     * @param hash The key's hash
+     * @return Index into m_blocks
+     */
+    std::size_t blockFor(std::uint64_t hash) const;
+
+    /**
+     * @brief Get the distance between successive bit positions of a key within its block
+     * @param hash The key's hash
+     * @return An odd step
+     */
+    static std::uint32_t probeStep(std::uint64_t hash);
+
+    std::vector<Block> m_blocks;
+    unsigned m_hashCount;   ///< Bits set per key
+};
+
+#endif // BLOOMFILTER_H
@@ -0,0 +1,235 @@
+#include "cardvalidator.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+CardValidationResult CardValidator::validateNumber(const std::string& cardNumber) {
+    unsigned char digits[32];
+    CardValidationResult result = loadDigits(cardNumber, digits);
+    if (result != CardValidationResult::VALID) {
+        return result;
+    }
+
+    return luhnSum(digits) % 10 == 0 ? CardValidationResult::VALID : CardValidationResult::INVALID_CHECKSUM;
+}
+
+CardValidationResult CardValidator::validateExpiry(const std::string& expiryDate,
+                                                   std::chrono::system_clock::time_point now) {
+    std::string digits;
+    for (char c : expiryDate) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            digits += c;
+        } else if (c != '/') {
+            return CardValidationResult::INVALID_EXPIRY;
+        }
+    }
+
+    if (digits.length() != 4 && digits.length() != 6) {
+        return CardValidationResult::INVALID_EXPIRY;
+    }
+
+    int month = std::stoi(digits.substr(0, 2));
+    int year = std::stoi(digits.substr(2));
+    if (digits.length() == 4) {
+        year += 2000;
+    }
+    if (month < 1 || month > 12) {
+        return CardValidationResult::INVALID_EXPIRY;
+    }
+
+    std::time_t time = std::chrono::system_clock::to_time_t(now);
+    // std::localtime shares one buffer between threads, and async payments validate concurrently
+    std::tm local{};
+#if defined(_WIN32)
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    int currentYear = local.tm_year + 1900;
+    int currentMonth = local.tm_mon + 1;
+
+    // A card is good through the last day of its expiry month
+    if (year < currentYear || (year == currentYear && month < currentMonth)) {
+        return CardValidationResult::EXPIRED;
+    }
+    return CardValidationResult::VALID;
+}
+
+CardValidationResult CardValidator::validateCvv(const std::string& cvv) {
+    if (cvv.length() < 3 || cvv.length() > 4) {
+        return CardValidationResult::INVALID_CVV;
+    }
+    for (char c : cvv) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) {
+            return CardValidationResult::INVALID_CVV;
+        }
+    }
+    return CardValidationResult::VALID;
+}
+
+std::vector<CardValidationResult> CardValidator::validateNumbers(const std::vector<std::string>& cardNumbers) {
+    std::vector<CardValidationResult> results(cardNumbers.size(), CardValidationResult::VALID);
+
+    alignas(16) unsigned char columns[32][kBatchLanes];
+    alignas(16) unsigned char sums[kBatchLanes];
+    for (std::size_t first = 0; first < cardNumbers.size(); first += kBatchLanes) {
+        const std::size_t count = std::min(kBatchLanes, cardNumbers.size() - first);
+
+        // Unused lanes and malformed numbers stay zero and are simply not read back
+        std::memset(columns, 0, sizeof(columns));
+        for (std::size_t lane = 0; lane < count; ++lane) {
+            results[first + lane] = loadDigits(cardNumbers[first + lane], columns, lane);
+        }
+
+        luhnSums(columns, sums);
+        for (std::size_t lane = 0; lane < count; ++lane) {
+            if (results[first + lane] == CardValidationResult::VALID && sums[lane] % 10 != 0) {
+                results[first + lane] = CardValidationResult::INVALID_CHECKSUM;
+            }
+        }
+    }
+
+    return results;
+}
+
+std::string CardValidator::resultToString(CardValidationResult result) {
+    switch (result) {
+        case CardValidationResult::VALID:
+            return "Valid";
+        case CardValidationResult::INVALID_CHARACTERS:
+            return "Card number contains invalid characters";
+        case CardValidationResult::INVALID_LENGTH:
+            return "Card number has an invalid length";
+        case CardValidationResult::INVALID_CHECKSUM:
+            return "Card number failed checksum";
+        case CardValidationResult::INVALID_EXPIRY:
+            return "Invalid expiry date";
+        case CardValidationResult::EXPIRED:
+            return "Card expired";
+        case CardValidationResult::INVALID_CVV:
+            return "Invalid CVV";
+        case CardValidationResult::UNKNOWN_BIN:
+            return "Card issuer not recognised";
+        default:
+            return "Unknown";
+    }
+}
+
+CardValidationResult CardValidator::loadDigits(const std::string& cardNumber, unsigned char (&digits)[32]) {
+    std::memset(digits, 0, sizeof(digits));
+
+    // Fill from the right so the check digit always lands in the last slot
+    std::size_t count = 0;
+    for (auto it = cardNumber.rbegin(); it != cardNumber.rend(); ++it) {
+        char c = *it;
+        if (c >= '0' && c <= '9') {
+            if (count == kMaxCardDigits) {
+                return CardValidationResult::INVALID_LENGTH;
+            }
+            digits[31 - count] = static_cast<unsigned char>(c - '0');
+            ++count;
+        } else if (c != ' ' && c != '-') {
+            return CardValidationResult::INVALID_CHARACTERS;
+        }
+    }
+
+    if (count < kMinCardDigits) {
+        return CardValidationResult::INVALID_LENGTH;
+    }
+    return CardValidationResult::VALID;
+}
+
+CardValidationResult CardValidator::loadDigits(const std::string& cardNumber,
+                                              unsigned char (&columns)[32][kBatchLanes], std::size_t lane) {
+    std::size_t count = 0;
+    for (auto it = cardNumber.rbegin(); it != cardNumber.rend(); ++it) {
+        char c = *it;
+        if (c >= '0' && c <= '9') {
+            if (count == kMaxCardDigits) {
+                return CardValidationResult::INVALID_LENGTH;
+            }
+            columns[31 - count][lane] = static_cast<unsigned char>(c - '0');
+            ++count;
+        } else if (c != ' ' && c != '-') {
+            return CardValidationResult::INVALID_CHARACTERS;
+        }
+    }
+
+    if (count < kMinCardDigits) {
+        return CardValidationResult::INVALID_LENGTH;
+    }
+    return CardValidationResult::VALID;
+}
+
+void CardValidator::luhnSums(const unsigned char (&columns)[32][kBatchLanes], unsigned char (&sums)[kBatchLanes]) {
+    // Only the last kMaxCardDigits positions can hold digits; as in luhnSum(), even positions are doubled
+    constexpr std::size_t firstPosition = 32 - kMaxCardDigits;
+#if defined(__SSE2__)
+    static_assert(kBatchLanes == 16, "one lane per byte of an SSE2 vector");
+    const __m128i nine = _mm_set1_epi8(9);
+
+    __m128i total = _mm_setzero_si128();
+    for (std::size_t position = firstPosition; position < 32; ++position) {
+        __m128i values = _mm_load_si128(reinterpret_cast<const __m128i*>(columns[position]));
+        if (position % 2 == 0) {
+            values = _mm_add_epi8(values, values);
+            values = _mm_sub_epi8(values, _mm_and_si128(_mm_cmpgt_epi8(values, nine), nine));
+        }
+        total = _mm_add_epi8(total, values);
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums), total);
+#else
+    for (std::size_t lane = 0; lane < kBatchLanes; ++lane) {
+        unsigned sum = 0;
+        for (std::size_t position = firstPosition; position < 32; ++position) {
+            unsigned digit = columns[position][lane];
+            if (position % 2 == 0) {
+                digit *= 2;
+                if (digit > 9) {
+                    digit -= 9;
+                }
+            }
+            sum += digit;
+        }
+        sums[lane] = static_cast<unsigned char>(sum);
+    }
+#endif
+}
+
+unsigned CardValidator::luhnSum(const unsigned char (&digits)[32]) {
+#if defined(__SSE2__)
+    // Counting from the check digit at index 31, every second digit (even indexes) is doubled
+    const __m128i evenLanes = _mm_set1_epi16(0x00FF);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i total = zero;
+    for (int half = 0; half < 2; ++half) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits + half * 16));
+        __m128i doubled = _mm_add_epi8(values, _mm_and_si128(values, evenLanes));
+        __m128i overNine = _mm_cmpgt_epi8(doubled, nine);
+        doubled = _mm_sub_epi8(doubled, _mm_and_si128(overNine, nine));
+        total = _mm_add_epi64(total, _mm_sad_epu8(doubled, zero));
+    }
+
+    return static_cast<unsigned>(_mm_cvtsi128_si32(total) + _mm_extract_epi16(total, 4));
+#else
+    unsigned sum = 0;
+    for (int i = 0; i < 32; ++i) {
+        unsigned digit = digits[i];
+        if (i % 2 == 0) {
+            digit *= 2;
+            if (digit > 9) {
+                digit -= 9;
+            }
+        }
+        sum += digit;
+    }
+    return sum;
+#endif
+}
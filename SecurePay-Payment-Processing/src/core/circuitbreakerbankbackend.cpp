@@ -0,0 +1,264 @@
+#include "circuitbreakerbankbackend.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+// Outcome flags stored in the sliding window
+constexpr std::uint8_t kOutcomeError = 0x1;
+constexpr std::uint8_t kOutcomeSlow = 0x2;
+
+// The p95 estimate is refreshed after this many new latency samples
+constexpr std::size_t kPercentileRefreshInterval = 64;
+}
+
+CircuitBreakerBankBackend::CircuitBreakerBankBackend(std::shared_ptr<BankBackend> primary,
+                                                     std::shared_ptr<BankBackend> secondary,
+                                                     const CircuitBreakerConfig& config)
+    : m_primary(std::move(primary)),
+      m_secondary(std::move(secondary)),
+      m_config(config),
+      m_state(CircuitState::CLOSED),
+      m_window(std::max<std::size_t>(1, config.windowSize), 0),
+      m_windowNext(0),
+      m_windowCount(0),
+      m_windowErrors(0),
+      m_windowSlow(0),
+      m_probesInFlight(0),
+      m_probeSuccesses(0),
+      m_latencies(std::max<std::size_t>(1, config.latencySamples), 0),
+      m_latencyNext(0),
+      m_latencyCount(0),
+      m_p95Micros(0),
+      m_requests(0),
+      m_rejected(0),
+      m_failedOver(0),
+      m_hedged(0),
+      m_hedgeWins(0),
+      m_timesOpened(0) {
+}
+
+void CircuitBreakerBankBackend::authorize(const BankAuthorizationRequest& request, Callback callback) {
+    ++m_requests;
+
+    bool probe = false;
+    if (!allowRequest(probe)) {
+        if (m_secondary) {
+            ++m_failedOver;
+            m_secondary->authorize(request, std::move(callback));
+        } else {
+            ++m_rejected;
+            callback(BankAuthorizationResponse{BankResponseCode::ERROR, std::chrono::microseconds(0)});
+        }
+        return;
+    }
+
+    auto attempt = std::make_shared<Attempt>();
+    attempt->request = request;
+    attempt->callback = std::move(callback);
+    attempt->started = Clock::now();
+    attempt->probe = probe;
+
+    auto self = shared_from_this();
+
+    // Probes must reach the primary on their own, so they are never hedged
+    std::int64_t p95Micros = m_p95Micros.load();
+    if (m_config.hedgingEnabled && m_secondary && p95Micros > 0 && !probe) {
+        std::chrono::microseconds delay = std::max(std::chrono::microseconds(p95Micros), m_config.minimumHedgeDelay);
+        attempt->hedgeTimer = TimingWheel::getInstance().schedule(delay, [self, attempt]() {
+            self->sendHedge(attempt);
+        });
+    }
+
+    m_primary->authorize(attempt->request, [self, attempt](const BankAuthorizationResponse& response) {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - attempt->started);
+        self->recordOutcome(response.code, latency, attempt->probe);
+
+        if (attempt->hedgeTimer != 0) {
+            TimingWheel::getInstance().cancel(attempt->hedgeTimer);
+        }
+        if (!deliver(*attempt, BankAuthorizationResponse{response.code, latency}) &&
+            response.code == BankResponseCode::APPROVED) {
+            self->m_primary->reverse(attempt->request); // Lost to the hedge
+        }
+    });
+}
+
+void CircuitBreakerBankBackend::capture(const BankAuthorizationRequest& request) {
+    m_primary->capture(request);
+    if (m_secondary) {
+        m_secondary->capture(request);
+    }
+}
+
+void CircuitBreakerBankBackend::reverse(const BankAuthorizationRequest& request) {
+    m_primary->reverse(request);
+    if (m_secondary) {
+        m_secondary->reverse(request);
+    }
+}
+
+std::string CircuitBreakerBankBackend::getName() const {
+    return "CircuitBreaker(" + m_primary->getName() + ")";
+}
+
+CircuitState CircuitBreakerBankBackend::getState() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state;
+}
+
+CircuitBreakerStatistics CircuitBreakerBankBackend::getStatistics() const {
+    return CircuitBreakerStatistics{
+        getState(),
+        m_requests.load(),
+        m_rejected.load(),
+        m_failedOver.load(),
+        m_hedged.load(),
+        m_hedgeWins.load(),
+        m_timesOpened.load(),
+        std::chrono::microseconds(m_p95Micros.load())
+    };
+}
+
+std::string CircuitBreakerBankBackend::stateToString(CircuitState state) {
+    switch (state) {
+        case CircuitState::CLOSED:
+            return "Closed";
+        case CircuitState::OPEN:
+            return "Open";
+        case CircuitState::HALF_OPEN:
+            return "Half-Open";
+        default:
+            return "Unknown";
+    }
+}
+
+bool CircuitBreakerBankBackend::allowRequest(bool& probe) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_state == CircuitState::CLOSED) {
+        return true;
+    }
+
+    if (m_state == CircuitState::OPEN) {
+        if (Clock::now() - m_openedAt < m_config.openDuration) {
+            return false;
+        }
+        std::cout << "Circuit breaker for " << m_primary->getName() << " half-open, probing" << std::endl;
+        m_state = CircuitState::HALF_OPEN;
+        m_probesInFlight = 0;
+        m_probeSuccesses = 0;
+    }
+
+    if (m_probesInFlight >= std::max<std::size_t>(1, m_config.halfOpenProbes)) {
+        return false;
+    }
+
+    ++m_probesInFlight;
+    probe = true;
+    return true;
+}
+
+void CircuitBreakerBankBackend::recordOutcome(BankResponseCode code, std::chrono::microseconds latency, bool probe) {
+    bool failed = code == BankResponseCode::ERROR || code == BankResponseCode::TIMEOUT;
+    bool slow = latency >= m_config.slowCallThreshold;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_latencies[m_latencyNext] = latency.count();
+    m_latencyNext = (m_latencyNext + 1) % m_latencies.size();
+    m_latencyCount = std::min(m_latencyCount + 1, m_latencies.size());
+    if (m_latencyCount >= m_config.minimumRequests && m_latencyNext % kPercentileRefreshInterval == 0) {
+        std::vector<std::int64_t> samples(m_latencies.begin(), m_latencies.begin() + m_latencyCount);
+        auto p95 = samples.begin() + static_cast<std::ptrdiff_t>(samples.size() * 95 / 100);
+        std::nth_element(samples.begin(), p95, samples.end());
+        m_p95Micros = *p95;
+    }
+
+    if (m_state == CircuitState::HALF_OPEN) {
+        if (!probe) {
+            return; // Answer to a request sent before the circuit opened
+        }
+        if (m_probesInFlight > 0) {
+            --m_probesInFlight;
+        }
+        if (failed || slow) {
+            openLocked(Clock::now());
+        } else if (++m_probeSuccesses >= m_config.halfOpenProbes) {
+            std::cout << "Circuit breaker for " << m_primary->getName() << " closed" << std::endl;
+            m_state = CircuitState::CLOSED;
+        }
+        return;
+    }
+
+    if (m_state != CircuitState::CLOSED) {
+        return;
+    }
+
+    std::uint8_t outcome = (failed ? kOutcomeError : 0) | (slow ? kOutcomeSlow : 0);
+    if (m_windowCount == m_window.size()) {
+        std::uint8_t evicted = m_window[m_windowNext];
+        m_windowErrors -= (evicted & kOutcomeError) ? 1 : 0;
+        m_windowSlow -= (evicted & kOutcomeSlow) ? 1 : 0;
+    } else {
+        ++m_windowCount;
+    }
+    m_window[m_windowNext] = outcome;
+    m_windowNext = (m_windowNext + 1) % m_window.size();
+    m_windowErrors += failed ? 1 : 0;
+    m_windowSlow += slow ? 1 : 0;
+
+    if (m_windowCount < m_config.minimumRequests) {
+        return;
+    }
+
+    double count = static_cast<double>(m_windowCount);
+    if (m_windowErrors / count >= m_config.errorRateThreshold ||
+        m_windowSlow / count >= m_config.slowCallRateThreshold) {
+        openLocked(Clock::now());
+    }
+}
+
+void CircuitBreakerBankBackend::openLocked(Clock::time_point now) {
+    std::cout << "Circuit breaker for " << m_primary->getName() << " opened" << std::endl;
+
+    m_state = CircuitState::OPEN;
+    m_openedAt = now;
+    m_probesInFlight = 0;
+    m_probeSuccesses = 0;
+
+    // Start the next closed period with a clean window
+    std::fill(m_window.begin(), m_window.end(), 0);
+    m_windowNext = 0;
+    m_windowCount = 0;
+    m_windowErrors = 0;
+    m_windowSlow = 0;
+
+    ++m_timesOpened;
+}
+
+void CircuitBreakerBankBackend::sendHedge(const std::shared_ptr<Attempt>& attempt) {
+    if (attempt->answered.load()) {
+        return;
+    }
+
+    ++m_hedged;
+
+    auto self = shared_from_this();
+    m_secondary->authorize(attempt->request, [self, attempt](const BankAuthorizationResponse& response) {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - attempt->started);
+        if (deliver(*attempt, BankAuthorizationResponse{response.code, latency})) {
+            ++self->m_hedgeWins;
+        } else if (response.code == BankResponseCode::APPROVED) {
+            self->m_secondary->reverse(attempt->request); // Lost to the primary
+        }
+    });
+}
+
+bool CircuitBreakerBankBackend::deliver(Attempt& attempt, const BankAuthorizationResponse& response) {
+    if (attempt.answered.exchange(true)) {
+        return false;
+    }
+
+    attempt.callback(response);
+    return true;
+}
@@ -0,0 +1,188 @@
+#ifndef CIRCUITBREAKERBANKBACKEND_H
+#define CIRCUITBREAKERBANKBACKEND_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "bankbackend.h"
+#include "timingwheel.h"
+
+/**
+ * @enum CircuitState
+ * @brief State of a circuit breaker
+ */
+enum class CircuitState {
+    CLOSED,    ///< Requests flow to the primary backend
+    OPEN,      ///< Primary is considered down; requests fail fast or go to the secondary
+    HALF_OPEN  ///< A limited number of probe requests test whether the primary has recovered
+};
+
+/**
+ * @struct CircuitBreakerConfig
+ * @brief Thresholds for CircuitBreakerBankBackend
+ */
+struct CircuitBreakerConfig {
+    std::size_t windowSize = 100;                        ///< Most recent primary outcomes considered
+    std::size_t minimumRequests = 20;                    ///< Outcomes needed in the window before it can trip
+    double errorRateThreshold = 0.5;                     ///< Fraction of ERROR/TIMEOUT answers that opens the circuit
+    std::chrono::microseconds slowCallThreshold{2000000}; ///< Answers at least this slow count as slow
+    double slowCallRateThreshold = 0.8;                  ///< Fraction of slow answers that opens the circuit
+    std::chrono::milliseconds openDuration{5000};        ///< Time spent open before probing
+    std::size_t halfOpenProbes = 3;                      ///< Successful probes needed to close again
+    bool hedgingEnabled = false;                         ///< Duplicate slow requests to the secondary
+    std::size_t latencySamples = 1024;                   ///< Recent latencies used for the p95 estimate
+    std::chrono::microseconds minimumHedgeDelay{1000};   ///< Floor for the hedge delay
+};
+
+/**
+ * @struct CircuitBreakerStatistics
+ * @brief Counters describing circuit breaker behaviour
+ */
+struct CircuitBreakerStatistics {
+    CircuitState state;
+    std::uint64_t requests;
+    std::uint64_t rejected;       ///< Failed fast while open, no secondary configured
+    std::uint64_t failedOver;     ///< Sent straight to the secondary while open
+    std::uint64_t hedged;         ///< Duplicates sent to the secondary
+    std::uint64_t hedgeWins;      ///< Hedged requests answered first by the secondary
+    std::uint64_t timesOpened;
+    std::chrono::microseconds p95Latency;
+};
+
+/**
+ * @class CircuitBreakerBankBackend
+ * @brief Decorator that guards a primary bank backend with a circuit breaker and optional hedging
+ *
+ * Outcomes of primary calls are kept in a sliding window. When the window
+ * holds enough calls and the share of errors or slow answers crosses its
+ * threshold the circuit opens: requests are answered with ERROR at once, or
+ * routed to the secondary backend if there is one. After openDuration a few
+ * probes are let through; if they succeed the circuit closes, otherwise it
+ * opens again.
+ *
+ * With hedging enabled, a request still unanswered after the primary's
+ * recent p95 latency is also sent to the secondary and the first answer
+ * wins. A losing approval is reversed on the backend that gave it, so its
+ * hold does not outlive the request. Captures and reversals from the bank
+ * go to both backends; only the one that approved holds anything.
+ *
+ * Outstanding requests keep the decorator alive, so it must be owned by a
+ * std::shared_ptr.
+ */
+class CircuitBreakerBankBackend : public BankBackend,
+                                  public std::enable_shared_from_this<CircuitBreakerBankBackend> {
+public:
+    /**
+     * @brief Constructor
+     * @param primary The backend being protected
+     * @param secondary Optional backend for fail-over and hedging
+     * @param config Breaker and hedging thresholds
+     */
+    CircuitBreakerBankBackend(std::shared_ptr<BankBackend> primary,
+                              std::shared_ptr<BankBackend> secondary = nullptr,
+                              const CircuitBreakerConfig& config = CircuitBreakerConfig());
+
+    void authorize(const BankAuthorizationRequest& request, Callback callback) override;
+    void capture(const BankAuthorizationRequest& request) override;
+    void reverse(const BankAuthorizationRequest& request) override;
+    std::string getName() const override;
+
+    /**
+     * @brief Get the current breaker state
+     * @return The circuit state
+     */
+    CircuitState getState() const;
+
+    /**
+     * @brief Get breaker and hedging counters
+     * @return Snapshot of the statistics
+     */
+    CircuitBreakerStatistics getStatistics() const;
+
+    /**
+     * @brief Convert a circuit state to a string
+     * @param state The circuit state
+     * @return The state as a string
+     */
+    static std::string stateToString(CircuitState state);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // One request as seen by the breaker; shared by the primary answer, the hedge timer and the secondary answer
+    struct Attempt {
+        BankAuthorizationRequest request;
+        Callback callback;
+        Clock::time_point started;
+        bool probe;
+        std::atomic<bool> answered{false};
+        TimingWheel::TimerId hedgeTimer = 0;
+    };
+
+    /**
+     * @brief Decide whether the primary may be called, moving OPEN to HALF_OPEN when due
+     * @param probe Set to true if the request is a half-open probe
+     * @return True if the primary may be called
+     */
+    bool allowRequest(bool& probe);
+
+    /**
+     * @brief Feed a primary outcome into the window and state machine
+     * @param code The primary's answer
+     * @param latency Time the primary took
+     * @param probe Whether the request was a half-open probe
+     */
+    void recordOutcome(BankResponseCode code, std::chrono::microseconds latency, bool probe);
+
+    /**
+     * @brief Trip the breaker; caller holds m_mutex
+     * @param now The current time
+     */
+    void openLocked(Clock::time_point now);
+
+    /**
+     * @brief Send the duplicate request to the secondary
+     * @param attempt The request being hedged
+     */
+    void sendHedge(const std::shared_ptr<Attempt>& attempt);
+
+    /**
+     * @brief Deliver the first answer for an attempt
+     * @param attempt The request
+     * @param response The answer
+     * @return True if this answer was the one delivered
+     */
+    static bool deliver(Attempt& attempt, const BankAuthorizationResponse& response);
+
+    std::shared_ptr<BankBackend> m_primary;
+    std::shared_ptr<BankBackend> m_secondary;
+    CircuitBreakerConfig m_config;
+
+    mutable std::mutex m_mutex;
+    CircuitState m_state;
+    Clock::time_point m_openedAt;
+    std::vector<std::uint8_t> m_window;  ///< Ring of outcome flags, see recordOutcome()
+    std::size_t m_windowNext;
+    std::size_t m_windowCount;
+    std::size_t m_windowErrors;
+    std::size_t m_windowSlow;
+    std::size_t m_probesInFlight;
+    std::size_t m_probeSuccesses;
+    std::vector<std::int64_t> m_latencies; ///< Ring of recent primary latencies in microseconds
+    std::size_t m_latencyNext;
+    std::size_t m_latencyCount;
+
+    std::atomic<std::int64_t> m_p95Micros; ///< 0 until enough samples have been seen
+    std::atomic<std::uint64_t> m_requests;
+    std::atomic<std::uint64_t> m_rejected;
+    std::atomic<std::uint64_t> m_failedOver;
+    std::atomic<std::uint64_t> m_hedged;
+    std::atomic<std::uint64_t> m_hedgeWins;
+    std::atomic<std::uint64_t> m_timesOpened;
+};
+
+#endif // CIRCUITBREAKERBANKBACKEND_H
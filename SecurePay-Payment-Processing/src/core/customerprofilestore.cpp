@@ -0,0 +1,266 @@
+#include "customerprofilestore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr char kSnapshotMagic[4] = {'S', 'P', 'C', 'P'};
+constexpr std::uint32_t kSnapshotVersion = 1;
+
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t recordSize;   ///< Guards against reading a snapshot from a build with another layout
+    std::uint64_t records;
+};
+
+} // namespace
+
+CustomerProfileStore::CustomerProfileStore(std::size_t maxProfiles, double alpha, std::size_t stripeCount)
+    : m_alpha(std::min(1.0, std::max(1e-6, alpha))) {
+    stripeCount = std::max<std::size_t>(1, stripeCount);
+    m_profilesPerStripe = std::max<std::size_t>(1, maxProfiles / stripeCount);
+
+    m_stripes.reserve(stripeCount);
+    for (std::size_t i = 0; i < stripeCount; ++i) {
+        m_stripes.push_back(std::make_unique<Stripe>());
+    }
+}
+
+CustomerProfileSignals CustomerProfileStore::observe(const std::string& customer, const std::string& merchant,
+                                                     const std::string& paymentMethod, double amount,
+                                                     std::chrono::system_clock::time_point time) {
+    const std::uint64_t merchantKey = hashKey(merchant);
+    const std::uint64_t paymentMethodKey = hashKey(paymentMethod);
+    const std::size_t hour = hourOf(time);
+
+    const std::uint64_t key = hashKey(customer);
+    Stripe& stripe = stripeFor(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+
+    Profile& profile = touch(stripe, key);
+    CustomerProfileSignals signals = signalsFor(&profile, merchantKey, paymentMethodKey, amount, hour);
+
+    // Exponentially weighted mean and variance, with 1 / n weights while the profile is young
+    ++profile.transactions;
+    const double weight = std::max(m_alpha, 1.0 / profile.transactions);
+    const double difference = amount - profile.meanAmount;
+    const double increment = weight * difference;
+    profile.meanAmount += increment;
+    profile.amountVariance = (1.0 - weight) * (profile.amountVariance + difference * increment);
+
+    remember(profile.merchants, merchantKey, static_cast<float>(weight));
+    remember(profile.paymentMethods, paymentMethodKey, static_cast<float>(weight));
+    for (float& share : profile.hours) {
+        share *= static_cast<float>(1.0 - weight);
+    }
+    profile.hours[hour] += static_cast<float>(weight);
+
+    return signals;
+}
+
+CustomerProfileSignals CustomerProfileStore::compare(const std::string& customer, const std::string& merchant,
+                                                     const std::string& paymentMethod, double amount,
+                                                     std::chrono::system_clock::time_point time) const {
+    const std::uint64_t key = hashKey(customer);
+    Stripe& stripe = stripeFor(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+
+    auto it = stripe.index.find(key);
+    const Profile* profile = it != stripe.index.end() ? &*it->second : nullptr;
+    return signalsFor(profile, hashKey(merchant), hashKey(paymentMethod), amount, hourOf(time));
+}
+
+std::size_t CustomerProfileStore::size() const {
+    std::size_t profiles = 0;
+    for (const auto& stripe : m_stripes) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        profiles += stripe->entries.size();
+    }
+    return profiles;
+}
+
+bool CustomerProfileStore::save(const std::string& filePath) const {
+    // Copied out stripe by stripe so transactions are only held up for one stripe at a time
+    std::vector<Profile> profiles;
+    for (const auto& stripe : m_stripes) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        profiles.insert(profiles.end(), stripe->entries.begin(), stripe->entries.end());
+    }
+
+    const std::string savePath = filePath + ".saving";
+    {
+        std::ofstream file(savePath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << savePath << " for writing" << std::endl;
+            return false;
+        }
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+        header.version = kSnapshotVersion;
+        header.recordSize = sizeof(Profile);
+        header.records = profiles.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(profiles.data()),
+                   static_cast<std::streamsize>(profiles.size() * sizeof(Profile)));
+
+        if (!file.flush()) {
+            std::cerr << "Failed to write customer profiles to " << savePath << std::endl;
+            file.close();
+            std::remove(savePath.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(savePath.c_str(), filePath.c_str()) != 0) {
+        std::cerr << "Failed to replace customer profile snapshot " << filePath << std::endl;
+        std::remove(savePath.c_str());
+        return false;
+    }
+
+    std::cout << "Saved " << profiles.size() << " customer profiles to " << filePath << std::endl;
+    return true;
+}
+
+bool CustomerProfileStore::load(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open customer profile snapshot " << filePath << std::endl;
+        return false;
+    }
+
+    SnapshotHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 ||
+        header.version != kSnapshotVersion || header.recordSize != sizeof(Profile)) {
+        std::cerr << filePath << " is not a customer profile snapshot this build can read" << std::endl;
+        return false;
+    }
+
+    std::vector<Profile> profiles(static_cast<std::size_t>(header.records));
+    if (!file.read(reinterpret_cast<char*>(profiles.data()),
+                   static_cast<std::streamsize>(profiles.size() * sizeof(Profile)))) {
+        std::cerr << "Customer profile snapshot " << filePath << " is truncated" << std::endl;
+        return false;
+    }
+
+    for (auto& stripe : m_stripes) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        stripe->entries.clear();
+        stripe->index.clear();
+    }
+
+    // Each stripe was saved most recently active first, so appending keeps its LRU order
+    for (const Profile& profile : profiles) {
+        Stripe& stripe = stripeFor(profile.key);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        if (stripe.entries.size() < m_profilesPerStripe && stripe.index.find(profile.key) == stripe.index.end()) {
+            stripe.entries.push_back(profile);
+            stripe.index.emplace(profile.key, std::prev(stripe.entries.end()));
+        }
+    }
+
+    std::cout << "Loaded " << profiles.size() << " customer profiles from " << filePath << std::endl;
+    return true;
+}
+
+CustomerProfileSignals CustomerProfileStore::signalsFor(const Profile* profile, std::uint64_t merchant,
+                                                        std::uint64_t paymentMethod, double amount,
+                                                        std::size_t hour) {
+    CustomerProfileSignals signals{0, 0.0, false, false, 0.0};
+    if (!profile || profile->transactions == 0) {
+        return signals;
+    }
+
+    signals.priorTransactions = profile->transactions;
+    signals.newMerchant = !isUsual(profile->merchants, merchant);
+    signals.newPaymentMethod = !isUsual(profile->paymentMethods, paymentMethod);
+
+    if (profile->transactions >= 2) {
+        // A customer who always spends the same would make any change look extreme, so the
+        // deviation is floored at a tenth of the usual amount, and at one currency unit
+        double deviation = std::max(std::sqrt(profile->amountVariance),
+                                    std::max(1.0, 0.1 * std::fabs(profile->meanAmount)));
+        signals.amountZScore = (amount - profile->meanAmount) / deviation;
+    }
+
+    float total = 0.0f;
+    for (float share : profile->hours) {
+        total += share;
+    }
+    if (total > 0.0f) {
+        signals.hourShare = profile->hours[hour] / total;
+    }
+    return signals;
+}
+
+template <std::size_t N>
+void CustomerProfileStore::remember(std::array<Usual, N>& slots, std::uint64_t key, float weight) {
+    Usual* target = nullptr;
+    Usual* lightest = &slots[0];
+    for (Usual& slot : slots) {
+        slot.weight *= 1.0f - weight;
+        if (slot.key == key) {
+            target = &slot;
+        } else if (slot.weight < lightest->weight) {
+            lightest = &slot;
+        }
+    }
+
+    if (!target) {
+        target = lightest;
+        *target = Usual{key, 0.0f};
+    }
+    target->weight += weight;
+}
+
+template <std::size_t N>
+bool CustomerProfileStore::isUsual(const std::array<Usual, N>& slots, std::uint64_t key) {
+    for (const Usual& slot : slots) {
+        if (slot.key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint64_t CustomerProfileStore::hashKey(const std::string& text) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+std::size_t CustomerProfileStore::hourOf(std::chrono::system_clock::time_point time) {
+    auto hours = std::chrono::duration_cast<std::chrono::hours>(time.time_since_epoch()).count();
+    return static_cast<std::size_t>(((hours % 24) + 24) % 24);
+}
+
+CustomerProfileStore::Profile& CustomerProfileStore::touch(Stripe& stripe, std::uint64_t key) {
+    auto it = stripe.index.find(key);
+    if (it != stripe.index.end()) {
+        stripe.entries.splice(stripe.entries.begin(), stripe.entries, it->second);
+    } else {
+        if (stripe.entries.size() >= m_profilesPerStripe) {
+            // Reuse the least recently active profile rather than freeing and allocating
+            stripe.index.erase(stripe.entries.back().key);
+            stripe.entries.splice(stripe.entries.begin(), stripe.entries, std::prev(stripe.entries.end()));
+            stripe.entries.front() = Profile{};
+        } else {
+            stripe.entries.emplace_front();
+        }
+        stripe.entries.front().key = key;
+        stripe.index.emplace(key, stripe.entries.begin());
+    }
+    return stripe.entries.front();
+}
+
+CustomerProfileStore::Stripe& CustomerProfileStore::stripeFor(std::uint64_t key) const {
+    return *m_stripes[key % m_stripes.size()];
+}
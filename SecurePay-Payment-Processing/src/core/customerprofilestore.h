@@ -0,0 +1,198 @@
+#ifndef CUSTOMERPROFILESTORE_H
+#define CUSTOMERPROFILESTORE_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct CustomerProfileSignals
+ * @brief How one transaction compares with the customer's profile before it
+ *
+ * Everything is zero or false for a customer without history.
+ */
+struct CustomerProfileSignals {
+    std::uint32_t priorTransactions;    ///< Transactions the profile was built from
+    double amountZScore;                ///< Standard deviations the amount lies above the usual amount
+    bool newMerchant;                   ///< Merchant is not among the customer's usual merchants
+    bool newPaymentMethod;              ///< Payment method is not among the customer's usual ones
+    double hourShare;                   ///< Share of the customer's activity in this UTC hour of the day, 0 to 1
+};
+
+/**
+ * @class CustomerProfileStore
+ * @brief Running behavioural profiles per customer, updated in constant time per transaction
+ *
+ * A profile holds an exponentially weighted mean and variance of the
+ * amount, the few merchants and payment methods the customer uses most
+ * and a decayed histogram of the UTC hour of day they buy at. Nothing
+ * refers back to past transactions, so observing one costs the same
+ * however long the history is. Until a profile has seen 1 / alpha
+ * transactions the weights are 1 / n, which makes the early mean and
+ * variance plain averages instead of leaning on the first amount.
+ *
+ * Profiles are spread over lock stripes, each an LRU list with a hash
+ * index, and the least recently active customer is evicted when a stripe
+ * is full. save() and load() snapshot the profiles to a binary file so a
+ * restart keeps them; the file is written in the host's byte order.
+ */
+class CustomerProfileStore {
+public:
+    /**
+     * @brief Constructor
+     * @param maxProfiles Upper bound on profiles held across all stripes
+     * @param alpha Weight of each new transaction; smaller remembers longer
+     * @param stripeCount Number of independently locked stripes
+     */
+    explicit CustomerProfileStore(std::size_t maxProfiles = 65536, double alpha = 0.05, std::size_t stripeCount = 64);
+
+    CustomerProfileStore(const CustomerProfileStore&) = delete;
+    CustomerProfileStore& operator=(const CustomerProfileStore&) = delete;
+
+    /**
+     * @brief Compare a transaction with its customer's profile, then fold it in
+     * @param customer The customer name
+     * @param merchant The merchant name
+     * @param paymentMethod The payment method fingerprint
+     * @param amount The transaction amount
+     * @param time When the transaction was made
+     * @return How the transaction compares with the profile as it was before it
+     */
+    CustomerProfileSignals observe(const std::string& customer, const std::string& merchant,
+                                   const std::string& paymentMethod, double amount,
+                                   std::chrono::system_clock::time_point time);
+
+    /**
+     * @brief Compare a transaction with its customer's profile without changing it
+     * @param customer The customer name
+     * @param merchant The merchant name
+     * @param paymentMethod The payment method fingerprint
+     * @param amount The transaction amount
+     * @param time When the transaction was made
+     * @return The comparison; an unknown customer has no prior transactions
+     */
+    CustomerProfileSignals compare(const std::string& customer, const std::string& merchant,
+                                   const std::string& paymentMethod, double amount,
+                                   std::chrono::system_clock::time_point time) const;
+
+    /**
+     * @brief Get the number of profiles held
+     * @return Profiles across all stripes
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Write every profile to a file
+     *
+     * The snapshot is written next to filePath and renamed over it once
+     * complete, so a crash never leaves a truncated file behind.
+     *
+     * @param filePath The snapshot file
+     * @return True if the snapshot was written
+     */
+    bool save(const std::string& filePath) const;
+
+    /**
+     * @brief Replace the profiles with those of a snapshot
+     * @param filePath A file written by save()
+     * @return True if the snapshot was read; on failure the profiles are unchanged
+     */
+    bool load(const std::string& filePath);
+
+private:
+    static constexpr std::size_t kUsualMerchants = 8;
+    static constexpr std::size_t kUsualPaymentMethods = 4;
+
+    struct Usual {
+        std::uint64_t key;      ///< Hash of the merchant or payment method; 0 marks a free slot
+        float weight;
+    };
+
+    // Plain data so snapshots can be written and read as raw records
+    struct Profile {
+        std::uint64_t key;
+        std::uint32_t transactions;
+        double meanAmount;
+        double amountVariance;
+        std::array<Usual, kUsualMerchants> merchants;
+        std::array<Usual, kUsualPaymentMethods> paymentMethods;
+        std::array<float, 24> hours;
+    };
+
+    struct Stripe {
+        mutable std::mutex mutex;
+        std::list<Profile> entries;     ///< Most recently active first
+        std::unordered_map<std::uint64_t, std::list<Profile>::iterator> index;
+    };
+
+    /**
+     * @brief Compare a transaction with a profile
+     * @param profile The profile, or nullptr for an unknown customer
+     * @param merchant Hash of the merchant
+     * @param paymentMethod Hash of the payment method
+     * @param amount The transaction amount
+     * @param hour The UTC hour of the day
+     * @return The comparison
+     */
+    static CustomerProfileSignals signalsFor(const Profile* profile, std::uint64_t merchant,
+                                             std::uint64_t paymentMethod, double amount, std::size_t hour);
+
+    /**
+     * @brief Decay every slot and credit one key, taking over the lightest slot if the key is new
+     * @param slots The usual merchants or payment methods
+     * @param key Hash of the merchant or payment method
+     * @param weight Weight of the new transaction
+     */
+    template <std::size_t N>
+    static void remember(std::array<Usual, N>& slots, std::uint64_t key, float weight);
+
+    /**
+     * @brief Check whether a key holds a slot
+     * @param slots The usual merchants or payment methods
+     * @param key Hash of the merchant or payment method
+     * @return True if the key is among them
+     */
+    template <std::size_t N>
+    static bool isUsual(const std::array<Usual, N>& slots, std::uint64_t key);
+
+    /**
+     * @brief Hash a name into a non-zero 64-bit key
+     * @param text The name
+     * @return The hash
+     */
+    static std::uint64_t hashKey(const std::string& text);
+
+    /**
+     * @brief Get the UTC hour of the day of a time
+     * @param time The time
+     * @return 0 to 23
+     */
+    static std::size_t hourOf(std::chrono::system_clock::time_point time);
+
+    /**
+     * @brief Find a customer's profile, creating or recycling one if needed; stripe.mutex must be held
+     * @param stripe The stripe responsible for the key
+     * @param key Hash of the customer
+     * @return The profile, moved to the front of the LRU list
+     */
+    Profile& touch(Stripe& stripe, std::uint64_t key);
+
+    /**
+     * @brief Select the stripe responsible for a key
+     * @param key Hash of the customer
+     * @return Reference to the stripe
+     */
+    Stripe& stripeFor(std::uint64_t key) const;
+
+    std::vector<std::unique_ptr<Stripe>> m_stripes;
+    std::size_t m_profilesPerStripe;
+    double m_alpha;
+};
+
+#endif // CUSTOMERPROFILESTORE_H
@@ -72,6 +72,13 @@ public:
      */
     virtual bool saveTransaction(const Transaction& transaction) = 0;
     
+    /**
+     * @brief Save many transactions to storage as one unit
+     * @param transactions The transactions to save
+     * @return True if every transaction was saved, false if none were
+     */
+    virtual bool saveTransactions(const std::vector<const Transaction*>& transactions) = 0;
+    
     /**
      * @brief Load all transactions from storage
      * @param customers Vector of customers for reference
@@ -104,6 +111,13 @@ public:
      */
     virtual bool saveFraudAlert(const FraudAlert& fraudAlert) = 0;
     
+    /**
+     * @brief Save many fraud alerts to storage as one unit
+     * @param fraudAlerts The fraud alerts to save
+     * @return True if every alert was saved, false if none were
+     */
+    virtual bool saveFraudAlerts(const std::vector<const FraudAlert*>& fraudAlerts) = 0;
+    
     /**
      * @brief Load all fraud alerts from storage
      * @param transactions Vector of transactions for reference
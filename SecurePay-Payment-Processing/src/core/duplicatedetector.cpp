@@ -0,0 +1,203 @@
+#include "duplicatedetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr std::size_t kInitialSlots = 64;
+
+std::uint64_t mixBytes(std::uint64_t hash, const void* data, std::size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < length; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::uint64_t mixString(std::uint64_t hash, const std::string& text) {
+    // The length goes in first so "ab" + "c" and "a" + "bc" differ
+    std::uint64_t length = text.size();
+    hash = mixBytes(hash, &length, sizeof(length));
+    return mixBytes(hash, text.data(), text.size());
+}
+
+} // namespace
+
+DuplicateDetector::DuplicateDetector(Clock::duration window)
+    : m_slices{},
+      m_duplicates(0) {
+    setWindow(window);
+}
+
+bool DuplicateDetector::checkAndRecord(const Transaction& transaction, Clock::time_point now) {
+    return checkAndRecord(fingerprint(transaction), now);
+}
+
+bool DuplicateDetector::checkAndRecord(std::uint64_t fingerprint, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_sliceWidth == Clock::duration::zero()) {
+        return false;
+    }
+
+    const std::uint64_t period = periodOf(now);
+    if (containsLocked(fingerprint, period)) {
+        ++m_duplicates;
+        return true;
+    }
+    recordLocked(fingerprint, period);
+    return false;
+}
+
+bool DuplicateDetector::check(std::uint64_t fingerprint, Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sliceWidth != Clock::duration::zero() && containsLocked(fingerprint, periodOf(now));
+}
+
+void DuplicateDetector::record(std::uint64_t fingerprint, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_sliceWidth != Clock::duration::zero()) {
+        recordLocked(fingerprint, periodOf(now));
+    }
+}
+
+void DuplicateDetector::forget(const Transaction& transaction) {
+    forget(fingerprint(transaction));
+}
+
+void DuplicateDetector::forget(std::uint64_t fingerprint) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Slice& slice : m_slices) {
+        if (slice.period != 0) {
+            erase(slice, fingerprint);
+        }
+    }
+}
+
+void DuplicateDetector::setWindow(Clock::duration window) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sliceWidth = window > Clock::duration::zero()
+        ? std::max<Clock::duration>(Clock::duration(1), window / kSlices)
+        : Clock::duration::zero();
+    for (Slice& slice : m_slices) {
+        slice = Slice{0, 0, std::vector<std::uint64_t>(kInitialSlots, 0)};
+    }
+}
+
+DuplicateDetector::Clock::duration DuplicateDetector::getWindow() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sliceWidth * kSlices;
+}
+
+std::uint64_t DuplicateDetector::getDuplicateCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_duplicates;
+}
+
+std::uint64_t DuplicateDetector::fingerprint(const std::string& customer, const std::string& merchant,
+                                             std::int64_t amountCents, const std::string& paymentMethod) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    hash = mixString(hash, customer);
+    hash = mixString(hash, merchant);
+    hash = mixBytes(hash, &amountCents, sizeof(amountCents));
+    hash = mixString(hash, paymentMethod);
+
+    // splitmix64 finalizer, so the low bits used for the slot index depend on every field
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash != 0 ? hash : 1;
+}
+
+std::uint64_t DuplicateDetector::fingerprint(const Transaction& transaction) {
+    return fingerprint(transaction.getCustomer().getName(),
+                       transaction.getMerchant().getName(),
+                       static_cast<std::int64_t>(std::llround(transaction.getAmount() * 100.0)),
+                       transaction.getPaymentMethod().getFingerprint());
+}
+
+std::uint64_t DuplicateDetector::periodOf(Clock::time_point now) const {
+    // Period 0 marks an unused slice, so real periods start at 1
+    return static_cast<std::uint64_t>(now.time_since_epoch() / m_sliceWidth) + 1;
+}
+
+bool DuplicateDetector::containsLocked(std::uint64_t fingerprint, std::uint64_t period) const {
+    for (const Slice& slice : m_slices) {
+        if (slice.period != 0 && period - slice.period <= kSlices && contains(slice, fingerprint)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DuplicateDetector::recordLocked(std::uint64_t fingerprint, std::uint64_t period) {
+    Slice& current = m_slices[period % m_slices.size()];
+    if (current.period != period) {
+        // Whatever this slice held has aged out of the window
+        current.period = period;
+        current.used = 0;
+        current.slots.assign(std::max(kInitialSlots, current.slots.size()), 0);
+    }
+    insert(current, fingerprint);
+}
+
+bool DuplicateDetector::contains(const Slice& slice, std::uint64_t fingerprint) {
+    const std::size_t mask = slice.slots.size() - 1;
+    for (std::size_t i = fingerprint & mask;; i = (i + 1) & mask) {
+        if (slice.slots[i] == fingerprint) {
+            return true;
+        }
+        if (slice.slots[i] == 0) {
+            return false;
+        }
+    }
+}
+
+void DuplicateDetector::insert(Slice& slice, std::uint64_t fingerprint) {
+    if ((slice.used + 1) * 2 > slice.slots.size()) {
+        std::vector<std::uint64_t> old(slice.slots.size() * 2, 0);
+        old.swap(slice.slots);
+        slice.used = 0;
+        for (std::uint64_t entry : old) {
+            if (entry != 0) {
+                insert(slice, entry);
+            }
+        }
+    }
+
+    const std::size_t mask = slice.slots.size() - 1;
+    for (std::size_t i = fingerprint & mask;; i = (i + 1) & mask) {
+        if (slice.slots[i] == fingerprint) {
+            return;
+        }
+        if (slice.slots[i] == 0) {
+            slice.slots[i] = fingerprint;
+            ++slice.used;
+            return;
+        }
+    }
+}
+
+void DuplicateDetector::erase(Slice& slice, std::uint64_t fingerprint) {
+    const std::size_t mask = slice.slots.size() - 1;
+    std::size_t hole = fingerprint & mask;
+    while (slice.slots[hole] != fingerprint) {
+        if (slice.slots[hole] == 0) {
+            return;
+        }
+        hole = (hole + 1) & mask;
+    }
+
+    // Without tombstones, a later entry of the run moves into the hole unless its home slot lies after the hole
+    for (std::size_t next = (hole + 1) & mask; slice.slots[next] != 0; next = (next + 1) & mask) {
+        const std::size_t home = slice.slots[next] & mask;
+        const bool homeAfterHole = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!homeAfterHole) {
+            slice.slots[hole] = slice.slots[next];
+            hole = next;
+        }
+    }
+    slice.slots[hole] = 0;
+    --slice.used;
+}
@@ -0,0 +1,188 @@
+#ifndef DUPLICATEDETECTOR_H
+#define DUPLICATEDETECTOR_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "transaction.h"
+
+/**
+ * @class DuplicateDetector
+ * @brief Flags repeat charges of the same customer, merchant, amount and payment method within a short window
+ *
+ * Each charge is reduced to a 64-bit fingerprint of those four fields and
+ * kept in the hash set of the time slice it arrived in. The window is
+ * split into four slices and one more set holds the slice being filled;
+ * when the clock moves on, the oldest set is emptied wholesale and reused
+ * for the new slice, so nothing is ever expired entry by entry. A charge
+ * is therefore remembered for at least the window and at most a quarter
+ * longer.
+ *
+ * Only the charge that is let through is remembered, and the gateway
+ * forgets it again if that charge ends up rejected or declined, so a
+ * genuine retry of a failed payment is not blocked by the attempt that
+ * failed.
+ *
+ * The sets use open addressing with linear probing over a flat array of
+ * fingerprints, so a check is a hash and a few probes into memory that
+ * stays in cache under normal traffic.
+ */
+class DuplicateDetector {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Constructor
+     * @param window How long a charge is remembered; zero disables detection
+     */
+    explicit DuplicateDetector(Clock::duration window = std::chrono::seconds(60));
+
+    DuplicateDetector(const DuplicateDetector&) = delete;
+    DuplicateDetector& operator=(const DuplicateDetector&) = delete;
+
+    /**
+     * @brief Check a transaction against recent charges, and remember it if it is not a repeat
+     *
+     * The check and the record are one step, so of two identical charges
+     * submitted together exactly one gets through.
+     *
+     * @param transaction The transaction about to be authorized
+     * @param now The time of the check
+     * @return True if an identical charge was seen within the window
+     */
+    bool checkAndRecord(const Transaction& transaction, Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Check a fingerprint against recent charges, and remember it if it is not a repeat
+     * @param fingerprint A value from fingerprint()
+     * @param now The time of the check
+     * @return True if the fingerprint was seen within the window
+     */
+    bool checkAndRecord(std::uint64_t fingerprint, Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Check a fingerprint against recent charges without remembering it
+     * @param fingerprint A value from fingerprint()
+     * @param now The time of the check
+     * @return True if the fingerprint was seen within the window
+     */
+    bool check(std::uint64_t fingerprint, Clock::time_point now = Clock::now()) const;
+
+    /**
+     * @brief Remember a fingerprint as charged
+     * @param fingerprint A value from fingerprint()
+     * @param now The time of the charge
+     */
+    void record(std::uint64_t fingerprint, Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Forget a charge that did not go through, so it can be retried at once
+     * @param transaction The transaction that was rejected or declined
+     */
+    void forget(const Transaction& transaction);
+
+    /**
+     * @brief Forget a fingerprint wherever it is remembered
+     * @param fingerprint A value from fingerprint()
+     */
+    void forget(std::uint64_t fingerprint);
+
+    /**
+     * @brief Change the window, forgetting every remembered charge
+     * @param window How long a charge is remembered; zero disables detection
+     */
+    void setWindow(Clock::duration window);
+
+    /**
+     * @brief Get the window
+     * @return How long a charge is remembered
+     */
+    Clock::duration getWindow() const;
+
+    /**
+     * @brief Get the number of duplicates flagged so far
+     * @return The duplicate count
+     */
+    std::uint64_t getDuplicateCount() const;
+
+    /**
+     * @brief Reduce the fields that identify a charge to one hash
+     * @param customer The customer name
+     * @param merchant The merchant name
+     * @param amountCents The amount in cents
+     * @param paymentMethod The payment method fingerprint
+     * @return A non-zero 64-bit fingerprint
+     */
+    static std::uint64_t fingerprint(const std::string& customer, const std::string& merchant,
+                                     std::int64_t amountCents, const std::string& paymentMethod);
+
+    /**
+     * @brief Fingerprint the charge a transaction makes
+     * @param transaction The transaction
+     * @return A non-zero 64-bit fingerprint
+     */
+    static std::uint64_t fingerprint(const Transaction& transaction);
+
+private:
+    static constexpr std::size_t kSlices = 4;
+
+    struct Slice {
+        std::uint64_t period;               ///< Index of the time slice held; 0 when unused
+        std::size_t used;
+        std::vector<std::uint64_t> slots;   ///< Power-of-two sized; 0 marks an empty slot
+    };
+
+    /**
+     * @brief Get the time slice a moment falls in; m_mutex must be held and detection enabled
+     * @param now The moment
+     * @return The slice index, starting at 1
+     */
+    std::uint64_t periodOf(Clock::time_point now) const;
+
+    /**
+     * @brief Check every slice within the window of a period; m_mutex must be held
+     * @param fingerprint The fingerprint
+     * @param period The current period
+     * @return True if a slice holds it
+     */
+    bool containsLocked(std::uint64_t fingerprint, std::uint64_t period) const;
+
+    /**
+     * @brief Add a fingerprint to the slice of a period, reusing the slice if it aged out; m_mutex must be held
+     * @param fingerprint The fingerprint
+     * @param period The current period
+     */
+    void recordLocked(std::uint64_t fingerprint, std::uint64_t period);
+
+    /**
+     * @brief Look a fingerprint up in one slice
+     * @param slice The slice
+     * @param fingerprint The fingerprint
+     * @return True if the slice holds it
+     */
+    static bool contains(const Slice& slice, std::uint64_t fingerprint);
+
+    /**
+     * @brief Add a fingerprint to one slice, doubling its table past half full
+     * @param slice The slice
+     * @param fingerprint The fingerprint
+     */
+    static void insert(Slice& slice, std::uint64_t fingerprint);
+
+    /**
+     * @brief Remove a fingerprint from one slice, shifting back later entries of its probe run
+     * @param slice The slice
+     * @param fingerprint The fingerprint
+     */
+    static void erase(Slice& slice, std::uint64_t fingerprint);
+
+    mutable std::mutex m_mutex;
+    Clock::duration m_sliceWidth;
+    std::array<Slice, kSlices + 1> m_slices;
+    std::uint64_t m_duplicates;
+};
+
+#endif // DUPLICATEDETECTOR_H
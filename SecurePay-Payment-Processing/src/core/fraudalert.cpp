@@ -1,10 +1,13 @@
 #include "fraudalert.h"
-#include <random>
+#include "idgenerator.h"
 #include <sstream>
 #include <iomanip>
 
 FraudAlert::FraudAlert(const Transaction& transaction, FraudRiskLevel riskLevel, const std::string& description)
-    : m_transaction(transaction), 
+    : m_transactionId(transaction.getTransactionId()),
+      m_customerName(transaction.getCustomer().getName()),
+      m_merchantName(transaction.getMerchant().getName()),
+      m_amount(transaction.getAmount()),
       m_riskLevel(riskLevel),
       m_description(description),
       m_timestamp(std::chrono::system_clock::now()),
@@ -12,12 +15,36 @@ FraudAlert::FraudAlert(const Transaction& transaction, FraudRiskLevel riskLevel,
     m_alertId = generateAlertId();
 }
 
+FraudAlert::FraudAlert(const FraudAlert& other)
+    : m_alertId(other.m_alertId),
+      m_transactionId(other.m_transactionId),
+      m_customerName(other.m_customerName),
+      m_merchantName(other.m_merchantName),
+      m_amount(other.m_amount),
+      m_riskLevel(other.m_riskLevel),
+      m_description(other.m_description),
+      m_timestamp(other.m_timestamp),
+      m_reviewed(other.m_reviewed.load()) {
+}
+
 std::string FraudAlert::getAlertId() const {
     return m_alertId;
 }
 
-const Transaction& FraudAlert::getTransaction() const {
-    return m_transaction;
+std::string FraudAlert::getTransactionId() const {
+    return m_transactionId;
+}
+
+std::string FraudAlert::getCustomerName() const {
+    return m_customerName;
+}
+
+std::string FraudAlert::getMerchantName() const {
+    return m_merchantName;
+}
+
+double FraudAlert::getAmount() const {
+    return m_amount;
 }
 
 FraudRiskLevel FraudAlert::getRiskLevel() const {
@@ -35,32 +62,20 @@ std::string FraudAlert::getTimestamp() const {
     return ss.str();
 }
 
+std::chrono::system_clock::time_point FraudAlert::getCreatedAt() const {
+    return m_timestamp;
+}
+
 bool FraudAlert::isReviewed() const {
-    return m_reviewed;
+    return m_reviewed.load();
 }
 
 void FraudAlert::setReviewed(bool reviewed) {
-    m_reviewed = reviewed;
+    m_reviewed.store(reviewed);
 }
 
 std::string FraudAlert::generateAlertId() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 15);
-    
-    const char* hex_chars = "0123456789ABCDEF";
-    
-    std::stringstream ss;
-    ss << "FA-";
-    for (int i = 0; i < 8; ++i) {
-        ss << hex_chars[dis(gen)];
-    }
-    ss << "-";
-    for (int i = 0; i < 4; ++i) {
-        ss << hex_chars[dis(gen)];
-    }
-    
-    return ss.str();
+    return IdGenerator::generate("FA");
 }
 
 std::unique_ptr<FraudAlert> FraudAlertFactory::createFraudAlert(
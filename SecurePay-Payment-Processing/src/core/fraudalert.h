@@ -4,8 +4,9 @@
 #include <string>
 #include <memory>
 #include <chrono>
+#include <atomic>
 #include "transaction.h"
-#include "fraudsystem.h"
+#include "fraudrules.h"
 
 /**
  * @class FraudAlert
@@ -13,17 +14,29 @@
  * 
  * This class follows the Single Responsibility Principle by focusing only on
  * fraud alert data representation and basic operations.
+ *
+ * The alert copies the details it reports from its transaction, so it stays
+ * valid after the transaction is destroyed. The review flag may be changed
+ * on one thread while reports read it on others, so it is atomic.
  */
 class FraudAlert {
 public:
     /**
      * @brief Constructor for a fraud alert
-     * @param transaction Reference to the suspicious transaction
+     * @param transaction The suspicious transaction; its details are copied
      * @param riskLevel The fraud risk level
      * @param description Description of the fraud alert
      */
     FraudAlert(const Transaction& transaction, FraudRiskLevel riskLevel, const std::string& description);
     
+    /**
+     * @brief Copy constructor; takes a snapshot of the review flag
+     * @param other The alert to copy
+     */
+    FraudAlert(const FraudAlert& other);
+    
+    FraudAlert& operator=(const FraudAlert&) = delete;
+    
     /**
      * @brief Get the alert ID
      * @return The unique alert ID
@@ -31,10 +44,28 @@ public:
     std::string getAlertId() const;
     
     /**
-     * @brief Get the transaction
-     * @return Reference to the suspicious transaction
+     * @brief Get the ID of the suspicious transaction
+     * @return The transaction ID
+     */
+    std::string getTransactionId() const;
+    
+    /**
+     * @brief Get the name of the transaction's customer
+     * @return The customer name
+     */
+    std::string getCustomerName() const;
+    
+    /**
+     * @brief Get the name of the transaction's merchant
+     * @return The merchant name
+     */
+    std::string getMerchantName() const;
+    
+    /**
+     * @brief Get the transaction amount
+     * @return The amount at the time the alert was raised
      */
-    const Transaction& getTransaction() const;
+    double getAmount() const;
     
     /**
      * @brief Get the risk level
@@ -54,6 +85,12 @@ public:
      */
     std::string getTimestamp() const;
     
+    /**
+     * @brief Get the time the alert was created
+     * @return The creation time
+     */
+    std::chrono::system_clock::time_point getCreatedAt() const;
+    
     /**
      * @brief Check if the alert has been reviewed
      * @return True if the alert has been reviewed, false otherwise
@@ -68,11 +105,14 @@ public:
     
 private:
     std::string m_alertId;
-    const Transaction& m_transaction;
+    std::string m_transactionId;
+    std::string m_customerName;
+    std::string m_merchantName;
+    double m_amount;
     FraudRiskLevel m_riskLevel;
     std::string m_description;
     std::chrono::system_clock::time_point m_timestamp;
-    bool m_reviewed;
+    std::atomic<bool> m_reviewed;
     
     /**
      * @brief Generate a unique alert ID
@@ -0,0 +1,263 @@
+#include "fraudalertstore.h"
+#include <algorithm>
+#include <iostream>
+
+FraudAlertStore::FraudAlertStore(std::size_t persistBatchSize)
+    : m_persistBatchSize(std::max<std::size_t>(1, persistBatchSize)),
+      m_dataManager(nullptr),
+      m_writeRequested(false),
+      m_stopping(false) {
+    m_writer = std::thread(&FraudAlertStore::writeLoop, this);
+}
+
+FraudAlertStore::~FraudAlertStore() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_writeCondition.notify_all();
+
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+}
+
+const FraudAlert* FraudAlertStore::add(std::unique_ptr<FraudAlert> alert) {
+    if (!alert) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::size_t position = m_alerts.size();
+    if (!m_byId.emplace(alert->getAlertId(), position).second) {
+        std::cerr << "Fraud alert " << alert->getAlertId() << " is already stored" << std::endl;
+        return nullptr;
+    }
+
+    m_byTransaction[alert->getTransactionId()].push_back(position);
+    m_byRiskLevel[static_cast<std::size_t>(alert->getRiskLevel())].push_back(position);
+    m_byReviewed[alert->isReviewed() ? 1 : 0].insert(position);
+    m_byCreatedAt.emplace(alert->getCreatedAt(), position);
+    m_alerts.push_back(std::move(alert));
+    m_isPending.push_back(false);
+
+    persistLater(position);
+    return m_alerts.back().get();
+}
+
+bool FraudAlertStore::setReviewed(const std::string& alertId, bool reviewed) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_byId.find(alertId);
+    if (it == m_byId.end()) {
+        return false;
+    }
+
+    const std::size_t position = it->second;
+    FraudAlert& alert = *m_alerts[position];
+    if (alert.isReviewed() != reviewed) {
+        m_byReviewed[reviewed ? 0 : 1].erase(position);
+        m_byReviewed[reviewed ? 1 : 0].insert(position);
+        alert.setReviewed(reviewed);
+
+        persistLater(position);
+    }
+    return true;
+}
+
+const FraudAlert* FraudAlertStore::findAlert(const std::string& alertId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_byId.find(alertId);
+    return it != m_byId.end() ? m_alerts[it->second].get() : nullptr;
+}
+
+std::vector<const FraudAlert*> FraudAlertStore::getAll() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<const FraudAlert*> alerts;
+    alerts.reserve(m_alerts.size());
+    for (const auto& alert : m_alerts) {
+        alerts.push_back(alert.get());
+    }
+    return alerts;
+}
+
+std::vector<const FraudAlert*> FraudAlertStore::getForTransaction(const std::string& transactionId) const {
+    FraudAlertFilter filter;
+    filter.transactionId = transactionId;
+    return query(filter);
+}
+
+std::vector<const FraudAlert*> FraudAlertStore::query(const FraudAlertFilter& filter) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Start from the narrowest index that applies; every candidate is still checked against the whole filter
+    const std::vector<std::size_t>* positions = nullptr;
+    const std::set<std::size_t>* reviewState = nullptr;
+    std::size_t narrowest = m_alerts.size();
+    static const std::vector<std::size_t> none;
+
+    if (!filter.transactionId.empty()) {
+        auto it = m_byTransaction.find(filter.transactionId);
+        positions = it != m_byTransaction.end() ? &it->second : &none;
+        narrowest = positions->size();
+    }
+    if (filter.filterRiskLevel && m_byRiskLevel[static_cast<std::size_t>(filter.riskLevel)].size() < narrowest) {
+        positions = &m_byRiskLevel[static_cast<std::size_t>(filter.riskLevel)];
+        narrowest = positions->size();
+    }
+    if (filter.filterReviewed && m_byReviewed[filter.reviewed ? 1 : 0].size() < narrowest) {
+        positions = nullptr;
+        reviewState = &m_byReviewed[filter.reviewed ? 1 : 0];
+        narrowest = reviewState->size();
+    }
+
+    // The time range is used instead when it holds fewer alerts; counting stops at the narrowest
+    // index found above, so sizing the range never costs more than walking that index would
+    bool byTime = false;
+    auto rangeBegin = m_byCreatedAt.end();
+    auto rangeEnd = m_byCreatedAt.end();
+    if (filter.from != std::chrono::system_clock::time_point::min() ||
+        filter.to != std::chrono::system_clock::time_point::max()) {
+        rangeBegin = m_byCreatedAt.lower_bound(filter.from);
+        rangeEnd = filter.to > filter.from ? m_byCreatedAt.lower_bound(filter.to) : rangeBegin;
+        std::size_t inRange = 0;
+        for (auto it = rangeBegin; it != rangeEnd && inRange < narrowest; ++it) {
+            ++inRange;
+        }
+        byTime = inRange < narrowest;
+    }
+
+    std::vector<std::size_t> candidates;
+    if (byTime) {
+        for (auto it = rangeBegin; it != rangeEnd; ++it) {
+            candidates.push_back(it->second);
+        }
+        std::sort(candidates.begin(), candidates.end());
+    } else if (positions) {
+        candidates = *positions;
+    } else if (reviewState) {
+        candidates.assign(reviewState->begin(), reviewState->end());
+    } else {
+        candidates.resize(m_alerts.size());
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            candidates[i] = i;
+        }
+    }
+
+    std::vector<const FraudAlert*> alerts;
+    for (std::size_t position : candidates) {
+        const FraudAlert& alert = *m_alerts[position];
+        if (matches(alert, filter)) {
+            alerts.push_back(&alert);
+        }
+    }
+    return alerts;
+}
+
+std::size_t FraudAlertStore::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_alerts.size();
+}
+
+std::size_t FraudAlertStore::unreviewedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_byReviewed[0].size();
+}
+
+void FraudAlertStore::setDataManager(DataManager* dataManager) {
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dataManager = dataManager;
+    m_pending.clear();
+    m_isPending.assign(m_alerts.size(), false);
+    for (std::size_t position = 0; position < m_alerts.size(); ++position) {
+        markPending(position);
+    }
+}
+
+bool FraudAlertStore::flush() {
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
+
+    // Copies are taken so the write reads a consistent review state while setReviewed() carries on
+    DataManager* dataManager = nullptr;
+    std::vector<std::size_t> positions;
+    std::vector<FraudAlert> copies;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dataManager || m_pending.empty()) {
+            return true;
+        }
+        dataManager = m_dataManager;
+        positions.swap(m_pending);
+        copies.reserve(positions.size());
+        for (std::size_t position : positions) {
+            m_isPending[position] = false;
+            copies.push_back(*m_alerts[position]);
+        }
+    }
+
+    std::vector<const FraudAlert*> batch;
+    batch.reserve(copies.size());
+    for (const FraudAlert& alert : copies) {
+        batch.push_back(&alert);
+    }
+
+    if (dataManager->saveFraudAlerts(batch)) {
+        return true;
+    }
+
+    std::cerr << "Failed to save " << batch.size() << " fraud alerts; they will be retried" << std::endl;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::size_t position : positions) {
+        markPending(position);
+    }
+    return false;
+}
+
+bool FraudAlertStore::matches(const FraudAlert& alert, const FraudAlertFilter& filter) {
+    if (!filter.transactionId.empty() && alert.getTransactionId() != filter.transactionId) {
+        return false;
+    }
+    if (filter.filterRiskLevel && alert.getRiskLevel() != filter.riskLevel) {
+        return false;
+    }
+    if (filter.filterReviewed && alert.isReviewed() != filter.reviewed) {
+        return false;
+    }
+    std::chrono::system_clock::time_point createdAt = alert.getCreatedAt();
+    return createdAt >= filter.from && createdAt < filter.to;
+}
+
+void FraudAlertStore::markPending(std::size_t position) {
+    if (m_dataManager && !m_isPending[position]) {
+        m_isPending[position] = true;
+        m_pending.push_back(position);
+    }
+}
+
+void FraudAlertStore::persistLater(std::size_t position) {
+    std::size_t pendingBefore = m_pending.size();
+    markPending(position);
+
+    // Only on whole batches, so a failing data manager is retried once per batch rather than per alert
+    if (m_pending.size() != pendingBefore && m_pending.size() % m_persistBatchSize == 0) {
+        m_writeRequested = true;
+        m_writeCondition.notify_one();
+    }
+}
+
+void FraudAlertStore::writeLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_writeCondition.wait(lock, [this]() {
+            return m_stopping || m_writeRequested;
+        });
+        if (m_stopping) {
+            break;
+        }
+        m_writeRequested = false;
+
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
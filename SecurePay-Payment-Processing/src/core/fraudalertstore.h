@@ -0,0 +1,185 @@
+#ifndef FRAUDALERTSTORE_H
+#define FRAUDALERTSTORE_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "datamanager.h"
+#include "fraudalert.h"
+
+/**
+ * @struct FraudAlertFilter
+ * @brief Criteria for FraudAlertStore::query(); unset criteria match every alert
+ */
+struct FraudAlertFilter {
+    std::string transactionId;                      ///< Empty matches any transaction
+    bool filterRiskLevel = false;
+    FraudRiskLevel riskLevel = FraudRiskLevel::LOW;
+    bool filterReviewed = false;
+    bool reviewed = false;
+    std::chrono::system_clock::time_point from = std::chrono::system_clock::time_point::min();  ///< Inclusive
+    std::chrono::system_clock::time_point to = std::chrono::system_clock::time_point::max();    ///< Exclusive
+};
+
+/**
+ * @class FraudAlertStore
+ * @brief In-memory home of the fraud alerts raised while screening, indexed for reporting
+ *
+ * Alerts are kept in the order they were raised and indexed by ID,
+ * transaction, risk level, review state and creation time. A query starts
+ * from whichever index narrows the alerts most and checks the remaining
+ * criteria on that subset only, so a report on a few unreviewed high-risk
+ * alerts does not walk the whole history.
+ *
+ * When a DataManager is attached, new alerts and review changes are
+ * written back in batches of persistBatchSize with saveFraudAlerts(), or
+ * sooner with flush(). Whole batches are written by a background thread
+ * from copies of the alerts, so neither screening nor queries wait on
+ * storage. A batch that fails to save stays queued and is retried with the
+ * next one.
+ */
+class FraudAlertStore {
+public:
+    /**
+     * @brief Constructor; starts the writer thread
+     * @param persistBatchSize Number of pending changes that triggers a write to the data manager
+     */
+    explicit FraudAlertStore(std::size_t persistBatchSize = 256);
+
+    /**
+     * @brief Destructor; stops the writer thread without writing what is still pending
+     */
+    ~FraudAlertStore();
+
+    FraudAlertStore(const FraudAlertStore&) = delete;
+    FraudAlertStore& operator=(const FraudAlertStore&) = delete;
+
+    /**
+     * @brief Take ownership of a new alert
+     * @param alert The alert
+     * @return The stored alert, or nullptr if alert was null or its ID is already stored
+     */
+    const FraudAlert* add(std::unique_ptr<FraudAlert> alert);
+
+    /**
+     * @brief Mark an alert as reviewed or not
+     * @param alertId The alert ID
+     * @param reviewed The new review state
+     * @return True if the alert exists
+     */
+    bool setReviewed(const std::string& alertId, bool reviewed);
+
+    /**
+     * @brief Find an alert by ID
+     * @param alertId The alert ID
+     * @return The alert, or nullptr if not found
+     */
+    const FraudAlert* findAlert(const std::string& alertId) const;
+
+    /**
+     * @brief Get every alert
+     * @return The alerts in the order they were raised
+     */
+    std::vector<const FraudAlert*> getAll() const;
+
+    /**
+     * @brief Get the alerts raised for one transaction
+     * @param transactionId The transaction ID
+     * @return The alerts in the order they were raised
+     */
+    std::vector<const FraudAlert*> getForTransaction(const std::string& transactionId) const;
+
+    /**
+     * @brief Get the alerts that meet every criterion of a filter
+     * @param filter The criteria
+     * @return The matching alerts in the order they were raised
+     */
+    std::vector<const FraudAlert*> query(const FraudAlertFilter& filter) const;
+
+    /**
+     * @brief Get the number of stored alerts
+     * @return The alert count
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Get the number of alerts still to be reviewed
+     * @return The unreviewed alert count
+     */
+    std::size_t unreviewedCount() const;
+
+    /**
+     * @brief Attach the storage alerts are written to
+     *
+     * Every alert already in the store is queued for the first write. Waits
+     * for any write in progress, so the previous data manager may be
+     * destroyed once this returns.
+     *
+     * @param dataManager The data manager, or nullptr to stop persisting
+     */
+    void setDataManager(DataManager* dataManager);
+
+    /**
+     * @brief Write all pending changes to the data manager on the calling thread
+     * @return True if every change taken for the write was saved
+     */
+    bool flush();
+
+private:
+    /**
+     * @brief Check the criteria of a filter against one alert
+     * @param alert The alert
+     * @param filter The criteria
+     * @return True if the alert meets them all
+     */
+    static bool matches(const FraudAlert& alert, const FraudAlertFilter& filter);
+
+    /**
+     * @brief Queue an alert for the next write, if persisting
+     * @param position The alert's position in m_alerts
+     */
+    void markPending(std::size_t position);
+
+    /**
+     * @brief Queue an alert and wake the writer once the queue reaches a whole batch; m_mutex must be held
+     * @param position The alert's position in m_alerts
+     */
+    void persistLater(std::size_t position);
+
+    /**
+     * @brief Writer thread body; flushes each time a whole batch is queued
+     */
+    void writeLoop();
+
+    mutable std::mutex m_mutex;
+    std::size_t m_persistBatchSize;
+    DataManager* m_dataManager;
+
+    // Held for the whole of a write, so writes reach storage in order and the data manager outlives them
+    std::mutex m_writeMutex;
+    std::condition_variable m_writeCondition;
+    bool m_writeRequested;
+    bool m_stopping;
+    std::thread m_writer;
+
+    // Alerts in the order they were raised; the indexes below hold positions into this
+    std::vector<std::unique_ptr<FraudAlert>> m_alerts;
+    std::unordered_map<std::string, std::size_t> m_byId;
+    std::unordered_map<std::string, std::vector<std::size_t>> m_byTransaction;
+    std::array<std::vector<std::size_t>, 3> m_byRiskLevel;     ///< Indexed by FraudRiskLevel
+    std::array<std::set<std::size_t>, 2> m_byReviewed;         ///< [0] unreviewed, [1] reviewed
+    std::multimap<std::chrono::system_clock::time_point, std::size_t> m_byCreatedAt;
+
+    std::vector<std::size_t> m_pending;
+    std::vector<bool> m_isPending;
+};
+
+#endif // FRAUDALERTSTORE_H
@@ -0,0 +1,257 @@
+#include "fraudmodel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Rows scored together by scoreBatch(); their running sums stay in L1
+constexpr std::size_t kBatchBlock = 256;
+
+std::string trim(const std::string& text) {
+    std::size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    std::size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool parseNumber(const std::string& text, double& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size() && std::isfinite(value);
+}
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::size_t start = 0;
+    while (true) {
+        std::size_t comma = line.find(',', start);
+        fields.push_back(trim(line.substr(start, comma == std::string::npos ? comma : comma - start)));
+        if (comma == std::string::npos) {
+            return fields;
+        }
+        start = comma + 1;
+    }
+}
+
+// Vector operations for scoreBatch(), one double per lane
+#if defined(__AVX2__)
+struct Lanes {
+    using Vector = __m256d;
+    static constexpr std::size_t kWidth = 4;
+
+    static Vector load(const double* values) { return _mm256_loadu_pd(values); }
+    static void store(double* values, Vector vector) { _mm256_storeu_pd(values, vector); }
+    static Vector broadcast(double value) { return _mm256_set1_pd(value); }
+    static Vector add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+    static Vector multiply(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+};
+#elif defined(__SSE2__)
+struct Lanes {
+    using Vector = __m128d;
+    static constexpr std::size_t kWidth = 2;
+
+    static Vector load(const double* values) { return _mm_loadu_pd(values); }
+    static void store(double* values, Vector vector) { _mm_storeu_pd(values, vector); }
+    static Vector broadcast(double value) { return _mm_set1_pd(value); }
+    static Vector add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+    static Vector multiply(Vector a, Vector b) { return _mm_mul_pd(a, b); }
+};
+#endif
+
+} // namespace
+
+std::shared_ptr<const FraudModel> FraudModel::parse(const std::string& source) {
+    std::shared_ptr<FraudModel> model(new FraudModel());
+    std::istringstream input(source);
+    std::string line;
+    int lineNumber = 0;
+    double offset = 0.0;    // Bias contributed by feature means
+    std::vector<bool> weighted(kFeatureCount, false);
+    bool hasMedium = false;
+    bool hasHigh = false;
+
+    auto fail = [&lineNumber](const std::string& message) {
+        std::cerr << "Fraud model line " << lineNumber << ": " << message << std::endl;
+        return std::shared_ptr<const FraudModel>();
+    };
+
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::vector<std::string> fields = splitFields(line);
+        const std::string& kind = fields[0];
+
+        if (kind == "model") {
+            if (fields.size() != 2) {
+                return fail("expected model,<linear|logistic>");
+            }
+            if (fields[1] == "linear") {
+                model->m_type = FraudModelType::LINEAR;
+            } else if (fields[1] == "logistic") {
+                model->m_type = FraudModelType::LOGISTIC;
+            } else {
+                return fail("unknown model type '" + fields[1] + "'");
+            }
+        } else if (kind == "bias") {
+            if (fields.size() != 2 || !parseNumber(fields[1], model->m_bias)) {
+                return fail("expected bias,<value>");
+            }
+        } else if (kind == "level") {
+            double cutoff = 0.0;
+            if (fields.size() != 3 || !parseNumber(fields[2], cutoff)) {
+                return fail("expected level,<medium|high>,<cutoff>");
+            }
+            if (fields[1] == "medium") {
+                model->m_mediumCutoff = cutoff;
+                hasMedium = true;
+            } else if (fields[1] == "high") {
+                model->m_highCutoff = cutoff;
+                hasHigh = true;
+            } else {
+                return fail("unknown level '" + fields[1] + "'");
+            }
+        } else if (kind == "weight") {
+            double weight = 0.0;
+            double mean = 0.0;
+            double scale = 1.0;
+            if ((fields.size() != 3 && fields.size() != 5) || !parseNumber(fields[2], weight) ||
+                (fields.size() == 5 && (!parseNumber(fields[3], mean) || !parseNumber(fields[4], scale)))) {
+                return fail("expected weight,<feature>,<weight> or weight,<feature>,<weight>,<mean>,<scale>");
+            }
+            FraudFeature feature;
+            if (!FraudRuleSet::featureFromString(fields[1], feature)) {
+                return fail("unknown feature '" + fields[1] + "'");
+            }
+            const std::size_t index = static_cast<std::size_t>(feature);
+            if (weighted[index]) {
+                return fail("feature '" + fields[1] + "' is weighted twice");
+            }
+            if (scale == 0.0) {
+                return fail("scale of feature '" + fields[1] + "' is zero");
+            }
+
+            // w * (x - mean) / scale is (w / scale) * x - w * mean / scale
+            weighted[index] = true;
+            model->m_weights[index] = weight / scale;
+            offset -= weight * mean / scale;
+        } else {
+            return fail("unknown entry '" + kind + "'");
+        }
+    }
+
+    // A model without these would give every transaction the same score and level
+    if (!hasMedium || !hasHigh) {
+        return fail("expected level,medium,<cutoff> and level,high,<cutoff>");
+    }
+    if (model->m_highCutoff < model->m_mediumCutoff) {
+        return fail("high cutoff is below the medium cutoff");
+    }
+    if (model->m_type == FraudModelType::LOGISTIC &&
+        (model->m_mediumCutoff <= 0.0 || model->m_highCutoff > 1.0)) {
+        return fail("logistic cutoffs must lie in (0, 1]");
+    }
+
+    model->m_bias += offset;
+    for (std::size_t feature = 0; feature < kFeatureCount; ++feature) {
+        if (model->m_weights[feature] != 0.0) {
+            model->m_active.push_back(static_cast<std::uint8_t>(feature));
+        }
+    }
+    if (model->m_active.empty()) {
+        return fail("no feature has a non-zero weight");
+    }
+
+    return model;
+}
+
+double FraudModel::score(const FraudFeatures& features) const {
+    // Same order as scoreBatch(), bias first then each used feature in turn, so both round identically
+    double sum = m_bias;
+    for (std::uint8_t feature : m_active) {
+        sum += m_weights[feature] * features[feature];
+    }
+    return activate(sum);
+}
+
+std::vector<double> FraudModel::scoreBatch(const FraudBatch& batch) const {
+    const std::size_t rows = batch.size();
+    std::vector<double> scores(rows);
+
+    // Each used feature adds its weighted column to a block of running sums, so the inner loop
+    // is a multiply and add over contiguous values
+    for (std::size_t row = 0; row < rows; row += kBatchBlock) {
+        const std::size_t count = std::min(kBatchBlock, rows - row);
+        double* sums = scores.data() + row;
+        std::fill(sums, sums + count, m_bias);
+
+        for (std::uint8_t feature : m_active) {
+            const double* values = batch.column(static_cast<FraudFeature>(feature)) + row;
+            const double weight = m_weights[feature];
+            std::size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+            const Lanes::Vector weights = Lanes::broadcast(weight);
+            for (; i + Lanes::kWidth <= count; i += Lanes::kWidth) {
+                Lanes::store(sums + i, Lanes::add(Lanes::load(sums + i),
+                                                  Lanes::multiply(weights, Lanes::load(values + i))));
+            }
+#endif
+            for (; i < count; ++i) {
+                sums[i] += weight * values[i];
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            sums[i] = activate(sums[i]);
+        }
+    }
+
+    return scores;
+}
+
+FraudRiskLevel FraudModel::levelFor(double score) const {
+    if (score >= m_highCutoff) {
+        return FraudRiskLevel::HIGH;
+    }
+    if (score >= m_mediumCutoff) {
+        return FraudRiskLevel::MEDIUM;
+    }
+    return FraudRiskLevel::LOW;
+}
+
+FraudModelType FraudModel::getType() const {
+    return m_type;
+}
+
+std::size_t FraudModel::size() const {
+    return m_active.size();
+}
+
+double FraudModel::activate(double sum) const {
+    if (m_type == FraudModelType::LINEAR) {
+        return sum;
+    }
+    // Written so exp() never overflows, however large the sum
+    if (sum >= 0.0) {
+        return 1.0 / (1.0 + std::exp(-sum));
+    }
+    const double e = std::exp(sum);
+    return e / (1.0 + e);
+}
@@ -0,0 +1,112 @@
+#ifndef FRAUDMODEL_H
+#define FRAUDMODEL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "fraudrules.h"
+
+/**
+ * @enum FraudModelType
+ * @brief How a FraudModel turns its weighted sum into a score
+ */
+enum class FraudModelType {
+    LINEAR,     ///< The weighted sum itself
+    LOGISTIC    ///< The weighted sum through the logistic function, a probability from 0 to 1
+};
+
+/**
+ * @class FraudModel
+ * @brief Immutable linear or logistic fraud model over the rule features
+ *
+ * The score is a bias plus one weight per FraudFeature times the feature's
+ * value, optionally passed through the logistic function, and is mapped to
+ * a risk level by two cutoffs. Weights are held in one dense array in
+ * FraudFeature order alongside the list of features with a non-zero
+ * weight, so scoring a transaction touches only the features the model
+ * uses and never allocates.
+ *
+ * Model files are line based; blank lines and lines starting with '#' are
+ * ignored. A weight may give the mean and scale the model was trained with,
+ * which are folded into the weight and bias when the file is loaded. At
+ * least one weight must be non-zero and both levels must be given; for a
+ * logistic model the cutoffs must lie in (0, 1]:
+ * @code
+ * model,logistic
+ * bias,-6.5
+ * weight,amount,0.0009
+ * weight,amount_zscore,0.8,1.2,2.5
+ * weight,new_merchant,1.1
+ * level,medium,0.5
+ * level,high,0.85
+ * @endcode
+ */
+class FraudModel {
+public:
+    /**
+     * @brief Parse a model from its text form
+     * @param source The model file contents
+     * @return The model, or nullptr if the text has errors; errors are reported on std::cerr
+     */
+    static std::shared_ptr<const FraudModel> parse(const std::string& source);
+
+    /**
+     * @brief Score a transaction's features
+     * @param features The feature values
+     * @return The model score
+     */
+    double score(const FraudFeatures& features) const;
+
+    /**
+     * @brief Score every transaction in a batch
+     *
+     * Sums are built a feature column at a time over consecutive
+     * transactions with AVX2 or SSE2 when the build targets them, skipping
+     * features the model does not use. Each row's terms are added in the
+     * same order as score(), so the results match it exactly.
+     *
+     * @param batch The transactions' features
+     * @return One score per row, in order
+     */
+    std::vector<double> scoreBatch(const FraudBatch& batch) const;
+
+    /**
+     * @brief Map a score to a risk level using the model's cutoffs
+     * @param score A score from score() or scoreBatch()
+     * @return The risk level
+     */
+    FraudRiskLevel levelFor(double score) const;
+
+    /**
+     * @brief Get how the weighted sum becomes a score
+     * @return The model type
+     */
+    FraudModelType getType() const;
+
+    /**
+     * @brief Get the number of features with a non-zero weight
+     * @return The feature count
+     */
+    std::size_t size() const;
+
+private:
+    static constexpr std::size_t kFeatureCount = static_cast<std::size_t>(FraudFeature::COUNT);
+
+    FraudModel() = default;
+
+    /**
+     * @brief Turn a weighted sum into a score according to the model type
+     * @param sum Bias plus weighted features
+     * @return The score
+     */
+    double activate(double sum) const;
+
+    FraudModelType m_type = FraudModelType::LOGISTIC;
+    double m_bias = 0.0;
+    alignas(32) FraudFeatures m_weights{};  ///< In FraudFeature order, after folding in any scaling
+    std::vector<std::uint8_t> m_active;     ///< Features with a non-zero weight
+    double m_mediumCutoff = 0.5;
+    double m_highCutoff = 0.8;
+};
+
+#endif // FRAUDMODEL_H
@@ -0,0 +1,97 @@
+#include "fraudreviewqueue.h"
+#include <tuple>
+
+bool FraudReviewQueue::Priority::operator<(const Priority& other) const {
+    // Higher score and amount first; the older transaction wins a tie, and the ID keeps keys unique
+    return std::tie(other.riskScore, other.amount, createdAt, transactionId) <
+           std::tie(riskScore, amount, other.createdAt, other.transactionId);
+}
+
+bool FraudReviewQueue::enqueue(Transaction* transaction, double riskScore) {
+    Priority priority{riskScore, transaction->getAmount(), transaction->getCreatedAt(),
+                      transaction->getTransactionId()};
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_entries.emplace(priority.transactionId, Entry{transaction, priority, ""}).second) {
+        return false;
+    }
+    m_unclaimed.insert(priority);
+    return true;
+}
+
+Transaction* FraudReviewQueue::claim(const std::string& reviewer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_unclaimed.empty() || reviewer.empty()) {
+        return nullptr;
+    }
+
+    Priority priority = *m_unclaimed.begin();
+    m_unclaimed.erase(m_unclaimed.begin());
+
+    Entry& entry = m_entries.at(priority.transactionId);
+    entry.reviewer = reviewer;
+    m_claimed[reviewer].insert(priority);
+    return entry.transaction;
+}
+
+bool FraudReviewQueue::release(const std::string& transactionId, const std::string& reviewer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(transactionId);
+    if (it == m_entries.end() || it->second.reviewer.empty() || it->second.reviewer != reviewer) {
+        return false;
+    }
+
+    m_claimed[reviewer].erase(it->second.priority);
+    it->second.reviewer.clear();
+    m_unclaimed.insert(it->second.priority);
+    return true;
+}
+
+Transaction* FraudReviewQueue::resolve(const std::string& transactionId, const std::string& reviewer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(transactionId);
+    if (it == m_entries.end() || it->second.reviewer.empty() || it->second.reviewer != reviewer) {
+        return nullptr;
+    }
+
+    auto claims = m_claimed.find(reviewer);
+    claims->second.erase(it->second.priority);
+    if (claims->second.empty()) {
+        m_claimed.erase(claims);
+    }
+
+    Transaction* transaction = it->second.transaction;
+    m_entries.erase(it);
+    return transaction;
+}
+
+std::vector<const Transaction*> FraudReviewQueue::getClaimed(const std::string& reviewer) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<const Transaction*> transactions;
+    auto claims = m_claimed.find(reviewer);
+    if (claims != m_claimed.end()) {
+        for (const Priority& priority : claims->second) {
+            transactions.push_back(m_entries.at(priority.transactionId).transaction);
+        }
+    }
+    return transactions;
+}
+
+std::vector<const Transaction*> FraudReviewQueue::peek(std::size_t limit) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<const Transaction*> transactions;
+    for (auto it = m_unclaimed.begin(); it != m_unclaimed.end() && transactions.size() < limit; ++it) {
+        transactions.push_back(m_entries.at(it->transactionId).transaction);
+    }
+    return transactions;
+}
+
+std::size_t FraudReviewQueue::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+std::size_t FraudReviewQueue::unclaimedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_unclaimed.size();
+}
@@ -0,0 +1,116 @@
+#ifndef FRAUDREVIEWQUEUE_H
+#define FRAUDREVIEWQUEUE_H
+
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "transaction.h"
+
+/**
+ * @class FraudReviewQueue
+ * @brief Flagged transactions waiting for manual review, riskiest first
+ *
+ * Transactions are ordered by fraud score, then by amount, then oldest
+ * first. Unclaimed transactions sit in one ordered set and each reviewer's
+ * claims in another, so claiming the next one, listing a reviewer's
+ * claims and resolving a review cost O(log n) however many transactions
+ * are waiting. A transaction can be claimed by one reviewer at a time.
+ *
+ * The queue refers to transactions owned by the PaymentGateway and never
+ * changes their state; approving and declining go through the gateway.
+ */
+class FraudReviewQueue {
+public:
+    FraudReviewQueue() = default;
+
+    FraudReviewQueue(const FraudReviewQueue&) = delete;
+    FraudReviewQueue& operator=(const FraudReviewQueue&) = delete;
+
+    /**
+     * @brief Add a flagged transaction
+     * @param transaction The transaction; must outlive the queue entry
+     * @param riskScore The fraud score the transaction was flagged with
+     * @return False if the transaction is already queued
+     */
+    bool enqueue(Transaction* transaction, double riskScore);
+
+    /**
+     * @brief Take the riskiest unclaimed transaction
+     * @param reviewer Who is claiming it; must not be empty
+     * @return The transaction, or nullptr if nothing is waiting
+     */
+    Transaction* claim(const std::string& reviewer);
+
+    /**
+     * @brief Hand a claimed transaction back for someone else to take
+     * @param transactionId The transaction ID
+     * @param reviewer The reviewer holding the claim
+     * @return True if the reviewer held the claim
+     */
+    bool release(const std::string& transactionId, const std::string& reviewer);
+
+    /**
+     * @brief Remove a claimed transaction once it has been reviewed
+     * @param transactionId The transaction ID
+     * @param reviewer The reviewer holding the claim
+     * @return The transaction, or nullptr if the reviewer did not hold the claim
+     */
+    Transaction* resolve(const std::string& transactionId, const std::string& reviewer);
+
+    /**
+     * @brief Get the transactions a reviewer has claimed and not yet resolved
+     * @param reviewer The reviewer
+     * @return The claims, riskiest first
+     */
+    std::vector<const Transaction*> getClaimed(const std::string& reviewer) const;
+
+    /**
+     * @brief Get the riskiest unclaimed transactions without claiming them
+     * @param limit Maximum number to return
+     * @return Up to limit transactions, riskiest first
+     */
+    std::vector<const Transaction*> peek(std::size_t limit) const;
+
+    /**
+     * @brief Get the number of transactions waiting, claimed or not
+     * @return The queue length
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Get the number of transactions nobody has claimed
+     * @return The unclaimed count
+     */
+    std::size_t unclaimedCount() const;
+
+private:
+    struct Priority {
+        double riskScore;
+        double amount;
+        std::chrono::system_clock::time_point createdAt;
+        std::string transactionId;
+
+        /**
+         * @brief Order riskiest first
+         * @param other The entry to compare with
+         * @return True if this entry should be reviewed before other
+         */
+        bool operator<(const Priority& other) const;
+    };
+
+    struct Entry {
+        Transaction* transaction;
+        Priority priority;
+        std::string reviewer;   ///< Empty while unclaimed
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::set<Priority> m_unclaimed;
+    std::unordered_map<std::string, std::set<Priority>> m_claimed;     ///< By reviewer
+};
+
+#endif // FRAUDREVIEWQUEUE_H
@@ -0,0 +1,465 @@
+#include "fraudrules.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Rule file names, in FraudFeature order
+const char* const kFeatureNames[] = {
+    "amount",
+    "address_flagged",
+    "wallet",
+    "prepaid",
+    "customer_velocity",
+    "card_velocity",
+    "merchant_velocity",
+    "customer_count_minute",
+    "customer_count_hour",
+    "customer_count_day",
+    "customer_amount_day",
+    "card_count_minute",
+    "card_count_hour",
+    "card_count_day",
+    "card_amount_day",
+    "merchant_count_minute",
+    "merchant_count_hour",
+    "merchant_count_day",
+    "merchant_amount_day",
+    "blocked_card",
+    "blocked_wallet",
+    "blocked_email",
+    "profile_transactions",
+    "amount_zscore",
+    "new_merchant",
+    "new_payment_method",
+    "hour_share"
+};
+static_assert(sizeof(kFeatureNames) / sizeof(kFeatureNames[0]) == static_cast<std::size_t>(FraudFeature::COUNT),
+              "every fraud feature needs a rule file name");
+
+// The checks FraudSystem made before rules were configurable, one point per suspicious factor,
+// plus blocklist hits, which are high risk on their own, and departures from an established profile
+const char* const kDefaultRules =
+    "rule,large_amount,1,amount > 1000\n"
+    "rule,suspicious_address,1,address_flagged == 1\n"
+    "rule,digital_wallet,1,wallet == 1\n"
+    "rule,prepaid_card,1,prepaid == 1\n"
+    "rule,customer_velocity,1,customer_velocity == 1\n"
+    "rule,card_velocity,1,card_velocity == 1\n"
+    "rule,merchant_velocity,1,merchant_velocity == 1\n"
+    "rule,blocked_card,2,blocked_card == 1\n"
+    "rule,blocked_wallet,2,blocked_wallet == 1\n"
+    "rule,blocked_email,2,blocked_email == 1\n"
+    "rule,unusual_amount,1,amount_zscore > 4 && profile_transactions >= 10\n"
+    "rule,unfamiliar_checkout,1,new_merchant == 1 && new_payment_method == 1 && profile_transactions >= 10\n"
+    "level,medium,1\n"
+    "level,high,2\n";
+
+std::string trim(const std::string& text) {
+    std::size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    std::size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool parseNumber(const std::string& text, double& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+constexpr std::size_t kFeatureCount = static_cast<std::size_t>(FraudFeature::COUNT);
+
+// Rows scored together by evaluateBatch(); its working masks stay in L1
+constexpr std::size_t kBatchBlock = 256;
+
+// Vector operations for evaluateBatch(), one double or one 64-bit mask per lane
+#if defined(__AVX2__)
+struct Lanes {
+    using Vector = __m256d;
+    using Bits = __m256i;
+    static constexpr std::size_t kWidth = 4;
+
+    static Vector load(const double* values) { return _mm256_loadu_pd(values); }
+    static void store(double* values, Vector vector) { _mm256_store_pd(values, vector); }
+    static Vector broadcast(double value) { return _mm256_set1_pd(value); }
+    static Vector zero() { return _mm256_setzero_pd(); }
+    static Vector allSet() { return _mm256_castsi256_pd(_mm256_set1_epi64x(-1)); }
+    static Vector add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+    static Vector mask(Vector mask, Vector value) { return _mm256_and_pd(mask, value); }
+
+    static Bits loadBits(const std::uint64_t* bits) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(bits)); }
+    static void storeBits(std::uint64_t* bits, Bits vector) { _mm256_store_si256(reinterpret_cast<__m256i*>(bits), vector); }
+    static Bits broadcastBits(std::uint64_t bits) { return _mm256_set1_epi64x(static_cast<long long>(bits)); }
+    static Bits zeroBits() { return _mm256_setzero_si256(); }
+    static Bits orBits(Bits a, Bits b) { return _mm256_or_si256(a, b); }
+    static Bits maskBits(Vector mask, Bits bits) { return _mm256_and_si256(_mm256_castpd_si256(mask), bits); }
+
+    struct Less { static Vector compare(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); } };
+    struct LessEqual { static Vector compare(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); } };
+    struct Greater { static Vector compare(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); } };
+    struct GreaterEqual { static Vector compare(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); } };
+    struct Equal { static Vector compare(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); } };
+    struct NotEqual { static Vector compare(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); } };
+};
+#elif defined(__SSE2__)
+struct Lanes {
+    using Vector = __m128d;
+    using Bits = __m128i;
+    static constexpr std::size_t kWidth = 2;
+
+    static Vector load(const double* values) { return _mm_loadu_pd(values); }
+    static void store(double* values, Vector vector) { _mm_store_pd(values, vector); }
+    static Vector broadcast(double value) { return _mm_set1_pd(value); }
+    static Vector zero() { return _mm_setzero_pd(); }
+    static Vector allSet() { return _mm_castsi128_pd(_mm_set1_epi32(-1)); }
+    static Vector add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+    static Vector mask(Vector mask, Vector value) { return _mm_and_pd(mask, value); }
+
+    static Bits loadBits(const std::uint64_t* bits) { return _mm_load_si128(reinterpret_cast<const __m128i*>(bits)); }
+    static void storeBits(std::uint64_t* bits, Bits vector) { _mm_store_si128(reinterpret_cast<__m128i*>(bits), vector); }
+    static Bits broadcastBits(std::uint64_t bits) { return _mm_set1_epi64x(static_cast<long long>(bits)); }
+    static Bits zeroBits() { return _mm_setzero_si128(); }
+    static Bits orBits(Bits a, Bits b) { return _mm_or_si128(a, b); }
+    static Bits maskBits(Vector mask, Bits bits) { return _mm_and_si128(_mm_castpd_si128(mask), bits); }
+
+    struct Less { static Vector compare(Vector a, Vector b) { return _mm_cmplt_pd(a, b); } };
+    struct LessEqual { static Vector compare(Vector a, Vector b) { return _mm_cmple_pd(a, b); } };
+    struct Greater { static Vector compare(Vector a, Vector b) { return _mm_cmpgt_pd(a, b); } };
+    struct GreaterEqual { static Vector compare(Vector a, Vector b) { return _mm_cmpge_pd(a, b); } };
+    struct Equal { static Vector compare(Vector a, Vector b) { return _mm_cmpeq_pd(a, b); } };
+    struct NotEqual { static Vector compare(Vector a, Vector b) { return _mm_cmpneq_pd(a, b); } };
+};
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+// Clears the holds lanes of rows whose value fails the comparison; count is a multiple of the width
+template <typename Compare>
+void narrow(const double* values, double constant, double* holds, std::size_t count) {
+    const Lanes::Vector threshold = Lanes::broadcast(constant);
+    for (std::size_t i = 0; i < count; i += Lanes::kWidth) {
+        Lanes::Vector result = Compare::compare(Lanes::load(values + i), threshold);
+        Lanes::store(holds + i, Lanes::mask(Lanes::load(holds + i), result));
+    }
+}
+#endif
+
+} // namespace
+
+FraudBatch::FraudBatch(std::size_t rows)
+    : m_rows(rows),
+      m_values(rows * kFeatureCount, 0.0) {
+}
+
+std::size_t FraudBatch::size() const {
+    return m_rows;
+}
+
+void FraudBatch::resize(std::size_t rows) {
+    m_rows = rows;
+    m_values.assign(rows * kFeatureCount, 0.0);
+}
+
+double* FraudBatch::column(FraudFeature feature) {
+    return m_values.data() + static_cast<std::size_t>(feature) * m_rows;
+}
+
+const double* FraudBatch::column(FraudFeature feature) const {
+    return m_values.data() + static_cast<std::size_t>(feature) * m_rows;
+}
+
+void FraudBatch::setRow(std::size_t row, const FraudFeatures& features) {
+    for (std::size_t feature = 0; feature < kFeatureCount; ++feature) {
+        m_values[feature * m_rows + row] = features[feature];
+    }
+}
+
+FraudFeatures FraudBatch::getRow(std::size_t row) const {
+    FraudFeatures features;
+    for (std::size_t feature = 0; feature < kFeatureCount; ++feature) {
+        features[feature] = m_values[feature * m_rows + row];
+    }
+    return features;
+}
+
+std::shared_ptr<const FraudRuleSet> FraudRuleSet::compile(const std::string& source) {
+    std::shared_ptr<FraudRuleSet> ruleSet(new FraudRuleSet());
+    std::istringstream input(source);
+    std::string line;
+    int lineNumber = 0;
+
+    auto fail = [&lineNumber](const std::string& message) {
+        std::cerr << "Fraud rules line " << lineNumber << ": " << message << std::endl;
+        return std::shared_ptr<const FraudRuleSet>();
+    };
+
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::size_t first = line.find(',');
+        std::size_t second = first == std::string::npos ? first : line.find(',', first + 1);
+        if (second == std::string::npos) {
+            return fail("expected rule,<name>,<weight>,<condition> or level,<medium|high>,<score>");
+        }
+        std::string kind = trim(line.substr(0, first));
+        std::string name = trim(line.substr(first + 1, second - first - 1));
+
+        if (kind == "level") {
+            double threshold = 0.0;
+            if (!parseNumber(trim(line.substr(second + 1)), threshold)) {
+                return fail("invalid level threshold");
+            }
+            if (name == "medium") {
+                ruleSet->m_mediumThreshold = threshold;
+            } else if (name == "high") {
+                ruleSet->m_highThreshold = threshold;
+            } else {
+                return fail("unknown level '" + name + "'");
+            }
+            continue;
+        }
+
+        if (kind != "rule") {
+            return fail("unknown entry '" + kind + "'");
+        }
+
+        std::size_t third = line.find(',', second + 1);
+        double weight = 0.0;
+        if (name.empty() || third == std::string::npos ||
+            !parseNumber(trim(line.substr(second + 1, third - second - 1)), weight)) {
+            return fail("expected rule,<name>,<weight>,<condition>");
+        }
+        if (ruleSet->m_names.size() == kMaxRules) {
+            return fail("too many rules");
+        }
+
+        // Each predicate is "feature op constant"; predicates are joined with &&
+        const std::uint8_t rule = static_cast<std::uint8_t>(ruleSet->m_names.size());
+        std::string condition = line.substr(third + 1);
+        std::size_t start = 0;
+        while (true) {
+            std::size_t split = condition.find("&&", start);
+            std::string predicate = trim(condition.substr(start, split == std::string::npos ? split : split - start));
+
+            std::size_t opBegin = predicate.find_first_of("<>=!");
+            if (opBegin == std::string::npos) {
+                return fail("expected a comparison in '" + predicate + "'");
+            }
+            std::size_t opEnd = opBegin + 1;
+            if (opEnd < predicate.size() && predicate[opEnd] == '=') {
+                ++opEnd;
+            }
+
+            std::string featureName = trim(predicate.substr(0, opBegin));
+            std::string opText = predicate.substr(opBegin, opEnd - opBegin);
+            FraudFeature feature;
+            if (!featureFromString(featureName, feature)) {
+                return fail("unknown feature '" + featureName + "'");
+            }
+
+            Instruction instruction{0.0, static_cast<std::uint8_t>(feature), Op::EQUAL, false, rule};
+            if (opText == "<") {
+                instruction.op = Op::LESS;
+            } else if (opText == "<=") {
+                instruction.op = Op::LESS_EQUAL;
+            } else if (opText == ">") {
+                instruction.op = Op::GREATER;
+            } else if (opText == ">=") {
+                instruction.op = Op::GREATER_EQUAL;
+            } else if (opText == "==") {
+                instruction.op = Op::EQUAL;
+            } else if (opText == "!=") {
+                instruction.op = Op::NOT_EQUAL;
+            } else {
+                return fail("unknown operator '" + opText + "'");
+            }
+            if (!parseNumber(trim(predicate.substr(opEnd)), instruction.constant)) {
+                return fail("invalid constant in '" + predicate + "'");
+            }
+            ruleSet->m_program.push_back(instruction);
+
+            if (split == std::string::npos) {
+                break;
+            }
+            start = split + 2;
+        }
+
+        ruleSet->m_program.back().endsRule = true;
+        ruleSet->m_weights.push_back(weight);
+        ruleSet->m_names.push_back(name);
+    }
+
+    if (ruleSet->m_highThreshold < ruleSet->m_mediumThreshold) {
+        return fail("high threshold is below the medium threshold");
+    }
+
+    return ruleSet;
+}
+
+std::shared_ptr<const FraudRuleSet> FraudRuleSet::defaults() {
+    static const std::shared_ptr<const FraudRuleSet> ruleSet = compile(kDefaultRules);
+    return ruleSet;
+}
+
+FraudAssessment FraudRuleSet::evaluate(const FraudFeatures& features) const {
+    double score = 0.0;
+    std::uint64_t matched = 0;
+    bool holds = true;
+
+    for (const Instruction& instruction : m_program) {
+        const double value = features[instruction.feature];
+        switch (instruction.op) {
+            case Op::LESS:
+                holds &= value < instruction.constant;
+                break;
+            case Op::LESS_EQUAL:
+                holds &= value <= instruction.constant;
+                break;
+            case Op::GREATER:
+                holds &= value > instruction.constant;
+                break;
+            case Op::GREATER_EQUAL:
+                holds &= value >= instruction.constant;
+                break;
+            case Op::EQUAL:
+                holds &= value == instruction.constant;
+                break;
+            case Op::NOT_EQUAL:
+                holds &= value != instruction.constant;
+                break;
+        }
+
+        if (instruction.endsRule) {
+            if (holds) {
+                score += m_weights[instruction.rule];
+                matched |= std::uint64_t(1) << instruction.rule;
+            }
+            holds = true;
+        }
+    }
+
+    return FraudAssessment{levelFor(score), score, matched};
+}
+
+std::vector<FraudAssessment> FraudRuleSet::evaluateBatch(const FraudBatch& batch) const {
+    const std::size_t rows = batch.size();
+    std::vector<FraudAssessment> assessments(rows);
+
+    std::size_t row = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+    const double* columns[kFeatureCount];
+    for (std::size_t feature = 0; feature < kFeatureCount; ++feature) {
+        columns[feature] = batch.column(static_cast<FraudFeature>(feature));
+    }
+
+    // The program runs instruction by instruction over a block of rows, so each predicate is one
+    // tight loop of vector compares. A failed compare clears the row's lane in holds, and a rule's
+    // weight is added through that mask, so every row sums in the same order as evaluate().
+    alignas(32) double holds[kBatchBlock];
+    alignas(32) double scores[kBatchBlock];
+    alignas(32) std::uint64_t matched[kBatchBlock];
+
+    const std::size_t vectorRows = rows - rows % Lanes::kWidth;
+    for (; row < vectorRows; row += kBatchBlock) {
+        const std::size_t count = std::min(kBatchBlock, vectorRows - row);
+        for (std::size_t i = 0; i < count; i += Lanes::kWidth) {
+            Lanes::store(holds + i, Lanes::allSet());
+            Lanes::store(scores + i, Lanes::zero());
+            Lanes::storeBits(matched + i, Lanes::zeroBits());
+        }
+
+        for (const Instruction& instruction : m_program) {
+            const double* values = columns[instruction.feature] + row;
+            switch (instruction.op) {
+                case Op::LESS:
+                    narrow<Lanes::Less>(values, instruction.constant, holds, count);
+                    break;
+                case Op::LESS_EQUAL:
+                    narrow<Lanes::LessEqual>(values, instruction.constant, holds, count);
+                    break;
+                case Op::GREATER:
+                    narrow<Lanes::Greater>(values, instruction.constant, holds, count);
+                    break;
+                case Op::GREATER_EQUAL:
+                    narrow<Lanes::GreaterEqual>(values, instruction.constant, holds, count);
+                    break;
+                case Op::EQUAL:
+                    narrow<Lanes::Equal>(values, instruction.constant, holds, count);
+                    break;
+                case Op::NOT_EQUAL:
+                    narrow<Lanes::NotEqual>(values, instruction.constant, holds, count);
+                    break;
+            }
+
+            if (instruction.endsRule) {
+                const Lanes::Vector weight = Lanes::broadcast(m_weights[instruction.rule]);
+                const Lanes::Bits bit = Lanes::broadcastBits(std::uint64_t(1) << instruction.rule);
+                for (std::size_t i = 0; i < count; i += Lanes::kWidth) {
+                    Lanes::Vector mask = Lanes::load(holds + i);
+                    Lanes::store(scores + i, Lanes::add(Lanes::load(scores + i), Lanes::mask(mask, weight)));
+                    Lanes::storeBits(matched + i, Lanes::orBits(Lanes::loadBits(matched + i), Lanes::maskBits(mask, bit)));
+                    Lanes::store(holds + i, Lanes::allSet());
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            assessments[row + i] = FraudAssessment{levelFor(scores[i]), scores[i], matched[i]};
+        }
+    }
+    row = vectorRows;
+#endif
+
+    // Rows left over after the vector loop, or all of them without SIMD
+    for (; row < rows; ++row) {
+        assessments[row] = evaluate(batch.getRow(row));
+    }
+
+    return assessments;
+}
+
+FraudRiskLevel FraudRuleSet::levelFor(double score) const {
+    if (score >= m_highThreshold) {
+        return FraudRiskLevel::HIGH;
+    }
+    if (score >= m_mediumThreshold) {
+        return FraudRiskLevel::MEDIUM;
+    }
+    return FraudRiskLevel::LOW;
+}
+
+std::size_t FraudRuleSet::size() const {
+    return m_names.size();
+}
+
+const std::string& FraudRuleSet::getRuleName(std::size_t rule) const {
+    return m_names.at(rule);
+}
+
+bool FraudRuleSet::featureFromString(const std::string& name, FraudFeature& feature) {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(FraudFeature::COUNT); ++i) {
+        if (name == kFeatureNames[i]) {
+            feature = static_cast<FraudFeature>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,239 @@
+#ifndef FRAUDRULES_H
+#define FRAUDRULES_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Enum for fraud risk level
+enum class FraudRiskLevel {
+    LOW,
+    MEDIUM,
+    HIGH
+};
+
+/**
+ * @enum FraudFeature
+ * @brief Transaction attributes that fraud rules can test
+ *
+ * Flags are 1 or 0, amounts are in currency units and counts include the
+ * transaction being evaluated.
+ */
+enum class FraudFeature : std::uint8_t {
+    AMOUNT,
+    ADDRESS_FLAGGED,        ///< Billing address contains a suspicious address token
+    DIGITAL_WALLET,
+    PREPAID_CARD,
+    CUSTOMER_VELOCITY,      ///< Customer is over one of its VelocityLimits
+    CARD_VELOCITY,
+    MERCHANT_VELOCITY,
+    CUSTOMER_COUNT_MINUTE,
+    CUSTOMER_COUNT_HOUR,
+    CUSTOMER_COUNT_DAY,
+    CUSTOMER_AMOUNT_DAY,
+    CARD_COUNT_MINUTE,
+    CARD_COUNT_HOUR,
+    CARD_COUNT_DAY,
+    CARD_AMOUNT_DAY,
+    MERCHANT_COUNT_MINUTE,
+    MERCHANT_COUNT_HOUR,
+    MERCHANT_COUNT_DAY,
+    MERCHANT_AMOUNT_DAY,
+    BLOCKED_CARD,           ///< Card number is on the card blocklist
+    BLOCKED_WALLET,
+    BLOCKED_EMAIL,          ///< Customer email is on the email blocklist
+    PROFILE_TRANSACTIONS,   ///< Earlier transactions in the customer's behavioural profile
+    AMOUNT_ZSCORE,          ///< Standard deviations above the customer's usual amount
+    NEW_MERCHANT,           ///< Merchant is not one the customer usually buys from
+    NEW_PAYMENT_METHOD,
+    HOUR_SHARE,             ///< Share of the customer's activity at this hour of the day, 0 to 1
+    COUNT
+};
+
+/**
+ * @brief Feature values for one transaction, indexed by FraudFeature
+ */
+using FraudFeatures = std::array<double, static_cast<std::size_t>(FraudFeature::COUNT)>;
+
+/**
+ * @class FraudBatch
+ * @brief Features of many transactions stored column by column
+ *
+ * Each feature is one contiguous column with a value per transaction, so
+ * a rule predicate can be tested over consecutive transactions with a
+ * single vector load and compare.
+ */
+class FraudBatch {
+public:
+    /**
+     * @brief Constructor
+     * @param rows Number of transactions; all features start at zero
+     */
+    explicit FraudBatch(std::size_t rows = 0);
+
+    /**
+     * @brief Get the number of transactions
+     * @return The row count
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Change the number of transactions, zeroing every feature
+     * @param rows The new row count
+     */
+    void resize(std::size_t rows);
+
+    /**
+     * @brief Get the column for one feature
+     * @param feature The feature
+     * @return Pointer to size() values; invalidated by resize()
+     */
+    double* column(FraudFeature feature);
+    const double* column(FraudFeature feature) const;
+
+    /**
+     * @brief Store the features of one transaction
+     * @param row The transaction's index in the batch
+     * @param features The feature values
+     */
+    void setRow(std::size_t row, const FraudFeatures& features);
+
+    /**
+     * @brief Read back the features of one transaction
+     * @param row The transaction's index in the batch
+     * @return The feature values
+     */
+    FraudFeatures getRow(std::size_t row) const;
+
+private:
+    std::size_t m_rows;
+    std::vector<double> m_values;   ///< Column for feature f starts at f * m_rows
+};
+
+/**
+ * @struct FraudAssessment
+ * @brief Outcome of running a rule set, and any fraud model, over a transaction
+ */
+struct FraudAssessment {
+    FraudRiskLevel level;
+    double score;               ///< Sum of the weights of the rules that matched
+    std::uint64_t matchedRules; ///< Bit i set if rule i matched
+    double modelScore = 0.0;    ///< FraudModel score; 0 when no model was run
+};
+
+/**
+ * @class FraudRuleSet
+ * @brief Immutable fraud rules compiled into a flat predicate program
+ *
+ * A rule is a conjunction of predicates of the form "feature op constant"
+ * and contributes its weight to the score when all of them hold; the score
+ * is then mapped to a risk level by two thresholds. Compilation resolves
+ * feature names to indices and lays every predicate out in one contiguous
+ * array, the last predicate of each rule carrying the rule's index. Running
+ * the program is a single pass over that array with no lookups and no
+ * allocation.
+ *
+ * Rule files are line based; blank lines and lines starting with '#' are
+ * ignored:
+ * @code
+ * rule,large_amount,1,amount > 1000
+ * rule,fast_wallet,2,wallet == 1 && card_count_minute >= 3
+ * level,medium,1
+ * level,high,2
+ * @endcode
+ */
+class FraudRuleSet {
+public:
+    /// Most rules a set may hold, so matches fit in FraudAssessment::matchedRules
+    static constexpr std::size_t kMaxRules = 64;
+
+    /**
+     * @brief Compile rules from their text form
+     * @param source The rule file contents
+     * @return The rule set, or nullptr if the text has errors; errors are reported on std::cerr
+     */
+    static std::shared_ptr<const FraudRuleSet> compile(const std::string& source);
+
+    /**
+     * @brief Get the built-in rules, which reproduce the original fixed checks
+     * @return The default rule set
+     */
+    static std::shared_ptr<const FraudRuleSet> defaults();
+
+    /**
+     * @brief Run the rules over a transaction's features
+     * @param features The feature values
+     * @return The score, risk level and matched rules
+     */
+    FraudAssessment evaluate(const FraudFeatures& features) const;
+
+    /**
+     * @brief Run the rules over every transaction in a batch
+     *
+     * Several transactions are scored at once with AVX2 or SSE2 when the
+     * build targets them, and one at a time otherwise. Results match
+     * evaluate() exactly.
+     *
+     * @param batch The transactions' features
+     * @return One assessment per row, in order
+     */
+    std::vector<FraudAssessment> evaluateBatch(const FraudBatch& batch) const;
+
+    /**
+     * @brief Get the number of rules
+     * @return The rule count
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Get the name of a rule
+     * @param rule Index of the rule, as used in FraudAssessment::matchedRules
+     * @return The name given in the rule file
+     */
+    const std::string& getRuleName(std::size_t rule) const;
+
+    /**
+     * @brief Look up a feature by the name used in rule files
+     * @param name e.g. "amount", "card_count_minute"
+     * @param feature Receives the feature
+     * @return False if the name is not known
+     */
+    static bool featureFromString(const std::string& name, FraudFeature& feature);
+
+private:
+    enum class Op : std::uint8_t {
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        EQUAL,
+        NOT_EQUAL
+    };
+
+    struct Instruction {
+        double constant;
+        std::uint8_t feature;
+        Op op;
+        bool endsRule;          ///< Last predicate of a rule; rule gives its index
+        std::uint8_t rule;
+    };
+
+    FraudRuleSet() = default;
+
+    /**
+     * @brief Map a score to a risk level using the set's thresholds
+     * @param score The summed rule weights
+     * @return The risk level
+     */
+    FraudRiskLevel levelFor(double score) const;
+
+    std::vector<Instruction> m_program;
+    std::vector<double> m_weights;  ///< Per rule
+    std::vector<std::string> m_names;
+    double m_mediumThreshold = 1.0;
+    double m_highThreshold = 2.0;
+};
+
+#endif // FRAUDRULES_H
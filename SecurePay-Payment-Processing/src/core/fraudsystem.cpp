@@ -1,58 +1,406 @@
 #include "fraudsystem.h"
+#include "bintable.h"
 #include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
 FraudSystem& FraudSystem::getInstance() {
     static FraudSystem instance;
     return instance;
 }
 
-FraudSystem::FraudSystem() {
+FraudSystem::FraudSystem()
+    : m_rules(FraudRuleSet::defaults()),
+      m_addressMatcher(std::make_shared<const AddressMatcher>(std::vector<std::string>{"unknown", "test"})),
+      m_blocklists{std::make_shared<const Blocklist>(BlocklistType::CARD),
+                   std::make_shared<const Blocklist>(BlocklistType::WALLET),
+                   std::make_shared<const Blocklist>(BlocklistType::EMAIL)} {
     std::cout << "FraudSystem initialized" << std::endl;
 }
 
 FraudRiskLevel FraudSystem::evaluateTransaction(const Transaction& transaction) {
+    return screenTransaction(transaction).level;
+}
+
+FraudAssessment FraudSystem::screenTransaction(const Transaction& transaction) {
+    std::shared_ptr<const FraudRuleSet> rules = getRules();
+    std::shared_ptr<const FraudModel> model = getModel();
+    FraudAssessment assessment = assessWith(transaction, recordFeatures(transaction), *rules, model.get());
+    raiseAlert(transaction, assessment, *rules, model.get());
+    return assessment;
+}
+
+std::vector<FraudAssessment> FraudSystem::screenBatch(const std::vector<const Transaction*>& transactions) {
+    std::cout << "Screening batch of " << transactions.size() << " transactions for fraud risk" << std::endl;
+    
+    // Rows are recorded in order, so each sees the velocity of the rows before it, as if screened one by one
+    FraudBatch batch(transactions.size());
+    for (std::size_t row = 0; row < transactions.size(); ++row) {
+        batch.setRow(row, recordFeatures(*transactions[row]));
+    }
+    
+    std::shared_ptr<const FraudRuleSet> rules = getRules();
+    std::shared_ptr<const FraudModel> model = getModel();
+    std::vector<FraudAssessment> assessments = assessBatchWith(batch, *rules, model.get());
+    for (std::size_t row = 0; row < transactions.size(); ++row) {
+        raiseAlert(*transactions[row], assessments[row], *rules, model.get());
+    }
+    
+    return assessments;
+}
+
+void FraudSystem::raiseAlert(const Transaction& transaction, const FraudAssessment& assessment,
+                             const FraudRuleSet& rules, const FraudModel* model) {
+    if (assessment.level != FraudRiskLevel::LOW) {
+        std::ostringstream description;
+        if (assessment.matchedRules != 0) {
+            description << "Matched rules: ";
+            const char* separator = "";
+            for (std::size_t rule = 0; rule < rules.size(); ++rule) {
+                if (assessment.matchedRules & (std::uint64_t(1) << rule)) {
+                    description << separator << rules.getRuleName(rule);
+                    separator = ", ";
+                }
+            }
+        }
+        if (model) {
+            description << (assessment.matchedRules != 0 ? "; model score " : "Model score ")
+                        << assessment.modelScore;
+        }
+        m_alertStore.add(FraudAlertFactory::createFraudAlert(transaction, assessment.level, description.str()));
+    }
+}
+
+FraudAssessment FraudSystem::assessTransaction(const Transaction& transaction) const {
+    return assessWith(transaction, extractFeatures(transaction), *getRules(), getModel().get());
+}
+
+FraudAssessment FraudSystem::assessWith(const Transaction& transaction, const FraudFeatures& features,
+                                        const FraudRuleSet& rules, const FraudModel* model) const {
     std::cout << "Evaluating transaction " << transaction.getTransactionId() 
               << " for fraud risk" << std::endl;
     
-    int suspiciousFactors = 0;
+    FraudAssessment assessment = rules.evaluate(features);
     
-    if (isAmountSuspicious(transaction.getAmount())) {
-        suspiciousFactors++;
+    for (std::size_t rule = 0; rule < rules.size(); ++rule) {
+        if (assessment.matchedRules & (std::uint64_t(1) << rule)) {
+            std::cout << "Fraud rule matched: " << rules.getRuleName(rule) << std::endl;
+        }
     }
     
-    if (isLocationSuspicious(transaction.getCustomer().getBillingAddress())) {
-        suspiciousFactors++;
+    if (model) {
+        assessment.modelScore = model->score(features);
+        assessment.level = std::max(assessment.level, model->levelFor(assessment.modelScore));
     }
     
-    if (isPaymentMethodSuspicious(transaction.getPaymentMethod())) {
-        suspiciousFactors++;
+    return assessment;
+}
+
+FraudBatch FraudSystem::buildBatch(const std::vector<const Transaction*>& transactions) const {
+    FraudBatch batch(transactions.size());
+    for (std::size_t row = 0; row < transactions.size(); ++row) {
+        batch.setRow(row, extractFeatures(*transactions[row]));
+    }
+    return batch;
+}
+
+std::vector<FraudAssessment> FraudSystem::assessBatch(const FraudBatch& batch) const {
+    return assessBatchWith(batch, *getRules(), getModel().get());
+}
+
+std::vector<FraudAssessment> FraudSystem::assessBatchWith(const FraudBatch& batch, const FraudRuleSet& rules,
+                                                          const FraudModel* model) const {
+    std::vector<FraudAssessment> assessments = rules.evaluateBatch(batch);
+    
+    if (model) {
+        std::vector<double> scores = model->scoreBatch(batch);
+        for (std::size_t row = 0; row < assessments.size(); ++row) {
+            assessments[row].modelScore = scores[row];
+            assessments[row].level = std::max(assessments[row].level, model->levelFor(scores[row]));
+        }
     }
     
-    if (suspiciousFactors == 0) {
-        return FraudRiskLevel::LOW;
-    } else if (suspiciousFactors == 1) {
-        return FraudRiskLevel::MEDIUM;
-    } else {
-        return FraudRiskLevel::HIGH;
+    return assessments;
+}
+
+std::vector<FraudRiskLevel> FraudSystem::evaluateBatch(const FraudBatch& batch) const {
+    std::vector<FraudAssessment> assessments = assessBatch(batch);
+    std::vector<FraudRiskLevel> levels;
+    levels.reserve(assessments.size());
+    for (const FraudAssessment& assessment : assessments) {
+        levels.push_back(assessment.level);
     }
+    return levels;
+}
+
+FraudFeatures FraudSystem::recordFeatures(const Transaction& transaction) {
+    FraudFeatures features = extractStaticFeatures(transaction);
+    
+    // Recent activity per customer, card and merchant, including this transaction
+    const PaymentMethod& paymentMethod = transaction.getPaymentMethod();
+    std::int64_t amountCents = static_cast<std::int64_t>(std::llround(transaction.getAmount() * 100.0));
+    setVelocityFeatures(features,
+        m_velocityTracker.record(VelocityDimension::CUSTOMER, transaction.getCustomer().getName(), amountCents),
+        m_velocityTracker.record(VelocityDimension::CARD, paymentMethod.getFingerprint(), amountCents),
+        m_velocityTracker.record(VelocityDimension::MERCHANT, transaction.getMerchant().getName(), amountCents));
+    
+    // How far this transaction departs from the customer's habits, before it joins them
+    setProfileFeatures(features, m_profiles.observe(
+        transaction.getCustomer().getName(), transaction.getMerchant().getName(),
+        paymentMethod.getFingerprint(), transaction.getAmount(), transaction.getCreatedAt()));
+    
+    return features;
+}
+
+FraudFeatures FraudSystem::extractFeatures(const Transaction& transaction) const {
+    FraudFeatures features = extractStaticFeatures(transaction);
+    
+    // Current activity with this transaction added on top, so thresholds read as they do in screening
+    const PaymentMethod& paymentMethod = transaction.getPaymentMethod();
+    std::int64_t amountCents = static_cast<std::int64_t>(std::llround(transaction.getAmount() * 100.0));
+    setVelocityFeatures(features,
+        including(m_velocityTracker.get(VelocityDimension::CUSTOMER, transaction.getCustomer().getName()), amountCents),
+        including(m_velocityTracker.get(VelocityDimension::CARD, paymentMethod.getFingerprint()), amountCents),
+        including(m_velocityTracker.get(VelocityDimension::MERCHANT, transaction.getMerchant().getName()), amountCents));
+    
+    setProfileFeatures(features, m_profiles.compare(
+        transaction.getCustomer().getName(), transaction.getMerchant().getName(),
+        paymentMethod.getFingerprint(), transaction.getAmount(), transaction.getCreatedAt()));
+    
+    return features;
 }
 
-bool FraudSystem::isAmountSuspicious(double amount) const {
-    return amount > 1000.0;
+FraudFeatures FraudSystem::extractStaticFeatures(const Transaction& transaction) const {
+    FraudFeatures features{};
+    auto set = [&features](FraudFeature feature, double value) {
+        features[static_cast<std::size_t>(feature)] = value;
+    };
+    
+    const PaymentMethod& paymentMethod = transaction.getPaymentMethod();
+    set(FraudFeature::AMOUNT, transaction.getAmount());
+    set(FraudFeature::ADDRESS_FLAGGED, isLocationSuspicious(transaction.getCustomer().getBillingAddress()));
+    set(FraudFeature::DIGITAL_WALLET, paymentMethod.getType() == "Digital Wallet");
+    set(FraudFeature::PREPAID_CARD, isPrepaidCard(paymentMethod));
+    set(FraudFeature::BLOCKED_CARD, getBlocklist(BlocklistType::CARD)->contains(paymentMethod.getCardNumber()));
+    set(FraudFeature::BLOCKED_WALLET, getBlocklist(BlocklistType::WALLET)->contains(paymentMethod.getWalletId()));
+    set(FraudFeature::BLOCKED_EMAIL, getBlocklist(BlocklistType::EMAIL)->contains(transaction.getCustomer().getEmail()));
+    
+    return features;
+}
+
+void FraudSystem::setVelocityFeatures(FraudFeatures& features, const VelocitySnapshot& customerActivity,
+                                      const VelocitySnapshot& cardActivity,
+                                      const VelocitySnapshot& merchantActivity) const {
+    auto set = [&features](FraudFeature feature, double value) {
+        features[static_cast<std::size_t>(feature)] = value;
+    };
+    
+    VelocityLimits limits = getVelocityLimits();
+    set(FraudFeature::CUSTOMER_VELOCITY, isVelocitySuspicious(customerActivity, limits.customer));
+    set(FraudFeature::CUSTOMER_COUNT_MINUTE, customerActivity.minute.count);
+    set(FraudFeature::CUSTOMER_COUNT_HOUR, customerActivity.hour.count);
+    set(FraudFeature::CUSTOMER_COUNT_DAY, customerActivity.day.count);
+    set(FraudFeature::CUSTOMER_AMOUNT_DAY, customerActivity.day.amountCents / 100.0);
+    
+    set(FraudFeature::CARD_VELOCITY, isVelocitySuspicious(cardActivity, limits.card));
+    set(FraudFeature::CARD_COUNT_MINUTE, cardActivity.minute.count);
+    set(FraudFeature::CARD_COUNT_HOUR, cardActivity.hour.count);
+    set(FraudFeature::CARD_COUNT_DAY, cardActivity.day.count);
+    set(FraudFeature::CARD_AMOUNT_DAY, cardActivity.day.amountCents / 100.0);
+    
+    set(FraudFeature::MERCHANT_VELOCITY, isVelocitySuspicious(merchantActivity, limits.merchant));
+    set(FraudFeature::MERCHANT_COUNT_MINUTE, merchantActivity.minute.count);
+    set(FraudFeature::MERCHANT_COUNT_HOUR, merchantActivity.hour.count);
+    set(FraudFeature::MERCHANT_COUNT_DAY, merchantActivity.day.count);
+    set(FraudFeature::MERCHANT_AMOUNT_DAY, merchantActivity.day.amountCents / 100.0);
+}
+
+void FraudSystem::setProfileFeatures(FraudFeatures& features, const CustomerProfileSignals& profile) {
+    features[static_cast<std::size_t>(FraudFeature::PROFILE_TRANSACTIONS)] = profile.priorTransactions;
+    features[static_cast<std::size_t>(FraudFeature::AMOUNT_ZSCORE)] = profile.amountZScore;
+    features[static_cast<std::size_t>(FraudFeature::NEW_MERCHANT)] = profile.newMerchant;
+    features[static_cast<std::size_t>(FraudFeature::NEW_PAYMENT_METHOD)] = profile.newPaymentMethod;
+    features[static_cast<std::size_t>(FraudFeature::HOUR_SHARE)] = profile.hourShare;
+}
+
+VelocitySnapshot FraudSystem::including(VelocitySnapshot activity, std::int64_t amountCents) {
+    for (VelocityCount* window : {&activity.minute, &activity.hour, &activity.day}) {
+        ++window->count;
+        window->amountCents += amountCents;
+    }
+    return activity;
 }
 
 bool FraudSystem::isLocationSuspicious(const std::string& billingAddress) const {
-    std::string lowerAddress = billingAddress;
-    std::transform(lowerAddress.begin(), lowerAddress.end(), lowerAddress.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+    return getAddressMatcher()->matches(billingAddress);
+}
+
+bool FraudSystem::isPrepaidCard(const PaymentMethod& paymentMethod) const {
+    // Prepaid cards are a common vehicle for card testing
+    std::string bin = paymentMethod.getBin();
+    if (!bin.empty()) {
+        std::shared_ptr<const BinTable> binTable = BinManager::getInstance().getTable();
+        const BinInfo* binInfo = binTable->lookup(bin);
+        return binInfo && binInfo->cardType == CardType::PREPAID;
+    }
+    
+    return false;
+}
+
+bool FraudSystem::isVelocitySuspicious(const VelocitySnapshot& activity, const VelocityWindowLimits& limits) {
+    return exceeds(activity.minute, limits.perMinute) ||
+           exceeds(activity.hour, limits.perHour) ||
+           exceeds(activity.day, limits.perDay);
+}
+
+bool FraudSystem::exceeds(const VelocityCount& activity, const VelocityLimit& limit) {
+    return (limit.maxCount > 0 && activity.count > limit.maxCount) ||
+           (limit.maxAmountCents > 0 && activity.amountCents > limit.maxAmountCents);
+}
+
+void FraudSystem::setVelocityLimits(const VelocityLimits& limits) {
+    std::lock_guard<std::mutex> lock(m_limitsMutex);
+    m_velocityLimits = limits;
+}
+
+VelocityLimits FraudSystem::getVelocityLimits() const {
+    std::lock_guard<std::mutex> lock(m_limitsMutex);
+    return m_velocityLimits;
+}
+
+const VelocityTracker& FraudSystem::getVelocityTracker() const {
+    return m_velocityTracker;
+}
+
+bool FraudSystem::loadRulesFromFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open fraud rules " << filePath << std::endl;
+        return false;
+    }
+    
+    std::stringstream source;
+    source << file.rdbuf();
+    
+    // A file with errors leaves the live rules in place
+    std::shared_ptr<const FraudRuleSet> rules = FraudRuleSet::compile(source.str());
+    if (!rules) {
+        std::cerr << "Fraud rules in " << filePath << " were not loaded" << std::endl;
+        return false;
+    }
+    
+    setRules(rules);
+    std::cout << "Loaded " << rules->size() << " fraud rules from " << filePath << std::endl;
+    return true;
+}
+
+void FraudSystem::setRules(std::shared_ptr<const FraudRuleSet> rules) {
+    if (!rules) {
+        rules = FraudRuleSet::defaults();
+    }
+    std::atomic_store(&m_rules, rules);
+}
+
+std::shared_ptr<const FraudRuleSet> FraudSystem::getRules() const {
+    return std::atomic_load(&m_rules);
+}
+
+bool FraudSystem::loadModelFromFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open fraud model " << filePath << std::endl;
+        return false;
+    }
+    
+    std::stringstream source;
+    source << file.rdbuf();
+    
+    // A file with errors leaves the live model, if any, in place
+    std::shared_ptr<const FraudModel> model = FraudModel::parse(source.str());
+    if (!model) {
+        std::cerr << "Fraud model in " << filePath << " was not loaded" << std::endl;
+        return false;
+    }
+    
+    setModel(model);
+    std::cout << "Loaded fraud model over " << model->size() << " features from " << filePath << std::endl;
+    return true;
+}
+
+void FraudSystem::setModel(std::shared_ptr<const FraudModel> model) {
+    std::atomic_store(&m_model, model);
+}
+
+std::shared_ptr<const FraudModel> FraudSystem::getModel() const {
+    return std::atomic_load(&m_model);
+}
+
+bool FraudSystem::loadAddressTokensFromFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open address tokens " << filePath << std::endl;
+        return false;
+    }
     
-    return lowerAddress.find("unknown") != std::string::npos ||
-           lowerAddress.find("test") != std::string::npos;
+    std::vector<std::string> tokens;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        std::size_t end = line.find_last_not_of(" \t\r");
+        tokens.push_back(line.substr(begin, end - begin + 1));
+    }
+    
+    setAddressTokens(tokens);
+    std::cout << "Loaded " << tokens.size() << " address tokens from " << filePath << std::endl;
+    return true;
+}
+
+void FraudSystem::setAddressTokens(const std::vector<std::string>& tokens) {
+    std::shared_ptr<const AddressMatcher> matcher = std::make_shared<const AddressMatcher>(tokens);
+    std::atomic_store(&m_addressMatcher, matcher);
+}
+
+std::shared_ptr<const AddressMatcher> FraudSystem::getAddressMatcher() const {
+    return std::atomic_load(&m_addressMatcher);
+}
+
+bool FraudSystem::loadBlocklist(BlocklistType type, const std::string& entriesPath, const std::string& databasePath) {
+    std::shared_ptr<const Blocklist> blocklist = Blocklist::build(type, entriesPath, databasePath);
+    if (!blocklist) {
+        return false;
+    }
+    
+    std::atomic_store(&m_blocklists[static_cast<std::size_t>(type)], blocklist);
+    return true;
+}
+
+std::shared_ptr<const Blocklist> FraudSystem::getBlocklist(BlocklistType type) const {
+    return std::atomic_load(&m_blocklists[static_cast<std::size_t>(type)]);
+}
+
+bool FraudSystem::saveProfiles(const std::string& filePath) const {
+    return m_profiles.save(filePath);
+}
+
+bool FraudSystem::loadProfiles(const std::string& filePath) {
+    return m_profiles.load(filePath);
+}
+
+const CustomerProfileStore& FraudSystem::getProfileStore() const {
+    return m_profiles;
+}
+
+FraudAlertStore& FraudSystem::getAlertStore() {
+    return m_alertStore;
 }
 
-bool FraudSystem::isPaymentMethodSuspicious(const PaymentMethod& paymentMethod) const {
-    return paymentMethod.getType() == "Digital Wallet";
+const FraudAlertStore& FraudSystem::getAlertStore() const {
+    return m_alertStore;
 }
 
 std::string FraudSystem::riskLevelToString(FraudRiskLevel riskLevel) {
@@ -2,13 +2,35 @@
 #define FRAUDSYSTEM_H
 
 #include <memory>
+#include <mutex>
+#include <vector>
+#include "addressmatcher.h"
+#include "blocklist.h"
+#include "customerprofilestore.h"
+#include "fraudalertstore.h"
+#include "fraudmodel.h"
+#include "fraudrules.h"
 #include "transaction.h"
+#include "velocitytracker.h"
 
-// Enum for fraud risk level
-enum class FraudRiskLevel {
-    LOW,
-    MEDIUM,
-    HIGH
+// Ceiling on activity within one window; 0 disables that part of the limit
+struct VelocityLimit {
+    std::uint32_t maxCount;
+    std::int64_t maxAmountCents;
+};
+
+// Minute, hour and day limits for one velocity dimension
+struct VelocityWindowLimits {
+    VelocityLimit perMinute;
+    VelocityLimit perHour;
+    VelocityLimit perDay;
+};
+
+// Velocity rules per customer, card and merchant; exceeding any window of a dimension sets its velocity rule feature
+struct VelocityLimits {
+    VelocityWindowLimits customer{{10, 0}, {60, 0}, {0, 1000000}};
+    VelocityWindowLimits card{{5, 0}, {30, 0}, {0, 500000}};
+    VelocityWindowLimits merchant{{0, 0}, {0, 0}, {0, 0}};
 };
 
 // Singleton class for fraud detection
@@ -22,19 +44,110 @@ public:
     FraudSystem& operator=(const FraudSystem&) = delete;
     
 
+    // Medium and high risk raise an alert in the alert store, which keeps its own copy of the
+    // transaction details it reports
     FraudRiskLevel evaluateTransaction(const Transaction& transaction);
     
+    // The same screening, returning the score and matched rules along with the level
+    FraudAssessment screenTransaction(const Transaction& transaction);
+    
+    // Runs the live rule set and model without counting the transaction toward velocity or folding it
+    // into its customer's profile, e.g. to re-evaluate it; only screening records a transaction
+    FraudAssessment assessTransaction(const Transaction& transaction) const;
+    
+    // Screens many transactions at once: each is recorded as screenTransaction() would, the batch is
+    // scored with SIMD where available, and medium and high risk raise alerts
+    std::vector<FraudAssessment> screenBatch(const std::vector<const Transaction*>& transactions);
+    
+    // Column-wise features for many transactions, read without recording anything, as assessTransaction() does
+    FraudBatch buildBatch(const std::vector<const Transaction*>& transactions) const;
+    
+    // Scores a whole batch against the live rule set and model with SIMD where available, e.g. to re-score
+    // stored features after a rule or model change
+    std::vector<FraudAssessment> assessBatch(const FraudBatch& batch) const;
+    std::vector<FraudRiskLevel> evaluateBatch(const FraudBatch& batch) const;
+    
   
     static std::string riskLevelToString(FraudRiskLevel riskLevel);
     
+    // Every evaluated transaction is counted, whatever its outcome, before the limits are checked
+    void setVelocityLimits(const VelocityLimits& limits);
+    VelocityLimits getVelocityLimits() const;
+    
+    const VelocityTracker& getVelocityTracker() const;
+    
+    // Rule sets are swapped atomically; evaluations in progress finish on the set they started with
+    bool loadRulesFromFile(const std::string& filePath);
+    void setRules(std::shared_ptr<const FraudRuleSet> rules);
+    std::shared_ptr<const FraudRuleSet> getRules() const;
+    
+    // An optional model scored alongside the rules; the higher of the two risk levels wins.
+    // Swapped atomically like the rules; setting nullptr goes back to rules alone
+    bool loadModelFromFile(const std::string& filePath);
+    void setModel(std::shared_ptr<const FraudModel> model);
+    std::shared_ptr<const FraudModel> getModel() const;
+    
+    // Billing addresses containing any of these tokens, ignoring case, are flagged; one token per line
+    bool loadAddressTokensFromFile(const std::string& filePath);
+    void setAddressTokens(const std::vector<std::string>& tokens);
+    std::shared_ptr<const AddressMatcher> getAddressMatcher() const;
+    
+    // Builds the new list aside and swaps it in, so evaluations never wait for a reload
+    bool loadBlocklist(BlocklistType type, const std::string& entriesPath, const std::string& databasePath);
+    std::shared_ptr<const Blocklist> getBlocklist(BlocklistType type) const;
+    
+    // Every evaluated transaction is folded into its customer's profile after being compared with it;
+    // snapshots let profiles survive a restart
+    bool saveProfiles(const std::string& filePath) const;
+    bool loadProfiles(const std::string& filePath);
+    const CustomerProfileStore& getProfileStore() const;
+    
+    FraudAlertStore& getAlertStore();
+    const FraudAlertStore& getAlertStore() const;
+    
 private:
     
     FraudSystem();
     
   
-    bool isAmountSuspicious(double amount) const;
+    // Screening features: the transaction is counted toward velocity and folded into its profile
+    FraudFeatures recordFeatures(const Transaction& transaction);
+    
+    // The same features without recording anything; velocity reads as if the transaction were counted now
+    FraudFeatures extractFeatures(const Transaction& transaction) const;
+    
+    FraudFeatures extractStaticFeatures(const Transaction& transaction) const;
+    void setVelocityFeatures(FraudFeatures& features, const VelocitySnapshot& customerActivity,
+                             const VelocitySnapshot& cardActivity, const VelocitySnapshot& merchantActivity) const;
+    static void setProfileFeatures(FraudFeatures& features, const CustomerProfileSignals& profile);
+    static VelocitySnapshot including(VelocitySnapshot activity, std::int64_t amountCents);
+    
+    FraudAssessment assessWith(const Transaction& transaction, const FraudFeatures& features,
+                               const FraudRuleSet& rules, const FraudModel* model) const;
+    std::vector<FraudAssessment> assessBatchWith(const FraudBatch& batch, const FraudRuleSet& rules,
+                                                 const FraudModel* model) const;
+    
+    // Stores an alert for medium and high risk, naming the matched rules and any model score
+    void raiseAlert(const Transaction& transaction, const FraudAssessment& assessment,
+                    const FraudRuleSet& rules, const FraudModel* model);
+    
     bool isLocationSuspicious(const std::string& billingAddress) const;
-    bool isPaymentMethodSuspicious(const PaymentMethod& paymentMethod) const;
+    bool isPrepaidCard(const PaymentMethod& paymentMethod) const;
+    static bool isVelocitySuspicious(const VelocitySnapshot& activity, const VelocityWindowLimits& limits);
+    static bool exceeds(const VelocityCount& activity, const VelocityLimit& limit);
+    
+    VelocityTracker m_velocityTracker;
+    CustomerProfileStore m_profiles;
+    
+    mutable std::mutex m_limitsMutex;
+    VelocityLimits m_velocityLimits;
+    
+    std::shared_ptr<const FraudRuleSet> m_rules; // Accessed with std::atomic_load / std::atomic_store
+    std::shared_ptr<const FraudModel> m_model; // Null when no model is loaded; atomic_load / atomic_store
+    std::shared_ptr<const AddressMatcher> m_addressMatcher; // Accessed with std::atomic_load / std::atomic_store
+    std::shared_ptr<const Blocklist> m_blocklists[3]; // Indexed by BlocklistType; atomic_load / atomic_store
+    
+    FraudAlertStore m_alertStore;
 };
 
 #endif 
\ No newline at end of file
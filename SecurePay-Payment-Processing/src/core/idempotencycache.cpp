@@ -0,0 +1,102 @@
+#include "idempotencycache.h"
+#include <algorithm>
+#include <functional>
+
+IdempotencyCache::IdempotencyCache(std::size_t capacity,
+                                   std::chrono::seconds timeToLive,
+                                   std::size_t shardCount)
+    : m_timeToLive(timeToLive) {
+    shardCount = std::max<std::size_t>(1, shardCount);
+    m_capacityPerShard = std::max<std::size_t>(1, (capacity + shardCount - 1) / shardCount);
+
+    m_shards.reserve(shardCount);
+    for (std::size_t i = 0; i < shardCount; ++i) {
+        m_shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+IdempotencyClaim IdempotencyCache::claim(const std::string& key,
+                                         const std::string& transactionId,
+                                         std::shared_ptr<std::promise<PaymentResult>> waiter) {
+    Shard& shard = shardFor(key);
+    Clock::time_point now = Clock::now();
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end() && it->second.expiresAt > now) {
+        Entry& entry = it->second;
+        if (!entry.completed && waiter) {
+            entry.waiters.push_back(std::move(waiter));
+        }
+        return IdempotencyClaim{false, entry.transactionId, entry.completed, entry.result};
+    }
+
+    if (it != shard.entries.end()) {
+        // Expired but not yet trimmed; forget it and treat the key as new
+        shard.order.erase(it->second.position);
+        shard.entries.erase(it);
+    }
+
+    evictLocked(shard, now);
+
+    shard.order.push_front(key);
+    Entry entry{
+        transactionId,
+        false,
+        PaymentResult{transactionId, TransactionStatus::PENDING, FraudRiskLevel::LOW},
+        now + m_timeToLive,
+        {},
+        shard.order.begin()
+    };
+    shard.entries.emplace(key, std::move(entry));
+
+    return IdempotencyClaim{true, transactionId, false, PaymentResult{transactionId, TransactionStatus::PENDING, FraudRiskLevel::LOW}};
+}
+
+void IdempotencyCache::complete(const std::string& key, const PaymentResult& result) {
+    std::vector<std::shared_ptr<std::promise<PaymentResult>>> waiters;
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return;
+        }
+
+        it->second.completed = true;
+        it->second.result = result;
+        waiters.swap(it->second.waiters);
+    }
+
+    for (auto& waiter : waiters) {
+        waiter->set_value(result);
+    }
+}
+
+std::size_t IdempotencyCache::size() const {
+    std::size_t total = 0;
+    for (const auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->entries.size();
+    }
+    return total;
+}
+
+IdempotencyCache::Shard& IdempotencyCache::shardFor(const std::string& key) const {
+    return *m_shards[std::hash<std::string>{}(key) % m_shards.size()];
+}
+
+void IdempotencyCache::evictLocked(Shard& shard, Clock::time_point now) {
+    while (!shard.order.empty()) {
+        auto oldest = shard.entries.find(shard.order.back());
+        bool expired = oldest->second.expiresAt <= now;
+        if (!expired && shard.entries.size() < m_capacityPerShard) {
+            break;
+        }
+
+        shard.entries.erase(oldest);
+        shard.order.pop_back();
+    }
+}
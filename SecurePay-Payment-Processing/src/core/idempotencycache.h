@@ -0,0 +1,113 @@
+#ifndef IDEMPOTENCYCACHE_H
+#define IDEMPOTENCYCACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paymentgateway.h"
+
+/**
+ * @struct IdempotencyClaim
+ * @brief Outcome of claiming an idempotency key
+ */
+struct IdempotencyClaim {
+    bool claimed;              ///< True if the caller now owns the key and should process the payment
+    std::string transactionId; ///< Transaction ID recorded under the key
+    bool completed;            ///< True if the original payment has finished
+    PaymentResult result;      ///< Final result of the original payment, valid when completed
+};
+
+/**
+ * @class IdempotencyCache
+ * @brief Bounded, time-expiring map from client idempotency key to payment outcome
+ *
+ * Keys are spread over independently locked shards. Each shard keeps its
+ * entries in insertion order; with a fixed time-to-live that is also expiry
+ * order, so expired entries and, when a shard is full, the oldest entries
+ * are dropped from the tail in constant time. Waiters on an entry evicted
+ * before its payment completes see a broken promise.
+ */
+class IdempotencyCache {
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Maximum number of keys held across all shards
+     * @param timeToLive How long a key is remembered after it is first claimed
+     * @param shardCount Number of independently locked shards
+     */
+    explicit IdempotencyCache(std::size_t capacity = 100000,
+                              std::chrono::seconds timeToLive = std::chrono::hours(24),
+                              std::size_t shardCount = 16);
+
+    /**
+     * @brief Claim a key for a new transaction, or find the payment already made under it
+     *
+     * If the key is live and its payment is still in flight, a non-null waiter
+     * is fulfilled with the original result when complete() is called for it.
+     *
+     * @param key The client-supplied idempotency key
+     * @param transactionId ID of the transaction the caller is about to process
+     * @param waiter Optional promise to fulfil once an in-flight original completes
+     * @return The claim outcome
+     */
+    IdempotencyClaim claim(const std::string& key,
+                           const std::string& transactionId,
+                           std::shared_ptr<std::promise<PaymentResult>> waiter = nullptr);
+
+    /**
+     * @brief Record the final result for a claimed key and release any waiters
+     * @param key The idempotency key
+     * @param result The final payment result
+     */
+    void complete(const std::string& key, const PaymentResult& result);
+
+    /**
+     * @brief Get the number of live keys
+     * @return The number of keys currently held
+     */
+    std::size_t size() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string transactionId;
+        bool completed;
+        PaymentResult result;
+        Clock::time_point expiresAt;
+        std::vector<std::shared_ptr<std::promise<PaymentResult>>> waiters;
+        std::list<std::string>::iterator position;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+        std::list<std::string> order; ///< Newest at the front
+    };
+
+    /**
+     * @brief Select the shard responsible for a key
+     * @param key The idempotency key
+     * @return Reference to the shard
+     */
+    Shard& shardFor(const std::string& key) const;
+
+    /**
+     * @brief Drop expired entries, then the oldest ones while the shard is full; caller holds the shard lock
+     * @param shard The shard to trim
+     * @param now The current time
+     */
+    void evictLocked(Shard& shard, Clock::time_point now);
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::size_t m_capacityPerShard;
+    std::chrono::seconds m_timeToLive;
+};
+
+#endif // IDEMPOTENCYCACHE_H
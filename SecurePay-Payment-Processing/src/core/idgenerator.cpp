@@ -0,0 +1,26 @@
+#include "idgenerator.h"
+#include <random>
+#include <sstream>
+
+std::string IdGenerator::generate(const std::string& prefix) {
+    thread_local std::mt19937_64 gen = [] {
+        std::random_device rd;
+        std::seed_seq seed{rd(), rd(), rd(), rd()};
+        return std::mt19937_64(seed);
+    }();
+    std::uniform_int_distribution<> dis(0, 15);
+    
+    const char* hex_chars = "0123456789ABCDEF";
+    
+    std::stringstream ss;
+    ss << prefix << "-";
+    for (int i = 0; i < 8; ++i) {
+        ss << hex_chars[dis(gen)];
+    }
+    ss << "-";
+    for (int i = 0; i < 4; ++i) {
+        ss << hex_chars[dis(gen)];
+    }
+    
+    return ss.str();
+}
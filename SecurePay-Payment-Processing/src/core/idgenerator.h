@@ -0,0 +1,24 @@
+#ifndef IDGENERATOR_H
+#define IDGENERATOR_H
+
+#include <string>
+
+/**
+ * @class IdGenerator
+ * @brief Random identifiers for transactions, refunds and fraud alerts
+ *
+ * Each thread draws from its own mt19937_64, seeded once with more than
+ * 32 bits. Reseeding from a single random_device value on every call
+ * repeated IDs at settlement volumes.
+ */
+class IdGenerator {
+public:
+    /**
+     * @brief Generate an ID of the form PREFIX-XXXXXXXX-XXXX with hex digits
+     * @param prefix The ID prefix, e.g. "TX"
+     * @return The new ID
+     */
+    static std::string generate(const std::string& prefix);
+};
+
+#endif // IDGENERATOR_H
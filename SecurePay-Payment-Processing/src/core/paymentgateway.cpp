@@ -1,24 +1,218 @@
 #include "paymentgateway.h"
 #include <iostream>
 #include <algorithm>
+#include <condition_variable>
 
-PaymentGateway::PaymentGateway() {
+PaymentGateway::PaymentGateway() : m_inFlight(0) {
     std::cout << "PaymentGateway initialized" << std::endl;
 }
 
 void PaymentGateway::processTransaction(std::unique_ptr<Transaction> transaction) {
     std::cout << "Processing transaction " << transaction->getTransactionId() << std::endl;
     
-    encryptTransactionData(*transaction);
+    CardValidationResult validation = transaction->getPaymentMethod().validate();
+    if (validation == CardValidationResult::VALID) {
+        validation = validateIssuer(transaction->getPaymentMethod(), *BinManager::getInstance().getTable());
+    }
+    if (validation != CardValidationResult::VALID) {
+        declineTransaction(std::move(transaction), validation);
+        return;
+    }
     
-    FraudSystem& fraudSystem = FraudSystem::getInstance();
-    FraudRiskLevel riskLevel = fraudSystem.evaluateTransaction(*transaction);
+    std::shared_ptr<AdmissionSlot> slot = admitTransaction(transaction, nullptr);
+    if (!slot) {
+        return;
+    }
+    
+    FraudAssessment assessment = screenTransaction(*transaction);
+    
+    Bank& bank = Bank::getInstance();
+    AuthorizationResult authResult = bank.authorizeTransaction(*transaction, assessment.level);
+    
+    completeTransaction(std::move(transaction), authResult, assessment.score);
+}
+
+void PaymentGateway::processTransactionAsync(std::unique_ptr<Transaction> transaction,
+                                             TransactionCompletionCallback onComplete) {
+    std::cout << "Processing transaction " << transaction->getTransactionId() << " asynchronously" << std::endl;
+    
+    CardValidationResult validation = transaction->getPaymentMethod().validate();
+    if (validation == CardValidationResult::VALID) {
+        validation = validateIssuer(transaction->getPaymentMethod(), *BinManager::getInstance().getTable());
+    }
+    if (validation != CardValidationResult::VALID) {
+        Transaction* declined = transaction.get();
+        declineTransaction(std::move(transaction), validation);
+        if (onComplete) {
+            onComplete(*declined, FraudRiskLevel::LOW);
+        }
+        return;
+    }
+    
+    authorizeTransactionAsync(std::move(transaction), std::move(onComplete));
+}
+
+std::vector<PaymentResult> PaymentGateway::processTransactionBatch(std::vector<std::unique_ptr<Transaction>> transactions) {
+    std::cout << "Processing batch of " << transactions.size() << " transactions" << std::endl;
+    
+    // Card numbers are checked together; non-card methods are left VALID here
+    std::vector<std::string> cardNumbers;
+    std::vector<std::size_t> cardPositions;
+    for (std::size_t i = 0; i < transactions.size(); ++i) {
+        std::string cardNumber = transactions[i]->getPaymentMethod().getCardNumber();
+        if (!cardNumber.empty()) {
+            cardNumbers.push_back(std::move(cardNumber));
+            cardPositions.push_back(i);
+        }
+    }
+    
+    std::vector<CardValidationResult> validations(transactions.size(), CardValidationResult::VALID);
+    std::vector<CardValidationResult> numberResults = CardValidator::validateNumbers(cardNumbers);
+    for (std::size_t i = 0; i < numberResults.size(); ++i) {
+        validations[cardPositions[i]] = numberResults[i];
+    }
+    std::shared_ptr<const BinTable> binTable = BinManager::getInstance().getTable();
+    
+    std::vector<PaymentResult> results(transactions.size());
+    std::mutex resultsMutex;
+    std::condition_variable allDone;
+    std::size_t outstanding = 0;
+    
+    auto completion = [&results, &resultsMutex, &allDone, &outstanding](std::size_t i) {
+        return [&results, &resultsMutex, &allDone, &outstanding, i](const Transaction& completed, FraudRiskLevel riskLevel) {
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            results[i] = PaymentResult{completed.getTransactionId(), completed.getStatus(), riskLevel};
+            if (--outstanding == 0) {
+                allDone.notify_all();
+            }
+        };
+    };
+    
+    // Admitted transactions are screened together, so the fraud rules and model run over a column-wise batch
+    std::vector<std::size_t> admitted;
+    std::vector<std::shared_ptr<AdmissionSlot>> slots;
+    std::vector<const Transaction*> screening;
+    
+    for (std::size_t i = 0; i < transactions.size(); ++i) {
+        std::unique_ptr<Transaction>& transaction = transactions[i];
+        results[i] = PaymentResult{transaction->getTransactionId(), TransactionStatus::DECLINED, FraudRiskLevel::LOW};
+        
+        if (validations[i] == CardValidationResult::VALID) {
+            validations[i] = transaction->getPaymentMethod().validateDetails();
+        }
+        if (validations[i] == CardValidationResult::VALID) {
+            validations[i] = validateIssuer(transaction->getPaymentMethod(), *binTable);
+        }
+        if (validations[i] != CardValidationResult::VALID) {
+            declineTransaction(std::move(transaction), validations[i]);
+            continue;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            ++outstanding;
+        }
+        std::shared_ptr<AdmissionSlot> slot = admitTransaction(transaction, completion(i));
+        if (!slot) {
+            continue;
+        }
+        
+        encryptTransactionData(*transaction);
+        admitted.push_back(i);
+        slots.push_back(std::move(slot));
+        screening.push_back(transaction.get());
+    }
+    
+    std::vector<FraudAssessment> assessments = FraudSystem::getInstance().screenBatch(screening);
+    for (std::size_t k = 0; k < admitted.size(); ++k) {
+        std::cout << "Fraud risk level: " << FraudSystem::riskLevelToString(assessments[k].level) << std::endl;
+        sendToBank(std::move(transactions[admitted[k]]), assessments[k], std::move(slots[k]), completion(admitted[k]));
+    }
+    
+    std::unique_lock<std::mutex> lock(resultsMutex);
+    allDone.wait(lock, [&outstanding] { return outstanding == 0; });
+    
+    return results;
+}
+
+void PaymentGateway::authorizeTransactionAsync(std::unique_ptr<Transaction> transaction,
+                                               TransactionCompletionCallback onComplete) {
+    std::shared_ptr<AdmissionSlot> slot = admitTransaction(transaction, onComplete);
+    if (!slot) {
+        return;
+    }
     
-    std::cout << "Fraud risk level: " << FraudSystem::riskLevelToString(riskLevel) << std::endl;
+    FraudAssessment assessment = screenTransaction(*transaction);
+    sendToBank(std::move(transaction), assessment, std::move(slot), std::move(onComplete));
+}
+
+std::shared_ptr<AdmissionSlot> PaymentGateway::admitTransaction(std::unique_ptr<Transaction>& transaction,
+                                                                const TransactionCompletionCallback& onComplete) {
+    // A double submit or client retry is caught here, before it uses admission capacity or reaches the bank
+    if (m_duplicateDetector.checkAndRecord(*transaction)) {
+        Transaction* rejected = transaction.get();
+        rejectTransaction(std::move(transaction), "Duplicate charge");
+        if (onComplete) {
+            onComplete(*rejected, FraudRiskLevel::LOW);
+        }
+        return nullptr;
+    }
+    
+    AdmissionDecision decision = m_admissionController.tryAdmit(transaction->getMerchant().getName());
+    if (decision != AdmissionDecision::ADMITTED) {
+        // Never charged, so a retry once capacity frees up is not a duplicate
+        m_duplicateDetector.forget(*transaction);
+        Transaction* rejected = transaction.get();
+        rejectTransaction(std::move(transaction), decision);
+        if (onComplete) {
+            onComplete(*rejected, FraudRiskLevel::LOW);
+        }
+        return nullptr;
+    }
+    
+    // Shared with the bank callback, which releases it; if the callback is dropped without
+    // running, e.g. because screening or the bank call threw, the last owner releases it
+    return std::make_shared<AdmissionSlot>(m_admissionController);
+}
+
+void PaymentGateway::sendToBank(std::unique_ptr<Transaction> transaction, const FraudAssessment& assessment,
+                                std::shared_ptr<AdmissionSlot> slot, TransactionCompletionCallback onComplete) {
+    FraudRiskLevel riskLevel = assessment.level;
+    double riskScore = assessment.score;
+    
+    // std::function needs a copyable target, so the in-flight transaction is parked in a shared holder
+    auto pending = std::make_shared<std::unique_ptr<Transaction>>(std::move(transaction));
+    const Transaction& pendingTransaction = **pending;
+    ++m_inFlight;
     
     Bank& bank = Bank::getInstance();
-    AuthorizationResult authResult = bank.authorizeTransaction(*transaction, riskLevel);
+    bank.authorizeTransactionAsync(pendingTransaction, riskLevel,
+        [this, pending, slot, riskLevel, riskScore, onComplete](AuthorizationResult authResult) {
+            Transaction* completed = pending->get();
+            completeTransaction(std::move(*pending), authResult, riskScore);
+            --m_inFlight;
+            slot->release();
+            
+            if (onComplete) {
+                onComplete(*completed, riskLevel);
+            }
+        });
+}
+
+FraudAssessment PaymentGateway::screenTransaction(const Transaction& transaction) {
+    encryptTransactionData(transaction);
+    
+    FraudSystem& fraudSystem = FraudSystem::getInstance();
+    FraudAssessment assessment = fraudSystem.screenTransaction(transaction);
+    
+    std::cout << "Fraud risk level: " << FraudSystem::riskLevelToString(assessment.level) << std::endl;
     
+    return assessment;
+}
+
+void PaymentGateway::completeTransaction(std::unique_ptr<Transaction> transaction,
+                                         AuthorizationResult authResult,
+                                         double riskScore) {
     std::cout << "Authorization result: " << Bank::resultToString(authResult) << std::endl;
     
     switch (authResult) {
@@ -27,38 +221,255 @@ void PaymentGateway::processTransaction(std::unique_ptr<Transaction> transaction
             break;
         case AuthorizationResult::DECLINED:
             transaction->setState(std::make_unique<DeclinedState>());
+            m_duplicateDetector.forget(*transaction);
             break;
         case AuthorizationResult::REVIEW_REQUIRED:
             transaction->setState(std::make_unique<FlaggedState>());
             break;
     }
     
-    notifyObservers(*transaction);
+    // Queued only once recorded, so a reviewer can never settle a transaction the gateway has not published
+    Transaction* recorded = transaction.get();
+    recordTransaction(std::move(transaction));
+    if (authResult == AuthorizationResult::REVIEW_REQUIRED) {
+        m_reviewQueue.enqueue(recorded, riskScore);
+    }
+}
+
+CardValidationResult PaymentGateway::validateIssuer(const PaymentMethod& paymentMethod, const BinTable& binTable) {
+    std::string bin = paymentMethod.getBin();
+    if (bin.empty() || binTable.empty()) {
+        return CardValidationResult::VALID;
+    }
     
-    m_transactions.push_back(std::move(transaction));
+    return binTable.lookup(bin) ? CardValidationResult::VALID : CardValidationResult::UNKNOWN_BIN;
 }
 
-const std::vector<std::unique_ptr<Transaction>>& PaymentGateway::getTransactions() const {
-    return m_transactions;
+void PaymentGateway::declineTransaction(std::unique_ptr<Transaction> transaction, CardValidationResult validation) {
+    std::cout << "Transaction " << transaction->getTransactionId() << " declined: "
+              << CardValidator::resultToString(validation) << std::endl;
+    
+    transaction->setState(std::make_unique<DeclinedState>());
+    recordTransaction(std::move(transaction));
 }
 
-void PaymentGateway::addObserver(TransactionObserver* observer) {
-    if (observer) {
-        m_observers.push_back(observer);
+void PaymentGateway::rejectTransaction(std::unique_ptr<Transaction> transaction, AdmissionDecision decision) {
+    rejectTransaction(std::move(transaction), AdmissionController::decisionToString(decision));
+}
+
+void PaymentGateway::rejectTransaction(std::unique_ptr<Transaction> transaction, const std::string& reason) {
+    std::cout << "Transaction " << transaction->getTransactionId() << " rejected: " << reason << std::endl;
+    
+    transaction->setState(std::make_unique<RejectedState>(reason));
+    recordTransaction(std::move(transaction));
+}
+
+void PaymentGateway::recordTransaction(std::unique_ptr<Transaction> transaction) {
+    // Record before publishing so observers can look the transaction up
+    Transaction& recorded = *transaction;
+    {
+        std::lock_guard<std::mutex> lock(m_transactionsMutex);
+        indexTransaction(transaction.get());
+        m_transactions.push_back(std::move(transaction));
     }
+    
+    notifyObservers(recorded);
 }
 
-void PaymentGateway::removeObserver(TransactionObserver* observer) {
-    auto it = std::find(m_observers.begin(), m_observers.end(), observer);
-    if (it != m_observers.end()) {
-        m_observers.erase(it);
+void PaymentGateway::indexTransaction(Transaction* transaction) {
+    // An ID clash must not silently repoint lookups, ledger holds or reviews at another transaction
+    if (!m_transactionIndex.emplace(transaction->getTransactionId(), transaction).second) {
+        std::cerr << "Transaction ID " << transaction->getTransactionId()
+                  << " is already recorded; the ID keeps referring to the first" << std::endl;
     }
+    insertPosting(m_customerIndex[transaction->getCustomer().getName()], transaction);
+    insertPosting(m_merchantIndex[transaction->getMerchant().getName()], transaction);
 }
 
-void PaymentGateway::notifyObservers(const Transaction& transaction) {
-    for (auto observer : m_observers) {
-        observer->onTransactionUpdated(transaction);
+void PaymentGateway::insertPosting(std::vector<TransactionPosting>& postings, Transaction* transaction) {
+    TransactionPosting posting{transaction->getCreatedAt(), transaction};
+    
+    // Transactions normally complete in creation order, so this is an append;
+    // an async completion that overtakes an older one is slotted in place
+    if (postings.empty() || postings.back().createdAt <= posting.createdAt) {
+        postings.push_back(posting);
+        return;
     }
+    
+    auto it = std::upper_bound(postings.begin(), postings.end(), posting.createdAt,
+        [](std::chrono::system_clock::time_point time, const TransactionPosting& entry) {
+            return time < entry.createdAt;
+        });
+    postings.insert(it, posting);
+}
+
+std::vector<Transaction*> PaymentGateway::getTransactions() {
+    std::lock_guard<std::mutex> lock(m_transactionsMutex);
+    std::vector<Transaction*> result;
+    result.reserve(m_transactions.size());
+    for (const auto& transaction : m_transactions) {
+        result.push_back(transaction.get());
+    }
+    return result;
+}
+
+std::vector<const Transaction*> PaymentGateway::getTransactions() const {
+    std::lock_guard<std::mutex> lock(m_transactionsMutex);
+    std::vector<const Transaction*> result;
+    result.reserve(m_transactions.size());
+    for (const auto& transaction : m_transactions) {
+        result.push_back(transaction.get());
+    }
+    return result;
+}
+
+Transaction* PaymentGateway::findTransaction(const std::string& transactionId) {
+    std::lock_guard<std::mutex> lock(m_transactionsMutex);
+    auto it = m_transactionIndex.find(transactionId);
+    return it != m_transactionIndex.end() ? it->second : nullptr;
+}
+
+const Transaction* PaymentGateway::findTransaction(const std::string& transactionId) const {
+    std::lock_guard<std::mutex> lock(m_transactionsMutex);
+    auto it = m_transactionIndex.find(transactionId);
+    return it != m_transactionIndex.end() ? it->second : nullptr;
+}
+
+std::vector<const Transaction*> PaymentGateway::getTransactionsForCustomer(const std::string& customerName) const {
+    std::lock_guard<std::mutex> lock(m_transactionsMutex);
+    return collectPostings(m_customerIndex, customerName);
+}
+
+std::vector<const Transaction*> PaymentGateway::getTransactionsForMerchant(const std::string& merchantName) const {
+    std::lock_guard<std::mutex> lock(m_transactionsMutex);
+    return collectPostings(m_merchantIndex, merchantName);
+}
+
+std::vector<const Transaction*> PaymentGateway::getTransactionsForCustomer(
+    const std::string& customerName,
+    std::chrono::system_clock::time_point from,
+    std::chrono::system_clock::time_point to) const {
+    std::lock_guard<std::mutex> lock(m_transactionsMutex);
+    return collectPostings(m_customerIndex, customerName, from, to);
+}
+
+std::vector<const Transaction*> PaymentGateway::getTransactionsForMerchant(
+    const std::string& merchantName,
+    std::chrono::system_clock::time_point from,
+    std::chrono::system_clock::time_point to) const {
+    std::lock_guard<std::mutex> lock(m_transactionsMutex);
+    return collectPostings(m_merchantIndex, merchantName, from, to);
+}
+
+std::vector<const Transaction*> PaymentGateway::collectPostings(
+    const std::unordered_map<std::string, std::vector<TransactionPosting>>& index,
+    const std::string& key) {
+    std::vector<const Transaction*> result;
+    
+    auto it = index.find(key);
+    if (it != index.end()) {
+        result.reserve(it->second.size());
+        for (const auto& posting : it->second) {
+            result.push_back(posting.transaction);
+        }
+    }
+    
+    return result;
+}
+
+std::vector<const Transaction*> PaymentGateway::collectPostings(
+    const std::unordered_map<std::string, std::vector<TransactionPosting>>& index,
+    const std::string& key,
+    std::chrono::system_clock::time_point from,
+    std::chrono::system_clock::time_point to) {
+    std::vector<const Transaction*> result;
+    
+    auto it = index.find(key);
+    if (it == index.end() || from > to) {
+        return result;
+    }
+    
+    const auto& postings = it->second;
+    auto first = std::lower_bound(postings.begin(), postings.end(), from,
+        [](const TransactionPosting& entry, std::chrono::system_clock::time_point time) {
+            return entry.createdAt < time;
+        });
+    auto last = std::upper_bound(first, postings.end(), to,
+        [](std::chrono::system_clock::time_point time, const TransactionPosting& entry) {
+            return time < entry.createdAt;
+        });
+    
+    result.reserve(static_cast<std::size_t>(std::distance(first, last)));
+    for (auto posting = first; posting != last; ++posting) {
+        result.push_back(posting->transaction);
+    }
+    
+    return result;
+}
+
+std::size_t PaymentGateway::getInFlightCount() const {
+    return m_inFlight.load();
+}
+
+AdmissionController& PaymentGateway::getAdmissionController() {
+    return m_admissionController;
+}
+
+DuplicateDetector& PaymentGateway::getDuplicateDetector() {
+    return m_duplicateDetector;
+}
+
+FraudReviewQueue& PaymentGateway::getReviewQueue() {
+    return m_reviewQueue;
+}
+
+bool PaymentGateway::approveReview(const std::string& transactionId, const std::string& reviewer) {
+    return resolveReview(transactionId, reviewer, true);
+}
+
+bool PaymentGateway::declineReview(const std::string& transactionId, const std::string& reviewer) {
+    return resolveReview(transactionId, reviewer, false);
+}
+
+bool PaymentGateway::resolveReview(const std::string& transactionId, const std::string& reviewer, bool approve) {
+    Transaction* transaction = m_reviewQueue.resolve(transactionId, reviewer);
+    if (!transaction) {
+        std::cerr << "Review of " << transactionId << " is not claimed by " << reviewer << std::endl;
+        return false;
+    }
+    
+    std::cout << "Transaction " << transactionId << (approve ? " approved" : " declined")
+              << " on review by " << reviewer << std::endl;
+    
+    // The bank's hold has waited for this decision
+    Bank& bank = Bank::getInstance();
+    if (approve) {
+        bank.captureAuthorization(*transaction);
+        transaction->setState(std::make_unique<ApprovedState>());
+    } else {
+        bank.releaseAuthorization(*transaction);
+        transaction->setState(std::make_unique<DeclinedState>());
+        // Nothing was charged, so the customer may try the same payment again
+        m_duplicateDetector.forget(*transaction);
+    }
+    notifyObservers(*transaction);
+    return true;
+}
+
+void PaymentGateway::addObserver(TransactionObserver* observer) {
+    m_eventBus.subscribe(observer);
+}
+
+void PaymentGateway::removeObserver(TransactionObserver* observer) {
+    m_eventBus.unsubscribe(observer);
+}
+
+void PaymentGateway::flushNotifications() {
+    m_eventBus.flush();
+}
+
+void PaymentGateway::notifyObservers(const Transaction& transaction) {
+    m_eventBus.publish(transaction);
 }
 
 void PaymentGateway::encryptTransactionData(const Transaction& transaction) {
@@ -4,17 +4,36 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <unordered_map>
 #include "transaction.h"
 #include "fraudsystem.h"
 #include "bank.h"
+#include "transactioneventbus.h"
+#include "admissioncontroller.h"
+#include "duplicatedetector.h"
+#include "fraudreviewqueue.h"
+#include "bintable.h"
 
-// Observer interface for transaction updates (Observer pattern)
-class TransactionObserver {
-public:
-    virtual ~TransactionObserver() = default;
-    virtual void onTransactionUpdated(const Transaction& transaction) = 0;
+// Entry in a per-customer or per-merchant posting list, kept sorted by creation time
+struct TransactionPosting {
+    std::chrono::system_clock::time_point createdAt;
+    Transaction* transaction;
+};
+
+// Final outcome of a processed payment
+struct PaymentResult {
+    std::string transactionId;
+    TransactionStatus status;
+    FraudRiskLevel riskLevel;
 };
 
+// Callback invoked once an asynchronously processed transaction reaches its final state
+using TransactionCompletionCallback = std::function<void(const Transaction&, FraudRiskLevel)>;
+
 // Class for processing payments
 class PaymentGateway {
 public:
@@ -23,8 +42,58 @@ public:
     
     void processTransaction(std::unique_ptr<Transaction> transaction);
     
+    // Screens the transaction, then hands it to the bank without blocking on the answer.
+    // The gateway keeps ownership while the authorization is outstanding.
+    void processTransactionAsync(std::unique_ptr<Transaction> transaction,
+                                 TransactionCompletionCallback onComplete);
+    
+    // Validates every card number in one pass and declines the malformed ones, screens the admitted rest
+    // for fraud as one batch and authorizes them concurrently. Blocks until all have completed; results
+    // are in input order.
+    std::vector<PaymentResult> processTransactionBatch(std::vector<std::unique_ptr<Transaction>> transactions);
+    
 
-    const std::vector<std::unique_ptr<Transaction>>& getTransactions() const;
+    // Snapshot of every recorded transaction, oldest first, taken under the gateway lock so it is
+    // safe to iterate while async completions are still being recorded
+    std::vector<Transaction*> getTransactions();
+    std::vector<const Transaction*> getTransactions() const;
+    
+    // O(1) lookup by transaction ID; nullptr if the gateway has not recorded it
+    Transaction* findTransaction(const std::string& transactionId);
+    const Transaction* findTransaction(const std::string& transactionId) const;
+    
+    // Secondary index lookups keyed by customer / merchant name, oldest first
+    std::vector<const Transaction*> getTransactionsForCustomer(const std::string& customerName) const;
+    std::vector<const Transaction*> getTransactionsForMerchant(const std::string& merchantName) const;
+    
+    // Range queries over the posting lists; both bounds are inclusive
+    std::vector<const Transaction*> getTransactionsForCustomer(
+        const std::string& customerName,
+        std::chrono::system_clock::time_point from,
+        std::chrono::system_clock::time_point to) const;
+    std::vector<const Transaction*> getTransactionsForMerchant(
+        const std::string& merchantName,
+        std::chrono::system_clock::time_point from,
+        std::chrono::system_clock::time_point to) const;
+    
+    
+    std::size_t getInFlightCount() const;
+    
+    // Per-merchant and global rate limits; transactions over a limit are recorded as REJECTED without reaching the bank
+    AdmissionController& getAdmissionController();
+    
+    // Repeats of a recent charge (same customer, merchant, amount and card) are recorded as REJECTED
+    // before admission, screening and the bank; a zero window turns the check off. A charge that ends
+    // up rejected by admission or declined by the bank is forgotten, so it can be retried at once
+    DuplicateDetector& getDuplicateDetector();
+    
+    // Transactions the bank sent for review wait here, riskiest first, for a reviewer to claim
+    FraudReviewQueue& getReviewQueue();
+    
+    // Settle a review the reviewer has claimed: the bank's hold is captured or released, the transaction
+    // becomes APPROVED or DECLINED and observers are notified. False if the reviewer does not hold the claim.
+    bool approveReview(const std::string& transactionId, const std::string& reviewer);
+    bool declineReview(const std::string& transactionId, const std::string& reviewer);
     
    
     void addObserver(TransactionObserver* observer);
@@ -32,18 +101,96 @@ public:
     
     void removeObserver(TransactionObserver* observer);
     
+    // Blocks until observers have seen every update published so far
+    void flushNotifications();
+    
 private:
   
     std::vector<std::unique_ptr<Transaction>> m_transactions;
     
-   
-    std::vector<TransactionObserver*> m_observers;
+    // Transaction ID -> owned transaction, maintained alongside m_transactions
+    std::unordered_map<std::string, Transaction*> m_transactionIndex;
+    
+    // Customer / merchant name -> time-ordered postings, maintained on insert
+    std::unordered_map<std::string, std::vector<TransactionPosting>> m_customerIndex;
+    std::unordered_map<std::string, std::vector<TransactionPosting>> m_merchantIndex;
+    
+    // Guards m_transactions and its indexes; completions may arrive on a bank callback thread
+    mutable std::mutex m_transactionsMutex;
+    
+    std::atomic<std::size_t> m_inFlight;
+    
+    AdmissionController m_admissionController;
+    
+    DuplicateDetector m_duplicateDetector;
+    
+    FraudReviewQueue m_reviewQueue;
+    
+    // Observer notifications run on the bus thread, off the authorization path.
+    // Declared after the transaction storage so it is stopped before the transactions it references go away.
+    TransactionEventBus m_eventBus;
     
    
     void notifyObservers(const Transaction& transaction);
     
     
     void encryptTransactionData(const Transaction& transaction);
+    
+    // Admission, screening and the bank call for a transaction whose payment details passed validation
+    void authorizeTransactionAsync(std::unique_ptr<Transaction> transaction,
+                                   TransactionCompletionCallback onComplete);
+    
+    // Duplicate and admission checks. On refusal the transaction is recorded as REJECTED, onComplete is
+    // called and nullptr returned, leaving transaction empty; otherwise returns the admission slot
+    std::shared_ptr<AdmissionSlot> admitTransaction(std::unique_ptr<Transaction>& transaction,
+                                                    const TransactionCompletionCallback& onComplete);
+    
+    // Hands a screened transaction to the bank without blocking; the slot is released once it completes
+    void sendToBank(std::unique_ptr<Transaction> transaction, const FraudAssessment& assessment,
+                    std::shared_ptr<AdmissionSlot> slot, TransactionCompletionCallback onComplete);
+    
+    // Without a BIN table every issuer is accepted; with one, a card must belong to a known range
+    static CardValidationResult validateIssuer(const PaymentMethod& paymentMethod, const BinTable& binTable);
+    
+    // Records a transaction with malformed payment details as declined and notifies observers
+    void declineTransaction(std::unique_ptr<Transaction> transaction, CardValidationResult validation);
+    
+    // Encryption and fraud evaluation, everything that runs before the bank call
+    FraudAssessment screenTransaction(const Transaction& transaction);
+    
+    // Applies the authorization result, records the transaction and notifies observers;
+    // transactions sent for review are queued by their fraud score
+    void completeTransaction(std::unique_ptr<Transaction> transaction,
+                             AuthorizationResult authResult,
+                             double riskScore);
+    
+    // Moves a claimed review to its final state and notifies observers
+    bool resolveReview(const std::string& transactionId, const std::string& reviewer, bool approve);
+    
+    // Records a transaction refused by admission control and notifies observers
+    void rejectTransaction(std::unique_ptr<Transaction> transaction, AdmissionDecision decision);
+    
+    // Records a transaction turned away before authorization for the given reason and notifies observers
+    void rejectTransaction(std::unique_ptr<Transaction> transaction, const std::string& reason);
+    
+    // Stores the transaction and its indexes, then publishes it to observers
+    void recordTransaction(std::unique_ptr<Transaction> transaction);
+    
+    // Adds the transaction to the ID and secondary indexes; caller holds m_transactionsMutex.
+    // A repeated ID is reported and left pointing at the transaction recorded first
+    void indexTransaction(Transaction* transaction);
+    
+    static void insertPosting(std::vector<TransactionPosting>& postings, Transaction* transaction);
+    
+    static std::vector<const Transaction*> collectPostings(
+        const std::unordered_map<std::string, std::vector<TransactionPosting>>& index,
+        const std::string& key);
+    
+    static std::vector<const Transaction*> collectPostings(
+        const std::unordered_map<std::string, std::vector<TransactionPosting>>& index,
+        const std::string& key,
+        std::chrono::system_clock::time_point from,
+        std::chrono::system_clock::time_point to);
 };
 
 #endif
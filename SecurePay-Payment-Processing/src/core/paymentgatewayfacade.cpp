@@ -12,10 +12,25 @@ std::string PaymentGatewayFacade::processPayment(
     const Merchant& merchant,
     const std::string& paymentMethodType,
     const std::vector<std::string>& paymentDetails,
-    double amount) {
+    double amount,
+    const std::string& idempotencyKey) {
+    
+    // Keyed payments share the async path so a retry racing the original waits for it
+    if (!idempotencyKey.empty()) {
+        std::future<PaymentResult> result = processPaymentAsync(
+            customer, merchant, paymentMethodType, paymentDetails, amount, idempotencyKey);
+        try {
+            return result.get().transactionId;
+        } catch (const std::future_error& error) {
+            // The cache evicted the key while the original payment was in flight
+            std::cerr << "Lost track of the payment under idempotency key " << idempotencyKey
+                      << ": " << error.what() << std::endl;
+            return "";
+        }
+    }
     
     // Create payment method
-    auto paymentMethod = createPaymentMethod(paymentMethodType, paymentDetails);
+    auto paymentMethod = PaymentMethodFactory::createPaymentMethod(paymentMethodType, paymentDetails);
     if (!paymentMethod) {
         std::cerr << "Failed to create payment method" << std::endl;
         return "";
@@ -34,71 +49,89 @@ std::string PaymentGatewayFacade::processPayment(
     return transactionId;
 }
 
-const Transaction* PaymentGatewayFacade::getTransaction(const std::string& transactionId) const {
-    for (const auto& transaction : m_paymentGateway.getTransactions()) {
-        if (transaction->getTransactionId() == transactionId) {
-            return transaction.get();
+std::future<PaymentResult> PaymentGatewayFacade::processPaymentAsync(
+    const Customer& customer,
+    const Merchant& merchant,
+    const std::string& paymentMethodType,
+    const std::vector<std::string>& paymentDetails,
+    double amount,
+    const std::string& idempotencyKey) {
+    
+    auto promise = std::make_shared<std::promise<PaymentResult>>();
+    std::future<PaymentResult> result = promise->get_future();
+    
+    // The key is claimed before anything is built, so a retry costs one cache lookup
+    std::string transactionId = Transaction::generateTransactionId();
+    if (!idempotencyKey.empty()) {
+        IdempotencyClaim claim = m_idempotencyCache.claim(idempotencyKey, transactionId, promise);
+        if (!claim.claimed) {
+            std::cout << "Idempotency key " << idempotencyKey << " already used by "
+                      << claim.transactionId << ", returning original result" << std::endl;
+            if (claim.completed) {
+                promise->set_value(claim.result);
+            }
+            return result;
         }
     }
     
-    return nullptr;
-}
-
-std::vector<const Transaction*> PaymentGatewayFacade::getAllTransactions() const {
-    std::vector<const Transaction*> result;
-    
-    for (const auto& transaction : m_paymentGateway.getTransactions()) {
-        result.push_back(transaction.get());
+    // Create payment method
+    auto paymentMethod = PaymentMethodFactory::createPaymentMethod(paymentMethodType, paymentDetails);
+    if (!paymentMethod) {
+        std::cerr << "Failed to create payment method" << std::endl;
+        PaymentResult failed{"", TransactionStatus::DECLINED, FraudRiskLevel::LOW};
+        if (!idempotencyKey.empty()) {
+            m_idempotencyCache.complete(idempotencyKey, failed);
+        }
+        promise->set_value(failed);
+        return result;
     }
     
+    // Create transaction
+    auto transaction = TransactionFactory::createTransaction(
+        customer, merchant, std::move(paymentMethod), amount, transactionId);
+    
+    // The promise is fulfilled from whichever thread delivers the bank's answer
+    m_paymentGateway.processTransactionAsync(std::move(transaction),
+        [this, promise, idempotencyKey](const Transaction& completed, FraudRiskLevel riskLevel) {
+            PaymentResult paymentResult{
+                completed.getTransactionId(), completed.getStatus(), riskLevel};
+            if (!idempotencyKey.empty()) {
+                m_idempotencyCache.complete(idempotencyKey, paymentResult);
+            }
+            promise->set_value(paymentResult);
+        });
+    
     return result;
 }
 
+const Transaction* PaymentGatewayFacade::getTransaction(const std::string& transactionId) const {
+    const PaymentGateway& paymentGateway = m_paymentGateway;
+    return paymentGateway.findTransaction(transactionId);
+}
+
+std::vector<const Transaction*> PaymentGatewayFacade::getAllTransactions() const {
+    const PaymentGateway& paymentGateway = m_paymentGateway;
+    return paymentGateway.getTransactions();
+}
+
 std::vector<const Transaction*> PaymentGatewayFacade::getTransactionsForCustomer(const std::string& customerId) const {
-    std::vector<const Transaction*> result;
-    
-    for (const auto& transaction : m_paymentGateway.getTransactions()) {
-        if (transaction->getCustomer().getName() == customerId) {
-            result.push_back(transaction.get());
-        }
-    }
-    
-    return result;
+    return m_paymentGateway.getTransactionsForCustomer(customerId);
 }
 
 std::vector<const Transaction*> PaymentGatewayFacade::getTransactionsForMerchant(const std::string& merchantId) const {
-    std::vector<const Transaction*> result;
-    
-    for (const auto& transaction : m_paymentGateway.getTransactions()) {
-        if (transaction->getMerchant().getName() == merchantId) {
-            result.push_back(transaction.get());
-        }
-    }
-    
-    return result;
+    return m_paymentGateway.getTransactionsForMerchant(merchantId);
 }
 
-std::unique_ptr<PaymentMethod> PaymentGatewayFacade::createPaymentMethod(
-    const std::string& type,
-    const std::vector<std::string>& details) const {
-    
-    if (type == "Credit Card") {
-        if (details.size() >= 4) {
-            return PaymentMethodFactory::createCreditCard(
-                details[0], details[1], details[2], details[3]);
-        }
-    } else if (type == "Debit Card") {
-        if (details.size() >= 4) {
-            return PaymentMethodFactory::createDebitCard(
-                details[0], details[1], details[2], details[3]);
-        }
-    } else if (type == "Digital Wallet") {
-        if (details.size() >= 2) {
-            return PaymentMethodFactory::createDigitalWallet(
-                details[0], details[1]);
-        }
-    }
-    
-    std::cerr << "Invalid payment method type or insufficient details" << std::endl;
-    return nullptr;
+std::vector<const Transaction*> PaymentGatewayFacade::getTransactionsForCustomer(
+    const std::string& customerId,
+    std::chrono::system_clock::time_point from,
+    std::chrono::system_clock::time_point to) const {
+    return m_paymentGateway.getTransactionsForCustomer(customerId, from, to);
+}
+
+std::vector<const Transaction*> PaymentGatewayFacade::getTransactionsForMerchant(
+    const std::string& merchantId,
+    std::chrono::system_clock::time_point from,
+    std::chrono::system_clock::time_point to) const {
+    return m_paymentGateway.getTransactionsForMerchant(merchantId, from, to);
 }
@@ -4,7 +4,9 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <future>
 #include "paymentgateway.h"
+#include "idempotencycache.h"
 #include "bank.h"
 #include "fraudsystem.h"
 #include "transaction.h"
@@ -37,6 +39,8 @@ public:
      * @param paymentMethodType The type of payment method
      * @param paymentDetails Payment method details
      * @param amount The payment amount
+     * @param idempotencyKey Optional client key; a retry with the same key returns
+     *        the original transaction ID instead of charging again
      * @return The transaction ID if successful, empty string otherwise
      */
     std::string processPayment(
@@ -44,7 +48,32 @@ public:
         const Merchant& merchant,
         const std::string& paymentMethodType,
         const std::vector<std::string>& paymentDetails,
-        double amount);
+        double amount,
+        const std::string& idempotencyKey = "");
+    
+    /**
+     * @brief Process a payment without blocking on bank authorization
+     * 
+     * The transaction is screened on the calling thread and then handed to the
+     * bank; the returned future becomes ready once the authorization completes.
+     * 
+     * @param customer The customer making the payment
+     * @param merchant The merchant receiving the payment
+     * @param paymentMethodType The type of payment method
+     * @param paymentDetails Payment method details
+     * @param amount The payment amount
+     * @param idempotencyKey Optional client key; a retry with the same key resolves
+     *        to the original payment's result without fraud checks or bank authorization
+     * @return Future resolving to the final status and fraud risk level; the
+     *         transaction ID is empty if the payment method could not be created
+     */
+    std::future<PaymentResult> processPaymentAsync(
+        const Customer& customer,
+        const Merchant& merchant,
+        const std::string& paymentMethodType,
+        const std::vector<std::string>& paymentDetails,
+        double amount,
+        const std::string& idempotencyKey = "");
     
     /**
      * @brief Get a transaction by ID
@@ -73,20 +102,36 @@ public:
      */
     std::vector<const Transaction*> getTransactionsForMerchant(const std::string& merchantId) const;
     
+    /**
+     * @brief Get transactions for a customer created within a time range
+     * @param customerId The customer ID
+     * @param from Start of the range (inclusive)
+     * @param to End of the range (inclusive)
+     * @return Vector of transactions, oldest first
+     */
+    std::vector<const Transaction*> getTransactionsForCustomer(
+        const std::string& customerId,
+        std::chrono::system_clock::time_point from,
+        std::chrono::system_clock::time_point to) const;
+    
+    /**
+     * @brief Get transactions for a merchant created within a time range
+     * @param merchantId The merchant ID
+     * @param from Start of the range (inclusive)
+     * @param to End of the range (inclusive)
+     * @return Vector of transactions, oldest first
+     */
+    std::vector<const Transaction*> getTransactionsForMerchant(
+        const std::string& merchantId,
+        std::chrono::system_clock::time_point from,
+        std::chrono::system_clock::time_point to) const;
+    
 private:
     PaymentGateway& m_paymentGateway;
     Bank& m_bank;
     FraudSystem& m_fraudSystem;
+    IdempotencyCache m_idempotencyCache;
     
-    /**
-     * @brief Create a payment method from type and details
-     * @param type The payment method type
-     * @param details Payment method details
-     * @return Unique pointer to the payment method
-     */
-    std::unique_ptr<PaymentMethod> createPaymentMethod(
-        const std::string& type,
-        const std::vector<std::string>& details) const;
 };
 
 #endif // PAYMENTGATEWAYFACADE_H
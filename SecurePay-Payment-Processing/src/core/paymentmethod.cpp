@@ -1,5 +1,72 @@
 #include "paymentmethod.h"
 #include <iostream>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+// Leading digits of a card number, skipping spaces and dashes; eight, the granularity the
+// BIN table keys ranges at, so ranges narrower than a six-digit prefix resolve correctly
+std::string cardBin(const std::string& cardNumber) {
+    const std::size_t binLength = 8;
+    std::string bin;
+    for (char c : cardNumber) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            bin += c;
+            if (bin.length() == binLength) {
+                break;
+            }
+        }
+    }
+    return bin;
+}
+
+// 64-bit FNV-1a of the text as 16 hex digits; identifies an instrument without storing it
+std::string fingerprint(const std::string& text) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+// Card numbers are fingerprinted on their digits alone, so credit and debit use of one card match
+std::string cardFingerprint(const std::string& cardNumber) {
+    std::string digits = "card:";
+    for (char c : cardNumber) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            digits += c;
+        }
+    }
+    return fingerprint(digits);
+}
+}
+
+std::string PaymentMethod::getBin() const {
+    return "";
+}
+
+std::string PaymentMethod::getCardNumber() const {
+    return "";
+}
+
+std::string PaymentMethod::getWalletId() const {
+    return "";
+}
+
+std::string PaymentMethod::getFingerprint() const {
+    return fingerprint(getType() + ":" + getDetails());
+}
+
+CardValidationResult PaymentMethod::validate() const {
+    return validateDetails();
+}
+
+CardValidationResult PaymentMethod::validateDetails() const {
+    return CardValidationResult::VALID;
+}
 
 CreditCard::CreditCard(const std::string& cardNumber, const std::string& cardholderName, 
                        const std::string& expiryDate, const std::string& cvv)
@@ -21,6 +88,28 @@ std::string CreditCard::getDetails() const {
     return maskedNumber + " (" + m_cardholderName + ")";
 }
 
+std::string CreditCard::getBin() const {
+    return cardBin(m_cardNumber);
+}
+
+std::string CreditCard::getCardNumber() const {
+    return m_cardNumber;
+}
+
+std::string CreditCard::getFingerprint() const {
+    return cardFingerprint(m_cardNumber);
+}
+
+CardValidationResult CreditCard::validate() const {
+    CardValidationResult result = CardValidator::validateNumber(m_cardNumber);
+    return result == CardValidationResult::VALID ? validateDetails() : result;
+}
+
+CardValidationResult CreditCard::validateDetails() const {
+    CardValidationResult result = CardValidator::validateExpiry(m_expiryDate);
+    return result == CardValidationResult::VALID ? CardValidator::validateCvv(m_cvv) : result;
+}
+
 PaymentMethod* CreditCard::clone() const {
     return new CreditCard(m_cardNumber, m_cardholderName, m_expiryDate, m_cvv);
 }
@@ -45,6 +134,28 @@ std::string DebitCard::getDetails() const {
     return maskedNumber + " (" + m_cardholderName + ")";
 }
 
+std::string DebitCard::getBin() const {
+    return cardBin(m_cardNumber);
+}
+
+std::string DebitCard::getCardNumber() const {
+    return m_cardNumber;
+}
+
+std::string DebitCard::getFingerprint() const {
+    return cardFingerprint(m_cardNumber);
+}
+
+CardValidationResult DebitCard::validate() const {
+    CardValidationResult result = CardValidator::validateNumber(m_cardNumber);
+    return result == CardValidationResult::VALID ? validateDetails() : result;
+}
+
+CardValidationResult DebitCard::validateDetails() const {
+    CardValidationResult result = CardValidator::validateExpiry(m_expiryDate);
+    return result == CardValidationResult::VALID ? CardValidator::validateCvv(m_cvv) : result;
+}
+
 PaymentMethod* DebitCard::clone() const {
     return new DebitCard(m_cardNumber, m_cardholderName, m_expiryDate, m_cvv);
 }
@@ -66,6 +177,14 @@ std::string DigitalWallet::getDetails() const {
     return m_walletId + " (" + m_email + ")";
 }
 
+std::string DigitalWallet::getWalletId() const {
+    return m_walletId;
+}
+
+std::string DigitalWallet::getFingerprint() const {
+    return fingerprint("wallet:" + m_walletId);
+}
+
 PaymentMethod* DigitalWallet::clone() const {
     return new DigitalWallet(m_walletId, m_email);
 }
@@ -86,3 +205,21 @@ std::unique_ptr<PaymentMethod> PaymentMethodFactory::createDigitalWallet(
     const std::string& walletId, const std::string& email) {
     return std::make_unique<DigitalWallet>(walletId, email);
 }
+
+std::unique_ptr<PaymentMethod> PaymentMethodFactory::createPaymentMethod(
+    const std::string& type, const std::vector<std::string>& details) {
+    if (type == "Credit Card") {
+        if (details.size() >= 4) {
+            return createCreditCard(details[0], details[1], details[2], details[3]);
+        }
+    } else if (type == "Debit Card") {
+        if (details.size() >= 4) {
+            return createDebitCard(details[0], details[1], details[2], details[3]);
+        }
+    } else if (type == "Digital Wallet") {
+        if (details.size() >= 2) {
+            return createDigitalWallet(details[0], details[1]);
+        }
+    }
+    return nullptr;
+}
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include "cardvalidator.h"
 
 /**
  * @class PaymentMethod
@@ -34,6 +36,45 @@ public:
      */
     virtual std::string getDetails() const = 0;
     
+    /**
+     * @brief Get the bank identification number (leading card digits)
+     * @return The first eight digits of the card number, or an empty string if the method has no card
+     */
+    virtual std::string getBin() const;
+    
+    /**
+     * @brief Get the full card number, for validation
+     * @return The card number, or an empty string if the method has no card
+     */
+    virtual std::string getCardNumber() const;
+    
+    /**
+     * @brief Get the digital wallet ID, for blocklist checks
+     * @return The wallet ID, or an empty string if the method is not a wallet
+     */
+    virtual std::string getWalletId() const;
+    
+    /**
+     * @brief Get a stable key identifying the funding instrument, for velocity and blocklist checks
+     * @return An opaque hash; the same card gives the same fingerprint however its number is formatted
+     */
+    virtual std::string getFingerprint() const;
+    
+    /**
+     * @brief Check the payment details are well formed before any money moves
+     * @return VALID or the first check that failed
+     */
+    virtual CardValidationResult validate() const;
+    
+    /**
+     * @brief Check everything validate() does except the card number
+     *
+     * Lets batch callers check card numbers together with CardValidator::validateNumbers().
+     *
+     * @return VALID or the first check that failed
+     */
+    virtual CardValidationResult validateDetails() const;
+    
     /**
      * @brief Create a clone of this payment method
      * @return A unique pointer to the cloned payment method
@@ -54,6 +95,11 @@ public:
     bool process(double amount) const override;
     std::string getType() const override;
     std::string getDetails() const override;
+    std::string getBin() const override;
+    std::string getCardNumber() const override;
+    std::string getFingerprint() const override;
+    CardValidationResult validate() const override;
+    CardValidationResult validateDetails() const override;
     PaymentMethod* clone() const override;
     
 private:
@@ -76,6 +122,11 @@ public:
     bool process(double amount) const override;
     std::string getType() const override;
     std::string getDetails() const override;
+    std::string getBin() const override;
+    std::string getCardNumber() const override;
+    std::string getFingerprint() const override;
+    CardValidationResult validate() const override;
+    CardValidationResult validateDetails() const override;
     PaymentMethod* clone() const override;
     
 private:
@@ -97,6 +148,8 @@ public:
     bool process(double amount) const override;
     std::string getType() const override;
     std::string getDetails() const override;
+    std::string getWalletId() const override;
+    std::string getFingerprint() const override;
     PaymentMethod* clone() const override;
     
 private:
@@ -117,6 +170,12 @@ public:
         
     static std::unique_ptr<PaymentMethod> createDigitalWallet(
         const std::string& walletId, const std::string& email);
+    
+    // Builds a "Credit Card", "Debit Card" or "Digital Wallet" from its details in entry order
+    // (number, holder, expiry, CVV for cards; wallet ID, email for wallets). Returns nullptr for
+    // an unknown type or too few details.
+    static std::unique_ptr<PaymentMethod> createPaymentMethod(
+        const std::string& type, const std::vector<std::string>& details);
 };
 
 #endif
@@ -1,5 +1,5 @@
 #include "refund.h"
-#include <random>
+#include "idgenerator.h"
 #include <sstream>
 #include <iomanip>
 
@@ -34,24 +34,12 @@ std::string Refund::getTimestamp() const {
     return ss.str();
 }
 
+std::chrono::system_clock::time_point Refund::getCreatedAt() const {
+    return m_timestamp;
+}
+
 std::string Refund::generateRefundId() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 15);
-    
-    const char* hex_chars = "0123456789ABCDEF";
-    
-    std::stringstream ss;
-    ss << "RF-";
-    for (int i = 0; i < 8; ++i) {
-        ss << hex_chars[dis(gen)];
-    }
-    ss << "-";
-    for (int i = 0; i < 4; ++i) {
-        ss << hex_chars[dis(gen)];
-    }
-    
-    return ss.str();
+    return IdGenerator::generate("RF");
 }
 
 std::unique_ptr<Refund> RefundFactory::createRefund(
@@ -53,6 +53,12 @@ public:
      */
     std::string getTimestamp() const;
     
+    /**
+     * @brief Get the time the refund was created
+     * @return The creation time point, suitable for ordering and range queries
+     */
+    std::chrono::system_clock::time_point getCreatedAt() const;
+    
 private:
     std::string m_refundId;
     const Transaction& m_transaction;
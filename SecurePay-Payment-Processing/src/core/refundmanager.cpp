@@ -67,8 +67,10 @@ bool RefundManager::processRefundCommand(std::unique_ptr<RefundCommand> command)
                       << " amount: " << refund->getAmount() << std::endl;
             
             // Take ownership of the refund
-            m_refunds.push_back(RefundFactory::createRefund(
-                refund->getTransaction(), refund->getAmount(), refund->getReason()));
+            std::unique_ptr<Refund> recorded = RefundFactory::createRefund(
+                refund->getTransaction(), refund->getAmount(), refund->getReason());
+            std::lock_guard<std::mutex> lock(m_refundsMutex);
+            m_refunds.push_back(std::move(recorded));
             
             return true;
         }
@@ -77,11 +79,18 @@ bool RefundManager::processRefundCommand(std::unique_ptr<RefundCommand> command)
     return false;
 }
 
-const std::vector<std::unique_ptr<Refund>>& RefundManager::getRefunds() const {
-    return m_refunds;
+std::vector<const Refund*> RefundManager::getRefunds() const {
+    std::lock_guard<std::mutex> lock(m_refundsMutex);
+    std::vector<const Refund*> result;
+    result.reserve(m_refunds.size());
+    for (const auto& refund : m_refunds) {
+        result.push_back(refund.get());
+    }
+    return result;
 }
 
 std::vector<const Refund*> RefundManager::getRefundsForTransaction(const std::string& transactionId) const {
+    std::lock_guard<std::mutex> lock(m_refundsMutex);
     std::vector<const Refund*> result;
     
     for (const auto& refund : m_refunds) {
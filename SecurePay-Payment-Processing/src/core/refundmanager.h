@@ -2,6 +2,7 @@
 #define REFUNDMANAGER_H
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 #include "transaction.h"
@@ -140,9 +141,9 @@ public:
     
     /**
      * @brief Get all refunds
-     * @return Vector of refunds
+     * @return Snapshot of the refunds, oldest first; safe to iterate while refunds are added
      */
-    const std::vector<std::unique_ptr<Refund>>& getRefunds() const;
+    std::vector<const Refund*> getRefunds() const;
     
     /**
      * @brief Get refunds for a specific transaction
@@ -165,6 +166,11 @@ private:
     bool processRefundCommand(std::unique_ptr<RefundCommand> command);
     
     std::vector<std::unique_ptr<Refund>> m_refunds;
+    
+    /**
+     * @brief Guards m_refunds; refunds may be added while settlement or reports read them
+     */
+    mutable std::mutex m_refundsMutex;
 };
 
 #endif // REFUNDMANAGER_H
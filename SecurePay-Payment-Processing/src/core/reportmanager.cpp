@@ -18,6 +18,23 @@ std::string getCurrentTimestamp() {
     return ss.str();
 }
 
+// Helper function to parse a yyyy-MM-dd filter date as local midnight
+static bool parseFilterDate(const std::string& date, std::chrono::system_clock::time_point& midnight) {
+    std::tm tm = {};
+    std::istringstream ss(date);
+    ss >> std::get_time(&tm, "%Y-%m-%d");
+    if (ss.fail()) {
+        return false;
+    }
+    tm.tm_isdst = -1;
+    std::time_t time = std::mktime(&tm);
+    if (time == -1) {
+        return false;
+    }
+    midnight = std::chrono::system_clock::from_time_t(time);
+    return true;
+}
+
 // TransactionHistoryReport implementation
 std::string TransactionHistoryReport::generateReport(
     const std::vector<const Transaction*>& transactions,
@@ -204,8 +221,6 @@ std::string FraudAlertReport::generateReport(
     ss << "ID,Date,Transaction ID,Customer,Merchant,Amount,Risk Level,Description,Reviewed\n";
     
     for (const auto& alert : fraudAlerts) {
-        const Transaction& transaction = alert->getTransaction();
-        
         // Apply filters
         if (!riskLevel.empty()) {
             std::string alertRiskLevel = FraudSystem::riskLevelToString(alert->getRiskLevel());
@@ -221,14 +236,18 @@ std::string FraudAlertReport::generateReport(
             }
         }
         
-        // TODO: Implement date filtering
+        // Timestamps start with yyyy-MM-dd, so the date range compares as strings
+        std::string alertDate = alert->getTimestamp().substr(0, 10);
+        if ((!startDate.empty() && alertDate < startDate) || (!endDate.empty() && alertDate > endDate)) {
+            continue;
+        }
         
         ss << alert->getAlertId() << ","
            << alert->getTimestamp() << ","
-           << transaction.getTransactionId() << ","
-           << transaction.getCustomer().getName() << ","
-           << transaction.getMerchant().getName() << ","
-           << transaction.getAmount() << ","
+           << alert->getTransactionId() << ","
+           << alert->getCustomerName() << ","
+           << alert->getMerchantName() << ","
+           << alert->getAmount() << ","
            << FraudSystem::riskLevelToString(alert->getRiskLevel()) << ","
            << alert->getDescription() << ","
            << (alert->isReviewed() ? "Yes" : "No") << "\n";
@@ -479,10 +498,8 @@ std::string DailySummaryReport::generateReport(
     
     // Count fraud alerts
     for (const auto& alert : fraudAlerts) {
-        const Transaction& transaction = alert->getTransaction();
-        
         // Apply filters
-        if (!merchantId.empty() && transaction.getMerchant().getName() != merchantId) {
+        if (!merchantId.empty() && alert->getMerchantName() != merchantId) {
             continue;
         }
         
@@ -608,10 +625,8 @@ std::string MonthlySummaryReport::generateReport(
     
     // Count fraud alerts
     for (const auto& alert : fraudAlerts) {
-        const Transaction& transaction = alert->getTransaction();
-        
         // Apply filters
-        if (!merchantId.empty() && transaction.getMerchant().getName() != merchantId) {
+        if (!merchantId.empty() && alert->getMerchantName() != merchantId) {
             continue;
         }
         
@@ -751,9 +766,11 @@ std::string ReportManager::generateReport(
     ReportType reportType,
     const std::map<std::string, std::string>& filterCriteria) {
     
-    auto transactions = getAllTransactions();
+    auto transactions = getCandidateTransactions(filterCriteria);
     auto refunds = getAllRefunds();
-    auto fraudAlerts = getAllFraudAlerts();
+    auto fraudAlerts = reportType == ReportType::FRAUD_ALERTS
+        ? getCandidateFraudAlerts(filterCriteria)
+        : getAllFraudAlerts();
     
     auto strategy = createReportStrategy(reportType);
     return strategy->generateReport(transactions, refunds, fraudAlerts, filterCriteria);
@@ -779,35 +796,84 @@ bool ReportManager::generateAndExportReport(
 }
 
 std::vector<const Transaction*> ReportManager::getAllTransactions() const {
-    std::vector<const Transaction*> result;
+    if (m_paymentGateway) {
+        const PaymentGateway& paymentGateway = *m_paymentGateway;
+        return paymentGateway.getTransactions();
+    }
+    
+    return {};
+}
+
+std::vector<const Transaction*> ReportManager::getCandidateTransactions(
+    const std::map<std::string, std::string>& filterCriteria) const {
     
     if (m_paymentGateway) {
-        for (const auto& transaction : m_paymentGateway->getTransactions()) {
-            result.push_back(transaction.get());
+        auto it = filterCriteria.find("merchantId");
+        if (it != filterCriteria.end() && !it->second.empty()) {
+            return m_paymentGateway->getTransactionsForMerchant(it->second);
+        }
+        
+        it = filterCriteria.find("customerId");
+        if (it != filterCriteria.end() && !it->second.empty()) {
+            return m_paymentGateway->getTransactionsForCustomer(it->second);
         }
     }
     
-    return result;
+    return getAllTransactions();
 }
 
 std::vector<const Refund*> ReportManager::getAllRefunds() const {
-    std::vector<const Refund*> result;
-    
     if (m_refundManager) {
-        for (const auto& refund : m_refundManager->getRefunds()) {
-            result.push_back(refund.get());
-        }
+        return m_refundManager->getRefunds();
     }
     
-    return result;
+    return {};
 }
 
 std::vector<const FraudAlert*> ReportManager::getAllFraudAlerts() const {
-    std::vector<const FraudAlert*> result;
+    if (m_fraudSystem) {
+        return m_fraudSystem->getAlertStore().getAll();
+    }
     
-    // TODO: Implement once FraudSystem is updated to store alerts
+    return {};
+}
+
+std::vector<const FraudAlert*> ReportManager::getCandidateFraudAlerts(
+    const std::map<std::string, std::string>& filterCriteria) const {
+    
+    if (!m_fraudSystem) {
+        return {};
+    }
+    
+    // Criteria the store can't express are left to the report, which checks every filter again
+    FraudAlertFilter filter;
+    auto it = filterCriteria.find("riskLevel");
+    if (it != filterCriteria.end()) {
+        for (FraudRiskLevel level : {FraudRiskLevel::LOW, FraudRiskLevel::MEDIUM, FraudRiskLevel::HIGH}) {
+            if (FraudSystem::riskLevelToString(level) == it->second) {
+                filter.filterRiskLevel = true;
+                filter.riskLevel = level;
+            }
+        }
+    }
+    
+    it = filterCriteria.find("reviewed");
+    if (it != filterCriteria.end() && (it->second == "true" || it->second == "false")) {
+        filter.filterReviewed = true;
+        filter.reviewed = it->second == "true";
+    }
+    
+    it = filterCriteria.find("startDate");
+    if (it != filterCriteria.end()) {
+        parseFilterDate(it->second, filter.from);
+    }
+    
+    it = filterCriteria.find("endDate");
+    if (it != filterCriteria.end() && parseFilterDate(it->second, filter.to)) {
+        filter.to += std::chrono::hours(24); // The end date is inclusive
+    }
     
-    return result;
+    return m_fraudSystem->getAlertStore().query(filter);
 }
 
 std::unique_ptr<ReportStrategy> ReportManager::createReportStrategy(ReportType reportType) const {
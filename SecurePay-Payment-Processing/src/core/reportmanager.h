@@ -284,6 +284,18 @@ private:
      */
     std::vector<const Transaction*> getAllTransactions() const;
     
+    /**
+     * @brief Get the transactions a report needs to look at
+     * 
+     * Uses the gateway's customer / merchant indexes when the filter names one,
+     * so filtered reports don't walk the full history.
+     * 
+     * @param filterCriteria The report filter criteria
+     * @return Vector of candidate transactions
+     */
+    std::vector<const Transaction*> getCandidateTransactions(
+        const std::map<std::string, std::string>& filterCriteria) const;
+    
     /**
      * @brief Get all refunds
      * @return Vector of refunds
@@ -296,6 +308,18 @@ private:
      */
     std::vector<const FraudAlert*> getAllFraudAlerts() const;
     
+    /**
+     * @brief Get the fraud alerts a fraud alert report needs to look at
+     * 
+     * Narrows by risk level, review state and date range through the alert
+     * store's indexes instead of handing the report every alert.
+     * 
+     * @param filterCriteria The report filter criteria
+     * @return Vector of candidate fraud alerts
+     */
+    std::vector<const FraudAlert*> getCandidateFraudAlerts(
+        const std::map<std::string, std::string>& filterCriteria) const;
+    
     /**
      * @brief Create a report strategy based on report type
      * @param reportType Type of report
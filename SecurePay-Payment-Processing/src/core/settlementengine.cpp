@@ -0,0 +1,247 @@
+#include "settlementengine.h"
+#include "paymentgateway.h"
+#include "refundmanager.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+std::int64_t toCents(double amount) {
+    return static_cast<std::int64_t>(std::llround(amount * 100.0));
+}
+
+std::string formatCents(std::int64_t cents) {
+    std::ostringstream ss;
+    if (cents < 0) {
+        ss << '-';
+        cents = -cents;
+    }
+    ss << cents / 100 << '.' << std::setw(2) << std::setfill('0') << cents % 100;
+    return ss.str();
+}
+
+// std::localtime shares one buffer between threads; settlement runs alongside live payments
+std::tm localTime(std::time_t time) {
+    std::tm local{};
+#if defined(_WIN32)
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    return local;
+}
+
+std::string formatDate(std::chrono::system_clock::time_point time, const char* format) {
+    std::tm local = localTime(std::chrono::system_clock::to_time_t(time));
+    std::ostringstream ss;
+    ss << std::put_time(&local, format);
+    return ss.str();
+}
+
+std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+bool isSettled(TransactionStatus status) {
+    return status == TransactionStatus::APPROVED ||
+           status == TransactionStatus::PARTIALLY_REFUNDED ||
+           status == TransactionStatus::REFUNDED;
+}
+
+// Runs task(0) .. task(count - 1) on their own threads and waits for all of them
+void runParallel(std::size_t count, const std::function<void(std::size_t)>& task) {
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (std::size_t i = 1; i < count; ++i) {
+        threads.emplace_back(task, i);
+    }
+    task(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+SettlementEngine::SettlementEngine(std::size_t threadCount, std::size_t entriesPerThread)
+    : m_threadCount(threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency())),
+      m_entriesPerThread(std::max<std::size_t>(1, entriesPerThread)) {
+}
+
+SettlementBatch SettlementEngine::settle(const std::vector<const Transaction*>& transactions,
+                                         const std::vector<const Refund*>& refunds,
+                                         std::chrono::system_clock::time_point from,
+                                         std::chrono::system_clock::time_point to) const {
+    // Small days are not worth the thread start-up
+    const std::size_t total = transactions.size() + refunds.size();
+    const std::size_t threads = std::max<std::size_t>(1, std::min(m_threadCount, total / m_entriesPerThread));
+
+    // Phase 1: each thread routes a contiguous chunk of the input to merchant partitions
+    std::vector<std::vector<std::vector<Posting>>> routed(threads, std::vector<std::vector<Posting>>(threads));
+    runParallel(threads, [&](std::size_t thread) {
+        std::hash<std::string> hasher;
+        std::size_t begin = total * thread / threads;
+        std::size_t end = total * (thread + 1) / threads;
+        for (std::size_t i = begin; i < end; ++i) {
+            Posting posting;
+            if (i < transactions.size()) {
+                const Transaction* transaction = transactions[i];
+                // By approval time, so a payment approved on review after its day closed settles in a later one
+                auto approvedAt = transaction->getApprovedAt();
+                if (!isSettled(transaction->getStatus()) || approvedAt < from || approvedAt >= to) {
+                    continue;
+                }
+                posting = Posting{transaction->getMerchant().getName(), toCents(transaction->getAmount()), false};
+            } else {
+                const Refund* refund = refunds[i - transactions.size()];
+                auto createdAt = refund->getCreatedAt();
+                if (createdAt < from || createdAt >= to) {
+                    continue;
+                }
+                posting = Posting{refund->getTransaction().getMerchant().getName(), toCents(refund->getAmount()), true};
+            }
+            std::size_t partition = hasher(posting.merchantName) % threads;
+            routed[thread][partition].push_back(std::move(posting));
+        }
+    });
+
+    // Phase 2: each thread nets the merchants of one partition
+    std::vector<std::vector<MerchantSettlement>> partitions(threads);
+    runParallel(threads, [&](std::size_t partition) {
+        std::unordered_map<std::string, MerchantSettlement> totals;
+        for (std::size_t source = 0; source < threads; ++source) {
+            for (const Posting& posting : routed[source][partition]) {
+                auto it = totals.find(posting.merchantName);
+                if (it == totals.end()) {
+                    it = totals.emplace(posting.merchantName,
+                                        MerchantSettlement{posting.merchantName, 0, 0, 0, 0, 0}).first;
+                }
+                MerchantSettlement& merchant = it->second;
+                if (posting.refund) {
+                    ++merchant.refundCount;
+                    merchant.refundCents += posting.cents;
+                } else {
+                    ++merchant.captureCount;
+                    merchant.grossCents += posting.cents;
+                }
+            }
+        }
+
+        std::vector<MerchantSettlement>& merchants = partitions[partition];
+        merchants.reserve(totals.size());
+        for (auto& entry : totals) {
+            entry.second.netCents = entry.second.grossCents - entry.second.refundCents;
+            merchants.push_back(std::move(entry.second));
+        }
+    });
+
+    // Merge: partitions hold disjoint merchants, so ordering by name alone is deterministic
+    SettlementBatch batch{"STL-" + formatDate(from, "%Y%m%d"), formatDate(from, "%Y-%m-%d"), {}, 0, 0, 0, 0, 0};
+    for (auto& merchants : partitions) {
+        std::move(merchants.begin(), merchants.end(), std::back_inserter(batch.merchants));
+    }
+    std::sort(batch.merchants.begin(), batch.merchants.end(),
+              [](const MerchantSettlement& a, const MerchantSettlement& b) {
+                  return a.merchantName < b.merchantName;
+              });
+
+    for (const MerchantSettlement& merchant : batch.merchants) {
+        batch.captureCount += merchant.captureCount;
+        batch.grossCents += merchant.grossCents;
+        batch.refundCount += merchant.refundCount;
+        batch.refundCents += merchant.refundCents;
+        batch.netCents += merchant.netCents;
+    }
+
+    return batch;
+}
+
+bool SettlementEngine::closeBusinessDay(const PaymentGateway& paymentGateway,
+                                        const RefundManager& refundManager,
+                                        std::chrono::system_clock::time_point day,
+                                        SettlementBatch& batch) {
+    // Local midnight to the following midnight, which mktime keeps right across DST changes
+    std::time_t dayTime = std::chrono::system_clock::to_time_t(day);
+    std::tm local = localTime(dayTime);
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    std::time_t startTime = std::mktime(&local);
+    local.tm_mday += 1;
+    local.tm_isdst = -1;
+    std::time_t endTime = std::mktime(&local);
+
+    auto from = std::chrono::system_clock::from_time_t(startTime);
+    auto to = std::chrono::system_clock::from_time_t(endTime);
+    std::string businessDate = formatDate(from, "%Y-%m-%d");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_closedDays.count(businessDate) != 0) {
+        std::cerr << "Business day " << businessDate << " is already closed" << std::endl;
+        return false;
+    }
+
+    // Both are snapshots taken under their owners' locks, so payments and refunds can keep completing
+    std::vector<const Transaction*> transactions = paymentGateway.getTransactions();
+    std::vector<const Refund*> refunds = refundManager.getRefunds();
+
+    batch = settle(transactions, refunds, from, to);
+    m_closedDays.insert(businessDate);
+
+    std::cout << "Closed business day " << businessDate << ": " << batch.merchants.size()
+              << " merchants, net " << formatCents(batch.netCents) << std::endl;
+    return true;
+}
+
+bool SettlementEngine::isClosed(const std::string& businessDate) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_closedDays.count(businessDate) != 0;
+}
+
+bool SettlementEngine::writeSettlementFile(const SettlementBatch& batch, const std::string& filePath) {
+    std::ofstream file(filePath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for writing: " << filePath << std::endl;
+        return false;
+    }
+
+    file << "H," << batch.batchId << "," << batch.businessDate << "," << batch.merchants.size() << "\n";
+    for (const MerchantSettlement& merchant : batch.merchants) {
+        file << "D," << csvField(merchant.merchantName) << ","
+             << merchant.captureCount << "," << formatCents(merchant.grossCents) << ","
+             << merchant.refundCount << "," << formatCents(merchant.refundCents) << ","
+             << formatCents(merchant.netCents) << "\n";
+    }
+    file << "T," << batch.captureCount << "," << formatCents(batch.grossCents) << ","
+         << batch.refundCount << "," << formatCents(batch.refundCents) << ","
+         << formatCents(batch.netCents) << "\n";
+
+    file.close();
+    if (!file) {
+        std::cerr << "Failed to write settlement file: " << filePath << std::endl;
+        return false;
+    }
+
+    std::cout << "Settlement file written: " << filePath << std::endl;
+    return true;
+}
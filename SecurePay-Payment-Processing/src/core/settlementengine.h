@@ -0,0 +1,125 @@
+#ifndef SETTLEMENTENGINE_H
+#define SETTLEMENTENGINE_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "refund.h"
+#include "transaction.h"
+
+class PaymentGateway;
+class RefundManager;
+
+/**
+ * @struct MerchantSettlement
+ * @brief One merchant's netted position for a business day, in cents
+ */
+struct MerchantSettlement {
+    std::string merchantName;
+    std::uint64_t captureCount;
+    std::int64_t grossCents;    ///< Amounts approved during the day, whenever the payment was made
+    std::uint64_t refundCount;
+    std::int64_t refundCents;   ///< Refunds issued during the day, whenever the original sale was
+    std::int64_t netCents;      ///< grossCents - refundCents; negative when the merchant owes
+};
+
+/**
+ * @struct SettlementBatch
+ * @brief Result of closing a business day
+ */
+struct SettlementBatch {
+    std::string batchId;
+    std::string businessDate;                   ///< YYYY-MM-DD, local time
+    std::vector<MerchantSettlement> merchants;  ///< Sorted by merchant name
+    std::uint64_t captureCount;
+    std::int64_t grossCents;
+    std::uint64_t refundCount;
+    std::int64_t refundCents;
+    std::int64_t netCents;
+};
+
+/**
+ * @class SettlementEngine
+ * @brief Closes a business day by netting each merchant's captures against its refunds
+ *
+ * A transaction settles on the day it was approved rather than the day it
+ * was made, so a payment approved after a fraud review that ran past
+ * midnight lands in the next open day instead of one already closed.
+ *
+ * Settlement runs in two parallel phases. First the input is split into
+ * contiguous chunks, one per thread, and each entry is routed to a
+ * partition chosen by hashing its merchant name. Then each thread owns one
+ * partition and totals its merchants without sharing state. Amounts are
+ * summed in integer cents, so totals do not depend on order. Sorting the
+ * merged merchants by name makes the batch and the file byte-for-byte
+ * reproducible for any thread count.
+ */
+class SettlementEngine {
+public:
+    /**
+     * @brief Constructor
+     * @param threadCount Worker threads per settlement run; 0 uses the hardware concurrency
+     * @param entriesPerThread Entries each worker thread must have, so small days are not worth the thread start-up
+     */
+    explicit SettlementEngine(std::size_t threadCount = 0, std::size_t entriesPerThread = 4096);
+
+    /**
+     * @brief Net captures and refunds falling in a time window
+     * @param transactions Candidate transactions; only APPROVED, PARTIALLY_REFUNDED and REFUNDED ones
+     *                     settle, in the window containing their approval time
+     * @param refunds Candidate refunds
+     * @param from Start of the window, inclusive
+     * @param to End of the window, exclusive
+     * @return The settlement batch, with businessDate taken from the start of the window
+     */
+    SettlementBatch settle(const std::vector<const Transaction*>& transactions,
+                           const std::vector<const Refund*>& refunds,
+                           std::chrono::system_clock::time_point from,
+                           std::chrono::system_clock::time_point to) const;
+
+    /**
+     * @brief Settle the local calendar day containing a point in time, at most once
+     * @param paymentGateway Source of the day's transactions
+     * @param refundManager Source of the day's refunds
+     * @param day Any time during the business day
+     * @param batch Receives the settlement batch
+     * @return False if that business day has already been closed
+     */
+    bool closeBusinessDay(const PaymentGateway& paymentGateway,
+                          const RefundManager& refundManager,
+                          std::chrono::system_clock::time_point day,
+                          SettlementBatch& batch);
+
+    /**
+     * @brief Check whether a business day has been closed
+     * @param businessDate The date as YYYY-MM-DD
+     * @return True if closeBusinessDay() has settled that day
+     */
+    bool isClosed(const std::string& businessDate) const;
+
+    /**
+     * @brief Write a settlement file: a header line, one detail line per merchant and a trailer with the totals
+     * @param batch The settlement batch
+     * @param filePath Path to the output file
+     * @return True if the file was written, false otherwise
+     */
+    static bool writeSettlementFile(const SettlementBatch& batch, const std::string& filePath);
+
+private:
+    struct Posting {
+        std::string merchantName;
+        std::int64_t cents;
+        bool refund;
+    };
+
+    std::size_t m_threadCount;
+    std::size_t m_entriesPerThread;
+
+    mutable std::mutex m_mutex;
+    std::set<std::string> m_closedDays;
+};
+
+#endif // SETTLEMENTENGINE_H
@@ -0,0 +1,146 @@
+#include "simulatedbankbackend.h"
+#include <algorithm>
+#include <cmath>
+
+SimulatedBankBackend::SimulatedBankBackend(const SimulatedBankConfig& config)
+    : m_config(config),
+      m_timingWheel(TimingWheel::getInstance()),
+      m_random(config.seed != 0 ? config.seed : std::random_device{}()),
+      m_active(0),
+      m_peakActive(0),
+      m_requests(0),
+      m_completed(0),
+      m_errors(0),
+      m_refused(0) {
+}
+
+void SimulatedBankBackend::authorize(const BankAuthorizationRequest& request, Callback callback) {
+    ++m_requests;
+
+    PendingRequest pending{request, std::move(callback), std::chrono::steady_clock::now()};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_config.maxConcurrent == 0 || m_active < m_config.maxConcurrent) {
+            startLocked(std::move(pending));
+            return;
+        }
+
+        if (m_waiting.size() < m_config.maxQueued) {
+            m_waiting.push_back(std::move(pending));
+            return;
+        }
+    }
+
+    // Acquirer saturated: refuse without occupying a slot
+    ++m_refused;
+    pending.callback(BankAuthorizationResponse{BankResponseCode::ERROR, std::chrono::microseconds(0)});
+}
+
+void SimulatedBankBackend::capture(const BankAuthorizationRequest& request) {
+    if (m_config.ledger) {
+        m_config.ledger->capture(request.accountId, request.transactionId);
+    }
+}
+
+void SimulatedBankBackend::reverse(const BankAuthorizationRequest& request) {
+    if (m_config.ledger) {
+        m_config.ledger->release(request.accountId, request.transactionId);
+    }
+}
+
+std::string SimulatedBankBackend::getName() const {
+    return m_config.name;
+}
+
+std::shared_ptr<AccountLedger> SimulatedBankBackend::getLedger() const {
+    return m_config.ledger;
+}
+
+SimulatedBankStatistics SimulatedBankBackend::getStatistics() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return SimulatedBankStatistics{
+        m_requests.load(),
+        m_completed.load(),
+        m_errors.load(),
+        m_refused.load(),
+        m_active,
+        m_waiting.size(),
+        m_peakActive
+    };
+}
+
+void SimulatedBankBackend::startLocked(PendingRequest pending) {
+    ++m_active;
+    m_peakActive = std::max(m_peakActive, m_active);
+
+    std::chrono::microseconds latency = sampleLatencyLocked();
+    auto shared = std::make_shared<PendingRequest>(std::move(pending));
+    auto self = shared_from_this();
+    m_timingWheel.schedule(latency, [self, shared]() {
+        self->finish(*shared);
+    });
+}
+
+void SimulatedBankBackend::finish(const PendingRequest& pending) {
+    BankResponseCode code;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        if (m_config.errorRate > 0.0 && unit(m_random) < m_config.errorRate) {
+            code = BankResponseCode::ERROR;
+        } else if (m_config.ledger) {
+            code = BankResponseCode::APPROVED; // Decided by the hold below, outside m_mutex
+        } else if (pending.request.amount < m_config.approvalLimit) {
+            code = BankResponseCode::APPROVED;
+        } else {
+            code = BankResponseCode::INSUFFICIENT_FUNDS;
+        }
+
+        --m_active;
+        if (!m_waiting.empty()) {
+            PendingRequest next = std::move(m_waiting.front());
+            m_waiting.pop_front();
+            startLocked(std::move(next));
+        }
+    }
+
+    if (code == BankResponseCode::APPROVED && m_config.ledger &&
+        !m_config.ledger->placeHold(pending.request.accountId, pending.request.transactionId,
+                                    AccountLedger::toCents(pending.request.amount))) {
+        code = BankResponseCode::INSUFFICIENT_FUNDS;
+    }
+
+    if (code == BankResponseCode::ERROR) {
+        ++m_errors;
+    }
+    ++m_completed;
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - pending.received);
+    pending.callback(BankAuthorizationResponse{code, latency});
+}
+
+std::chrono::microseconds SimulatedBankBackend::sampleLatencyLocked() {
+    double micros = 0.0;
+    double minMicros = static_cast<double>(m_config.minLatency.count());
+    double maxMicros = static_cast<double>(std::max(m_config.minLatency, m_config.maxLatency).count());
+
+    switch (m_config.distribution) {
+        case LatencyDistribution::FIXED:
+            micros = static_cast<double>(m_config.medianLatency.count());
+            break;
+        case LatencyDistribution::UNIFORM: {
+            std::uniform_real_distribution<double> uniform(minMicros, maxMicros);
+            micros = uniform(m_random);
+            break;
+        }
+        case LatencyDistribution::LOG_NORMAL: {
+            double median = std::max(1.0, static_cast<double>(m_config.medianLatency.count()));
+            std::lognormal_distribution<double> logNormal(std::log(median), m_config.logNormalSigma);
+            micros = std::clamp(logNormal(m_random), minMicros, maxMicros);
+            break;
+        }
+    }
+
+    return std::chrono::microseconds(static_cast<std::int64_t>(micros));
+}
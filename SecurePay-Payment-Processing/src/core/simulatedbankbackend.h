@@ -0,0 +1,142 @@
+#ifndef SIMULATEDBANKBACKEND_H
+#define SIMULATEDBANKBACKEND_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include "bankbackend.h"
+#include "timingwheel.h"
+#include "accountledger.h"
+
+/**
+ * @enum LatencyDistribution
+ * @brief Shape of the simulated acquirer response time
+ */
+enum class LatencyDistribution {
+    FIXED,      ///< Every call takes medianLatency
+    UNIFORM,    ///< Uniform between minLatency and maxLatency
+    LOG_NORMAL  ///< Log-normal around medianLatency, clamped to [minLatency, maxLatency]
+};
+
+/**
+ * @struct SimulatedBankConfig
+ * @brief Tuning knobs for SimulatedBankBackend
+ */
+struct SimulatedBankConfig {
+    std::string name = "Simulated";
+    LatencyDistribution distribution = LatencyDistribution::UNIFORM;
+    std::chrono::microseconds minLatency{50000};
+    std::chrono::microseconds maxLatency{300000};
+    std::chrono::microseconds medianLatency{100000};
+    double logNormalSigma = 0.5;
+    double errorRate = 0.0;          ///< Fraction of calls answered with ERROR
+    std::size_t maxConcurrent = 0;   ///< Authorizations the acquirer works on at once; 0 = unlimited
+    std::size_t maxQueued = 10000;   ///< Requests waiting for a slot before new ones are refused
+    double approvalLimit = 5000.0;   ///< Amounts at or above this are declined for insufficient funds; used without a ledger
+    std::shared_ptr<AccountLedger> ledger; ///< If set, approvals place a hold against the account's balance
+    std::uint32_t seed = 0;          ///< 0 seeds from std::random_device
+};
+
+/**
+ * @struct SimulatedBankStatistics
+ * @brief Counters describing the simulated acquirer's load
+ */
+struct SimulatedBankStatistics {
+    std::uint64_t requests;
+    std::uint64_t completed;
+    std::uint64_t errors;
+    std::uint64_t refused;
+    std::size_t active;
+    std::size_t queued;
+    std::size_t peakActive;
+};
+
+/**
+ * @class SimulatedBankBackend
+ * @brief Local stand-in for an acquiring bank with configurable latency
+ *
+ * Each accepted request occupies one of maxConcurrent slots for a sampled
+ * latency and is answered from the shared TimingWheel, so any number
+ * of authorizations can be outstanding without a thread per request.
+ * Requests beyond the concurrency limit wait in a FIFO; when that is full
+ * they are refused with ERROR straight away.
+ *
+ * With a ledger configured, an approval is a hold for the full amount on the
+ * request's account, keyed by transaction ID, and insufficient available
+ * funds produce INSUFFICIENT_FUNDS. capture() debits the hold and reverse()
+ * releases it.
+ *
+ * Outstanding requests keep the backend alive, so it must be owned by a
+ * std::shared_ptr.
+ */
+class SimulatedBankBackend : public BankBackend,
+                             public std::enable_shared_from_this<SimulatedBankBackend> {
+public:
+    /**
+     * @brief Constructor
+     * @param config Latency, error and concurrency settings
+     */
+    explicit SimulatedBankBackend(const SimulatedBankConfig& config = SimulatedBankConfig());
+
+    void authorize(const BankAuthorizationRequest& request, Callback callback) override;
+    void capture(const BankAuthorizationRequest& request) override;
+    void reverse(const BankAuthorizationRequest& request) override;
+    std::string getName() const override;
+
+    /**
+     * @brief Get load counters
+     * @return Snapshot of the backend statistics
+     */
+    SimulatedBankStatistics getStatistics() const;
+
+    /**
+     * @brief Get the account ledger, for captures, releases and balance checks
+     * @return The ledger, or nullptr if the backend uses the flat approval limit
+     */
+    std::shared_ptr<AccountLedger> getLedger() const;
+
+private:
+    struct PendingRequest {
+        BankAuthorizationRequest request;
+        Callback callback;
+        std::chrono::steady_clock::time_point received;
+    };
+
+    /**
+     * @brief Occupy a slot and schedule the answer; caller holds m_mutex
+     * @param pending The request to start
+     */
+    void startLocked(PendingRequest pending);
+
+    /**
+     * @brief Answer a request and start the next queued one
+     * @param pending The request that has finished
+     */
+    void finish(const PendingRequest& pending);
+
+    /**
+     * @brief Draw a latency from the configured distribution; caller holds m_mutex
+     * @return The simulated latency
+     */
+    std::chrono::microseconds sampleLatencyLocked();
+
+    SimulatedBankConfig m_config;
+    TimingWheel& m_timingWheel;
+
+    mutable std::mutex m_mutex;
+    std::mt19937 m_random;
+    std::deque<PendingRequest> m_waiting;
+    std::size_t m_active;
+    std::size_t m_peakActive;
+
+    std::atomic<std::uint64_t> m_requests;
+    std::atomic<std::uint64_t> m_completed;
+    std::atomic<std::uint64_t> m_errors;
+    std::atomic<std::uint64_t> m_refused;
+};
+
+#endif // SIMULATEDBANKBACKEND_H
@@ -238,6 +238,63 @@ bool SQLiteDataManager::saveTransaction(const Transaction& transaction) {
     return executeSQL(ss.str());
 }
 
+bool SQLiteDataManager::saveTransactions(const std::vector<const Transaction*>& transactions) {
+    if (transactions.empty()) {
+        return true;
+    }
+    
+    // One prepared statement and one commit for the whole batch instead of a journal sync per row
+    const char* sql =
+        "INSERT OR REPLACE INTO transactions ("
+        "id, customer_name, merchant_name, amount, refunded_amount, status, timestamp, "
+        "payment_method_type, payment_detail1, payment_detail2, payment_detail3, payment_detail4"
+        ") VALUES (?, ?, ?, ?, ?, ?, ?, ?, '', '', '', '');";
+    
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(m_db, sql, -1, &statement, nullptr) != SQLITE_OK) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(m_db) << std::endl;
+        return false;
+    }
+    
+    if (!executeSQL("BEGIN TRANSACTION;")) {
+        sqlite3_finalize(statement);
+        return false;
+    }
+    
+    bool success = true;
+    for (const Transaction* transaction : transactions) {
+        std::string id = transaction->getTransactionId();
+        std::string customerName = transaction->getCustomer().getName();
+        std::string merchantName = transaction->getMerchant().getName();
+        std::string timestamp = transaction->getTimestamp();
+        std::string paymentMethodType = transaction->getPaymentMethod().getType();
+        
+        sqlite3_bind_text(statement, 1, id.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(statement, 2, customerName.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(statement, 3, merchantName.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_double(statement, 4, transaction->getAmount());
+        sqlite3_bind_double(statement, 5, transaction->getRefundedAmount());
+        sqlite3_bind_int(statement, 6, static_cast<int>(transaction->getStatus()));
+        sqlite3_bind_text(statement, 7, timestamp.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(statement, 8, paymentMethodType.c_str(), -1, SQLITE_TRANSIENT);
+        
+        if (sqlite3_step(statement) != SQLITE_DONE) {
+            std::cerr << "SQL error: " << sqlite3_errmsg(m_db) << std::endl;
+            success = false;
+            break;
+        }
+        sqlite3_reset(statement);
+    }
+    
+    sqlite3_finalize(statement);
+    
+    if (!success) {
+        executeSQL("ROLLBACK;");
+        return false;
+    }
+    return executeSQL("COMMIT;");
+}
+
 // Structure to hold transaction data during loading
 struct TransactionData {
     std::vector<std::unique_ptr<Transaction>>* transactions;
@@ -273,8 +330,8 @@ static int transactionCallback(void* data, int argc, char** argv, char** azColNa
     }
     
     // Create the payment method
-    auto paymentMethod = transactionData->manager->createPaymentMethod(
-        paymentMethodType, paymentDetail1, paymentDetail2, paymentDetail3, paymentDetail4);
+    auto paymentMethod = PaymentMethodFactory::createPaymentMethod(
+        paymentMethodType, {paymentDetail1, paymentDetail2, paymentDetail3, paymentDetail4});
     
     if (!paymentMethod) {
         std::cerr << "Failed to create payment method for transaction " << id << std::endl;
@@ -384,7 +441,7 @@ bool SQLiteDataManager::saveFraudAlert(const FraudAlert& fraudAlert) {
     std::stringstream ss;
     ss << "INSERT OR REPLACE INTO fraud_alerts (id, transaction_id, risk_level, description, timestamp, reviewed) VALUES ("
        << "'" << fraudAlert.getAlertId() << "', "
-       << "'" << fraudAlert.getTransaction().getTransactionId() << "', "
+       << "'" << fraudAlert.getTransactionId() << "', "
        << static_cast<int>(fraudAlert.getRiskLevel()) << ", "
        << "'" << fraudAlert.getDescription() << "', "
        << "'" << fraudAlert.getTimestamp() << "', "
@@ -394,6 +451,57 @@ bool SQLiteDataManager::saveFraudAlert(const FraudAlert& fraudAlert) {
     return executeSQL(ss.str());
 }
 
+bool SQLiteDataManager::saveFraudAlerts(const std::vector<const FraudAlert*>& fraudAlerts) {
+    if (fraudAlerts.empty()) {
+        return true;
+    }
+    
+    const char* sql =
+        "INSERT OR REPLACE INTO fraud_alerts (id, transaction_id, risk_level, description, timestamp, reviewed) "
+        "VALUES (?, ?, ?, ?, ?, ?);";
+    
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(m_db, sql, -1, &statement, nullptr) != SQLITE_OK) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(m_db) << std::endl;
+        return false;
+    }
+    
+    if (!executeSQL("BEGIN TRANSACTION;")) {
+        sqlite3_finalize(statement);
+        return false;
+    }
+    
+    bool success = true;
+    for (const FraudAlert* fraudAlert : fraudAlerts) {
+        std::string id = fraudAlert->getAlertId();
+        std::string transactionId = fraudAlert->getTransactionId();
+        std::string description = fraudAlert->getDescription();
+        std::string timestamp = fraudAlert->getTimestamp();
+        
+        sqlite3_bind_text(statement, 1, id.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(statement, 2, transactionId.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(statement, 3, static_cast<int>(fraudAlert->getRiskLevel()));
+        sqlite3_bind_text(statement, 4, description.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(statement, 5, timestamp.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(statement, 6, fraudAlert->isReviewed() ? 1 : 0);
+        
+        if (sqlite3_step(statement) != SQLITE_DONE) {
+            std::cerr << "SQL error: " << sqlite3_errmsg(m_db) << std::endl;
+            success = false;
+            break;
+        }
+        sqlite3_reset(statement);
+    }
+    
+    sqlite3_finalize(statement);
+    
+    if (!success) {
+        executeSQL("ROLLBACK;");
+        return false;
+    }
+    return executeSQL("COMMIT;");
+}
+
 // Structure to hold fraud alert data during loading
 struct FraudAlertData {
     std::vector<std::unique_ptr<FraudAlert>>* fraudAlerts;
@@ -480,21 +588,3 @@ const Transaction* SQLiteDataManager::findTransactionById(const std::string& id,
     
     return nullptr;
 }
-
-std::unique_ptr<PaymentMethod> SQLiteDataManager::createPaymentMethod(
-    const std::string& type,
-    const std::string& details1,
-    const std::string& details2,
-    const std::string& details3,
-    const std::string& details4) const {
-    
-    if (type == "Credit Card") {
-        return PaymentMethodFactory::createCreditCard(details1, details2, details3, details4);
-    } else if (type == "Debit Card") {
-        return PaymentMethodFactory::createDebitCard(details1, details2, details3, details4);
-    } else if (type == "Digital Wallet") {
-        return PaymentMethodFactory::createDigitalWallet(details1, details2);
-    }
-    
-    return nullptr;
-}
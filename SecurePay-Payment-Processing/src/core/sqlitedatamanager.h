@@ -77,6 +77,13 @@ public:
      */
     bool saveTransaction(const Transaction& transaction) override;
     
+    /**
+     * @brief Save many transactions in a single SQLite transaction
+     * @param transactions The transactions to save
+     * @return True if every transaction was saved, false if the batch was rolled back
+     */
+    bool saveTransactions(const std::vector<const Transaction*>& transactions) override;
+    
     /**
      * @brief Load all transactions from the SQLite database
      * @param customers Vector of customers for reference
@@ -109,6 +116,13 @@ public:
      */
     bool saveFraudAlert(const FraudAlert& fraudAlert) override;
     
+    /**
+     * @brief Save many fraud alerts in a single SQLite transaction
+     * @param fraudAlerts The fraud alerts to save
+     * @return True if every alert was saved, false if the batch was rolled back
+     */
+    bool saveFraudAlerts(const std::vector<const FraudAlert*>& fraudAlerts) override;
+    
     /**
      * @brief Load all fraud alerts from the SQLite database
      * @param transactions Vector of transactions for reference
@@ -141,22 +155,6 @@ public:
      */
     const Transaction* findTransactionById(const std::string& id, const std::vector<std::unique_ptr<Transaction>>& transactions) const;
     
-    /**
-     * @brief Create a payment method from database data
-     * @param type The payment method type
-     * @param details1 First payment method detail
-     * @param details2 Second payment method detail
-     * @param details3 Third payment method detail
-     * @param details4 Fourth payment method detail
-     * @return Unique pointer to the created payment method
-     */
-    std::unique_ptr<PaymentMethod> createPaymentMethod(
-        const std::string& type,
-        const std::string& details1,
-        const std::string& details2,
-        const std::string& details3,
-        const std::string& details4) const;
-    
 private:
     /**
      * @brief Create the database tables if they don't exist
@@ -0,0 +1,402 @@
+#include "subscriptionmanager.h"
+#include <algorithm>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+SubscriptionManager::SubscriptionManager(PaymentGateway& gateway,
+                                         const SubscriptionConfig& config,
+                                         DataManager* dataManager)
+    : m_gateway(gateway),
+      m_config(config),
+      m_dataManager(dataManager),
+      m_nextId(1),
+      m_random(std::random_device{}()),
+      m_running(false),
+      m_batches(0),
+      m_charges(0),
+      m_approved(0),
+      m_failed(0),
+      m_heldForReview(0),
+      m_retriesScheduled(0),
+      m_pastDue(0),
+      m_persistFailures(0) {
+    if (m_config.batchSize == 0) {
+        m_config.batchSize = 1;
+    }
+    m_gateway.addObserver(this);
+}
+
+SubscriptionManager::~SubscriptionManager() {
+    stop();
+    m_gateway.removeObserver(this);
+}
+
+std::string SubscriptionManager::addSubscription(const Customer& customer,
+                                                 const Merchant& merchant,
+                                                 const std::string& paymentMethodType,
+                                                 const std::vector<std::string>& paymentDetails,
+                                                 double amount,
+                                                 BillingInterval interval,
+                                                 std::chrono::system_clock::time_point firstBillingAt) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::ostringstream id;
+    id << "SUB" << std::setw(8) << std::setfill('0') << m_nextId++;
+
+    Record record{
+        Subscription{id.str(), customer, merchant, paymentMethodType, paymentDetails, amount, interval,
+                     firstBillingAt, 0, SubscriptionStatus::ACTIVE, "", false},
+        firstBillingAt,
+        0
+    };
+    Record& stored = m_subscriptions.emplace(id.str(), std::move(record)).first->second;
+    scheduleLocked(stored, firstBillingAt + billingOffset(id.str()));
+
+    std::cout << "Subscription " << id.str() << " created for " << customer.getName()
+              << " -> " << merchant.getName() << std::endl;
+    return id.str();
+}
+
+bool SubscriptionManager::cancelSubscription(const std::string& subscriptionId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_subscriptions.find(subscriptionId);
+    if (it == m_subscriptions.end() || it->second.subscription.status == SubscriptionStatus::CANCELLED) {
+        return false;
+    }
+
+    Subscription& subscription = it->second.subscription;
+    m_due.erase(std::make_pair(subscription.nextBillingAt, subscription.id));
+    subscription.status = SubscriptionStatus::CANCELLED;
+    return true;
+}
+
+bool SubscriptionManager::reactivateSubscription(const std::string& subscriptionId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_subscriptions.find(subscriptionId);
+    if (it == m_subscriptions.end() || it->second.subscription.status != SubscriptionStatus::PAST_DUE) {
+        return false;
+    }
+
+    Subscription& subscription = it->second.subscription;
+    subscription.status = SubscriptionStatus::ACTIVE;
+    subscription.failedAttempts = 0;
+    scheduleLocked(it->second, std::chrono::system_clock::now());
+    return true;
+}
+
+bool SubscriptionManager::getSubscription(const std::string& subscriptionId, Subscription& subscription) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_subscriptions.find(subscriptionId);
+    if (it == m_subscriptions.end()) {
+        return false;
+    }
+
+    subscription = it->second.subscription;
+    return true;
+}
+
+std::size_t SubscriptionManager::billDue(std::chrono::system_clock::time_point now) {
+    std::lock_guard<std::mutex> billingLock(m_billingMutex);
+
+    std::size_t submitted = 0;
+    while (true) {
+        std::vector<Subscription> batch = takeDueBatch(now);
+        if (batch.empty()) {
+            break;
+        }
+
+        // Charges whose payment details cannot form a payment method fail without reaching the gateway
+        std::vector<PaymentResult> results(batch.size(), PaymentResult{"", TransactionStatus::DECLINED, FraudRiskLevel::LOW});
+        std::vector<std::unique_ptr<Transaction>> transactions;
+        std::vector<std::size_t> positions;
+        transactions.reserve(batch.size());
+        positions.reserve(batch.size());
+
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            const Subscription& subscription = batch[i];
+            auto paymentMethod = PaymentMethodFactory::createPaymentMethod(subscription.paymentMethodType,
+                                                                            subscription.paymentDetails);
+            if (!paymentMethod) {
+                std::cerr << "Subscription " << subscription.id << " has invalid payment details" << std::endl;
+                continue;
+            }
+            transactions.push_back(TransactionFactory::createTransaction(
+                subscription.customer, subscription.merchant, std::move(paymentMethod), subscription.amount));
+            positions.push_back(i);
+        }
+
+        std::vector<PaymentResult> gatewayResults = m_gateway.processTransactionBatch(std::move(transactions));
+        for (std::size_t i = 0; i < gatewayResults.size(); ++i) {
+            results[positions[i]] = gatewayResults[i];
+        }
+
+        ++m_batches;
+        m_charges += batch.size();
+        submitted += batch.size();
+        applyResults(batch, results, now);
+    }
+
+    return submitted;
+}
+
+void SubscriptionManager::start() {
+    std::lock_guard<std::mutex> lock(m_threadMutex);
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&SubscriptionManager::run, this);
+}
+
+void SubscriptionManager::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_threadMutex);
+        m_running = false;
+    }
+    m_threadCondition.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+SubscriptionStatistics SubscriptionManager::getStatistics() const {
+    std::size_t active = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& entry : m_subscriptions) {
+            if (entry.second.subscription.status == SubscriptionStatus::ACTIVE) {
+                ++active;
+            }
+        }
+    }
+
+    return SubscriptionStatistics{
+        m_batches.load(),
+        m_charges.load(),
+        m_approved.load(),
+        m_failed.load(),
+        m_heldForReview.load(),
+        m_retriesScheduled.load(),
+        m_pastDue.load(),
+        m_persistFailures.load(),
+        active
+    };
+}
+
+std::string SubscriptionManager::statusToString(SubscriptionStatus status) {
+    switch (status) {
+        case SubscriptionStatus::ACTIVE:
+            return "Active";
+        case SubscriptionStatus::PAST_DUE:
+            return "Past Due";
+        case SubscriptionStatus::CANCELLED:
+            return "Cancelled";
+        default:
+            return "Unknown";
+    }
+}
+
+void SubscriptionManager::onTransactionUpdated(const Transaction& transaction) {
+    TransactionStatus status = transaction.getStatus();
+    if (status == TransactionStatus::FLAGGED_FOR_REVIEW) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_inReview.find(transaction.getTransactionId());
+        if (it == m_inReview.end()) {
+            return;
+        }
+
+        Record& record = m_subscriptions.at(it->second);
+        m_inReview.erase(it);
+        record.subscription.awaitingReview = false;
+
+        bool approved = status == TransactionStatus::APPROVED;
+        if (approved) {
+            ++m_approved;
+        } else {
+            ++m_failed;
+        }
+        if (record.subscription.status == SubscriptionStatus::ACTIVE) {
+            settleChargeLocked(record, approved, std::chrono::system_clock::now());
+        }
+    }
+
+    // The charge was stored while it was held; store the reviewer's decision too
+    if (m_dataManager && !m_dataManager->saveTransaction(transaction)) {
+        std::cerr << "Failed to save reviewed subscription transaction " << transaction.getTransactionId() << std::endl;
+        ++m_persistFailures;
+    }
+}
+
+std::vector<Subscription> SubscriptionManager::takeDueBatch(TimePoint now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<Subscription> batch;
+    auto it = m_due.begin();
+    while (it != m_due.end() && it->first <= now && batch.size() < m_config.batchSize) {
+        batch.push_back(m_subscriptions.at(it->second).subscription);
+        it = m_due.erase(it);
+    }
+    return batch;
+}
+
+void SubscriptionManager::applyResults(const std::vector<Subscription>& batch,
+                                       const std::vector<PaymentResult>& results,
+                                       TimePoint now) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            const PaymentResult& result = results[i];
+            Record& record = m_subscriptions.at(batch[i].id);
+            Subscription& subscription = record.subscription;
+            if (!result.transactionId.empty()) {
+                subscription.lastTransactionId = result.transactionId;
+            }
+
+            TransactionStatus status = result.status;
+            if (status == TransactionStatus::FLAGGED_FOR_REVIEW) {
+                ++m_heldForReview;
+                // A reviewer may already have decided before the entry below could observe it
+                if (const Transaction* transaction = m_gateway.findTransaction(result.transactionId)) {
+                    status = transaction->getStatus();
+                }
+                if (status == TransactionStatus::FLAGGED_FOR_REVIEW) {
+                    // Not rescheduled: the decision arrives through onTransactionUpdated()
+                    subscription.awaitingReview = true;
+                    m_inReview.emplace(result.transactionId, subscription.id);
+                    continue;
+                }
+            }
+
+            bool approved = status == TransactionStatus::APPROVED;
+            if (approved) {
+                ++m_approved;
+            } else {
+                ++m_failed;
+            }
+            if (subscription.status != SubscriptionStatus::ACTIVE) {
+                continue; // Cancelled while the charge was with the gateway
+            }
+            settleChargeLocked(record, approved, now);
+        }
+    }
+
+    if (!m_dataManager) {
+        return;
+    }
+
+    std::vector<const Transaction*> transactions;
+    transactions.reserve(results.size());
+    for (const PaymentResult& result : results) {
+        if (result.transactionId.empty()) {
+            continue;
+        }
+        if (const Transaction* transaction = m_gateway.findTransaction(result.transactionId)) {
+            transactions.push_back(transaction);
+        }
+    }
+
+    if (!m_dataManager->saveTransactions(transactions)) {
+        std::cerr << "Failed to save " << transactions.size() << " subscription transactions" << std::endl;
+        ++m_persistFailures;
+    }
+}
+
+void SubscriptionManager::settleChargeLocked(Record& record, bool approved, TimePoint now) {
+    Subscription& subscription = record.subscription;
+    if (approved) {
+        subscription.failedAttempts = 0;
+        auto offset = billingOffset(subscription.id);
+        do {
+            ++record.cycle; // Cycles missed while billing was down are skipped, not charged together
+        } while (nominalTime(record) + offset <= now);
+        scheduleLocked(record, nominalTime(record) + offset);
+        return;
+    }
+
+    ++subscription.failedAttempts;
+    if (subscription.failedAttempts > m_config.maxRetries) {
+        std::cout << "Subscription " << subscription.id << " is past due after "
+                  << subscription.failedAttempts << " failed charges" << std::endl;
+        subscription.status = SubscriptionStatus::PAST_DUE;
+        ++m_pastDue;
+        return;
+    }
+
+    // Exponential backoff with up to half as much again of random jitter
+    auto backoff = m_config.retryBaseDelay * (std::int64_t(1) << std::min(subscription.failedAttempts - 1, 16));
+    std::uniform_int_distribution<std::int64_t> jitter(0, std::max<std::int64_t>(0, backoff.count() / 2));
+    scheduleLocked(record, now + backoff + std::chrono::system_clock::duration(jitter(m_random)));
+    ++m_retriesScheduled;
+}
+
+SubscriptionManager::TimePoint SubscriptionManager::nominalTime(const Record& record) {
+    switch (record.subscription.interval) {
+        case BillingInterval::DAILY:
+            return record.anchor + std::chrono::hours(24) * static_cast<std::int64_t>(record.cycle);
+        case BillingInterval::WEEKLY:
+            return record.anchor + std::chrono::hours(24 * 7) * static_cast<std::int64_t>(record.cycle);
+        case BillingInterval::MONTHLY:
+        default: {
+            // Months are counted from the anchor so a short month does not pull later cycles earlier
+            std::time_t anchorTime = std::chrono::system_clock::to_time_t(record.anchor);
+            auto fraction = record.anchor - std::chrono::system_clock::from_time_t(anchorTime);
+
+            // Billing runs on its own thread, so use the reentrant form rather than localtime's shared buffer
+            std::tm local{};
+#if defined(_WIN32)
+            localtime_s(&local, &anchorTime);
+#else
+            localtime_r(&anchorTime, &local);
+#endif
+            int day = local.tm_mday;
+            local.tm_mon += static_cast<int>(record.cycle);
+            local.tm_isdst = -1;
+            std::time_t billingTime = std::mktime(&local);
+            if (local.tm_mday != day) {
+                local.tm_mday = 0; // Overflowed into the next month; use the last day of the intended one
+                local.tm_isdst = -1;
+                billingTime = std::mktime(&local);
+            }
+            return std::chrono::system_clock::from_time_t(billingTime) + fraction;
+        }
+    }
+}
+
+std::chrono::system_clock::duration SubscriptionManager::billingOffset(const std::string& subscriptionId) const {
+    auto window = m_config.jitterWindow.count();
+    if (window <= 0) {
+        return std::chrono::system_clock::duration::zero();
+    }
+    return std::chrono::system_clock::duration(
+        static_cast<std::int64_t>(std::hash<std::string>{}(subscriptionId) % static_cast<std::uint64_t>(window)));
+}
+
+void SubscriptionManager::scheduleLocked(Record& record, TimePoint at) {
+    Subscription& subscription = record.subscription;
+    m_due.erase(std::make_pair(subscription.nextBillingAt, subscription.id));
+    subscription.nextBillingAt = at;
+    m_due.emplace(at, subscription.id);
+}
+
+void SubscriptionManager::run() {
+    std::unique_lock<std::mutex> lock(m_threadMutex);
+    while (m_running) {
+        lock.unlock();
+        billDue();
+        lock.lock();
+
+        m_threadCondition.wait_for(lock, m_config.pollInterval, [this] { return !m_running; });
+    }
+}
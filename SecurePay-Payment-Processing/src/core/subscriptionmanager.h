@@ -0,0 +1,299 @@
+#ifndef SUBSCRIPTIONMANAGER_H
+#define SUBSCRIPTIONMANAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "customer.h"
+#include "datamanager.h"
+#include "merchant.h"
+#include "paymentgateway.h"
+
+/**
+ * @enum BillingInterval
+ * @brief How often a subscription is charged
+ */
+enum class BillingInterval {
+    DAILY,
+    WEEKLY,
+    MONTHLY  ///< Same day each month, or the month's last day when it is shorter
+};
+
+/**
+ * @enum SubscriptionStatus
+ * @brief Lifecycle state of a subscription
+ */
+enum class SubscriptionStatus {
+    ACTIVE,
+    PAST_DUE,   ///< Every retry of a charge failed; no further billing until reactivated
+    CANCELLED
+};
+
+/**
+ * @struct Subscription
+ * @brief A recurring payment schedule for a customer-merchant pair
+ */
+struct Subscription {
+    std::string id;
+    Customer customer;
+    Merchant merchant;
+    std::string paymentMethodType;
+    std::vector<std::string> paymentDetails;
+    double amount;
+    BillingInterval interval;
+    std::chrono::system_clock::time_point nextBillingAt; ///< Next charge or retry, including jitter
+    int failedAttempts;                                  ///< Failed charges for the current cycle
+    SubscriptionStatus status;
+    std::string lastTransactionId;
+    bool awaitingReview;                                 ///< lastTransactionId is held for manual fraud review
+};
+
+/**
+ * @struct SubscriptionConfig
+ * @brief Batching, spreading and retry settings for the subscription engine
+ */
+struct SubscriptionConfig {
+    std::size_t batchSize = 1000;                                           ///< Charges submitted to the gateway at once
+    int maxRetries = 4;                                                     ///< Retries after the first failed charge
+    std::chrono::system_clock::duration retryBaseDelay = std::chrono::hours(1); ///< Doubles on each retry
+    std::chrono::system_clock::duration jitterWindow = std::chrono::hours(1);   ///< Spread of billing times after the nominal time
+    std::chrono::milliseconds pollInterval = std::chrono::seconds(60);      ///< How often the billing thread looks for due charges
+};
+
+/**
+ * @struct SubscriptionStatistics
+ * @brief Counters describing subscription billing
+ */
+struct SubscriptionStatistics {
+    std::uint64_t batches;
+    std::uint64_t charges;
+    std::uint64_t approved;
+    std::uint64_t failed;
+    std::uint64_t heldForReview;
+    std::uint64_t retriesScheduled;
+    std::uint64_t pastDue;
+    std::uint64_t persistFailures;
+    std::size_t active;
+};
+
+/**
+ * @class SubscriptionManager
+ * @brief Stores recurring payment schedules and bills them through the gateway
+ *
+ * Due subscriptions are kept in a set ordered by billing time, so finding
+ * the next batch never scans subscriptions that are not due. Charges are
+ * built for up to batchSize subscriptions at a time and submitted together
+ * through PaymentGateway::processTransactionBatch, which validates their
+ * cards and scores them for fraud a batch at a time; with a DataManager the
+ * resulting transactions are written in one storage transaction per batch.
+ *
+ * Each subscription is billed at a fixed offset within jitterWindow after
+ * its nominal time, derived from its ID, so schedules created for the top of
+ * the hour are spread out rather than arriving together. Cycles missed
+ * while billing was not running are skipped rather than charged at once.
+ * A declined or rejected charge is retried after retryBaseDelay, doubling
+ * each time, with random jitter; after maxRetries further failures the
+ * subscription becomes PAST_DUE.
+ *
+ * A charge flagged for manual fraud review is neither: the subscription is
+ * not billed again until the review is resolved. The manager observes the
+ * gateway and, when the reviewer decides, treats an approval as a completed
+ * cycle and a decline as a failed charge.
+ */
+class SubscriptionManager : public TransactionObserver {
+public:
+    /**
+     * @brief Constructor
+     * @param gateway The gateway that processes the charges
+     * @param config Batching, spreading and retry settings
+     * @param dataManager Optional storage for the charge transactions
+     */
+    explicit SubscriptionManager(PaymentGateway& gateway,
+                                 const SubscriptionConfig& config = SubscriptionConfig(),
+                                 DataManager* dataManager = nullptr);
+
+    /**
+     * @brief Destructor; stops the billing thread and stops observing the gateway
+     */
+    ~SubscriptionManager() override;
+
+    SubscriptionManager(const SubscriptionManager&) = delete;
+    SubscriptionManager& operator=(const SubscriptionManager&) = delete;
+
+    /**
+     * @brief Create a subscription
+     * @param customer The customer being charged
+     * @param merchant The merchant being paid
+     * @param paymentMethodType "Credit Card", "Debit Card" or "Digital Wallet"
+     * @param paymentDetails Payment method details, as for PaymentGatewayFacade::processPayment
+     * @param amount The amount charged each cycle
+     * @param interval The billing interval
+     * @param firstBillingAt Nominal time of the first charge
+     * @return The subscription ID
+     */
+    std::string addSubscription(const Customer& customer,
+                                const Merchant& merchant,
+                                const std::string& paymentMethodType,
+                                const std::vector<std::string>& paymentDetails,
+                                double amount,
+                                BillingInterval interval,
+                                std::chrono::system_clock::time_point firstBillingAt = std::chrono::system_clock::now());
+
+    /**
+     * @brief Cancel a subscription; a charge already submitted still completes
+     * @param subscriptionId The subscription ID
+     * @return False if the subscription does not exist or is already cancelled
+     */
+    bool cancelSubscription(const std::string& subscriptionId);
+
+    /**
+     * @brief Resume billing a PAST_DUE subscription, retrying the failed cycle immediately
+     * @param subscriptionId The subscription ID
+     * @return False if the subscription is not PAST_DUE
+     */
+    bool reactivateSubscription(const std::string& subscriptionId);
+
+    /**
+     * @brief Get a copy of a subscription
+     * @param subscriptionId The subscription ID
+     * @param subscription Receives the subscription
+     * @return False if the subscription does not exist
+     */
+    bool getSubscription(const std::string& subscriptionId, Subscription& subscription) const;
+
+    /**
+     * @brief Charge every subscription due at or before a point in time
+     * @param now The billing time
+     * @return The number of charges submitted
+     */
+    std::size_t billDue(std::chrono::system_clock::time_point now = std::chrono::system_clock::now());
+
+    /**
+     * @brief Start billing due subscriptions every pollInterval on a background thread
+     */
+    void start();
+
+    /**
+     * @brief Stop the billing thread after its current batch
+     */
+    void stop();
+
+    /**
+     * @brief Get billing counters
+     * @return Snapshot of the subscription statistics
+     */
+    SubscriptionStatistics getStatistics() const;
+
+    /**
+     * @brief Convert a subscription status to a string
+     * @param status The subscription status
+     * @return The status as a string
+     */
+    static std::string statusToString(SubscriptionStatus status);
+
+    /**
+     * @brief Resolve a charge held for review once the reviewer approves or declines it
+     * @param transaction The updated transaction
+     */
+    void onTransactionUpdated(const Transaction& transaction) override;
+
+private:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    struct Record {
+        Subscription subscription;
+        TimePoint anchor;       ///< Nominal time of the first charge
+        std::uint64_t cycle;    ///< Billing cycles completed since the anchor
+    };
+
+    /**
+     * @brief Take up to batchSize due subscriptions off the due set
+     * @param now The billing time
+     * @return Copies of the subscriptions to charge
+     */
+    std::vector<Subscription> takeDueBatch(TimePoint now);
+
+    /**
+     * @brief Update subscriptions with the outcome of their charges and persist the transactions
+     * @param batch The subscriptions that were charged
+     * @param results Gateway results, in the same order; an empty transaction ID means no charge was made
+     * @param now The billing time
+     */
+    void applyResults(const std::vector<Subscription>& batch,
+                      const std::vector<PaymentResult>& results,
+                      TimePoint now);
+
+    /**
+     * @brief Apply the final outcome of a charge to an active subscription; caller holds m_mutex
+     * @param record The subscription
+     * @param approved Whether the charge was approved
+     * @param now The time the outcome is known
+     */
+    void settleChargeLocked(Record& record, bool approved, TimePoint now);
+
+    /**
+     * @brief Nominal time of a billing cycle; caller holds m_mutex
+     * @param record The subscription
+     * @return The anchor advanced by record.cycle intervals
+     */
+    static TimePoint nominalTime(const Record& record);
+
+    /**
+     * @brief Fixed offset, within the jitter window, at which a subscription is billed
+     * @param subscriptionId The subscription ID
+     * @return The offset after the nominal time
+     */
+    std::chrono::system_clock::duration billingOffset(const std::string& subscriptionId) const;
+
+    /**
+     * @brief Put a subscription on the due set at a new time; caller holds m_mutex
+     * @param record The subscription
+     * @param at The billing time
+     */
+    void scheduleLocked(Record& record, TimePoint at);
+
+    /**
+     * @brief Billing thread main loop
+     */
+    void run();
+
+    PaymentGateway& m_gateway;
+    SubscriptionConfig m_config;
+    DataManager* m_dataManager;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Record> m_subscriptions;
+    std::set<std::pair<TimePoint, std::string>> m_due;
+    std::unordered_map<std::string, std::string> m_inReview; ///< Transaction ID -> subscription ID
+    std::uint64_t m_nextId;
+    std::mt19937 m_random;
+
+    // Serializes billing runs so a manual billDue() and the thread never submit the same batch twice
+    std::mutex m_billingMutex;
+
+    std::mutex m_threadMutex;
+    std::condition_variable m_threadCondition;
+    bool m_running;
+    std::thread m_thread;
+
+    std::atomic<std::uint64_t> m_batches;
+    std::atomic<std::uint64_t> m_charges;
+    std::atomic<std::uint64_t> m_approved;
+    std::atomic<std::uint64_t> m_failed;
+    std::atomic<std::uint64_t> m_heldForReview;
+    std::atomic<std::uint64_t> m_retriesScheduled;
+    std::atomic<std::uint64_t> m_pastDue;
+    std::atomic<std::uint64_t> m_persistFailures;
+};
+
+#endif // SUBSCRIPTIONMANAGER_H
@@ -0,0 +1,285 @@
+#include "timingwheel.h"
+#include <algorithm>
+#include <iostream>
+
+TimingWheel& TimingWheel::getInstance() {
+    static TimingWheel instance(std::chrono::milliseconds(1),
+                                std::max(2u, std::thread::hardware_concurrency()));
+    return instance;
+}
+
+TimingWheel::TimingWheel(std::chrono::microseconds tick, std::size_t workerCount)
+    : m_tick(std::max<Clock::duration>(tick, std::chrono::microseconds(1))),
+      m_start(Clock::now()),
+      m_freeList(kNone),
+      m_allocated(0),
+      m_pending(0),
+      m_currentTick(0),
+      m_stopping(false),
+      m_workStopping(false) {
+    m_slots.fill(kNone);
+
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&TimingWheel::work, this);
+    }
+    m_driver = std::thread(&TimingWheel::run, this);
+}
+
+TimingWheel::~TimingWheel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    if (m_driver.joinable()) {
+        m_driver.join();
+    }
+
+    // Callbacks that already fired still run before the workers exit
+    {
+        std::lock_guard<std::mutex> lock(m_workMutex);
+        m_workStopping = true;
+    }
+    m_workCondition.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+TimingWheel::TimerId TimingWheel::schedule(Clock::duration delay, std::function<void()> callback) {
+    Clock::time_point now = Clock::now();
+    Clock::duration sinceStart = std::max(now + delay - m_start, Clock::duration::zero());
+    std::uint64_t due = static_cast<std::uint64_t>((sinceStart + m_tick - Clock::duration(1)) / m_tick);
+
+    TimerId id;
+    bool wasIdle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // An empty wheel is not ticked, so catch it up before placing the timer
+        wasIdle = m_pending == 0;
+        if (wasIdle) {
+            m_currentTick = std::max(m_currentTick, tickAt(now));
+        }
+
+        std::uint32_t index = allocateLocked();
+        Node& timer = node(index);
+        timer.callback = std::move(callback);
+        timer.due = std::max(due, m_currentTick + 1);
+        insertLocked(index);
+        ++m_pending;
+
+        id = (static_cast<TimerId>(timer.generation) << 32) | index;
+    }
+
+    if (wasIdle) {
+        m_condition.notify_one();
+    }
+
+    return id;
+}
+
+bool TimingWheel::cancel(TimerId id) {
+    std::uint32_t index = static_cast<std::uint32_t>(id);
+    std::uint32_t generation = static_cast<std::uint32_t>(id >> 32);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index >= m_allocated) {
+        return false;
+    }
+
+    Node& timer = node(index);
+    if (!timer.linked || timer.generation != generation) {
+        return false; // Fired, cancelled, or the slot has been reused
+    }
+
+    unlinkLocked(index);
+    freeLocked(index);
+    --m_pending;
+    return true;
+}
+
+std::size_t TimingWheel::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending;
+}
+
+TimingWheel::Node& TimingWheel::node(std::uint32_t index) {
+    return m_chunks[index >> kChunkBits][index & (kChunkSize - 1)];
+}
+
+std::uint32_t TimingWheel::allocateLocked() {
+    std::uint32_t index;
+    if (m_freeList != kNone) {
+        index = m_freeList;
+        m_freeList = node(index).next;
+    } else {
+        if ((m_allocated & (kChunkSize - 1)) == 0) {
+            m_chunks.emplace_back(new Node[kChunkSize]);
+        }
+        index = m_allocated++;
+    }
+
+    Node& timer = node(index);
+    if (++timer.generation == 0) {
+        timer.generation = 1;
+    }
+    return index;
+}
+
+void TimingWheel::freeLocked(std::uint32_t index) {
+    Node& timer = node(index);
+    timer.callback = nullptr;
+    timer.linked = false;
+    timer.prev = kNone;
+    timer.next = m_freeList;
+    m_freeList = index;
+}
+
+void TimingWheel::insertLocked(std::uint32_t index) {
+    Node& timer = node(index);
+    std::uint64_t delta = timer.due > m_currentTick ? timer.due - m_currentTick : 0;
+
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (std::uint64_t(1) << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+
+    // Beyond the top wheel's span: park in its last slot and re-place on cascade
+    std::uint64_t position = timer.due;
+    if (delta >= (std::uint64_t(1) << (kSlotBits * kLevels))) {
+        position = m_currentTick + (std::uint64_t(1) << (kSlotBits * kLevels)) - 1;
+    }
+
+    std::uint16_t slot = static_cast<std::uint16_t>(
+        level * kSlots + ((position >> (kSlotBits * level)) & (kSlots - 1)));
+
+    timer.slot = slot;
+    timer.prev = kNone;
+    timer.next = m_slots[slot];
+    timer.linked = true;
+    if (timer.next != kNone) {
+        node(timer.next).prev = index;
+    }
+    m_slots[slot] = index;
+}
+
+void TimingWheel::unlinkLocked(std::uint32_t index) {
+    Node& timer = node(index);
+    if (timer.prev != kNone) {
+        node(timer.prev).next = timer.next;
+    } else {
+        m_slots[timer.slot] = timer.next;
+    }
+    if (timer.next != kNone) {
+        node(timer.next).prev = timer.prev;
+    }
+    timer.linked = false;
+}
+
+void TimingWheel::advanceLocked(std::vector<std::function<void()>>& expired) {
+    ++m_currentTick;
+
+    // Coarser slots whose span starts at this tick move down to finer wheels
+    for (int level = kLevels - 1; level > 0; --level) {
+        std::uint64_t span = std::uint64_t(1) << (kSlotBits * level);
+        if (m_currentTick % span != 0) {
+            continue;
+        }
+
+        std::uint32_t slot = level * kSlots + ((m_currentTick >> (kSlotBits * level)) & (kSlots - 1));
+        std::uint32_t index = m_slots[slot];
+        m_slots[slot] = kNone;
+        while (index != kNone) {
+            std::uint32_t next = node(index).next;
+            insertLocked(index);
+            index = next;
+        }
+    }
+
+    std::uint32_t slot = m_currentTick & (kSlots - 1);
+    std::uint32_t index = m_slots[slot];
+    m_slots[slot] = kNone;
+    while (index != kNone) {
+        Node& timer = node(index);
+        std::uint32_t next = timer.next;
+        expired.push_back(std::move(timer.callback));
+        freeLocked(index);
+        --m_pending;
+        index = next;
+    }
+}
+
+std::uint64_t TimingWheel::tickAt(Clock::time_point time) const {
+    if (time <= m_start) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>((time - m_start) / m_tick);
+}
+
+void TimingWheel::invoke(std::function<void()>& callback) {
+    try {
+        callback();
+    } catch (const std::exception& e) {
+        std::cerr << "Timer callback failed: " << e.what() << std::endl;
+    }
+}
+
+void TimingWheel::run() {
+    std::vector<std::function<void()>> expired;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        if (m_pending == 0) {
+            m_condition.wait(lock, [this] { return m_pending > 0 || m_stopping; });
+            continue;
+        }
+
+        std::uint64_t target = tickAt(Clock::now());
+        if (m_currentTick >= target) {
+            m_condition.wait_until(lock, m_start + m_tick * static_cast<Clock::rep>(m_currentTick + 1));
+            continue;
+        }
+
+        while (m_currentTick < target && m_pending > 0) {
+            advanceLocked(expired);
+        }
+        if (expired.empty()) {
+            continue;
+        }
+
+        lock.unlock();
+        if (m_workers.empty()) {
+            for (auto& callback : expired) {
+                invoke(callback);
+            }
+        } else {
+            {
+                std::lock_guard<std::mutex> workLock(m_workMutex);
+                for (auto& callback : expired) {
+                    m_work.push_back(std::move(callback));
+                }
+            }
+            m_workCondition.notify_all();
+        }
+        expired.clear();
+        lock.lock();
+    }
+}
+
+void TimingWheel::work() {
+    std::unique_lock<std::mutex> lock(m_workMutex);
+    while (true) {
+        m_workCondition.wait(lock, [this] { return !m_work.empty() || m_workStopping; });
+        if (m_work.empty()) {
+            return;
+        }
+
+        std::function<void()> callback = std::move(m_work.front());
+        m_work.pop_front();
+
+        lock.unlock();
+        invoke(callback);
+        lock.lock();
+    }
+}
@@ -0,0 +1,179 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class TimingWheel
+ * @brief Hierarchical timing wheel that runs delayed callbacks on a worker pool
+ *
+ * Four wheels of 256 slots each cover 2^32 ticks; a timer goes into the
+ * wheel whose span contains its due tick and is cascaded into the next finer
+ * wheel when the coarser slot comes round. Timer nodes live in a slab of
+ * fixed-size chunks and are linked into their slot by index, so scheduling
+ * and cancelling are O(1) whatever the number of pending timers, and growing
+ * the slab never moves existing nodes.
+ *
+ * One driver thread advances the wheels a tick at a time and hands expired
+ * callbacks to the workers. With no workers, callbacks run on the driver
+ * thread and must be short. Timers never fire early; they fire up to one
+ * tick late.
+ */
+class TimingWheel {
+public:
+    using TimerId = std::uint64_t;
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Get the shared scheduler
+     * @return Reference to the process-wide instance, with a 1 ms tick
+     */
+    static TimingWheel& getInstance();
+
+    /**
+     * @brief Constructor; starts the driver and worker threads
+     * @param tick Resolution of the wheel
+     * @param workerCount Threads that run callbacks; 0 runs them on the driver thread
+     */
+    explicit TimingWheel(std::chrono::microseconds tick = std::chrono::milliseconds(1),
+                         std::size_t workerCount = 2);
+
+    /**
+     * @brief Destructor; stops all threads, dropping timers that have not fired
+     */
+    ~TimingWheel();
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    /**
+     * @brief Schedule a callback
+     * @param delay Time from now until the callback runs
+     * @param callback The callback to run
+     * @return ID that can be passed to cancel(); never 0
+     */
+    TimerId schedule(Clock::duration delay, std::function<void()> callback);
+
+    /**
+     * @brief Cancel a timer that has not fired yet
+     * @param id The timer ID
+     * @return True if the timer was pending and is now cancelled
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief Get the number of pending timers
+     * @return The number of timers that have not fired or been cancelled
+     */
+    std::size_t getPendingCount() const;
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 8;
+    static constexpr std::uint32_t kSlots = 1u << kSlotBits;
+    static constexpr std::uint32_t kChunkBits = 12;
+    static constexpr std::uint32_t kChunkSize = 1u << kChunkBits;
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+    struct Node {
+        std::function<void()> callback;
+        std::uint64_t due = 0;          ///< Absolute tick the timer fires on
+        std::uint32_t generation = 0;   ///< Bumped on every reuse so stale IDs are rejected
+        std::uint32_t prev = kNone;
+        std::uint32_t next = kNone;
+        std::uint16_t slot = 0;         ///< level * kSlots + slot index
+        bool linked = false;
+    };
+
+    /**
+     * @brief Look up a node by slab index; caller holds m_mutex
+     * @param index The node index
+     * @return Reference to the node
+     */
+    Node& node(std::uint32_t index);
+
+    /**
+     * @brief Take a node from the free list, growing the slab if needed; caller holds m_mutex
+     * @return The node index
+     */
+    std::uint32_t allocateLocked();
+
+    /**
+     * @brief Return a node to the free list; caller holds m_mutex
+     * @param index The node index
+     */
+    void freeLocked(std::uint32_t index);
+
+    /**
+     * @brief Link a node into the slot for its due tick; caller holds m_mutex
+     * @param index The node index
+     */
+    void insertLocked(std::uint32_t index);
+
+    /**
+     * @brief Unlink a node from its slot; caller holds m_mutex
+     * @param index The node index
+     */
+    void unlinkLocked(std::uint32_t index);
+
+    /**
+     * @brief Advance one tick, collecting expired callbacks; caller holds m_mutex
+     * @param expired Receives the callbacks due on the new tick
+     */
+    void advanceLocked(std::vector<std::function<void()>>& expired);
+
+    /**
+     * @brief Get the tick the wheel should have reached at a point in time
+     * @param time The point in time
+     * @return Ticks since construction, rounded down
+     */
+    std::uint64_t tickAt(Clock::time_point time) const;
+
+    /**
+     * @brief Run a callback, logging anything it throws
+     * @param callback The callback
+     */
+    static void invoke(std::function<void()>& callback);
+
+    /**
+     * @brief Driver thread main loop
+     */
+    void run();
+
+    /**
+     * @brief Worker thread main loop
+     */
+    void work();
+
+    Clock::duration m_tick;
+    Clock::time_point m_start;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<std::unique_ptr<Node[]>> m_chunks;
+    std::array<std::uint32_t, kLevels * kSlots> m_slots;
+    std::uint32_t m_freeList;
+    std::uint32_t m_allocated;
+    std::size_t m_pending;
+    std::uint64_t m_currentTick;
+    bool m_stopping;
+
+    std::mutex m_workMutex;
+    std::condition_variable m_workCondition;
+    std::deque<std::function<void()>> m_work;
+    bool m_workStopping;
+
+    std::thread m_driver;
+    std::vector<std::thread> m_workers;
+};
+
+#endif // TIMINGWHEEL_H
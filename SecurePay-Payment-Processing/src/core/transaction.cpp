@@ -1,6 +1,6 @@
 #include "transaction.h"
 #include "merchant.h"
-#include <random>
+#include "idgenerator.h"
 #include <sstream>
 #include <iomanip>
 #include <iostream>
@@ -8,13 +8,19 @@
 // Transaction implementation
 Transaction::Transaction(const Customer& customer, const Merchant& merchant,
                          std::unique_ptr<PaymentMethod> paymentMethod, double amount)
-    : m_customer(customer),
+    : Transaction(customer, merchant, std::move(paymentMethod), amount, generateTransactionId()) {
+}
+
+Transaction::Transaction(const Customer& customer, const Merchant& merchant,
+                         std::unique_ptr<PaymentMethod> paymentMethod, double amount,
+                         const std::string& transactionId)
+    : m_transactionId(transactionId),
+      m_customer(customer),
       m_merchant(merchant),
       m_paymentMethod(std::move(paymentMethod)),
       m_amount(amount),
       m_refundedAmount(0.0),
       m_timestamp(std::chrono::system_clock::now()) {
-    m_transactionId = generateTransactionId();
     m_state = std::make_unique<PendingState>();
 }
 
@@ -39,17 +45,26 @@ double Transaction::getAmount() const {
 }
 
 double Transaction::getRemainingAmount() const {
+    std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
     return m_amount - m_refundedAmount;
 }
 
 double Transaction::getRefundedAmount() const {
+    std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
     return m_refundedAmount;
 }
 
 TransactionStatus Transaction::getStatus() const {
+    std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
     return m_state->getStatus();
 }
 
+std::string Transaction::getRejectionReason() const {
+    std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
+    const auto* rejected = dynamic_cast<const RejectedState*>(m_state.get());
+    return rejected ? rejected->getReason() : std::string();
+}
+
 std::string Transaction::getTimestamp() const {
     auto time = std::chrono::system_clock::to_time_t(m_timestamp);
     std::stringstream ss;
@@ -57,19 +72,37 @@ std::string Transaction::getTimestamp() const {
     return ss.str();
 }
 
+std::chrono::system_clock::time_point Transaction::getCreatedAt() const {
+    return m_timestamp;
+}
+
+std::chrono::system_clock::time_point Transaction::getApprovedAt() const {
+    std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
+    return m_approvedAt;
+}
+
 bool Transaction::process() {
+    // Held across the state's own setState() and addRefundedAmount() calls, so a transition is atomic
+    std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
     return m_state->process(*this);
 }
 
 bool Transaction::refund(double amount) {
+    std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
     return m_state->refund(*this, amount);
 }
 
 void Transaction::setState(std::unique_ptr<TransactionState> state) {
+    std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
     m_state = std::move(state);
+    if (m_approvedAt == std::chrono::system_clock::time_point() &&
+        m_state->getStatus() == TransactionStatus::APPROVED) {
+        m_approvedAt = std::chrono::system_clock::now();
+    }
 }
 
 void Transaction::addRefundedAmount(double amount) {
+    std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
     m_refundedAmount += amount;
 }
 
@@ -87,29 +120,15 @@ std::string Transaction::statusToString(TransactionStatus status) {
             return "Refunded";
         case TransactionStatus::PARTIALLY_REFUNDED:
             return "Partially Refunded";
+        case TransactionStatus::REJECTED:
+            return "Rejected";
         default:
             return "Unknown";
     }
 }
 
 std::string Transaction::generateTransactionId() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 15);
-    
-    const char* hex_chars = "0123456789ABCDEF";
-    
-    std::stringstream ss;
-    ss << "TX-";
-    for (int i = 0; i < 8; ++i) {
-        ss << hex_chars[dis(gen)];
-    }
-    ss << "-";
-    for (int i = 0; i < 4; ++i) {
-        ss << hex_chars[dis(gen)];
-    }
-    
-    return ss.str();
+    return IdGenerator::generate("TX");
 }
 
 // TransactionFactory implementation
@@ -119,6 +138,13 @@ std::unique_ptr<Transaction> TransactionFactory::createTransaction(
     return std::make_unique<Transaction>(customer, merchant, std::move(paymentMethod), amount);
 }
 
+std::unique_ptr<Transaction> TransactionFactory::createTransaction(
+    const Customer& customer, const Merchant& merchant,
+    std::unique_ptr<PaymentMethod> paymentMethod, double amount,
+    const std::string& transactionId) {
+    return std::make_unique<Transaction>(customer, merchant, std::move(paymentMethod), amount, transactionId);
+}
+
 // PendingState implementation
 bool PendingState::process(Transaction& transaction) {
     std::cout << "Processing transaction " << transaction.getTransactionId() << " from pending state" << std::endl;
@@ -262,3 +288,30 @@ TransactionStatus PartiallyRefundedState::getStatus() const {
 std::string PartiallyRefundedState::toString() const {
     return "Partially Refunded";
 }
+
+// RejectedState implementation
+RejectedState::RejectedState(const std::string& reason)
+    : m_reason(reason) {
+}
+
+bool RejectedState::process(Transaction& /*transaction*/) {
+    std::cout << "Cannot process a rejected transaction" << std::endl;
+    return false;
+}
+
+bool RejectedState::refund(Transaction& /*transaction*/, double /*amount*/) {
+    std::cout << "Cannot refund a rejected transaction" << std::endl;
+    return false;
+}
+
+TransactionStatus RejectedState::getStatus() const {
+    return TransactionStatus::REJECTED;
+}
+
+std::string RejectedState::toString() const {
+    return "Rejected: " + m_reason;
+}
+
+const std::string& RejectedState::getReason() const {
+    return m_reason;
+}
@@ -4,6 +4,7 @@
 #include <string>
 #include <memory>
 #include <chrono>
+#include <mutex>
 #include <vector>
 #include "customer.h"
 #include "merchant.h"
@@ -23,7 +24,8 @@ enum class TransactionStatus {
     DECLINED,
     FLAGGED_FOR_REVIEW,
     REFUNDED,
-    PARTIALLY_REFUNDED
+    PARTIALLY_REFUNDED,
+    REJECTED
 };
 
 /**
@@ -72,6 +74,10 @@ public:
  * This class follows the State Pattern to manage transaction states
  * and the Single Responsibility Principle by focusing on transaction data
  * and operations.
+ *
+ * The state and refunded amount may change on one thread, e.g. when a
+ * review is resolved, while others read the status, so both are guarded by
+ * a mutex. It is recursive because states call back into the transaction.
  */
 class Transaction {
 public:
@@ -85,6 +91,18 @@ public:
     Transaction(const Customer& customer, const Merchant& merchant, 
                 std::unique_ptr<PaymentMethod> paymentMethod, double amount);
     
+    /**
+     * @brief Constructor for a transaction whose ID was generated beforehand
+     * @param customer The customer making the payment
+     * @param merchant The merchant receiving the payment
+     * @param paymentMethod The payment method used
+     * @param amount The transaction amount
+     * @param transactionId An ID from generateTransactionId()
+     */
+    Transaction(const Customer& customer, const Merchant& merchant, 
+                std::unique_ptr<PaymentMethod> paymentMethod, double amount,
+                const std::string& transactionId);
+    
     /**
      * @brief Virtual destructor
      */
@@ -138,12 +156,33 @@ public:
      */
     virtual TransactionStatus getStatus() const;
     
+    /**
+     * @brief Get why the transaction was rejected
+     * @return The reason given to its RejectedState, or an empty string if it is not rejected
+     */
+    virtual std::string getRejectionReason() const;
+    
     /**
      * @brief Get the timestamp of when the transaction was created
      * @return The timestamp as a string
      */
     virtual std::string getTimestamp() const;
     
+    /**
+     * @brief Get the time the transaction was created
+     * @return The creation time point, suitable for ordering and range queries
+     */
+    virtual std::chrono::system_clock::time_point getCreatedAt() const;
+    
+    /**
+     * @brief Get the time the transaction was first approved
+     *
+     * Differs from the creation time when approval waited for a fraud review.
+     *
+     * @return The approval time point, or a default-constructed one if never approved
+     */
+    virtual std::chrono::system_clock::time_point getApprovedAt() const;
+    
     /**
      * @brief Process the transaction
      * @return True if processing was successful, false otherwise
@@ -176,21 +215,23 @@ public:
      */
     static std::string statusToString(TransactionStatus status);
     
+    /**
+     * @brief Generate a unique transaction ID
+     * @return A unique transaction ID
+     */
+    static std::string generateTransactionId();
+    
 private:
     std::string m_transactionId;
     Customer m_customer;
     Merchant m_merchant;
     std::unique_ptr<PaymentMethod> m_paymentMethod;
     double m_amount;
+    mutable std::recursive_mutex m_stateMutex;   ///< Guards m_refundedAmount, m_state and m_approvedAt
     double m_refundedAmount;
     std::unique_ptr<TransactionState> m_state;
     std::chrono::system_clock::time_point m_timestamp;
-    
-    /**
-     * @brief Generate a unique transaction ID
-     * @return A unique transaction ID
-     */
-    static std::string generateTransactionId();
+    std::chrono::system_clock::time_point m_approvedAt;
 };
 
 /**
@@ -210,6 +251,20 @@ public:
     static std::unique_ptr<Transaction> createTransaction(
         const Customer& customer, const Merchant& merchant,
         std::unique_ptr<PaymentMethod> paymentMethod, double amount);
+    
+    /**
+     * @brief Create a new transaction under an ID generated beforehand
+     * @param customer The customer making the payment
+     * @param merchant The merchant receiving the payment
+     * @param paymentMethod The payment method used
+     * @param amount The transaction amount
+     * @param transactionId An ID from Transaction::generateTransactionId()
+     * @return A unique pointer to the created transaction
+     */
+    static std::unique_ptr<Transaction> createTransaction(
+        const Customer& customer, const Merchant& merchant,
+        std::unique_ptr<PaymentMethod> paymentMethod, double amount,
+        const std::string& transactionId);
 };
 
 /**
@@ -284,4 +339,31 @@ public:
     std::string toString() const override;
 };
 
+/**
+ * @class RejectedState
+ * @brief Represents a transaction turned away before authorization, e.g. by admission control
+ */
+class RejectedState : public TransactionState {
+public:
+    /**
+     * @brief Constructor
+     * @param reason Why the transaction was not accepted for processing
+     */
+    explicit RejectedState(const std::string& reason);
+    
+    bool process(Transaction& transaction) override;
+    bool refund(Transaction& transaction, double amount) override;
+    TransactionStatus getStatus() const override;
+    std::string toString() const override;
+    
+    /**
+     * @brief Get the rejection reason
+     * @return The reason the transaction was rejected
+     */
+    const std::string& getReason() const;
+    
+private:
+    std::string m_reason;
+};
+
 #endif // TRANSACTION_H
@@ -48,6 +48,10 @@ std::string TransactionDecorator::getTimestamp() const {
     return m_transaction->getTimestamp();
 }
 
+std::chrono::system_clock::time_point TransactionDecorator::getCreatedAt() const {
+    return m_transaction->getCreatedAt();
+}
+
 bool TransactionDecorator::process() {
     return m_transaction->process();
 }
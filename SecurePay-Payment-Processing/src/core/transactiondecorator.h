@@ -72,6 +72,12 @@ public:
      */
     std::string getTimestamp() const override;
     
+    /**
+     * @brief Get the time the transaction was created
+     * @return The creation time point
+     */
+    std::chrono::system_clock::time_point getCreatedAt() const override;
+    
     /**
      * @brief Process the transaction
      * @return True if processing was successful, false otherwise
@@ -0,0 +1,116 @@
+#include "transactioneventbus.h"
+#include <algorithm>
+#include <iostream>
+
+// TransactionObserver implementation
+void TransactionObserver::onTransactionsUpdated(const std::vector<const Transaction*>& transactions) {
+    for (const Transaction* transaction : transactions) {
+        onTransactionUpdated(*transaction);
+    }
+}
+
+// TransactionEventBus implementation
+TransactionEventBus::TransactionEventBus(std::size_t maxBatchSize)
+    : m_maxBatchSize(maxBatchSize > 0 ? maxBatchSize : 1),
+      m_dispatching(false),
+      m_stopping(false) {
+    m_dispatcher = std::thread(&TransactionEventBus::dispatchLoop, this);
+}
+
+TransactionEventBus::~TransactionEventBus() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopping = true;
+    }
+    m_queueCondition.notify_all();
+
+    if (m_dispatcher.joinable()) {
+        m_dispatcher.join();
+    }
+}
+
+void TransactionEventBus::subscribe(TransactionObserver* observer) {
+    if (!observer) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_subscribersMutex);
+    m_subscribers.push_back(observer);
+}
+
+void TransactionEventBus::unsubscribe(TransactionObserver* observer) {
+    std::lock_guard<std::mutex> lock(m_subscribersMutex);
+    auto it = std::find(m_subscribers.begin(), m_subscribers.end(), observer);
+    if (it != m_subscribers.end()) {
+        m_subscribers.erase(it);
+    }
+}
+
+void TransactionEventBus::publish(const Transaction& transaction) {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (!m_pendingSet.insert(&transaction).second) {
+            return; // Already queued; the pending notification will show the latest state
+        }
+        m_pending.push_back(&transaction);
+    }
+    m_queueCondition.notify_one();
+}
+
+void TransactionEventBus::flush() {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    m_drainedCondition.wait(lock, [this]() {
+        return m_pending.empty() && !m_dispatching;
+    });
+}
+
+std::size_t TransactionEventBus::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return m_pending.size();
+}
+
+void TransactionEventBus::dispatchLoop() {
+    std::vector<const Transaction*> batch;
+    batch.reserve(m_maxBatchSize);
+
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    while (true) {
+        m_queueCondition.wait(lock, [this]() {
+            return m_stopping || !m_pending.empty();
+        });
+
+        if (m_pending.empty()) {
+            break; // Stopping with nothing left to deliver
+        }
+
+        std::size_t count = std::min(m_pending.size(), m_maxBatchSize);
+        batch.assign(m_pending.begin(), m_pending.begin() + count);
+        m_pending.erase(m_pending.begin(), m_pending.begin() + count);
+        for (const Transaction* transaction : batch) {
+            m_pendingSet.erase(transaction);
+        }
+        m_dispatching = true;
+
+        lock.unlock();
+        deliver(batch);
+        lock.lock();
+
+        m_dispatching = false;
+        if (m_pending.empty()) {
+            m_drainedCondition.notify_all();
+        }
+    }
+
+    m_drainedCondition.notify_all();
+}
+
+void TransactionEventBus::deliver(const std::vector<const Transaction*>& batch) {
+    std::lock_guard<std::mutex> lock(m_subscribersMutex);
+    for (TransactionObserver* observer : m_subscribers) {
+        try {
+            observer->onTransactionsUpdated(batch);
+        } catch (const std::exception& e) {
+            std::cerr << "Transaction observer failed: " << e.what() << std::endl;
+        }
+    }
+}
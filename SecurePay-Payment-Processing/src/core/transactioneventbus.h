@@ -0,0 +1,126 @@
+#ifndef TRANSACTIONEVENTBUS_H
+#define TRANSACTIONEVENTBUS_H
+
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstddef>
+#include "transaction.h"
+
+/**
+ * @class TransactionObserver
+ * @brief Observer interface for transaction updates (Observer Pattern)
+ */
+class TransactionObserver {
+public:
+    virtual ~TransactionObserver() = default;
+
+    /**
+     * @brief Called when a transaction has been updated
+     * @param transaction The updated transaction
+     */
+    virtual void onTransactionUpdated(const Transaction& transaction) = 0;
+
+    /**
+     * @brief Called with a batch of updated transactions
+     *
+     * The default implementation forwards each transaction to
+     * onTransactionUpdated(); override it to handle a batch in one go.
+     *
+     * @param transactions The updated transactions, each listed once
+     */
+    virtual void onTransactionsUpdated(const std::vector<const Transaction*>& transactions);
+};
+
+/**
+ * @class TransactionEventBus
+ * @brief Delivers transaction updates to observers on a dedicated thread
+ *
+ * Publishing only enqueues the transaction, so observer cost never lands on
+ * the thread that processed the payment. Updates to a transaction that is
+ * still waiting for delivery are coalesced: observers read the transaction's
+ * current state when the batch is delivered, so one notification covers them.
+ *
+ * Observers are called with the subscriber list locked; they must not
+ * subscribe or unsubscribe from inside a callback.
+ */
+class TransactionEventBus {
+public:
+    /**
+     * @brief Constructor; starts the dispatch thread
+     * @param maxBatchSize Maximum number of transactions delivered per batch
+     */
+    explicit TransactionEventBus(std::size_t maxBatchSize = 256);
+
+    /**
+     * @brief Destructor; delivers anything still queued and stops the dispatch thread
+     */
+    ~TransactionEventBus();
+
+    TransactionEventBus(const TransactionEventBus&) = delete;
+    TransactionEventBus& operator=(const TransactionEventBus&) = delete;
+
+    /**
+     * @brief Register an observer
+     * @param observer The observer to add
+     */
+    void subscribe(TransactionObserver* observer);
+
+    /**
+     * @brief Unregister an observer
+     *
+     * Blocks until any batch currently being delivered has finished, so the
+     * observer is never called after this returns.
+     *
+     * @param observer The observer to remove
+     */
+    void unsubscribe(TransactionObserver* observer);
+
+    /**
+     * @brief Queue an update for delivery
+     * @param transaction The updated transaction; must outlive its delivery
+     */
+    void publish(const Transaction& transaction);
+
+    /**
+     * @brief Block until every update published so far has been delivered
+     */
+    void flush();
+
+    /**
+     * @brief Get the number of updates waiting for delivery
+     * @return The queue depth
+     */
+    std::size_t getPendingCount() const;
+
+private:
+    /**
+     * @brief Dispatch thread main loop
+     */
+    void dispatchLoop();
+
+    /**
+     * @brief Deliver one batch to every subscriber
+     * @param batch The transactions to deliver
+     */
+    void deliver(const std::vector<const Transaction*>& batch);
+
+    std::size_t m_maxBatchSize;
+
+    mutable std::mutex m_queueMutex;
+    std::condition_variable m_queueCondition;
+    std::condition_variable m_drainedCondition;
+    std::vector<const Transaction*> m_pending;
+    std::unordered_set<const Transaction*> m_pendingSet;
+    bool m_dispatching;
+    bool m_stopping;
+
+    std::mutex m_subscribersMutex;
+    std::vector<TransactionObserver*> m_subscribers;
+
+    std::thread m_dispatcher;
+};
+
+#endif // TRANSACTIONEVENTBUS_H
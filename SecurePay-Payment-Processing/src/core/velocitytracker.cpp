@@ -0,0 +1,121 @@
+#include "velocitytracker.h"
+#include <algorithm>
+
+namespace {
+
+constexpr std::chrono::seconds kMinuteBucket(10);
+constexpr std::chrono::minutes kHourBucket(10);
+constexpr std::chrono::hours kDayBucket(1);
+
+// Period 0 marks an unused bucket, so real periods start at 1
+template <typename Duration>
+std::uint32_t periodOf(VelocityTracker::Clock::time_point now, Duration width) {
+    return static_cast<std::uint32_t>(now.time_since_epoch() / width) + 1;
+}
+
+} // namespace
+
+VelocityTracker::VelocityTracker(std::size_t maxKeys, std::size_t stripeCount) {
+    stripeCount = std::max<std::size_t>(1, stripeCount);
+    m_keysPerStripe = std::max<std::size_t>(1, maxKeys / stripeCount);
+
+    m_stripes.reserve(stripeCount);
+    for (std::size_t i = 0; i < stripeCount; ++i) {
+        m_stripes.push_back(std::make_unique<Stripe>());
+    }
+}
+
+VelocitySnapshot VelocityTracker::record(VelocityDimension dimension, const std::string& key,
+                                         std::int64_t amountCents, Clock::time_point now) {
+    std::uint64_t hashedKey = hashKey(dimension, key);
+    Stripe& stripe = stripeFor(hashedKey);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+
+    auto it = stripe.index.find(hashedKey);
+    if (it != stripe.index.end()) {
+        stripe.entries.splice(stripe.entries.begin(), stripe.entries, it->second);
+    } else {
+        if (stripe.entries.size() >= m_keysPerStripe) {
+            // Reuse the least recently active entry rather than freeing and allocating
+            stripe.index.erase(stripe.entries.back().key);
+            stripe.entries.splice(stripe.entries.begin(), stripe.entries, std::prev(stripe.entries.end()));
+            stripe.entries.front() = Counters{};
+        } else {
+            stripe.entries.emplace_front();
+        }
+        stripe.entries.front().key = hashedKey;
+        stripe.index.emplace(hashedKey, stripe.entries.begin());
+    }
+
+    Counters& counters = stripe.entries.front();
+    add(counters.minute, periodOf(now, kMinuteBucket), amountCents);
+    add(counters.hour, periodOf(now, kHourBucket), amountCents);
+    add(counters.day, periodOf(now, kDayBucket), amountCents);
+    return snapshot(counters, now);
+}
+
+VelocitySnapshot VelocityTracker::get(VelocityDimension dimension, const std::string& key,
+                                      Clock::time_point now) const {
+    std::uint64_t hashedKey = hashKey(dimension, key);
+    Stripe& stripe = stripeFor(hashedKey);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+
+    auto it = stripe.index.find(hashedKey);
+    if (it == stripe.index.end()) {
+        return VelocitySnapshot{{0, 0}, {0, 0}, {0, 0}};
+    }
+    return snapshot(*it->second, now);
+}
+
+std::size_t VelocityTracker::size() const {
+    std::size_t keys = 0;
+    for (const auto& stripe : m_stripes) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        keys += stripe->entries.size();
+    }
+    return keys;
+}
+
+std::uint64_t VelocityTracker::hashKey(VelocityDimension dimension, const std::string& key) {
+    // FNV-1a over the dimension tag and the key, so equal strings in different dimensions differ
+    std::uint64_t hash = 14695981039346656037ULL;
+    hash = (hash ^ static_cast<std::uint64_t>(dimension)) * 1099511628211ULL;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+template <std::size_t N>
+void VelocityTracker::add(std::array<Bucket, N>& ring, std::uint32_t period, std::int64_t amountCents) {
+    Bucket& bucket = ring[period % N];
+    if (bucket.period != period) {
+        bucket = Bucket{period, 0, 0};
+    }
+    ++bucket.count;
+    bucket.amountCents += amountCents;
+}
+
+template <std::size_t N>
+VelocityCount VelocityTracker::sum(const std::array<Bucket, N>& ring, std::uint32_t period) {
+    VelocityCount total{0, 0};
+    for (const Bucket& bucket : ring) {
+        if (bucket.period != 0 && period - bucket.period < N) {
+            total.count += bucket.count;
+            total.amountCents += bucket.amountCents;
+        }
+    }
+    return total;
+}
+
+VelocitySnapshot VelocityTracker::snapshot(const Counters& counters, Clock::time_point now) {
+    return VelocitySnapshot{
+        sum(counters.minute, periodOf(now, kMinuteBucket)),
+        sum(counters.hour, periodOf(now, kHourBucket)),
+        sum(counters.day, periodOf(now, kDayBucket))
+    };
+}
+
+VelocityTracker::Stripe& VelocityTracker::stripeFor(std::uint64_t key) const {
+    return *m_stripes[key % m_stripes.size()];
+}
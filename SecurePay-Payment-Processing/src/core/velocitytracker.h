@@ -0,0 +1,164 @@
+#ifndef VELOCITYTRACKER_H
+#define VELOCITYTRACKER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @enum VelocityDimension
+ * @brief What a velocity counter is keyed by
+ */
+enum class VelocityDimension {
+    CUSTOMER,
+    CARD,       ///< Payment method fingerprint
+    MERCHANT
+};
+
+/**
+ * @struct VelocityCount
+ * @brief Activity within one window
+ */
+struct VelocityCount {
+    std::uint32_t count;
+    std::int64_t amountCents;
+};
+
+/**
+ * @struct VelocitySnapshot
+ * @brief Activity for one key over the tracked windows
+ */
+struct VelocitySnapshot {
+    VelocityCount minute;
+    VelocityCount hour;
+    VelocityCount day;
+};
+
+/**
+ * @class VelocityTracker
+ * @brief Bounded sliding-window transaction counters per customer, card and merchant
+ *
+ * Each key keeps three small rings of time buckets: 6 x 10 s for the last
+ * minute, 6 x 10 min for the last hour and 24 x 1 h for the last day. A
+ * bucket remembers which period it belongs to and is reset lazily when
+ * the ring wraps onto it, so recording and reading touch a fixed
+ * 36 buckets whatever the traffic. Windows therefore slide in steps of
+ * one bucket.
+ *
+ * Keys are spread over lock stripes, each an LRU list with a hash index.
+ * When a stripe is full the least recently active key is evicted, which
+ * bounds memory at about maxKeys entries.
+ */
+class VelocityTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Constructor
+     * @param maxKeys Upper bound on tracked keys across all dimensions
+     * @param stripeCount Number of independently locked stripes
+     */
+    explicit VelocityTracker(std::size_t maxKeys = 65536, std::size_t stripeCount = 64);
+
+    VelocityTracker(const VelocityTracker&) = delete;
+    VelocityTracker& operator=(const VelocityTracker&) = delete;
+
+    /**
+     * @brief Count a transaction against a key and return the updated activity
+     * @param dimension The kind of key
+     * @param key The customer name, card fingerprint or merchant name
+     * @param amountCents The transaction amount in cents
+     * @param now The time of the transaction
+     * @return Activity including this transaction
+     */
+    VelocitySnapshot record(VelocityDimension dimension, const std::string& key,
+                            std::int64_t amountCents, Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Get the activity for a key without counting anything
+     * @param dimension The kind of key
+     * @param key The customer name, card fingerprint or merchant name
+     * @param now The time to measure the windows back from
+     * @return The activity; zero for keys that are not tracked
+     */
+    VelocitySnapshot get(VelocityDimension dimension, const std::string& key,
+                         Clock::time_point now = Clock::now()) const;
+
+    /**
+     * @brief Get the number of tracked keys
+     * @return Keys currently held across all stripes
+     */
+    std::size_t size() const;
+
+private:
+    struct Bucket {
+        std::uint32_t period;       ///< Index of the time period the bucket holds
+        std::uint32_t count;
+        std::int64_t amountCents;
+    };
+
+    struct Counters {
+        std::uint64_t key;
+        std::array<Bucket, 6> minute;
+        std::array<Bucket, 6> hour;
+        std::array<Bucket, 24> day;
+    };
+
+    struct Stripe {
+        mutable std::mutex mutex;
+        std::list<Counters> entries;    ///< Most recently active first
+        std::unordered_map<std::uint64_t, std::list<Counters>::iterator> index;
+    };
+
+    /**
+     * @brief Hash a dimension and key into the 64-bit key used by the stripes
+     * @param dimension The kind of key
+     * @param key The key
+     * @return The combined hash
+     */
+    static std::uint64_t hashKey(VelocityDimension dimension, const std::string& key);
+
+    /**
+     * @brief Add to the current bucket of a ring, resetting it if it held an older period
+     * @param ring The ring of buckets
+     * @param period Index of the current period
+     * @param amountCents The amount to add
+     */
+    template <std::size_t N>
+    static void add(std::array<Bucket, N>& ring, std::uint32_t period, std::int64_t amountCents);
+
+    /**
+     * @brief Sum the buckets of a ring that fall within its window
+     * @param ring The ring of buckets
+     * @param period Index of the current period
+     * @return The activity over the last N periods
+     */
+    template <std::size_t N>
+    static VelocityCount sum(const std::array<Bucket, N>& ring, std::uint32_t period);
+
+    /**
+     * @brief Read all windows of a key
+     * @param counters The key's buckets
+     * @param now The time to measure the windows back from
+     * @return The activity
+     */
+    static VelocitySnapshot snapshot(const Counters& counters, Clock::time_point now);
+
+    /**
+     * @brief Select the stripe responsible for a key
+     * @param key The combined hash
+     * @return Reference to the stripe
+     */
+    Stripe& stripeFor(std::uint64_t key) const;
+
+    std::vector<std::unique_ptr<Stripe>> m_stripes;
+    std::size_t m_keysPerStripe;
+};
+
+#endif // VELOCITYTRACKER_H
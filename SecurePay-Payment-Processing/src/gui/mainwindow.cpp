@@ -12,18 +12,29 @@
 #include <functional>
 #include <iostream>
 
-MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
+MainWindow::MainWindow(const std::string& databasePath, QWidget* parent) : QMainWindow(parent) {
     // Initialize core components
-    m_appController = std::make_unique<AppController>();
+    m_appController = std::make_unique<AppController>(databasePath);
     m_refundManager = &RefundManager::getInstance();
     m_reportManager = &ReportManager::getInstance();
+    m_reportManager->setFraudSystem(&FraudSystem::getInstance());
     
     // Setup UI
     setupUI();
     
-    // Register for transaction updates
-    m_appController->setTransactionUpdateCallback(
-        std::bind(&MainWindow::onTransactionUpdated, this, std::placeholders::_1));
+    // Register for transaction updates. Batches arrive on the gateway's event bus
+    // thread, so the table refresh is queued onto the GUI thread.
+    m_appController->setTransactionBatchUpdateCallback(
+        [this](const std::vector<const Transaction*>& transactions) {
+            if (transactions.empty()) {
+                return;
+            }
+            QString lastTransactionId = QString::fromUtf8(transactions.back()->getTransactionId().c_str());
+            int count = static_cast<int>(transactions.size());
+            QMetaObject::invokeMethod(this, [this, lastTransactionId, count]() {
+                onTransactionsUpdated(lastTransactionId, count);
+            }, Qt::QueuedConnection);
+        });
     
     // Populate customer combo box
     for (const auto& customer : m_appController->getCustomers()) {
@@ -447,7 +458,7 @@ void MainWindow::updatePaymentMethodFields() {
 }
 
 void MainWindow::updateCustomerTransactionHistory() {
-    const auto& transactions = m_appController->getTransactionHistory();
+    std::vector<Transaction*> transactions = m_appController->getTransactionHistory();
     
     m_customerTransactionTable->setRowCount(0);
     
@@ -464,7 +475,7 @@ void MainWindow::updateCustomerTransactionHistory() {
 }
 
 void MainWindow::updateMerchantTransactionHistory() {
-    const auto& transactions = m_appController->getTransactionHistory();
+    std::vector<Transaction*> transactions = m_appController->getTransactionHistory();
     
     m_merchantTransactionTable->setRowCount(0);
     
@@ -488,9 +499,19 @@ void MainWindow::updateRefundHistory() {
 }
 
 void MainWindow::updateFraudAlerts() {
-    // In a real implementation, this would fetch fraud alerts from the FraudSystem
-    // For now, we'll just clear the table
+    const auto alerts = FraudSystem::getInstance().getAlertStore().getAll();
+    
     m_fraudAlertTable->setRowCount(0);
+    
+    for (const FraudAlert* alert : alerts) {
+        int row = m_fraudAlertTable->rowCount();
+        m_fraudAlertTable->insertRow(row);
+        
+        m_fraudAlertTable->setItem(row, 0, new QTableWidgetItem(QString::fromUtf8(alert->getAlertId().c_str())));
+        m_fraudAlertTable->setItem(row, 1, new QTableWidgetItem(QString::fromUtf8(alert->getTransactionId().c_str())));
+        m_fraudAlertTable->setItem(row, 2, new QTableWidgetItem(QString::fromUtf8(FraudSystem::riskLevelToString(alert->getRiskLevel()).c_str())));
+        m_fraudAlertTable->setItem(row, 3, new QTableWidgetItem(QString::fromUtf8(alert->getTimestamp().c_str())));
+    }
 }
 
 void MainWindow::onCustomerSelected(int index) {
@@ -631,14 +652,11 @@ void MainWindow::onSubmitClicked() {
         updateCustomerTransactionHistory();
         updateMerchantTransactionHistory();
         
-        const auto& transactions = m_appController->getTransactionHistory();
         TransactionStatus status = TransactionStatus::PENDING;
-        
-        for (const auto& tx : transactions) {
-            if (tx->getTransactionId() == transactionId) {
-                status = tx->getStatus();
-                break;
-            }
+        std::string rejectionReason;
+        if (const Transaction* tx = m_appController->findTransaction(transactionId)) {
+            status = tx->getStatus();
+            rejectionReason = tx->getRejectionReason();
         }
         QString resultText;
         QString resultStyle;
@@ -656,6 +674,10 @@ void MainWindow::onSubmitClicked() {
                 resultText = "Transaction Flagged for Review";
                 resultStyle = "color: orange; font-weight: bold;";
                 break;
+            case TransactionStatus::REJECTED:
+                resultText = "Transaction Rejected - " + QString::fromUtf8(rejectionReason.c_str());
+                resultStyle = "color: red; font-weight: bold;";
+                break;
             default:
                 resultText = "Transaction Status: " + QString::fromUtf8(Transaction::statusToString(status).c_str());
                 resultStyle = "color: black;";
@@ -683,13 +705,8 @@ void MainWindow::onProcessRefundClicked() {
     QString transactionId = m_merchantTransactionTable->item(row, 0)->text();
     
     // Find transaction in history
-    const Transaction* selectedTransaction = nullptr;
-    for (const auto& transaction : m_appController->getTransactionHistory()) {
-        if (transaction->getTransactionId() == transactionId.toUtf8().constData()) {
-            selectedTransaction = transaction.get();
-            break;
-        }
-    }
+    const Transaction* selectedTransaction =
+        m_appController->findTransaction(transactionId.toUtf8().constData());
     
     if (!selectedTransaction) {
         QMessageBox::warning(this, "Error", "Transaction not found.");
@@ -716,9 +733,14 @@ void MainWindow::onExportMerchantReportClicked() {
     dialog.exec();
 }
 
-void MainWindow::onTransactionUpdated(const Transaction& transaction) {
+void MainWindow::onTransactionsUpdated(const QString& lastTransactionId, int count) {
     updateCustomerTransactionHistory();
     updateMerchantTransactionHistory();
+    updateFraudAlerts();
     
-    statusBar()->showMessage("Transaction updated: " + QString::fromUtf8(transaction.getTransactionId().c_str()));
+    if (count > 1) {
+        statusBar()->showMessage(QString("%1 transactions updated, latest: %2").arg(count).arg(lastTransactionId));
+    } else {
+        statusBar()->showMessage("Transaction updated: " + lastTransactionId);
+    }
 }
@@ -18,6 +18,7 @@
 #include "../core/transaction.h"
 #include "../core/refundmanager.h"
 #include "../core/reportmanager.h"
+#include "../core/fraudsystem.h"
 
 // Enum for user roles
 enum class UserRole {
@@ -29,7 +30,7 @@ class MainWindow : public QMainWindow {
     Q_OBJECT
     
 public:
-    MainWindow(QWidget* parent = nullptr);
+    explicit MainWindow(const std::string& databasePath, QWidget* parent = nullptr);
     ~MainWindow();
     
 private:
@@ -106,7 +107,7 @@ private slots:
     void onExportMerchantReportClicked();
     
     // Common slots
-    void onTransactionUpdated(const Transaction& transaction);
+    void onTransactionsUpdated(const QString& lastTransactionId, int count);
 };
 
 #endif
@@ -3,10 +3,10 @@
 #include <QButtonGroup>
 #include <QGroupBox>
 
-RefundDialog::RefundDialog(const std::vector<std::unique_ptr<Transaction>>& transactions,
+RefundDialog::RefundDialog(std::vector<Transaction*> transactions,
                            RefundManager& refundManager,
                            QWidget* parent)
-    : QDialog(parent), m_transactions(transactions), m_refundManager(refundManager) {
+    : QDialog(parent), m_transactions(std::move(transactions)), m_refundManager(refundManager) {
     
     setWindowTitle("Process Refund");
     setMinimumWidth(500);
@@ -127,7 +127,7 @@ void RefundDialog::onTransactionSelected(int index) {
             transaction->getStatus() == TransactionStatus::PARTIALLY_REFUNDED) {
             
             if (refundableIndex == index) {
-                selectedTransaction = transaction.get();
+                selectedTransaction = transaction;
                 break;
             }
             
@@ -183,7 +183,7 @@ void RefundDialog::updateRefundAmount() {
             transaction->getStatus() == TransactionStatus::PARTIALLY_REFUNDED) {
             
             if (refundableIndex == m_transactionComboBox->currentIndex()) {
-                selectedTransaction = transaction.get();
+                selectedTransaction = transaction;
                 break;
             }
             
@@ -216,7 +216,7 @@ void RefundDialog::processRefund() {
             transaction->getStatus() == TransactionStatus::PARTIALLY_REFUNDED) {
             
             if (refundableIndex == m_transactionComboBox->currentIndex()) {
-                selectedTransaction = transaction.get();
+                selectedTransaction = transaction;
                 break;
             }
             
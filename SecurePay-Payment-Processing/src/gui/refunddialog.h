@@ -31,7 +31,7 @@ public:
      * @param refundManager Reference to the refund manager
      * @param parent Parent widget
      */
-    RefundDialog(const std::vector<std::unique_ptr<Transaction>>& transactions,
+    RefundDialog(std::vector<Transaction*> transactions,
                  RefundManager& refundManager,
                  QWidget* parent = nullptr);
     
@@ -79,7 +79,7 @@ private:
     /**
      * @brief Vector of transactions to choose from
      */
-    const std::vector<std::unique_ptr<Transaction>>& m_transactions;
+    std::vector<Transaction*> m_transactions;
     
     /**
      * @brief Reference to the refund manager
@@ -13,7 +13,11 @@ int main(int argc, char *argv[]) {
         
         std::cout << "Starting SecurePay Payment Processing Application" << std::endl;
         
-        MainWindow mainWindow;
+        // The database path may be given as the first argument
+        const QStringList arguments = QApplication::arguments();
+        const std::string databasePath = arguments.size() > 1 ? arguments.at(1).toStdString() : "securepay.db";
+        
+        MainWindow mainWindow(databasePath);
         mainWindow.show();
         
         return app.exec();
@@ -0,0 +1,150 @@
+#include <chrono>
+#include <memory>
+#include <thread>
+#include "accountledger.h"
+#include "paymentgateway.h"
+#include "simulatedbankbackend.h"
+#include "check.h"
+
+using namespace std::chrono;
+
+namespace {
+
+const char* const kCardNumber = "4111111111111111";
+
+std::unique_ptr<Transaction> makeTransaction(const Customer& customer, const Merchant& merchant, double amount) {
+    return TransactionFactory::createTransaction(customer, merchant,
+        PaymentMethodFactory::createCreditCard(kCardNumber, "Test Holder", "12/30", "123"), amount);
+}
+
+// Polls until the ledger has no open holds, since expiry and late answers arrive on timer threads
+bool waitForNoOpenHolds(const AccountLedger& ledger, milliseconds timeout) {
+    auto deadline = steady_clock::now() + timeout;
+    while (ledger.getStatistics().openHolds != 0) {
+        if (steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+void holdsReserveFundsUntilCapturedOrReleased() {
+    AccountLedger ledger;
+    ledger.setBalance("account", 10000);
+
+    CHECK(ledger.placeHold("account", "TX-1", 3000));
+    AccountBalance balance = ledger.getBalance("account");
+    CHECK(balance.balance == 10000 && balance.held == 3000 && balance.available == 7000);
+
+    // A partial capture debits what was captured and frees the rest
+    CHECK(ledger.capture("account", "TX-1", 2000));
+    balance = ledger.getBalance("account");
+    CHECK(balance.balance == 8000 && balance.held == 0 && balance.available == 8000);
+    CHECK(!ledger.capture("account", "TX-1"));
+
+    CHECK(ledger.placeHold("account", "TX-2", 5000));
+    CHECK(ledger.release("account", "TX-2"));
+    CHECK(ledger.getBalance("account").available == 8000);
+    CHECK(!ledger.release("account", "TX-2"));
+
+    LedgerStatistics statistics = ledger.getStatistics();
+    CHECK(statistics.holdsPlaced == 2 && statistics.captures == 1 && statistics.releases == 1);
+    CHECK(statistics.openHolds == 0);
+}
+
+void holdsBeyondTheAvailableBalanceAreRefused() {
+    AccountLedger ledger(5000);
+    CHECK(ledger.getBalance("new").balance == 5000);
+
+    CHECK(ledger.placeHold("new", "TX-1", 4000));
+    CHECK(!ledger.placeHold("new", "TX-2", 1001));
+    CHECK(!ledger.placeHold("new", "TX-1", 10));
+    CHECK(ledger.placeHold("new", "TX-3", 1000));
+    CHECK(ledger.getBalance("new").available == 0);
+    CHECK(ledger.getStatistics().holdsDeclined == 2);
+}
+
+void uncapturedHoldsExpire() {
+    AccountLedger ledger(10000, milliseconds(30), 4, milliseconds(5));
+    CHECK(ledger.placeHold("account", "TX-1", 6000));
+    CHECK(!ledger.placeHold("account", "TX-2", 6000));
+
+    CHECK(waitForNoOpenHolds(ledger, seconds(5)));
+    CHECK(ledger.getBalance("account").available == 10000);
+    CHECK(ledger.getStatistics().expirations == 1);
+    CHECK(!ledger.capture("account", "TX-1"));
+}
+
+void approvedPaymentsAreCapturedAgainstTheCardFingerprint() {
+    auto ledger = std::make_shared<AccountLedger>(100000);
+    SimulatedBankConfig config;
+    config.distribution = LatencyDistribution::FIXED;
+    config.medianLatency = milliseconds(1);
+    config.ledger = ledger;
+    Bank::getInstance().setBackend(std::make_shared<SimulatedBankBackend>(config));
+
+    PaymentGateway gateway;
+    Customer customer("Ledger Customer", "ledger@example.com", "1 Main Street");
+    Merchant merchant("Ledger Merchant", "shop@example.com", "2 High Street");
+    auto transaction = makeTransaction(customer, merchant, 250.0);
+    std::string accountId = transaction->getPaymentMethod().getFingerprint();
+    std::string transactionId = transaction->getTransactionId();
+    gateway.processTransaction(std::move(transaction));
+
+    const Transaction* processed = gateway.findTransaction(transactionId);
+    CHECK(processed && processed->getStatus() == TransactionStatus::APPROVED);
+    AccountBalance balance = ledger->getBalance(accountId);
+    CHECK(balance.balance == 100000 - 25000 && balance.held == 0);
+    LedgerStatistics statistics = ledger->getStatistics();
+    CHECK(statistics.captures == 1 && statistics.openHolds == 0);
+    // The raw card number is never used as an account key
+    CHECK(statistics.accounts == 1);
+    CHECK(accountId != kCardNumber);
+
+    Bank::getInstance().setBackend(std::make_shared<InstantBankBackend>());
+}
+
+void timedOutApprovalsAreReleased() {
+    auto ledger = std::make_shared<AccountLedger>(100000);
+    SimulatedBankConfig config;
+    config.distribution = LatencyDistribution::FIXED;
+    config.medianLatency = milliseconds(50);
+    config.ledger = ledger;
+    Bank::getInstance().setBackend(std::make_shared<SimulatedBankBackend>(config));
+    Bank::getInstance().setAuthorizationTimeout(milliseconds(5));
+
+    PaymentGateway gateway;
+    Customer customer("Timeout Customer", "timeout@example.com", "3 Main Street");
+    Merchant merchant("Timeout Merchant", "shop@example.com", "4 High Street");
+    auto transaction = makeTransaction(customer, merchant, 300.0);
+    std::string accountId = transaction->getPaymentMethod().getFingerprint();
+    std::string transactionId = transaction->getTransactionId();
+    gateway.processTransaction(std::move(transaction));
+
+    const Transaction* processed = gateway.findTransaction(transactionId);
+    CHECK(processed && processed->getStatus() == TransactionStatus::DECLINED);
+
+    // The acquirer's late approval placed a hold, which is released at once
+    auto deadline = steady_clock::now() + seconds(5);
+    while (ledger->getStatistics().holdsPlaced == 0 && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    CHECK(waitForNoOpenHolds(*ledger, seconds(5)));
+    CHECK(ledger->getStatistics().releases == 1);
+    CHECK(ledger->getBalance(accountId).available == 100000);
+
+    Bank::getInstance().setAuthorizationTimeout(milliseconds(0));
+    Bank::getInstance().setBackend(std::make_shared<InstantBankBackend>());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(holdsReserveFundsUntilCapturedOrReleased);
+    RUN_TEST(holdsBeyondTheAvailableBalanceAreRefused);
+    RUN_TEST(uncapturedHoldsExpire);
+    RUN_TEST(approvedPaymentsAreCapturedAgainstTheCardFingerprint);
+    RUN_TEST(timedOutApprovalsAreReleased);
+    return checkFailures() == 0 ? 0 : 1;
+}
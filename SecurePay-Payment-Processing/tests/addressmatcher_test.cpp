@@ -0,0 +1,122 @@
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include "addressmatcher.h"
+#include "fraudsystem.h"
+#include "check.h"
+
+namespace {
+
+// Earliest position at which any token ends, or npos; the reference for findFirst()
+std::size_t naiveFirstEnd(const std::vector<std::string>& tokens, const std::string& text) {
+    std::size_t best = std::string::npos;
+    for (const std::string& token : tokens) {
+        if (token.empty()) {
+            continue;
+        }
+        std::size_t at = text.find(token);
+        if (at != std::string::npos && (best == std::string::npos || at + token.size() < best)) {
+            best = at + token.size();
+        }
+    }
+    return best;
+}
+
+void matchesIgnoringAsciiCase() {
+    AddressMatcher matcher({"po box", "Unknown", "test road"});
+    CHECK(matcher.matches("PO Box 12, Springfield"));
+    CHECK(matcher.matches("1 TEST ROAD"));
+    CHECK(matcher.matches("unknown"));
+    CHECK(!matcher.matches("123 Main St, San Francisco, CA"));
+    CHECK(!matcher.matches(""));
+}
+
+void findFirstReportsTokenEndingEarliest() {
+    AddressMatcher matcher({"hers", "she", "his", "he"});
+    std::size_t token = 0;
+    CHECK(matcher.findFirst("ushers", token));
+    CHECK(matcher.getToken(token) == "she" || matcher.getToken(token) == "he");  // Both end at the first 'e'
+    CHECK(matcher.findFirst("ahis", token));
+    CHECK(matcher.getToken(token) == "his");
+    CHECK(!matcher.findFirst("xyz", token));
+}
+
+void emptyTokensAreIgnored() {
+    AddressMatcher none;
+    CHECK(none.size() == 0u);
+    CHECK(!none.matches("anything"));
+
+    AddressMatcher withEmpty({"", "box"});
+    CHECK(withEmpty.size() == 2u);
+    CHECK(!withEmpty.matches("street"));
+    CHECK(withEmpty.matches("a box"));
+}
+
+void agreesWithNaiveSearch() {
+    // A three-letter alphabet makes overlapping and nested tokens common
+    std::mt19937 random(5);
+    auto word = [&random](std::size_t length) {
+        std::string text;
+        for (std::size_t i = 0; i < length; ++i) {
+            text += static_cast<char>('a' + random() % 3);
+        }
+        return text;
+    };
+
+    for (int round = 0; round < 200; ++round) {
+        std::vector<std::string> tokens;
+        for (int i = 0; i < 1 + round % 8; ++i) {
+            tokens.push_back(word(1 + random() % 4));
+        }
+        AddressMatcher matcher(tokens);
+
+        for (int check = 0; check < 20; ++check) {
+            std::string text = word(random() % 12);
+            std::size_t expected = naiveFirstEnd(tokens, text);
+            std::size_t token = 0;
+            bool found = matcher.findFirst(text, token);
+
+            CHECK(found == (expected != std::string::npos));
+            CHECK(matcher.matches(text) == found);
+            if (found && expected != std::string::npos) {
+                // The reported token must be one that ends at the earliest end
+                const std::string& match = matcher.getToken(token);
+                CHECK(match.size() <= expected &&
+                      text.compare(expected - match.size(), match.size(), match) == 0);
+            }
+        }
+    }
+}
+
+void fraudSystemLoadsTokensFromAFile() {
+    FraudSystem& fraudSystem = FraudSystem::getInstance();
+    const char* path = "addressmatcher_test.tokens";
+    std::ofstream(path) << "# Drop addresses\n"
+                        << "\n"
+                        << "  Mail Drop  \n"
+                        << "suite 999\n";
+
+    std::shared_ptr<const AddressMatcher> before = fraudSystem.getAddressMatcher();
+    CHECK(fraudSystem.loadAddressTokensFromFile(path));
+    std::shared_ptr<const AddressMatcher> loaded = fraudSystem.getAddressMatcher();
+    CHECK(loaded != before && loaded->size() == 2);
+    CHECK(loaded->matches("12 MAIL DROP LANE"));
+    CHECK(loaded->matches("1 Main Street, Suite 999"));
+    CHECK(!loaded->matches("# Drop addresses"));
+
+    // A missing file keeps the loaded tokens
+    CHECK(!fraudSystem.loadAddressTokensFromFile("missing-addressmatcher_test.tokens"));
+    CHECK(fraudSystem.getAddressMatcher() == loaded);
+    std::remove(path);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(matchesIgnoringAsciiCase);
+    RUN_TEST(findFirstReportsTokenEndingEarliest);
+    RUN_TEST(emptyTokensAreIgnored);
+    RUN_TEST(agreesWithNaiveSearch);
+    RUN_TEST(fraudSystemLoadsTokensFromAFile);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#include "admissioncontroller.h"
+#include "check.h"
+
+namespace {
+
+// Slow enough that no token refills while a test runs
+constexpr double kTrickle = 0.001;
+
+void bucketAdmitsItsBurstThenRefuses() {
+    TokenBucket bucket(kTrickle, 3);
+    CHECK(bucket.tryAcquire());
+    CHECK(bucket.tryAcquire());
+    CHECK(bucket.tryAcquire());
+    CHECK(!bucket.tryAcquire());
+
+    // A token given back can be taken again
+    bucket.release();
+    CHECK(bucket.tryAcquire());
+    CHECK(!bucket.tryAcquire());
+
+    TokenBucket unlimited(0.0, 1);
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(unlimited.tryAcquire());
+    }
+}
+
+void merchantLimitIsPerMerchant() {
+    AdmissionConfig config;
+    config.merchantRatePerSecond = kTrickle;
+    config.merchantBurst = 2;
+    AdmissionController controller(config);
+
+    CHECK(controller.tryAdmit("Busy") == AdmissionDecision::ADMITTED);
+    CHECK(controller.tryAdmit("Busy") == AdmissionDecision::ADMITTED);
+    CHECK(controller.tryAdmit("Busy") == AdmissionDecision::MERCHANT_RATE_LIMITED);
+    CHECK(controller.tryAdmit("Quiet") == AdmissionDecision::ADMITTED);
+
+    AdmissionStatistics statistics = controller.getStatistics();
+    CHECK(statistics.admitted == 3);
+    CHECK(statistics.merchantRateLimited == 1);
+    CHECK(statistics.inFlight == 3);
+    for (int i = 0; i < 3; ++i) {
+        controller.release();
+    }
+    CHECK(controller.getStatistics().inFlight == 0);
+}
+
+void merchantRefusalLeavesGlobalCapacity() {
+    AdmissionConfig config;
+    config.globalRatePerSecond = kTrickle;
+    config.globalBurst = 2;
+    config.merchantRatePerSecond = kTrickle;
+    config.merchantBurst = 1;
+    AdmissionController controller(config);
+
+    CHECK(controller.tryAdmit("A") == AdmissionDecision::ADMITTED);
+    CHECK(controller.tryAdmit("A") == AdmissionDecision::MERCHANT_RATE_LIMITED);
+    CHECK(controller.tryAdmit("B") == AdmissionDecision::ADMITTED);
+    CHECK(controller.tryAdmit("C") == AdmissionDecision::GLOBAL_RATE_LIMITED);
+    CHECK(controller.getStatistics().globalRateLimited == 1);
+}
+
+void merchantOverrideReplacesTheDefault() {
+    AdmissionConfig config;
+    config.merchantRatePerSecond = kTrickle;
+    config.merchantBurst = 1;
+    AdmissionController controller(config);
+    controller.setMerchantLimit("Large", kTrickle, 3);
+    controller.setMerchantLimit("Unlimited", 0.0, 1);
+
+    for (int i = 0; i < 3; ++i) {
+        CHECK(controller.tryAdmit("Large") == AdmissionDecision::ADMITTED);
+    }
+    CHECK(controller.tryAdmit("Large") == AdmissionDecision::MERCHANT_RATE_LIMITED);
+    for (int i = 0; i < 10; ++i) {
+        CHECK(controller.tryAdmit("Unlimited") == AdmissionDecision::ADMITTED);
+    }
+
+    // Reconfiguring keeps the override and refills its bucket
+    controller.configure(config);
+    CHECK(controller.tryAdmit("Large") == AdmissionDecision::ADMITTED);
+}
+
+void inFlightBoundIsReleasedBySlots() {
+    AdmissionConfig config;
+    config.maxInFlight = 2;
+    AdmissionController controller(config);
+
+    CHECK(controller.tryAdmit("M") == AdmissionDecision::ADMITTED);
+    {
+        AdmissionSlot slot(controller);
+        CHECK(controller.tryAdmit("M") == AdmissionDecision::ADMITTED);
+        AdmissionSlot second(controller);
+        CHECK(controller.tryAdmit("M") == AdmissionDecision::OVERLOADED);
+
+        // Released once, however often release() is called
+        second.release();
+        second.release();
+        CHECK(controller.getStatistics().inFlight == 1);
+    }
+    CHECK(controller.getStatistics().inFlight == 0);
+    CHECK(controller.tryAdmit("M") == AdmissionDecision::ADMITTED);
+    CHECK(controller.getStatistics().overloaded == 1);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(bucketAdmitsItsBurstThenRefuses);
+    RUN_TEST(merchantLimitIsPerMerchant);
+    RUN_TEST(merchantRefusalLeavesGlobalCapacity);
+    RUN_TEST(merchantOverrideReplacesTheDefault);
+    RUN_TEST(inFlightBoundIsReleasedBySlots);
+    return checkFailures() == 0 ? 0 : 1;
+}
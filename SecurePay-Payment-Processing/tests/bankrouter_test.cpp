@@ -0,0 +1,127 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "bankrouter.h"
+#include "check.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// Answers inline with a fixed code after an optional delay, counting the requests it receives
+class CountingBackend : public BankBackend {
+public:
+    CountingBackend(std::string name, BankResponseCode code, microseconds delay = microseconds(0))
+        : m_name(std::move(name)), m_code(code), m_delay(delay) {}
+
+    void authorize(const BankAuthorizationRequest& /*request*/, Callback callback) override {
+        ++m_calls;
+        if (m_delay.count() > 0) {
+            std::this_thread::sleep_for(m_delay);
+        }
+        callback(BankAuthorizationResponse{m_code, m_delay});
+    }
+
+    std::string getName() const override { return m_name; }
+    int calls() const { return m_calls; }
+
+private:
+    std::string m_name;
+    BankResponseCode m_code;
+    microseconds m_delay;
+    std::atomic<int> m_calls{0};
+};
+
+BankAuthorizationRequest cardRequest(const std::string& bin, const std::string& network) {
+    return BankAuthorizationRequest{"TX-1", "Credit Card", 10.0, bin, network, "account"};
+}
+
+BankResponseCode send(BankBackend& backend, const BankAuthorizationRequest& request) {
+    BankResponseCode code = BankResponseCode::TIMEOUT;
+    // Every backend in these tests answers inline
+    backend.authorize(request, [&code](const BankAuthorizationResponse& response) { code = response.code; });
+    return code;
+}
+
+void rulesDecideWhichBackendsMayTakeARequest() {
+    auto visa = std::make_shared<CountingBackend>("Visa", BankResponseCode::APPROVED);
+    auto amex = std::make_shared<CountingBackend>("Amex", BankResponseCode::APPROVED);
+    auto wallets = std::make_shared<CountingBackend>("Wallets", BankResponseCode::APPROVED);
+    auto router = std::make_shared<BankRouter>(0.1, 0);
+    CHECK(router->addBackend(visa, BankRouteRule{{"Credit Card", "Debit Card"}, {"4"}, {}}));
+    CHECK(router->addBackend(amex, BankRouteRule{{}, {}, {"Amex"}}));
+    CHECK(router->addBackend(wallets, BankRouteRule{{"Digital Wallet"}, {}, {}}));
+
+    CHECK(send(*router, cardRequest("41111111", "Visa")) == BankResponseCode::APPROVED);
+    CHECK(send(*router, cardRequest("37144963", "Amex")) == BankResponseCode::APPROVED);
+    CHECK(send(*router, BankAuthorizationRequest{"TX-2", "Digital Wallet", 5.0, "", "", "wallet"}) ==
+          BankResponseCode::APPROVED);
+    CHECK(visa->calls() == 1);
+    CHECK(amex->calls() == 1);
+    CHECK(wallets->calls() == 1);
+
+    // No rule accepts a Mastercard BIN
+    CHECK(send(*router, cardRequest("55555555", "Mastercard")) == BankResponseCode::ERROR);
+    CHECK(visa->calls() + amex->calls() + wallets->calls() == 3);
+}
+
+void fasterBackendTakesTheTraffic() {
+    auto slow = std::make_shared<CountingBackend>("Slow", BankResponseCode::APPROVED, milliseconds(2));
+    auto fast = std::make_shared<CountingBackend>("Fast", BankResponseCode::APPROVED, microseconds(50));
+    auto router = std::make_shared<BankRouter>(0.1, 0);
+    router->addBackend(slow);
+    router->addBackend(fast);
+
+    for (int i = 0; i < 100; ++i) {
+        send(*router, cardRequest("41111111", "Visa"));
+    }
+
+    // One probe finds the slow backend, after which it is passed over
+    CHECK(slow->calls() == 1);
+    CHECK(fast->calls() == 99);
+    std::vector<BankRouteStatistics> statistics = router->getStatistics();
+    CHECK(statistics.size() == 2);
+    CHECK(statistics.size() == 2 && statistics[0].latencyMs > statistics[1].latencyMs);
+}
+
+void decliningBackendLosesTheTraffic() {
+    auto declining = std::make_shared<CountingBackend>("Declining", BankResponseCode::INSUFFICIENT_FUNDS, microseconds(200));
+    auto approving = std::make_shared<CountingBackend>("Approving", BankResponseCode::APPROVED, microseconds(200));
+    auto router = std::make_shared<BankRouter>(0.5, 0);
+    router->addBackend(declining);
+    router->addBackend(approving);
+
+    for (int i = 0; i < 100; ++i) {
+        send(*router, cardRequest("41111111", "Visa"));
+    }
+
+    CHECK(approving->calls() >= 90);
+    std::vector<BankRouteStatistics> statistics = router->getStatistics();
+    CHECK(statistics.size() == 2 && statistics[0].approvalRate < statistics[1].approvalRate);
+}
+
+void explorationKeepsSamplingEveryBackend() {
+    auto slow = std::make_shared<CountingBackend>("Slow", BankResponseCode::APPROVED, milliseconds(1));
+    auto fast = std::make_shared<CountingBackend>("Fast", BankResponseCode::APPROVED);
+    auto router = std::make_shared<BankRouter>(0.1, 10);
+    router->addBackend(slow);
+    router->addBackend(fast);
+
+    for (int i = 0; i < 200; ++i) {
+        send(*router, cardRequest("41111111", "Visa"));
+    }
+
+    // Every tenth request rotates through the two backends
+    CHECK(slow->calls() >= 10);
+    CHECK(fast->calls() >= 150);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(rulesDecideWhichBackendsMayTakeARequest);
+    RUN_TEST(fasterBackendTakesTheTraffic);
+    RUN_TEST(decliningBackendLosesTheTraffic);
+    RUN_TEST(explorationKeepsSamplingEveryBackend);
+    return checkFailures() == 0 ? 0 : 1;
+}
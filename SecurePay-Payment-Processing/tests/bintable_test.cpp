@@ -0,0 +1,98 @@
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include "bintable.h"
+#include "check.h"
+
+namespace {
+
+BinRange range(const std::string& low, const std::string& high, const std::string& network,
+               const std::string& issuer, CardType cardType = CardType::CREDIT) {
+    return BinRange{low, high, BinInfo{issuer, network, cardType, "US"}};
+}
+
+void narrowestRangeWinsWhereRangesOverlap() {
+    BinTable table({
+        range("4", "4", "Visa", "Generic Visa"),
+        range("411111", "411111", "Visa", "Test Bank", CardType::DEBIT),
+        range("424242", "424243", "Visa", "Prepaid Co", CardType::PREPAID),
+        range("51", "55", "Mastercard", "Generic Mastercard"),
+    });
+
+    const BinInfo* info = table.lookup("4111 1111 1111 1111");
+    CHECK(info && info->issuer == "Test Bank" && info->cardType == CardType::DEBIT);
+    info = table.lookup("4000000000000002");
+    CHECK(info && info->issuer == "Generic Visa");
+    info = table.lookup("4242439999999999");
+    CHECK(info && info->cardType == CardType::PREPAID);
+    // Either side of a nested range falls back to the wider one
+    info = table.lookup("4242440000000000");
+    CHECK(info && info->issuer == "Generic Visa");
+    info = table.lookup("4999999999999999");
+    CHECK(info && info->issuer == "Generic Visa");
+    info = table.lookup("5500000000000004");
+    CHECK(info && info->network == "Mastercard");
+}
+
+void numbersOutsideEveryRangeAreUnknown() {
+    BinTable table({range("4", "4", "Visa", "Generic Visa")});
+    CHECK(table.lookup("6011000000000004") == nullptr);
+    CHECK(table.lookup("3999999999999999") == nullptr);
+    CHECK(table.lookup("") == nullptr);
+    CHECK(table.lookup("abc") == nullptr);
+
+    BinTable empty;
+    CHECK(empty.empty());
+    CHECK(empty.lookup("4111111111111111") == nullptr);
+}
+
+void shortBinsMatchTheirWholeRange() {
+    BinTable table({range("510000", "559999", "Mastercard", "Generic Mastercard")});
+    CHECK(table.lookup("51") != nullptr);
+    CHECK(table.lookup("55999999") != nullptr);
+    CHECK(table.lookup("56000000") == nullptr);
+}
+
+void cardTypesRoundTripThroughStrings() {
+    CHECK(BinTable::cardTypeFromString("credit") == CardType::CREDIT);
+    CHECK(BinTable::cardTypeFromString("DEBIT") == CardType::DEBIT);
+    CHECK(BinTable::cardTypeFromString("Prepaid") == CardType::PREPAID);
+    CHECK(BinTable::cardTypeFromString("charge") == CardType::UNKNOWN);
+    CHECK(BinTable::cardTypeFromString(BinTable::cardTypeToString(CardType::DEBIT)) == CardType::DEBIT);
+}
+
+void managerLoadsAndReplacesTheLiveTable() {
+    const char* path = "bintable_test.csv";
+    std::ofstream(path) << "low,high,network,issuer,type,country\n"
+                        << "# Test ranges\n"
+                        << "\n"
+                        << "4,4,Visa,Generic Visa,Credit,US\n"
+                        << "34,34,Amex,American Express,Credit,US\n";
+
+    BinManager& manager = BinManager::getInstance();
+    CHECK(manager.loadFromFile(path));
+    std::shared_ptr<const BinTable> loaded = manager.getTable();
+    const BinInfo* info = loaded->lookup("340000000000009");
+    CHECK(info && info->network == "Amex");
+    CHECK(!manager.loadFromFile("missing-bintable_test.csv"));
+    CHECK(manager.getTable() == loaded);
+
+    // A snapshot taken before a reload keeps answering from the old table
+    manager.load({range("5", "5", "Mastercard", "Generic Mastercard")});
+    CHECK(manager.getTable()->lookup("4111111111111111") == nullptr);
+    CHECK(loaded->lookup("4111111111111111") != nullptr);
+
+    manager.load({});
+    std::remove(path);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(narrowestRangeWinsWhereRangesOverlap);
+    RUN_TEST(numbersOutsideEveryRangeAreUnknown);
+    RUN_TEST(shortBinsMatchTheirWholeRange);
+    RUN_TEST(cardTypesRoundTripThroughStrings);
+    RUN_TEST(managerLoadsAndReplacesTheLiveTable);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "blocklist.h"
+#include "fraudsystem.h"
+#include "check.h"
+
+namespace {
+
+void writeEntries(const char* path, const std::string& contents) {
+    std::ofstream(path) << contents;
+}
+
+void removeFiles(const char* entriesPath, const char* databasePath) {
+    std::remove(entriesPath);
+    std::remove(databasePath);
+}
+
+void valuesAreNormalizedByType() {
+    CHECK(Blocklist::normalize(BlocklistType::CARD, "4111-1111 1111 1111") == "4111111111111111");
+    CHECK(Blocklist::normalize(BlocklistType::CARD, "no digits").empty());
+    CHECK(Blocklist::normalize(BlocklistType::WALLET, "  Wallet-1\t") == "Wallet-1");
+    CHECK(Blocklist::normalize(BlocklistType::EMAIL, " Bob@Example.COM ") == "bob@example.com");
+    CHECK(Blocklist::normalize(BlocklistType::EMAIL, "   ").empty());
+}
+
+void listedValuesAreFoundInAnyFormatting() {
+    const char* entries = "blocklist_test_cards.txt";
+    const char* database = "blocklist_test_cards.db";
+    writeEntries(entries, "# Stolen cards\n"
+                          "4111 1111 1111 1111\n"
+                          "\n"
+                          "4111-1111-1111-1111\n"
+                          "5500000000000004\n");
+
+    std::shared_ptr<const Blocklist> blocklist = Blocklist::build(BlocklistType::CARD, entries, database);
+    CHECK(blocklist != nullptr);
+    if (!blocklist) {
+        removeFiles(entries, database);
+        return;
+    }
+    CHECK(blocklist->getType() == BlocklistType::CARD);
+    CHECK(blocklist->size() == 2);
+    CHECK(blocklist->contains("4111111111111111"));
+    CHECK(blocklist->contains("5500-0000-0000-0004"));
+    CHECK(!blocklist->contains("4000000000000002"));
+    CHECK(!blocklist->contains(""));
+
+    // Values that were never listed are nearly all turned away by the filter
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(!blocklist->contains("6011" + std::to_string(100000000000 + i)));
+    }
+    BlocklistStatistics statistics = blocklist->getStatistics();
+    CHECK(statistics.entries == 2 && statistics.filterBytes > 0);
+    CHECK(statistics.hits == 2);
+    CHECK(statistics.exactLookups < 2 + 100);
+    removeFiles(entries, database);
+}
+
+void rebuildingLeavesAListInUseReadable() {
+    const char* entries = "blocklist_test_emails.txt";
+    const char* database = "blocklist_test_emails.db";
+    writeEntries(entries, "fraud@example.com\n");
+    std::shared_ptr<const Blocklist> first = Blocklist::build(BlocklistType::EMAIL, entries, database);
+
+    writeEntries(entries, "other@example.com\n");
+    std::shared_ptr<const Blocklist> second = Blocklist::build(BlocklistType::EMAIL, entries, database);
+    CHECK(first && second);
+    if (first && second) {
+        CHECK(first->contains("FRAUD@example.com"));
+        CHECK(!second->contains("fraud@example.com"));
+        CHECK(second->contains("other@example.com"));
+    }
+    removeFiles(entries, database);
+}
+
+void emptyAndUnreadableListsContainNothing() {
+    Blocklist empty(BlocklistType::WALLET);
+    CHECK(empty.size() == 0);
+    CHECK(!empty.contains("wallet"));
+    CHECK(!Blocklist::build(BlocklistType::WALLET, "missing-blocklist_test.txt", "blocklist_test_missing.db"));
+}
+
+void blockedEmailsRaiseTheRisk() {
+    const char* entries = "blocklist_test_fraud.txt";
+    const char* database = "blocklist_test_fraud.db";
+    writeEntries(entries, "blocked@example.com\n");
+
+    FraudSystem& fraudSystem = FraudSystem::getInstance();
+    Merchant merchant("Blocklist Merchant", "shop@example.com", "1 High Street");
+    Customer blocked("Blocked Customer", "Blocked@Example.com", "2 Main Street");
+    Customer allowed("Allowed Customer", "allowed@example.com", "3 Main Street");
+    auto card = [] { return PaymentMethodFactory::createCreditCard("4111111111111111", "Holder", "12/30", "123"); };
+    auto blockedPayment = TransactionFactory::createTransaction(blocked, merchant, card(), 10.0);
+    auto allowedPayment = TransactionFactory::createTransaction(allowed, merchant, card(), 10.0);
+
+    CHECK(fraudSystem.loadBlocklist(BlocklistType::EMAIL, entries, database));
+    CHECK(fraudSystem.getBlocklist(BlocklistType::EMAIL)->size() == 1);
+    CHECK(fraudSystem.assessTransaction(*blockedPayment).level == FraudRiskLevel::HIGH);
+    CHECK(fraudSystem.assessTransaction(*allowedPayment).level == FraudRiskLevel::LOW);
+
+    // A list that cannot be read leaves the loaded one in place
+    CHECK(!fraudSystem.loadBlocklist(BlocklistType::EMAIL, "missing-blocklist_test.txt", database));
+    CHECK(fraudSystem.getBlocklist(BlocklistType::EMAIL)->contains("blocked@example.com"));
+    removeFiles(entries, database);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(valuesAreNormalizedByType);
+    RUN_TEST(listedValuesAreFoundInAnyFormatting);
+    RUN_TEST(rebuildingLeavesAListInUseReadable);
+    RUN_TEST(emptyAndUnreadableListsContainNothing);
+    RUN_TEST(blockedEmailsRaiseTheRisk);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,31 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+
+/**
+ * @brief Number of failed checks so far in this test executable
+ * @return Reference to the failure count
+ */
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+// Unlike assert(), stays active in release builds and carries on after a failure
+#define CHECK(condition)                                                                      \
+    do {                                                                                      \
+        if (!(condition)) {                                                                   \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            ++checkFailures();                                                                \
+        }                                                                                     \
+    } while (0)
+
+// Runs one test function, reporting its name on std::cerr
+#define RUN_TEST(test)                                         \
+    do {                                                       \
+        std::cerr << "[ RUN ] " #test << std::endl;            \
+        test();                                                \
+    } while (0)
+
+#endif // CHECK_H
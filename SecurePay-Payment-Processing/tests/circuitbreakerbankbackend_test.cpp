@@ -0,0 +1,195 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "circuitbreakerbankbackend.h"
+#include "check.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// Answers inline with a settable code, or holds callbacks until the test answers them
+class ScriptedBackend : public BankBackend {
+public:
+    explicit ScriptedBackend(BankResponseCode code, microseconds answerDelay = microseconds(0))
+        : m_code(code), m_answerDelay(answerDelay) {}
+
+    void authorize(const BankAuthorizationRequest& /*request*/, Callback callback) override {
+        ++m_calls;
+        if (m_deferred) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_held.push_back(std::move(callback));
+            return;
+        }
+        if (m_answerDelay.count() > 0) {
+            std::this_thread::sleep_for(m_answerDelay);
+        }
+        callback(BankAuthorizationResponse{m_code, m_answerDelay});
+    }
+
+    void reverse(const BankAuthorizationRequest& /*request*/) override { ++m_reversals; }
+
+    std::string getName() const override { return "Scripted"; }
+
+    void setCode(BankResponseCode code) { m_code = code; }
+    void setDeferred(bool deferred) { m_deferred = deferred; }
+    int calls() const { return m_calls; }
+    int reversals() const { return m_reversals; }
+
+    void answerHeld() {
+        std::vector<Callback> held;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            held.swap(m_held);
+        }
+        for (Callback& callback : held) {
+            callback(BankAuthorizationResponse{m_code, microseconds(0)});
+        }
+    }
+
+private:
+    std::atomic<BankResponseCode> m_code;
+    microseconds m_answerDelay;
+    std::atomic<bool> m_deferred{false};
+    std::atomic<int> m_calls{0};
+    std::atomic<int> m_reversals{0};
+    std::mutex m_mutex;
+    std::vector<Callback> m_held;
+};
+
+const BankAuthorizationRequest kRequest{"TX-1", "Credit Card", 10.0, "411111", "Visa", "account"};
+
+// Sends one request and waits for its answer, counting how often the callback runs
+BankResponseCode send(BankBackend& backend, std::atomic<int>* answers = nullptr) {
+    auto promise = std::make_shared<std::promise<BankResponseCode>>();
+    std::future<BankResponseCode> result = promise->get_future();
+    backend.authorize(kRequest, [promise, answers](const BankAuthorizationResponse& response) {
+        if (answers) {
+            ++*answers;
+        }
+        promise->set_value(response.code);
+    });
+    return result.get();
+}
+
+CircuitBreakerConfig smallWindow() {
+    CircuitBreakerConfig config;
+    config.windowSize = 20;
+    config.minimumRequests = 10;
+    config.openDuration = milliseconds(30);
+    config.halfOpenProbes = 2;
+    return config;
+}
+
+void errorsOpenTheCircuitAndRequestsFailFast() {
+    auto primary = std::make_shared<ScriptedBackend>(BankResponseCode::ERROR);
+    auto breaker = std::make_shared<CircuitBreakerBankBackend>(primary, nullptr, smallWindow());
+
+    for (int i = 0; i < 9; ++i) {
+        send(*breaker);
+    }
+    CHECK(breaker->getState() == CircuitState::CLOSED);
+    send(*breaker);
+    CHECK(breaker->getState() == CircuitState::OPEN);
+
+    // Open: answered with ERROR without calling the primary
+    CHECK(send(*breaker) == BankResponseCode::ERROR);
+    CHECK(primary->calls() == 10);
+    CircuitBreakerStatistics statistics = breaker->getStatistics();
+    CHECK(statistics.rejected == 1);
+    CHECK(statistics.timesOpened == 1);
+}
+
+void openCircuitFailsOverToTheSecondary() {
+    auto primary = std::make_shared<ScriptedBackend>(BankResponseCode::TIMEOUT);
+    auto secondary = std::make_shared<ScriptedBackend>(BankResponseCode::APPROVED);
+    auto breaker = std::make_shared<CircuitBreakerBankBackend>(primary, secondary, smallWindow());
+
+    for (int i = 0; i < 10; ++i) {
+        send(*breaker);
+    }
+    CHECK(breaker->getState() == CircuitState::OPEN);
+    CHECK(send(*breaker) == BankResponseCode::APPROVED);
+    CHECK(secondary->calls() == 1);
+    CHECK(breaker->getStatistics().failedOver == 1);
+}
+
+void halfOpenProbesCloseOrReopenTheCircuit() {
+    auto primary = std::make_shared<ScriptedBackend>(BankResponseCode::ERROR);
+    auto breaker = std::make_shared<CircuitBreakerBankBackend>(primary, nullptr, smallWindow());
+    for (int i = 0; i < 10; ++i) {
+        send(*breaker);
+    }
+    CHECK(breaker->getState() == CircuitState::OPEN);
+
+    // A failed probe opens the circuit again
+    std::this_thread::sleep_for(milliseconds(40));
+    send(*breaker);
+    CHECK(breaker->getState() == CircuitState::OPEN);
+    CHECK(breaker->getStatistics().timesOpened == 2);
+
+    // Enough successful probes close it
+    primary->setCode(BankResponseCode::APPROVED);
+    std::this_thread::sleep_for(milliseconds(40));
+    CHECK(send(*breaker) == BankResponseCode::APPROVED);
+    CHECK(breaker->getState() == CircuitState::HALF_OPEN);
+    CHECK(send(*breaker) == BankResponseCode::APPROVED);
+    CHECK(breaker->getState() == CircuitState::CLOSED);
+}
+
+void slowAnswersOpenTheCircuit() {
+    auto primary = std::make_shared<ScriptedBackend>(BankResponseCode::APPROVED, microseconds(500));
+    CircuitBreakerConfig config = smallWindow();
+    config.slowCallThreshold = microseconds(200);
+    auto breaker = std::make_shared<CircuitBreakerBankBackend>(primary, nullptr, config);
+
+    for (int i = 0; i < 10; ++i) {
+        CHECK(send(*breaker) == BankResponseCode::APPROVED);
+    }
+    CHECK(breaker->getState() == CircuitState::OPEN);
+}
+
+void stalledRequestIsHedgedToTheSecondary() {
+    // Answers of about 200 us give the primary a p95, so later requests are hedged after the 1 ms floor
+    auto primary = std::make_shared<ScriptedBackend>(BankResponseCode::APPROVED, microseconds(200));
+    auto secondary = std::make_shared<ScriptedBackend>(BankResponseCode::APPROVED);
+    CircuitBreakerConfig config;
+    config.hedgingEnabled = true;
+    config.minimumRequests = 20;
+    config.minimumHedgeDelay = milliseconds(1);
+    auto breaker = std::make_shared<CircuitBreakerBankBackend>(primary, secondary, config);
+
+    for (int i = 0; i < 64; ++i) {
+        send(*breaker);
+    }
+    CHECK(breaker->getStatistics().p95Latency.count() > 0);
+    CHECK(breaker->getStatistics().hedged == 0);
+
+    primary->setDeferred(true);
+    std::atomic<int> answers{0};
+    CHECK(send(*breaker, &answers) == BankResponseCode::APPROVED);
+    CHECK(secondary->calls() == 1);
+
+    // The primary's late approval loses: it is not delivered again and its hold is reversed
+    primary->answerHeld();
+    CHECK(answers == 1);
+    CHECK(primary->reversals() == 1);
+    CHECK(secondary->reversals() == 0);
+    CircuitBreakerStatistics statistics = breaker->getStatistics();
+    CHECK(statistics.hedged == 1);
+    CHECK(statistics.hedgeWins == 1);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(errorsOpenTheCircuitAndRequestsFailFast);
+    RUN_TEST(openCircuitFailsOverToTheSecondary);
+    RUN_TEST(halfOpenProbesCloseOrReopenTheCircuit);
+    RUN_TEST(slowAnswersOpenTheCircuit);
+    RUN_TEST(stalledRequestIsHedgedToTheSecondary);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include "appcontroller.h"
+#include "customerprofilestore.h"
+#include "fraudsystem.h"
+#include "check.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// 09:00 UTC on some day
+const system_clock::time_point kMorning = system_clock::time_point(hours(24 * 20000 + 9));
+
+void observeMany(CustomerProfileStore& store, const std::string& customer, int count) {
+    for (int i = 0; i < count; ++i) {
+        store.observe(customer, "Corner Shop", "card-1", 20.0 + i % 3, kMorning + minutes(i));
+    }
+}
+
+void unknownCustomersHaveNoHistory() {
+    CustomerProfileStore store;
+    CustomerProfileSignals signals = store.compare("nobody", "Corner Shop", "card-1", 50.0, kMorning);
+    CHECK(signals.priorTransactions == 0 && signals.amountZScore == 0.0);
+    CHECK(!signals.newMerchant && !signals.newPaymentMethod && signals.hourShare == 0.0);
+
+    // The first transaction is compared with the empty profile it is about to start
+    signals = store.observe("alice", "Corner Shop", "card-1", 50.0, kMorning);
+    CHECK(signals.priorTransactions == 0);
+    CHECK(store.size() == 1);
+}
+
+void transactionsAreComparedWithTheHabitsBeforeThem() {
+    CustomerProfileStore store;
+    observeMany(store, "alice", 30);
+
+    CustomerProfileSignals usual = store.compare("alice", "Corner Shop", "card-1", 21.0, kMorning);
+    CHECK(usual.priorTransactions == 30);
+    CHECK(!usual.newMerchant && !usual.newPaymentMethod);
+    CHECK(usual.amountZScore < 1.0);
+    CHECK(usual.hourShare > 0.99);
+
+    CustomerProfileSignals unusual = store.compare("alice", "Jewellers", "card-2", 900.0, kMorning + hours(12));
+    CHECK(unusual.newMerchant && unusual.newPaymentMethod);
+    CHECK(unusual.amountZScore > 10.0);
+    CHECK(unusual.hourShare < 0.01);
+
+    // compare() leaves the profile alone; observe() reports the profile as it was, then adds to it
+    CHECK(store.compare("alice", "Jewellers", "card-2", 900.0, kMorning).priorTransactions == 30);
+    CHECK(store.observe("alice", "Jewellers", "card-2", 900.0, kMorning).newMerchant);
+    CHECK(!store.compare("alice", "Jewellers", "card-2", 900.0, kMorning).newMerchant);
+}
+
+void leastRecentlyActiveCustomerIsEvicted() {
+    CustomerProfileStore store(2, 0.05, 1);
+    store.observe("a", "m", "p", 1.0, kMorning);
+    store.observe("b", "m", "p", 1.0, kMorning);
+    store.observe("a", "m", "p", 1.0, kMorning);
+    store.observe("c", "m", "p", 1.0, kMorning);
+
+    CHECK(store.size() == 2);
+    CHECK(store.compare("b", "m", "p", 1.0, kMorning).priorTransactions == 0);
+    CHECK(store.compare("a", "m", "p", 1.0, kMorning).priorTransactions == 2);
+    CHECK(store.compare("c", "m", "p", 1.0, kMorning).priorTransactions == 1);
+}
+
+void snapshotsRoundTrip() {
+    const char* path = "customerprofilestore_test.profiles";
+    CustomerProfileStore saved;
+    observeMany(saved, "alice", 10);
+    observeMany(saved, "bob", 3);
+    CHECK(saved.save(path));
+
+    CustomerProfileStore loaded;
+    observeMany(loaded, "carol", 1);
+    CHECK(loaded.load(path));
+    CHECK(loaded.size() == 2);
+    CHECK(loaded.compare("carol", "Corner Shop", "card-1", 20.0, kMorning).priorTransactions == 0);
+    CustomerProfileSignals before = saved.compare("alice", "Corner Shop", "card-1", 40.0, kMorning);
+    CustomerProfileSignals after = loaded.compare("alice", "Corner Shop", "card-1", 40.0, kMorning);
+    CHECK(after.priorTransactions == 10 && after.amountZScore == before.amountZScore);
+
+    // A missing or foreign file leaves the profiles as they were
+    std::ofstream(path) << "not a snapshot";
+    CHECK(!loaded.load(path));
+    CHECK(!loaded.load("missing-customerprofilestore_test.profiles"));
+    CHECK(loaded.size() == 2);
+    std::remove(path);
+}
+
+void appControllerKeepsProfilesAcrossRestarts() {
+    const char* database = "customerprofilestore_test.db";
+    const char* profiles = "customerprofilestore_test_app.profiles";
+    const char* empty = "customerprofilestore_test_empty.profiles";
+    std::remove(profiles);
+    FraudSystem& fraudSystem = FraudSystem::getInstance();
+    CHECK(CustomerProfileStore().save(empty));
+    CHECK(fraudSystem.loadProfiles(empty));
+
+    {
+        AppController controller(database, profiles);
+        auto transaction = controller.createTransaction(controller.getCustomers()[0], controller.getMerchants()[0],
+                                                        "Credit Card", "4111111111111111", "Test Holder", "12/30",
+                                                        "123", 10.0);
+        CHECK(transaction != nullptr);
+        if (transaction) {
+            fraudSystem.screenTransaction(*transaction);
+        }
+    }
+    CHECK(std::ifstream(profiles).good());
+
+    // Forget everything in memory; the next controller reads the snapshot back
+    CHECK(fraudSystem.loadProfiles(empty));
+    CHECK(fraudSystem.getProfileStore().size() == 0);
+    {
+        AppController controller(database, profiles);
+        CHECK(fraudSystem.getProfileStore().size() == 1);
+    }
+
+    std::remove(database);
+    std::remove(profiles);
+    std::remove(empty);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(unknownCustomersHaveNoHistory);
+    RUN_TEST(transactionsAreComparedWithTheHabitsBeforeThem);
+    RUN_TEST(leastRecentlyActiveCustomerIsEvicted);
+    RUN_TEST(snapshotsRoundTrip);
+    RUN_TEST(appControllerKeepsProfilesAcrossRestarts);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+#include <vector>
+#include "duplicatedetector.h"
+#include "paymentgateway.h"
+#include "check.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// An arbitrary fixed time, so slice boundaries fall the same way on every run
+const DuplicateDetector::Clock::time_point kStart{hours(1000)};
+
+void fingerprintCoversEveryField() {
+    std::uint64_t base = DuplicateDetector::fingerprint("alice", "acme", 1000, "card");
+    CHECK(base != DuplicateDetector::fingerprint("alice", "acme", 1001, "card"));
+    CHECK(base != DuplicateDetector::fingerprint("bob", "acme", 1000, "card"));
+    CHECK(base != DuplicateDetector::fingerprint("alice", "acme", 1000, "other"));
+    CHECK(base != DuplicateDetector::fingerprint("aliceacme", "", 1000, "card"));
+    CHECK(base != 0u);
+}
+
+void remembersForAtLeastTheWindow() {
+    const std::uint64_t fingerprint = DuplicateDetector::fingerprint("alice", "acme", 500, "card");
+    // Every offset within a slice, so the bound holds wherever the first charge lands
+    for (int second = 0; second < 60; ++second) {
+        DuplicateDetector detector(seconds(60));
+        const auto first = kStart + seconds(second);
+        CHECK(!detector.checkAndRecord(fingerprint, first));
+        CHECK(detector.checkAndRecord(fingerprint, first + seconds(1)));
+        CHECK(detector.checkAndRecord(fingerprint, first + seconds(60)));
+        CHECK(!detector.checkAndRecord(fingerprint + 1, first + seconds(60)));
+    }
+}
+
+void forgetsAfterAQuarterMoreThanTheWindow() {
+    DuplicateDetector detector(seconds(60));
+    const std::uint64_t fingerprint = 42;
+    CHECK(!detector.checkAndRecord(fingerprint, kStart));
+    CHECK(detector.checkAndRecord(fingerprint, kStart + seconds(59)));
+    // Repeats are not remembered, so the window still runs from the first charge
+    CHECK(!detector.checkAndRecord(fingerprint, kStart + seconds(76)));
+    CHECK(detector.getDuplicateCount() == 1u);
+}
+
+void checkDoesNotRecord() {
+    DuplicateDetector detector(seconds(60));
+    CHECK(!detector.check(7, kStart));
+    CHECK(!detector.check(7, kStart));
+    detector.record(7, kStart);
+    CHECK(detector.check(7, kStart + seconds(1)));
+    CHECK(detector.getDuplicateCount() == 0u);
+}
+
+void forgetAllowsAnImmediateRetry() {
+    DuplicateDetector detector(seconds(60));
+    CHECK(!detector.checkAndRecord(9, kStart));
+    detector.forget(9);
+    CHECK(!detector.check(9, kStart + seconds(1)));
+    CHECK(!detector.checkAndRecord(9, kStart + seconds(1)));
+    CHECK(detector.checkAndRecord(9, kStart + seconds(2)));
+}
+
+void forgetKeepsCollidingEntriesReachable() {
+    // Low bits shared in runs of 64, so entries pile into long probe runs that erasing has to repair
+    DuplicateDetector detector(seconds(60));
+    std::vector<std::uint64_t> fingerprints;
+    for (std::uint64_t i = 1; i <= 5000; ++i) {
+        fingerprints.push_back(((i * 0x9E3779B97F4A7C15ULL) & ~63ULL) | ((i % 7) + 1));
+        detector.record(fingerprints.back(), kStart);
+    }
+    for (std::size_t i = 0; i < fingerprints.size(); i += 3) {
+        detector.forget(fingerprints[i]);
+    }
+    for (std::size_t i = 0; i < fingerprints.size(); ++i) {
+        CHECK(detector.check(fingerprints[i], kStart) == (i % 3 != 0));
+    }
+}
+
+void zeroWindowDisablesDetection() {
+    DuplicateDetector detector(seconds(60));
+    CHECK(!detector.checkAndRecord(5, kStart));
+    detector.setWindow(seconds(0));
+    CHECK(detector.getWindow() == DuplicateDetector::Clock::duration::zero());
+    CHECK(!detector.checkAndRecord(5, kStart));
+    CHECK(!detector.checkAndRecord(5, kStart));
+}
+
+std::unique_ptr<Transaction> makePayment(double amount) {
+    Customer customer("Duplicate Customer", "duplicate@example.com", "1 Main Street");
+    Merchant merchant("Duplicate Merchant", "shop@example.com", "2 High Street");
+    return TransactionFactory::createTransaction(customer, merchant,
+        PaymentMethodFactory::createCreditCard("4111111111111111", "Test Holder", "12/30", "123"), amount);
+}
+
+TransactionStatus process(PaymentGateway& gateway, std::unique_ptr<Transaction> transaction) {
+    const std::string transactionId = transaction->getTransactionId();
+    gateway.processTransaction(std::move(transaction));
+    const Transaction* processed = gateway.findTransaction(transactionId);
+    return processed ? processed->getStatus() : TransactionStatus::PENDING;
+}
+
+void gatewayRejectsARepeatWithItsReason() {
+    PaymentGateway gateway;
+    CHECK(process(gateway, makePayment(25.0)) == TransactionStatus::APPROVED);
+
+    auto repeat = makePayment(25.0);
+    const std::string repeatId = repeat->getTransactionId();
+    CHECK(process(gateway, std::move(repeat)) == TransactionStatus::REJECTED);
+    CHECK(gateway.findTransaction(repeatId)->getRejectionReason() == "Duplicate charge");
+    CHECK(gateway.getDuplicateDetector().getDuplicateCount() == 1u);
+}
+
+void paymentDeclinedOnReviewCanBeRetried() {
+    FraudSystem& fraudSystem = FraudSystem::getInstance();
+    fraudSystem.setRules(FraudRuleSet::compile(
+        "rule,large_amount,3,amount > 1000\n"
+        "level,medium,1\n"
+        "level,high,2\n"));
+    PaymentGateway gateway;
+
+    CHECK(process(gateway, makePayment(2500.0)) == TransactionStatus::FLAGGED_FOR_REVIEW);
+    Transaction* held = gateway.getReviewQueue().claim("reviewer");
+    CHECK(held != nullptr);
+    if (held) {
+        CHECK(held->getRejectionReason().empty());
+        CHECK(gateway.declineReview(held->getTransactionId(), "reviewer"));
+    }
+
+    // Declined before anything was charged, so the same payment is not a duplicate
+    CHECK(process(gateway, makePayment(2500.0)) == TransactionStatus::FLAGGED_FOR_REVIEW);
+    CHECK(gateway.getDuplicateDetector().getDuplicateCount() == 0u);
+    fraudSystem.setRules(FraudRuleSet::defaults());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(fingerprintCoversEveryField);
+    RUN_TEST(remembersForAtLeastTheWindow);
+    RUN_TEST(forgetsAfterAQuarterMoreThanTheWindow);
+    RUN_TEST(checkDoesNotRecord);
+    RUN_TEST(forgetAllowsAnImmediateRetry);
+    RUN_TEST(forgetKeepsCollidingEntriesReachable);
+    RUN_TEST(zeroWindowDisablesDetection);
+    RUN_TEST(gatewayRejectsARepeatWithItsReason);
+    RUN_TEST(paymentDeclinedOnReviewCanBeRetried);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "fraudalertstore.h"
+#include "check.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// Keeps the review state of every alert it is asked to save, and can be told to fail
+class RecordingDataManager : public DataManager {
+public:
+    bool initialize() override { return true; }
+    bool saveAll() override { return true; }
+    bool loadAll() override { return true; }
+    bool saveCustomer(const Customer& /*customer*/) override { return true; }
+    std::vector<Customer> loadCustomers() override { return {}; }
+    bool saveMerchant(const Merchant& /*merchant*/) override { return true; }
+    std::vector<Merchant> loadMerchants() override { return {}; }
+    bool saveTransaction(const Transaction& /*transaction*/) override { return true; }
+    bool saveTransactions(const std::vector<const Transaction*>& /*transactions*/) override { return true; }
+    std::vector<std::unique_ptr<Transaction>> loadTransactions(const std::vector<Customer>& /*customers*/,
+                                                               const std::vector<Merchant>& /*merchants*/) override {
+        return {};
+    }
+    bool saveRefund(const Refund& /*refund*/) override { return true; }
+    std::vector<std::unique_ptr<Refund>> loadRefunds(
+        const std::vector<std::unique_ptr<Transaction>>& /*transactions*/) override {
+        return {};
+    }
+    bool saveFraudAlert(const FraudAlert& fraudAlert) override { return saveFraudAlerts({&fraudAlert}); }
+    bool saveFraudAlerts(const std::vector<const FraudAlert*>& fraudAlerts) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_writes;
+        if (m_failing) {
+            return false;
+        }
+        for (const FraudAlert* alert : fraudAlerts) {
+            m_saved[alert->getAlertId()] = alert->isReviewed();
+        }
+        return true;
+    }
+    std::vector<std::unique_ptr<FraudAlert>> loadFraudAlerts(
+        const std::vector<std::unique_ptr<Transaction>>& /*transactions*/) override {
+        return {};
+    }
+
+    void setFailing(bool failing) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failing = failing;
+    }
+    std::map<std::string, bool> saved() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_saved;
+    }
+    int writes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_writes;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, bool> m_saved;
+    int m_writes = 0;
+    bool m_failing = false;
+};
+
+const Customer kCustomer("Alert Customer", "alert@example.com", "1 Main Street");
+const Merchant kMerchant("Alert Merchant", "shop@example.com", "2 High Street");
+
+std::unique_ptr<Transaction> makeTransaction(double amount) {
+    return TransactionFactory::createTransaction(kCustomer, kMerchant,
+        PaymentMethodFactory::createCreditCard("4111111111111111", "Test Holder", "12/30", "123"), amount);
+}
+
+const FraudAlert* addAlert(FraudAlertStore& store, FraudRiskLevel level, double amount = 10.0) {
+    return store.add(FraudAlertFactory::createFraudAlert(*makeTransaction(amount), level, "Test alert"));
+}
+
+// Every alert meeting the filter, found by walking them all; the reference for query()
+std::vector<const FraudAlert*> scan(const FraudAlertStore& store, const FraudAlertFilter& filter) {
+    std::vector<const FraudAlert*> matching;
+    for (const FraudAlert* alert : store.getAll()) {
+        if ((filter.transactionId.empty() || alert->getTransactionId() == filter.transactionId) &&
+            (!filter.filterRiskLevel || alert->getRiskLevel() == filter.riskLevel) &&
+            (!filter.filterReviewed || alert->isReviewed() == filter.reviewed) &&
+            alert->getCreatedAt() >= filter.from && alert->getCreatedAt() < filter.to) {
+            matching.push_back(alert);
+        }
+    }
+    return matching;
+}
+
+template <typename Predicate>
+bool waitFor(Predicate predicate) {
+    auto deadline = steady_clock::now() + seconds(5);
+    while (!predicate()) {
+        if (steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+void alertsKeepTheirDetailsAfterTheTransactionIsGone() {
+    FraudAlertStore store;
+    std::string transactionId;
+    {
+        auto transaction = makeTransaction(1234.5);
+        transactionId = transaction->getTransactionId();
+        CHECK(store.add(FraudAlertFactory::createFraudAlert(*transaction, FraudRiskLevel::HIGH, "Large amount")));
+    }
+
+    std::vector<const FraudAlert*> alerts = store.getForTransaction(transactionId);
+    CHECK(alerts.size() == 1);
+    if (alerts.size() == 1) {
+        CHECK(alerts[0]->getCustomerName() == kCustomer.getName());
+        CHECK(alerts[0]->getMerchantName() == kMerchant.getName());
+        CHECK(alerts[0]->getAmount() == 1234.5);
+        CHECK(alerts[0]->getDescription() == "Large amount");
+    }
+    CHECK(!store.add(nullptr));
+}
+
+void queriesMatchAFullScan() {
+    FraudAlertStore store;
+    std::vector<const FraudAlert*> early;
+    for (int i = 0; i < 60; ++i) {
+        early.push_back(addAlert(store, i % 3 == 0 ? FraudRiskLevel::HIGH : FraudRiskLevel::MEDIUM));
+    }
+    std::this_thread::sleep_for(milliseconds(5));
+    const auto middle = system_clock::now();
+    std::this_thread::sleep_for(milliseconds(5));
+    for (int i = 0; i < 5; ++i) {
+        addAlert(store, FraudRiskLevel::MEDIUM);
+    }
+    for (int i = 0; i < 60; i += 4) {
+        CHECK(store.setReviewed(early[i]->getAlertId(), true));
+    }
+    CHECK(!store.setReviewed("FA-missing", true));
+    CHECK(store.unreviewedCount() == 65 - 15);
+
+    std::vector<FraudAlertFilter> filters(7);
+    filters[1].filterRiskLevel = true;
+    filters[1].riskLevel = FraudRiskLevel::HIGH;
+    filters[2].filterReviewed = true;
+    filters[2].reviewed = true;
+    filters[3].from = middle;
+    filters[4] = filters[3];
+    filters[4].filterReviewed = true;   // Far more unreviewed alerts than recent ones: starts from the time range
+    filters[5].to = middle;
+    filters[5].filterRiskLevel = true;
+    filters[5].riskLevel = FraudRiskLevel::HIGH;
+    filters[6].transactionId = early[7]->getTransactionId();
+    filters[6].from = middle;
+
+    for (const FraudAlertFilter& filter : filters) {
+        CHECK(store.query(filter) == scan(store, filter));
+    }
+    CHECK(store.query(filters[3]).size() == 5);
+    CHECK(store.query(filters[6]).empty());
+
+    FraudAlertFilter backwards;
+    backwards.from = middle;
+    backwards.to = middle - hours(1);
+    CHECK(store.query(backwards).empty());
+}
+
+void reviewStateCanChangeWhileReportsReadIt() {
+    FraudAlertStore store;
+    const FraudAlert* alert = addAlert(store, FraudRiskLevel::HIGH);
+    std::atomic<bool> done{false};
+    std::thread reviewer([&] {
+        for (int i = 0; i < 10000; ++i) {
+            store.setReviewed(alert->getAlertId(), i % 2 == 0);
+        }
+        done = true;
+    });
+
+    // A report reading the flag without the store's lock
+    while (!done) {
+        alert->isReviewed();
+    }
+    reviewer.join();
+    CHECK(!alert->isReviewed());
+    CHECK(store.unreviewedCount() == 1);
+
+    // A copy keeps the state it was taken with
+    FraudAlert copy(*alert);
+    store.setReviewed(alert->getAlertId(), true);
+    CHECK(!copy.isReviewed() && alert->isReviewed());
+}
+
+void changesArePersistedInBatches() {
+    RecordingDataManager dataManager;
+    FraudAlertStore store(4);
+    const FraudAlert* first = addAlert(store, FraudRiskLevel::MEDIUM);
+    store.setDataManager(&dataManager);
+
+    addAlert(store, FraudRiskLevel::HIGH);
+    addAlert(store, FraudRiskLevel::HIGH);
+    CHECK(dataManager.writes() == 0);
+    addAlert(store, FraudRiskLevel::HIGH);
+    CHECK(waitFor([&] { return dataManager.saved().size() == 4; }));
+
+    // A failed write keeps its alerts queued for the next one
+    dataManager.setFailing(true);
+    store.setReviewed(first->getAlertId(), true);
+    CHECK(!store.flush());
+    dataManager.setFailing(false);
+    CHECK(store.flush());
+    CHECK(dataManager.saved().at(first->getAlertId()));
+    CHECK(store.flush());
+
+    store.setDataManager(nullptr);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(alertsKeepTheirDetailsAfterTheTransactionIsGone);
+    RUN_TEST(queriesMatchAFullScan);
+    RUN_TEST(reviewStateCanChangeWhileReportsReadIt);
+    RUN_TEST(changesArePersistedInBatches);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include "fraudmodel.h"
+#include "fraudsystem.h"
+#include "check.h"
+
+namespace {
+
+double& feature(FraudFeatures& features, FraudFeature which) {
+    return features[static_cast<std::size_t>(which)];
+}
+
+void parseRejectsModelsThatCannotDiscriminate() {
+    CHECK(!FraudModel::parse("model,logistic\nbias,2\nlevel,medium,0.5\nlevel,high,0.8\n"));
+    CHECK(!FraudModel::parse("model,logistic\nweight,amount,0\nlevel,medium,0.5\nlevel,high,0.8\n"));
+    CHECK(!FraudModel::parse("weight,amount,1\nlevel,high,0.8\n"));
+    CHECK(!FraudModel::parse("weight,amount,1\nlevel,medium,5\nlevel,high,40\n"));
+    CHECK(FraudModel::parse("model,linear\nweight,amount,1\nlevel,medium,5\nlevel,high,40\n"));
+}
+
+void scoreBatchMatchesScoreExactly() {
+    std::shared_ptr<const FraudModel> model = FraudModel::parse(
+        "model,logistic\n"
+        "bias,-3\n"
+        "weight,amount,0.002\n"
+        "weight,amount_zscore,0.8,1,2\n"
+        "weight,hour_share,-1\n"
+        "weight,card_count_minute,0.37\n"
+        "weight,new_merchant,1.1\n"
+        "level,medium,0.5\n"
+        "level,high,0.9\n");
+    CHECK(model);
+    if (!model) {
+        return;
+    }
+
+    std::mt19937 random(11);
+    std::uniform_real_distribution<double> value(-50.0, 3000.0);
+    for (std::size_t rows : {1u, 3u, 4u, 5u, 257u, 1000u}) {
+        FraudBatch batch(rows);
+        std::vector<FraudFeatures> features(rows);
+        for (std::size_t row = 0; row < rows; ++row) {
+            for (double& feature : features[row]) {
+                feature = value(random);
+            }
+            batch.setRow(row, features[row]);
+        }
+
+        std::vector<double> scores = model->scoreBatch(batch);
+        CHECK(scores.size() == rows);
+        for (std::size_t row = 0; row < rows && row < scores.size(); ++row) {
+            CHECK(scores[row] == model->score(features[row]));
+        }
+    }
+}
+
+void linearModelsScoreTheWeightedSum() {
+    std::shared_ptr<const FraudModel> model = FraudModel::parse(
+        "# Standardized amount, plus a flat penalty for a new merchant\n"
+        "model,linear\n"
+        "bias,1\n"
+        "weight,amount,2,100,50\n"
+        "weight,new_merchant,3\n"
+        "level,medium,5\n"
+        "level,high,10\n");
+    CHECK(model && model->getType() == FraudModelType::LINEAR && model->size() == 2);
+    if (!model) {
+        return;
+    }
+
+    // The mean and scale are folded in: 1 + 2 * (amount - 100) / 50
+    FraudFeatures features{};
+    feature(features, FraudFeature::AMOUNT) = 100;
+    CHECK(std::fabs(model->score(features) - 1.0) < 1e-9);
+    feature(features, FraudFeature::AMOUNT) = 200;
+    CHECK(std::fabs(model->score(features) - 5.0) < 1e-9);
+    feature(features, FraudFeature::NEW_MERCHANT) = 1;
+    CHECK(std::fabs(model->score(features) - 8.0) < 1e-9);
+
+    CHECK(model->levelFor(4.9) == FraudRiskLevel::LOW);
+    CHECK(model->levelFor(5.0) == FraudRiskLevel::MEDIUM);
+    CHECK(model->levelFor(10.0) == FraudRiskLevel::HIGH);
+}
+
+void logisticScoresAreProbabilities() {
+    std::shared_ptr<const FraudModel> model = FraudModel::parse(
+        "model,logistic\n"
+        "weight,amount,1\n"
+        "level,medium,0.5\n"
+        "level,high,0.9\n");
+    CHECK(model && model->getType() == FraudModelType::LOGISTIC);
+    if (!model) {
+        return;
+    }
+
+    FraudFeatures features{};
+    CHECK(std::fabs(model->score(features) - 0.5) < 1e-9);
+    for (double amount : {-1000.0, -3.0, 1.0, 3.0, 1000.0}) {
+        feature(features, FraudFeature::AMOUNT) = amount;
+        double score = model->score(features);
+        CHECK(score >= 0.0 && score <= 1.0);
+        CHECK((score < 0.5) == (amount < 0));
+    }
+    feature(features, FraudFeature::AMOUNT) = 3;
+    CHECK(model->levelFor(model->score(features)) == FraudRiskLevel::HIGH);
+}
+
+void loadedModelCanRaiseTheRisk() {
+    const char* path = "fraudmodel_test.model";
+    std::ofstream(path) << "model,linear\n"
+                           "weight,amount,1\n"
+                           "level,medium,500\n"
+                           "level,high,800\n";
+
+    FraudSystem& fraudSystem = FraudSystem::getInstance();
+    Customer customer("Model Customer", "model@example.com", "1 Main Street");
+    Merchant merchant("Model Merchant", "shop@example.com", "2 High Street");
+    auto transaction = TransactionFactory::createTransaction(customer, merchant,
+        PaymentMethodFactory::createCreditCard("4111111111111111", "Test Holder", "12/30", "123"), 900.0);
+    CHECK(fraudSystem.assessTransaction(*transaction).level == FraudRiskLevel::LOW);
+
+    CHECK(fraudSystem.loadModelFromFile(path));
+    CHECK(fraudSystem.getModel() && fraudSystem.getModel()->size() == 1);
+    CHECK(fraudSystem.assessTransaction(*transaction).level == FraudRiskLevel::HIGH);
+
+    // A file with errors leaves the loaded model live
+    std::ofstream(path) << "model,linear\nlevel,high,1\n";
+    CHECK(!fraudSystem.loadModelFromFile(path));
+    CHECK(fraudSystem.getModel() && fraudSystem.getModel()->size() == 1);
+
+    fraudSystem.setModel(nullptr);
+    CHECK(fraudSystem.assessTransaction(*transaction).level == FraudRiskLevel::LOW);
+    std::remove(path);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(parseRejectsModelsThatCannotDiscriminate);
+    RUN_TEST(scoreBatchMatchesScoreExactly);
+    RUN_TEST(linearModelsScoreTheWeightedSum);
+    RUN_TEST(logisticScoresAreProbabilities);
+    RUN_TEST(loadedModelCanRaiseTheRisk);
+    return checkFailures() == 0 ? 0 : 1;
+}
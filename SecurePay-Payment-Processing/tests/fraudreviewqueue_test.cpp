@@ -0,0 +1,129 @@
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "fraudreviewqueue.h"
+#include "check.h"
+
+namespace {
+
+const Customer kCustomer("Review Customer", "review@example.com", "1 Main Street");
+const Merchant kMerchant("Review Merchant", "shop@example.com", "2 High Street");
+
+std::unique_ptr<Transaction> makeTransaction(double amount) {
+    return TransactionFactory::createTransaction(kCustomer, kMerchant,
+        PaymentMethodFactory::createCreditCard("4111111111111111", "Test Holder", "12/30", "123"), amount);
+}
+
+void riskiestAreClaimedFirst() {
+    std::vector<std::unique_ptr<Transaction>> transactions;
+    for (double amount : {100.0, 500.0, 100.0, 900.0}) {
+        transactions.push_back(makeTransaction(amount));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    FraudReviewQueue queue;
+    CHECK(queue.enqueue(transactions[0].get(), 2.0));
+    CHECK(queue.enqueue(transactions[1].get(), 2.0));
+    CHECK(queue.enqueue(transactions[2].get(), 2.0));
+    CHECK(queue.enqueue(transactions[3].get(), 1.0));
+    CHECK(!queue.enqueue(transactions[0].get(), 5.0));
+    CHECK(queue.size() == 4);
+
+    // Score first, then amount, then the older of two equal transactions
+    std::vector<const Transaction*> expected{transactions[1].get(), transactions[0].get(),
+                                             transactions[2].get(), transactions[3].get()};
+    CHECK(queue.peek(10) == expected);
+    CHECK(queue.peek(2).size() == 2);
+    for (const Transaction* next : expected) {
+        CHECK(queue.claim("reviewer") == next);
+    }
+    CHECK(queue.claim("reviewer") == nullptr);
+    CHECK(queue.unclaimedCount() == 0 && queue.size() == 4);
+    CHECK(queue.getClaimed("reviewer") == expected);
+}
+
+void claimsBelongToOneReviewer() {
+    auto transaction = makeTransaction(50.0);
+    const std::string& transactionId = transaction->getTransactionId();
+    FraudReviewQueue queue;
+    queue.enqueue(transaction.get(), 3.0);
+
+    CHECK(queue.claim("") == nullptr);
+    CHECK(queue.claim("alice") == transaction.get());
+    CHECK(queue.claim("bob") == nullptr);
+    CHECK(!queue.release(transactionId, "bob"));
+    CHECK(queue.resolve(transactionId, "bob") == nullptr);
+
+    // Released back to the queue, it can be taken by someone else
+    CHECK(queue.release(transactionId, "alice"));
+    CHECK(!queue.release(transactionId, "alice"));
+    CHECK(queue.getClaimed("alice").empty());
+    CHECK(queue.claim("bob") == transaction.get());
+
+    CHECK(queue.resolve(transactionId, "alice") == nullptr);
+    CHECK(queue.resolve(transactionId, "bob") == transaction.get());
+    CHECK(queue.resolve(transactionId, "bob") == nullptr);
+    CHECK(queue.size() == 0 && queue.getClaimed("bob").empty());
+
+    // Resolved transactions can be queued again
+    CHECK(queue.enqueue(transaction.get(), 3.0));
+}
+
+void concurrentReviewersNeverShareAClaim() {
+    constexpr int kTransactions = 2000;
+    constexpr int kReviewers = 4;
+    std::vector<std::unique_ptr<Transaction>> transactions;
+    FraudReviewQueue queue;
+    for (int i = 0; i < kTransactions; ++i) {
+        transactions.push_back(makeTransaction(10.0 + i));
+        queue.enqueue(transactions.back().get(), i % 5);
+    }
+
+    std::vector<std::vector<const Transaction*>> resolved(kReviewers);
+    std::mutex releasedMutex;
+    std::set<const Transaction*> released;
+    std::vector<std::thread> threads;
+    for (int r = 0; r < kReviewers; ++r) {
+        threads.emplace_back([&, r] {
+            const std::string reviewer = "reviewer-" + std::to_string(r);
+            while (Transaction* transaction = queue.claim(reviewer)) {
+                // Every other transaction is handed back once before anyone resolves it
+                bool handBack = false;
+                if (static_cast<int>(transaction->getAmount()) % 2 == 0) {
+                    std::lock_guard<std::mutex> lock(releasedMutex);
+                    handBack = released.insert(transaction).second;
+                }
+                if (handBack && queue.release(transaction->getTransactionId(), reviewer)) {
+                    continue;
+                }
+                if (queue.resolve(transaction->getTransactionId(), reviewer) == transaction) {
+                    resolved[r].push_back(transaction);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<const Transaction*> seen;
+    std::size_t total = 0;
+    for (const auto& claims : resolved) {
+        total += claims.size();
+        seen.insert(claims.begin(), claims.end());
+    }
+    CHECK(queue.size() == 0);
+    CHECK(total == static_cast<std::size_t>(kTransactions) && seen.size() == total);
+    CHECK(released.size() == kTransactions / 2);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(riskiestAreClaimedFirst);
+    RUN_TEST(claimsBelongToOneReviewer);
+    RUN_TEST(concurrentReviewersNeverShareAClaim);
+    return checkFailures() == 0 ? 0 : 1;
+}
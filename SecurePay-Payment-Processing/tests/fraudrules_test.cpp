@@ -0,0 +1,193 @@
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include "fraudrules.h"
+#include "paymentgateway.h"
+#include "check.h"
+
+namespace {
+
+const char* kRules =
+    "# Test rules\n"
+    "rule,large_amount,1,amount > 1000\n"
+    "rule,fast_wallet,0.75,wallet == 1 && card_count_minute >= 3\n"
+    "rule,prepaid,1,prepaid != 0\n"
+    "rule,small_after_spend,2,customer_amount_day >= 500 && amount <= 50 && merchant_count_hour < 7\n"
+    "\n"
+    "level,medium,1\n"
+    "level,high,2.5\n";
+
+double& feature(FraudFeatures& features, FraudFeature which) {
+    return features[static_cast<std::size_t>(which)];
+}
+
+// Mostly small counts and flags, with some large amounts so every rule both matches and misses
+FraudBatch randomBatch(std::size_t rows, std::mt19937& random) {
+    FraudBatch batch(rows);
+    for (std::size_t row = 0; row < rows; ++row) {
+        FraudFeatures features{};
+        for (double& value : features) {
+            value = random() % 4 == 0 ? static_cast<double>(random() % 2000) : static_cast<double>(random() % 3);
+        }
+        batch.setRow(row, features);
+    }
+    return batch;
+}
+
+void compileRejectsUnknownFeature() {
+    CHECK(!FraudRuleSet::compile("rule,bad,1,no_such_feature > 1\n"));
+}
+
+void compileRejectsMalformedLines() {
+    CHECK(!FraudRuleSet::compile("rule,missing_condition,1\n"));
+    CHECK(!FraudRuleSet::compile("rule,bad_weight,heavy,amount > 1\n"));
+    CHECK(!FraudRuleSet::compile("rule,no_operator,1,amount 1\n"));
+    CHECK(!FraudRuleSet::compile("rule,bad_constant,1,amount > lots\n"));
+    CHECK(!FraudRuleSet::compile("limit,amount,1\n"));
+    CHECK(!FraudRuleSet::compile("level,extreme,3\n"));
+    CHECK(!FraudRuleSet::compile("level,medium,3\nlevel,high,2\n"));
+
+    std::string tooMany;
+    for (std::size_t i = 0; i <= FraudRuleSet::kMaxRules; ++i) {
+        tooMany += "rule,r" + std::to_string(i) + ",1,amount > " + std::to_string(i) + "\n";
+    }
+    CHECK(!FraudRuleSet::compile(tooMany));
+}
+
+void compiledRulesScoreAndLevelATransaction() {
+    std::shared_ptr<const FraudRuleSet> rules = FraudRuleSet::compile(kRules);
+    CHECK(rules && rules->size() == 4);
+    if (!rules) {
+        return;
+    }
+    CHECK(rules->getRuleName(1) == "fast_wallet");
+
+    FraudFeatures features{};
+    feature(features, FraudFeature::AMOUNT) = 20;
+    FraudAssessment assessment = rules->evaluate(features);
+    CHECK(assessment.level == FraudRiskLevel::LOW && assessment.score == 0 && assessment.matchedRules == 0);
+
+    // Every predicate of a rule has to hold
+    feature(features, FraudFeature::DIGITAL_WALLET) = 1;
+    CHECK(rules->evaluate(features).matchedRules == 0);
+    feature(features, FraudFeature::CARD_COUNT_MINUTE) = 3;
+    assessment = rules->evaluate(features);
+    CHECK(assessment.matchedRules == 0x2 && assessment.score == 0.75);
+    CHECK(assessment.level == FraudRiskLevel::LOW);
+
+    feature(features, FraudFeature::PREPAID_CARD) = 1;
+    assessment = rules->evaluate(features);
+    CHECK(assessment.matchedRules == 0x6 && assessment.level == FraudRiskLevel::MEDIUM);
+
+    feature(features, FraudFeature::CUSTOMER_AMOUNT_DAY) = 500;
+    assessment = rules->evaluate(features);
+    CHECK(assessment.matchedRules == 0xE && assessment.score == 3.75);
+    CHECK(assessment.level == FraudRiskLevel::HIGH);
+}
+
+void featureNamesMatchRuleFiles() {
+    FraudFeature feature;
+    CHECK(FraudRuleSet::featureFromString("amount", feature) && feature == FraudFeature::AMOUNT);
+    CHECK(FraudRuleSet::featureFromString("card_count_minute", feature) && feature == FraudFeature::CARD_COUNT_MINUTE);
+    CHECK(!FraudRuleSet::featureFromString("Amount", feature));
+    CHECK(FraudRuleSet::defaults() && FraudRuleSet::defaults()->size() > 0);
+}
+
+void fileReloadSwapsTheLiveRules() {
+    FraudSystem& fraudSystem = FraudSystem::getInstance();
+    const char* path = "fraudrules_test.rules";
+    std::ofstream(path) << kRules;
+
+    std::shared_ptr<const FraudRuleSet> before = fraudSystem.getRules();
+    CHECK(fraudSystem.loadRulesFromFile(path));
+    std::shared_ptr<const FraudRuleSet> loaded = fraudSystem.getRules();
+    CHECK(loaded != before && loaded->size() == 4);
+
+    // A file with errors leaves the loaded rules live, and a held snapshot stays usable
+    std::ofstream(path) << "rule,bad,1,no_such_feature > 1\n";
+    CHECK(!fraudSystem.loadRulesFromFile(path));
+    CHECK(!fraudSystem.loadRulesFromFile("missing-fraudrules_test.rules"));
+    CHECK(fraudSystem.getRules() == loaded);
+
+    fraudSystem.setRules(nullptr);
+    CHECK(fraudSystem.getRules() == FraudRuleSet::defaults());
+    CHECK(loaded->getRuleName(0) == "large_amount");
+    std::remove(path);
+}
+
+void evaluateBatchMatchesEvaluate() {
+    std::shared_ptr<const FraudRuleSet> compiled = FraudRuleSet::compile(kRules);
+    CHECK(compiled);
+    if (!compiled) {
+        return;
+    }
+
+    std::mt19937 random(7);
+    // Sizes around the vector width exercise both the vector body and the scalar tail
+    for (std::size_t rows : {0u, 1u, 2u, 3u, 4u, 5u, 7u, 8u, 9u, 1001u}) {
+        FraudBatch batch = randomBatch(rows, random);
+        for (const auto& rules : {compiled, FraudRuleSet::defaults()}) {
+            std::vector<FraudAssessment> batched = rules->evaluateBatch(batch);
+            CHECK(batched.size() == rows);
+            for (std::size_t row = 0; row < rows && row < batched.size(); ++row) {
+                FraudAssessment single = rules->evaluate(batch.getRow(row));
+                CHECK(batched[row].level == single.level);
+                CHECK(batched[row].score == single.score);
+                CHECK(batched[row].matchedRules == single.matchedRules);
+            }
+        }
+    }
+}
+
+void gatewayBatchesAreScreenedLikeSinglePayments() {
+    FraudSystem& fraudSystem = FraudSystem::getInstance();
+    fraudSystem.setRules(FraudRuleSet::compile(
+        "rule,large_amount,3,amount > 1000\n"
+        "level,medium,1\n"
+        "level,high,2\n"));
+
+    Customer customer("Batch Customer", "batch@example.com", "1 Main Street");
+    Merchant merchant("Batch Merchant", "shop@example.com", "2 High Street");
+    std::vector<std::unique_ptr<Transaction>> transactions;
+    std::vector<const Transaction*> views;
+    for (int i = 0; i < 9; ++i) {
+        transactions.push_back(TransactionFactory::createTransaction(customer, merchant,
+            PaymentMethodFactory::createDigitalWallet("wallet-" + std::to_string(i), "batch@example.com"),
+            i % 3 == 0 ? 2000.0 + i : 10.0 + i));
+        views.push_back(transactions.back().get());
+    }
+
+    // Read-only batch scoring agrees with assessing each transaction
+    std::vector<FraudAssessment> assessed = fraudSystem.assessBatch(fraudSystem.buildBatch(views));
+    CHECK(assessed.size() == views.size());
+    for (std::size_t i = 0; i < views.size() && i < assessed.size(); ++i) {
+        FraudAssessment single = fraudSystem.assessTransaction(*views[i]);
+        CHECK(assessed[i].level == single.level && assessed[i].score == single.score);
+        CHECK(assessed[i].level == (i % 3 == 0 ? FraudRiskLevel::HIGH : FraudRiskLevel::LOW));
+    }
+
+    // The gateway screens the batch once, holding the high-risk payments for review
+    PaymentGateway gateway;
+    gateway.getDuplicateDetector().setWindow(std::chrono::seconds(0));
+    std::vector<PaymentResult> results = gateway.processTransactionBatch(std::move(transactions));
+    CHECK(results.size() == views.size());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        CHECK(results[i].status == (i % 3 == 0 ? TransactionStatus::FLAGGED_FOR_REVIEW : TransactionStatus::APPROVED));
+    }
+    CHECK(fraudSystem.getVelocityTracker().get(VelocityDimension::CUSTOMER, customer.getName()).day.count == 9);
+
+    fraudSystem.setRules(FraudRuleSet::defaults());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(compileRejectsUnknownFeature);
+    RUN_TEST(compileRejectsMalformedLines);
+    RUN_TEST(compiledRulesScoreAndLevelATransaction);
+    RUN_TEST(featureNamesMatchRuleFiles);
+    RUN_TEST(fileReloadSwapsTheLiveRules);
+    RUN_TEST(evaluateBatchMatchesEvaluate);
+    RUN_TEST(gatewayBatchesAreScreenedLikeSinglePayments);
+    return checkFailures() == 0 ? 0 : 1;
+}
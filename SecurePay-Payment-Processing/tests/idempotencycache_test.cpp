@@ -0,0 +1,91 @@
+#include <chrono>
+#include <future>
+#include <memory>
+#include <utility>
+#include "idempotencycache.h"
+#include "check.h"
+
+namespace {
+
+void repeatedClaimFindsTheOriginalPayment() {
+    IdempotencyCache cache;
+
+    IdempotencyClaim first = cache.claim("order-1", "TX-1");
+    CHECK(first.claimed);
+    CHECK(first.transactionId == "TX-1");
+
+    // Still in flight: the retry learns the original ID but no result yet
+    IdempotencyClaim inFlight = cache.claim("order-1", "TX-2");
+    CHECK(!inFlight.claimed);
+    CHECK(inFlight.transactionId == "TX-1");
+    CHECK(!inFlight.completed);
+
+    cache.complete("order-1", PaymentResult{"TX-1", TransactionStatus::APPROVED, FraudRiskLevel::LOW});
+    IdempotencyClaim completed = cache.claim("order-1", "TX-3");
+    CHECK(!completed.claimed);
+    CHECK(completed.completed);
+    CHECK(completed.result.transactionId == "TX-1");
+    CHECK(completed.result.status == TransactionStatus::APPROVED);
+    CHECK(cache.size() == 1);
+}
+
+void waitersAreReleasedWhenTheOriginalCompletes() {
+    IdempotencyCache cache;
+    CHECK(cache.claim("order-2", "TX-1").claimed);
+
+    auto waiter = std::make_shared<std::promise<PaymentResult>>();
+    std::future<PaymentResult> result = waiter->get_future();
+    CHECK(!cache.claim("order-2", "TX-2", waiter).claimed);
+    CHECK(result.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+
+    cache.complete("order-2", PaymentResult{"TX-1", TransactionStatus::DECLINED, FraudRiskLevel::MEDIUM});
+    PaymentResult delivered = result.get();
+    CHECK(delivered.transactionId == "TX-1");
+    CHECK(delivered.status == TransactionStatus::DECLINED);
+    CHECK(delivered.riskLevel == FraudRiskLevel::MEDIUM);
+}
+
+void fullShardEvictsTheOldestKey() {
+    IdempotencyCache cache(2, std::chrono::hours(1), 1);
+    CHECK(cache.claim("a", "TX-A").claimed);
+
+    auto waiter = std::make_shared<std::promise<PaymentResult>>();
+    std::future<PaymentResult> result = waiter->get_future();
+    // Handed over, so the cache holds the only reference to the promise
+    CHECK(!cache.claim("a", "TX-A2", std::move(waiter)).claimed);
+
+    CHECK(cache.claim("b", "TX-B").claimed);
+    CHECK(cache.claim("c", "TX-C").claimed);
+    CHECK(cache.size() == 2);
+
+    // Evicted while in flight, so its waiter sees a broken promise
+    bool broken = false;
+    try {
+        result.get();
+    } catch (const std::future_error&) {
+        broken = true;
+    }
+    CHECK(broken);
+
+    // The evicted key can be claimed again; the newer ones are still held
+    CHECK(!cache.claim("c", "TX-C2").claimed);
+    CHECK(cache.claim("a", "TX-A3").claimed);
+}
+
+void expiredKeysCanBeClaimedAgain() {
+    IdempotencyCache cache(100, std::chrono::seconds(0));
+    CHECK(cache.claim("order-3", "TX-1").claimed);
+    IdempotencyClaim again = cache.claim("order-3", "TX-2");
+    CHECK(again.claimed);
+    CHECK(again.transactionId == "TX-2");
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(repeatedClaimFindsTheOriginalPayment);
+    RUN_TEST(waitersAreReleasedWhenTheOriginalCompletes);
+    RUN_TEST(fullShardEvictsTheOldestKey);
+    RUN_TEST(expiredKeysCanBeClaimedAgain);
+    return checkFailures() == 0 ? 0 : 1;
+}
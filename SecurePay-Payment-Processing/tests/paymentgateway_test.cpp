@@ -0,0 +1,159 @@
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "paymentgateway.h"
+#include "check.h"
+
+namespace {
+
+std::unique_ptr<Transaction> makeTransaction(const Customer& customer, const Merchant& merchant,
+                                             double amount, const std::string& transactionId = "") {
+    auto card = PaymentMethodFactory::createCreditCard("4111111111111111", "Test Holder", "12/30", "123");
+    if (transactionId.empty()) {
+        return TransactionFactory::createTransaction(customer, merchant, std::move(card), amount);
+    }
+    return TransactionFactory::createTransaction(customer, merchant, std::move(card), amount, transactionId);
+}
+
+void recordedTransactionsAreFoundById() {
+    PaymentGateway gateway;
+    Customer customer("Lookup Customer", "lookup@example.com", "1 Main Street");
+    Merchant merchant("Lookup Merchant", "shop@example.com", "2 High Street");
+
+    std::vector<std::string> ids;
+    for (int i = 0; i < 20; ++i) {
+        auto transaction = makeTransaction(customer, merchant, 10.0 + i);
+        ids.push_back(transaction->getTransactionId());
+        gateway.processTransaction(std::move(transaction));
+    }
+
+    const PaymentGateway& constGateway = gateway;
+    for (const std::string& id : ids) {
+        const Transaction* found = constGateway.findTransaction(id);
+        CHECK(found != nullptr);
+        CHECK(found != nullptr && found->getTransactionId() == id);
+        CHECK(gateway.findTransaction(id) == found);
+    }
+    CHECK(gateway.findTransaction("TX-00000000-0000") == nullptr);
+}
+
+void repeatedIdKeepsReferringToTheFirstTransaction() {
+    PaymentGateway gateway;
+    Customer customer("Clash Customer", "clash@example.com", "3 Main Street");
+    Merchant merchant("Clash Merchant", "shop@example.com", "4 High Street");
+
+    const std::string id = Transaction::generateTransactionId();
+    gateway.processTransaction(makeTransaction(customer, merchant, 11.0, id));
+    gateway.processTransaction(makeTransaction(customer, merchant, 22.0, id));
+
+    const Transaction* found = gateway.findTransaction(id);
+    CHECK(found != nullptr && found->getAmount() == 11.0);
+    CHECK(gateway.getTransactions().size() == 2);
+}
+
+void generatedIdsDoNotRepeatAcrossThreads() {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 25000;
+    std::vector<std::vector<std::string>> generated(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&generated, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                generated[t].push_back(Transaction::generateTransactionId());
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::set<std::string> unique;
+    for (const auto& ids : generated) {
+        unique.insert(ids.begin(), ids.end());
+    }
+    CHECK(unique.size() == static_cast<std::size_t>(kThreads * kPerThread));
+}
+
+void customerAndMerchantIndexesListTransactionsOldestFirst() {
+    PaymentGateway gateway;
+    Customer alice("Index Alice", "alice@example.com", "5 Main Street");
+    Customer bob("Index Bob", "bob@example.com", "6 Main Street");
+    Merchant merchant("Index Merchant", "shop@example.com", "7 High Street");
+
+    std::vector<std::string> aliceIds;
+    for (int i = 0; i < 5; ++i) {
+        const Customer& customer = i % 2 == 0 ? alice : bob;
+        auto transaction = makeTransaction(customer, merchant, 30.0 + i);
+        if (&customer == &alice) {
+            aliceIds.push_back(transaction->getTransactionId());
+        }
+        gateway.processTransaction(std::move(transaction));
+    }
+
+    std::vector<const Transaction*> forAlice = gateway.getTransactionsForCustomer("Index Alice");
+    CHECK(forAlice.size() == 3);
+    for (std::size_t i = 0; i < forAlice.size() && i < aliceIds.size(); ++i) {
+        CHECK(forAlice[i]->getTransactionId() == aliceIds[i]);
+    }
+    CHECK(gateway.getTransactionsForCustomer("Index Bob").size() == 2);
+    CHECK(gateway.getTransactionsForMerchant("Index Merchant").size() == 5);
+    CHECK(gateway.getTransactionsForCustomer("Nobody").empty());
+}
+
+void rangeQueriesIncludeBothBounds() {
+    PaymentGateway gateway;
+    Customer customer("Range Customer", "range@example.com", "8 Main Street");
+    Merchant merchant("Range Merchant", "shop@example.com", "9 High Street");
+
+    std::vector<std::chrono::system_clock::time_point> createdAt;
+    for (int i = 0; i < 4; ++i) {
+        auto transaction = makeTransaction(customer, merchant, 50.0 + i);
+        createdAt.push_back(transaction->getCreatedAt());
+        gateway.processTransaction(std::move(transaction));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    CHECK(gateway.getTransactionsForCustomer("Range Customer", createdAt[1], createdAt[2]).size() == 2);
+    CHECK(gateway.getTransactionsForMerchant("Range Merchant", createdAt[0], createdAt[3]).size() == 4);
+    CHECK(gateway.getTransactionsForMerchant("Range Merchant", createdAt[3], createdAt[3]).size() == 1);
+    CHECK(gateway.getTransactionsForCustomer("Range Customer",
+                                             createdAt[0] - std::chrono::hours(2),
+                                             createdAt[0] - std::chrono::hours(1)).empty());
+}
+
+void unknownIssuerIsDeclinedBeforeTheBank() {
+    PaymentGateway gateway;
+    Customer customer("Issuer Customer", "issuer@example.com", "10 Main Street");
+    Merchant merchant("Issuer Merchant", "shop@example.com", "11 High Street");
+    BinManager::getInstance().load({BinRange{"5", "5", BinInfo{"Generic", "Mastercard", CardType::CREDIT, "US"}}});
+
+    std::uint64_t bankRequests = Bank::getInstance().getStatistics().requests;
+    auto single = makeTransaction(customer, merchant, 60.0);
+    std::string singleId = single->getTransactionId();
+    gateway.processTransaction(std::move(single));
+
+    std::vector<std::unique_ptr<Transaction>> batch;
+    batch.push_back(makeTransaction(customer, merchant, 61.0));
+    std::vector<PaymentResult> results = gateway.processTransactionBatch(std::move(batch));
+
+    const Transaction* declined = gateway.findTransaction(singleId);
+    CHECK(declined && declined->getStatus() == TransactionStatus::DECLINED);
+    CHECK(results.size() == 1 && results[0].status == TransactionStatus::DECLINED);
+    CHECK(Bank::getInstance().getStatistics().requests == bankRequests);
+
+    BinManager::getInstance().load({});
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(recordedTransactionsAreFoundById);
+    RUN_TEST(repeatedIdKeepsReferringToTheFirstTransaction);
+    RUN_TEST(generatedIdsDoNotRepeatAcrossThreads);
+    RUN_TEST(customerAndMerchantIndexesListTransactionsOldestFirst);
+    RUN_TEST(rangeQueriesIncludeBothBounds);
+    RUN_TEST(unknownIssuerIsDeclinedBeforeTheBank);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include <future>
+#include <string>
+#include <vector>
+#include "paymentgatewayfacade.h"
+#include "check.h"
+
+namespace {
+
+const std::vector<std::string> kCard{"4111111111111111", "Test Holder", "12/30", "123"};
+
+void asyncPaymentResolvesToTheRecordedTransaction() {
+    PaymentGateway gateway;
+    PaymentGatewayFacade facade(gateway, Bank::getInstance(), FraudSystem::getInstance());
+    Customer customer("Async Customer", "async@example.com", "1 Main Street");
+    Merchant merchant("Async Merchant", "shop@example.com", "2 High Street");
+
+    std::future<PaymentResult> future =
+        facade.processPaymentAsync(customer, merchant, "Credit Card", kCard, 25.0);
+    PaymentResult result = future.get();
+
+    CHECK(!result.transactionId.empty());
+    CHECK(result.status == TransactionStatus::APPROVED);
+    const Transaction* transaction = facade.getTransaction(result.transactionId);
+    CHECK(transaction != nullptr);
+    CHECK(transaction != nullptr && transaction->getStatus() == result.status);
+    CHECK(gateway.getInFlightCount() == 0);
+}
+
+void invalidPaymentMethodResolvesWithoutATransaction() {
+    PaymentGateway gateway;
+    PaymentGatewayFacade facade(gateway, Bank::getInstance(), FraudSystem::getInstance());
+    Customer customer("Invalid Customer", "invalid@example.com", "3 Main Street");
+    Merchant merchant("Invalid Merchant", "shop@example.com", "4 High Street");
+
+    PaymentResult result =
+        facade.processPaymentAsync(customer, merchant, "Cheque", {"12345"}, 25.0).get();
+    CHECK(result.transactionId.empty());
+    CHECK(result.status == TransactionStatus::DECLINED);
+    CHECK(facade.processPayment(customer, merchant, "Cheque", {"12345"}, 25.0).empty());
+    CHECK(facade.getAllTransactions().empty());
+}
+
+void retryWithTheSameKeyReturnsTheOriginalTransaction() {
+    PaymentGateway gateway;
+    PaymentGatewayFacade facade(gateway, Bank::getInstance(), FraudSystem::getInstance());
+    Customer customer("Retry Customer", "retry@example.com", "5 Main Street");
+    Merchant merchant("Retry Merchant", "shop@example.com", "6 High Street");
+
+    std::string first = facade.processPayment(customer, merchant, "Credit Card", kCard, 40.0, "order-1");
+    std::string retry = facade.processPayment(customer, merchant, "Credit Card", kCard, 40.0, "order-1");
+    CHECK(!first.empty());
+    CHECK(retry == first);
+
+    // The async path resolves a used key to the original result as well
+    PaymentResult asyncRetry =
+        facade.processPaymentAsync(customer, merchant, "Credit Card", kCard, 40.0, "order-1").get();
+    CHECK(asyncRetry.transactionId == first);
+    CHECK(asyncRetry.status == TransactionStatus::APPROVED);
+
+    // Only the original charge reached the gateway
+    CHECK(facade.getAllTransactions().size() == 1);
+}
+
+void concurrentRetriesShareOneCharge() {
+    PaymentGateway gateway;
+    PaymentGatewayFacade facade(gateway, Bank::getInstance(), FraudSystem::getInstance());
+    Customer customer("Concurrent Customer", "concurrent@example.com", "7 Main Street");
+    Merchant merchant("Concurrent Merchant", "shop@example.com", "8 High Street");
+
+    std::vector<std::future<PaymentResult>> futures;
+    for (int i = 0; i < 8; ++i) {
+        futures.push_back(std::async(std::launch::async, [&]() {
+            return facade.processPaymentAsync(customer, merchant, "Credit Card", kCard, 55.0, "order-2").get();
+        }));
+    }
+
+    std::string transactionId = futures.front().get().transactionId;
+    CHECK(!transactionId.empty());
+    for (std::size_t i = 1; i < futures.size(); ++i) {
+        CHECK(futures[i].get().transactionId == transactionId);
+    }
+    CHECK(facade.getAllTransactions().size() == 1);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(asyncPaymentResolvesToTheRecordedTransaction);
+    RUN_TEST(invalidPaymentMethodResolvesWithoutATransaction);
+    RUN_TEST(retryWithTheSameKeyReturnsTheOriginalTransaction);
+    RUN_TEST(concurrentRetriesShareOneCharge);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+#include <map>
+#include <memory>
+#include <thread>
+#include "refund.h"
+#include "settlementengine.h"
+#include "check.h"
+
+namespace {
+
+// Low enough that the shared day below is split across every thread count the tests use
+const std::size_t kEntriesPerThread = 256;
+
+struct Totals {
+    std::uint64_t captureCount = 0;
+    std::int64_t grossCents = 0;
+    std::uint64_t refundCount = 0;
+    std::int64_t refundCents = 0;
+};
+
+// A business day of captures and refunds over many merchants, with the totals settlement should reach
+struct Day {
+    std::vector<std::unique_ptr<Transaction>> transactions;
+    std::vector<std::unique_ptr<Refund>> refunds;
+    std::map<std::string, Totals> expected;
+
+    Day() {
+        Customer customer("Alice Smith", "alice@example.com", "123 Main St");
+
+        // Enough merchants and entries that every thread's chunk routes to every partition
+        for (int i = 0; i < 3000; ++i) {
+            const std::string merchantName = "Merchant " + std::to_string(i % 37);
+            const std::int64_t cents = 100 + (i * 7919) % 50000;
+            Merchant merchant(merchantName, "m@example.com", "1 Market St");
+            transactions.push_back(TransactionFactory::createTransaction(
+                customer, merchant, PaymentMethodFactory::createDigitalWallet("w" + std::to_string(i), "e"),
+                cents / 100.0));
+            Transaction& transaction = *transactions.back();
+
+            if (i % 5 == 4) {
+                transaction.setState(std::make_unique<DeclinedState>());
+                continue;
+            }
+            transaction.setState(std::make_unique<ApprovedState>());
+            Totals& totals = expected[merchantName];
+            ++totals.captureCount;
+            totals.grossCents += cents;
+
+            if (i % 4 == 0) {
+                const std::int64_t refundCents = cents / 3;
+                refunds.push_back(RefundFactory::createRefund(transaction, refundCents / 100.0, "Returned"));
+                ++totals.refundCount;
+                totals.refundCents += refundCents;
+            }
+        }
+    }
+
+    SettlementBatch settle(std::size_t threadCount) const {
+        std::vector<const Transaction*> captured;
+        for (const auto& transaction : transactions) {
+            captured.push_back(transaction.get());
+        }
+        std::vector<const Refund*> refunded;
+        for (const auto& refund : refunds) {
+            refunded.push_back(refund.get());
+        }
+        const auto now = std::chrono::system_clock::now();
+        return SettlementEngine(threadCount, kEntriesPerThread).settle(captured, refunded,
+                                                                       now - std::chrono::hours(1),
+                                                                       now + std::chrono::hours(1));
+    }
+};
+
+// Built once and shared, since the tests only read it
+const Day& day() {
+    static const Day instance;
+    return instance;
+}
+
+void mergedPartitionsMatchPerMerchantTotals() {
+    SettlementBatch batch = day().settle(4);
+
+    CHECK(batch.merchants.size() == day().expected.size());
+    if (batch.merchants.size() != day().expected.size()) {
+        return;
+    }
+
+    Totals overall;
+    auto expected = day().expected.begin();
+    for (const MerchantSettlement& merchant : batch.merchants) {
+        CHECK(merchant.merchantName == expected->first);
+        CHECK(merchant.captureCount == expected->second.captureCount);
+        CHECK(merchant.grossCents == expected->second.grossCents);
+        CHECK(merchant.refundCount == expected->second.refundCount);
+        CHECK(merchant.refundCents == expected->second.refundCents);
+        CHECK(merchant.netCents == merchant.grossCents - merchant.refundCents);
+
+        overall.captureCount += expected->second.captureCount;
+        overall.grossCents += expected->second.grossCents;
+        overall.refundCount += expected->second.refundCount;
+        overall.refundCents += expected->second.refundCents;
+        ++expected;
+    }
+
+    CHECK(batch.captureCount == overall.captureCount);
+    CHECK(batch.grossCents == overall.grossCents);
+    CHECK(batch.refundCount == overall.refundCount);
+    CHECK(batch.refundCents == overall.refundCents);
+    CHECK(batch.netCents == overall.grossCents - overall.refundCents);
+}
+
+void resultDoesNotDependOnThreadCount() {
+    SettlementBatch single = day().settle(1);
+    for (std::size_t threadCount : {2u, 3u, 8u}) {
+        SettlementBatch parallel = day().settle(threadCount);
+        CHECK(parallel.merchants.size() == single.merchants.size());
+        for (std::size_t i = 0; i < single.merchants.size() && i < parallel.merchants.size(); ++i) {
+            CHECK(parallel.merchants[i].merchantName == single.merchants[i].merchantName);
+            CHECK(parallel.merchants[i].captureCount == single.merchants[i].captureCount);
+            CHECK(parallel.merchants[i].refundCount == single.merchants[i].refundCount);
+            CHECK(parallel.merchants[i].netCents == single.merchants[i].netCents);
+        }
+        CHECK(parallel.netCents == single.netCents);
+    }
+}
+
+void entriesOutsideTheWindowAreLeftOut() {
+    std::vector<const Transaction*> transactions{day().transactions.front().get()};
+    std::vector<const Refund*> refunds{day().refunds.front().get()};
+    const auto now = std::chrono::system_clock::now();
+    SettlementBatch batch = SettlementEngine(2).settle(transactions, refunds, now - std::chrono::hours(48),
+                                                       now - std::chrono::hours(24));
+    CHECK(batch.merchants.empty());
+    CHECK(batch.captureCount == 0u);
+    CHECK(batch.refundCount == 0u);
+    CHECK(batch.netCents == 0);
+}
+
+void transactionsSettleOnTheirApprovalDay() {
+    Customer customer("Review Customer", "review@example.com", "1 Main St");
+    Merchant merchant("Review Merchant", "m@example.com", "1 Market St");
+    auto transaction = TransactionFactory::createTransaction(
+        customer, merchant, PaymentMethodFactory::createDigitalWallet("reviewed", "e"), 25.0);
+    transaction->setState(std::make_unique<FlaggedState>());
+    std::vector<const Transaction*> transactions{transaction.get()};
+
+    // The review finishes after the day the payment was made has ended
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    const auto dayEnd = std::chrono::system_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    transaction->setState(std::make_unique<ApprovedState>());
+
+    SettlementEngine engine(1);
+    SettlementBatch paymentDay = engine.settle(transactions, {}, dayEnd - std::chrono::hours(24), dayEnd);
+    CHECK(paymentDay.captureCount == 0u);
+    SettlementBatch approvalDay = engine.settle(transactions, {}, dayEnd, dayEnd + std::chrono::hours(24));
+    CHECK(approvalDay.captureCount == 1u);
+    CHECK(approvalDay.grossCents == 2500);
+
+    // Refunding does not move it to another day
+    CHECK(transaction->refund(25.0));
+    CHECK(engine.settle(transactions, {}, dayEnd, dayEnd + std::chrono::hours(24)).captureCount == 1u);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(mergedPartitionsMatchPerMerchantTotals);
+    RUN_TEST(resultDoesNotDependOnThreadCount);
+    RUN_TEST(entriesOutsideTheWindowAreLeftOut);
+    RUN_TEST(transactionsSettleOnTheirApprovalDay);
+    return checkFailures() == 0 ? 0 : 1;
+}
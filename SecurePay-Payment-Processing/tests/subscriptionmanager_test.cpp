@@ -0,0 +1,136 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include "subscriptionmanager.h"
+#include "check.h"
+
+using namespace std::chrono;
+
+namespace {
+
+const std::vector<std::string> kCard{"4111111111111111", "Test Holder", "12/30", "123"};
+
+// Charges over 1000 score high enough to be held for review; the default bank declines 5000 and above
+void flagLargeAmounts() {
+    VelocityLimits off;
+    off.customer = off.card = off.merchant = VelocityWindowLimits{{0, 0}, {0, 0}, {0, 0}};
+    FraudSystem::getInstance().setVelocityLimits(off);
+    FraudSystem::getInstance().setRules(FraudRuleSet::compile(
+        "rule,large_amount,3,amount > 1000\n"
+        "level,medium,1\n"
+        "level,high,2\n"));
+}
+
+SubscriptionConfig unjitteredConfig() {
+    SubscriptionConfig config;
+    config.jitterWindow = system_clock::duration::zero();
+    config.maxRetries = 1;
+    return config;
+}
+
+Subscription getSubscription(const SubscriptionManager& manager, const std::string& id) {
+    Subscription subscription{};
+    CHECK(manager.getSubscription(id, subscription));
+    return subscription;
+}
+
+void approvedChargeSchedulesTheNextCycle() {
+    PaymentGateway gateway;
+    SubscriptionManager manager(gateway, unjitteredConfig());
+    Customer customer("Daily Customer", "daily@example.com", "1 Main Street");
+    Merchant merchant("Daily Merchant", "shop@example.com", "2 High Street");
+
+    auto now = system_clock::now();
+    std::string id = manager.addSubscription(customer, merchant, "Credit Card", kCard, 10.0,
+                                             BillingInterval::DAILY, now - minutes(1));
+    CHECK(manager.billDue(now) == 1);
+    CHECK(manager.billDue(now) == 0);
+
+    Subscription subscription = getSubscription(manager, id);
+    CHECK(subscription.status == SubscriptionStatus::ACTIVE);
+    CHECK(subscription.nextBillingAt == now - minutes(1) + hours(24));
+    CHECK(!subscription.lastTransactionId.empty());
+    SubscriptionStatistics statistics = manager.getStatistics();
+    CHECK(statistics.approved == 1 && statistics.failed == 0 && statistics.heldForReview == 0);
+}
+
+void declinedChargesAreRetriedUntilPastDue() {
+    PaymentGateway gateway;
+    gateway.getDuplicateDetector().setWindow(seconds(0));
+    SubscriptionManager manager(gateway, unjitteredConfig());
+    Customer customer("Declined Customer", "declined@example.com", "3 Main Street");
+    Merchant merchant("Declined Merchant", "shop@example.com", "4 High Street");
+
+    auto now = system_clock::now();
+    std::string id = manager.addSubscription(customer, merchant, "Credit Card", kCard, 6000.0,
+                                             BillingInterval::MONTHLY, now);
+    CHECK(manager.billDue(now) == 1);
+    Subscription subscription = getSubscription(manager, id);
+    CHECK(subscription.failedAttempts == 1);
+    CHECK(subscription.nextBillingAt >= now + hours(1) && subscription.nextBillingAt <= now + minutes(90));
+
+    CHECK(manager.billDue(now + hours(2)) == 1);
+    CHECK(getSubscription(manager, id).status == SubscriptionStatus::PAST_DUE);
+    SubscriptionStatistics statistics = manager.getStatistics();
+    CHECK(statistics.failed == 2 && statistics.retriesScheduled == 1 && statistics.pastDue == 1);
+
+    CHECK(manager.reactivateSubscription(id));
+    CHECK(getSubscription(manager, id).failedAttempts == 0);
+}
+
+void flaggedChargeWaitsForTheReview() {
+    flagLargeAmounts();
+    PaymentGateway gateway;
+    gateway.getDuplicateDetector().setWindow(seconds(0));
+    SubscriptionManager manager(gateway, unjitteredConfig());
+    Customer customer("Reviewed Customer", "reviewed@example.com", "5 Main Street");
+    Merchant merchant("Reviewed Merchant", "shop@example.com", "6 High Street");
+
+    auto now = system_clock::now();
+    std::string approvedId = manager.addSubscription(customer, merchant, "Credit Card", kCard, 2000.0,
+                                                     BillingInterval::WEEKLY, now);
+    std::string declinedId = manager.addSubscription(customer, merchant, "Credit Card", kCard, 3000.0,
+                                                     BillingInterval::WEEKLY, now);
+    CHECK(manager.billDue(now) == 2);
+
+    // Held charges are neither approved nor failed, and are not billed again while they wait
+    Subscription approved = getSubscription(manager, approvedId);
+    Subscription declined = getSubscription(manager, declinedId);
+    CHECK(approved.awaitingReview && declined.awaitingReview);
+    CHECK(approved.failedAttempts == 0);
+    CHECK(manager.billDue(now + hours(24 * 30)) == 0);
+    SubscriptionStatistics statistics = manager.getStatistics();
+    CHECK(statistics.heldForReview == 2 && statistics.approved == 0 && statistics.failed == 0);
+    CHECK(statistics.retriesScheduled == 0);
+
+    // The reviewer's approval completes the cycle; a decline is retried like any failed charge
+    while (Transaction* transaction = gateway.getReviewQueue().claim("reviewer")) {
+        const std::string& transactionId = transaction->getTransactionId();
+        if (transactionId == approved.lastTransactionId) {
+            CHECK(gateway.approveReview(transactionId, "reviewer"));
+        } else {
+            CHECK(gateway.declineReview(transactionId, "reviewer"));
+        }
+    }
+    gateway.flushNotifications();
+
+    approved = getSubscription(manager, approvedId);
+    CHECK(!approved.awaitingReview);
+    CHECK(approved.nextBillingAt == now + hours(24 * 7));
+    declined = getSubscription(manager, declinedId);
+    CHECK(!declined.awaitingReview);
+    CHECK(declined.failedAttempts == 1 && declined.status == SubscriptionStatus::ACTIVE);
+    statistics = manager.getStatistics();
+    CHECK(statistics.approved == 1 && statistics.failed == 1 && statistics.retriesScheduled == 1);
+
+    FraudSystem::getInstance().setRules(FraudRuleSet::defaults());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(approvedChargeSchedulesTheNextCycle);
+    RUN_TEST(declinedChargesAreRetriedUntilPastDue);
+    RUN_TEST(flaggedChargeWaitsForTheReview);
+    return checkFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "timingwheel.h"
+#include "check.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// 10 us ticks put the second wheel at 2.56 ms and the third at 655 ms, so short delays reach every level
+constexpr microseconds kTick(10);
+
+struct Firings {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<int> order;
+    std::vector<TimingWheel::Clock::time_point> times;
+
+    std::function<void()> record(int timer) {
+        return [this, timer]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(timer);
+            times.push_back(TimingWheel::Clock::now());
+            condition.notify_all();
+        };
+    }
+
+    bool waitFor(std::size_t count, milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return condition.wait_for(lock, timeout, [this, count]() { return order.size() >= count; });
+    }
+};
+
+void cascadedTimersFireInOrderAndNeverEarly() {
+    // No workers, so callbacks run on the driver thread in the order they expire
+    TimingWheel wheel(kTick, 0);
+    Firings firings;
+
+    const std::vector<milliseconds> delays{
+        milliseconds(1),     // First wheel
+        milliseconds(20),    // Second wheel, cascaded once
+        milliseconds(200),
+        milliseconds(700),   // Third wheel, cascaded twice
+        milliseconds(900),
+    };
+    std::vector<TimingWheel::Clock::time_point> due(delays.size());
+    // Scheduled latest first, so firing in due order is not an artefact of scheduling order
+    for (std::size_t timer = delays.size(); timer-- > 0;) {
+        due[timer] = TimingWheel::Clock::now() + delays[timer];
+        wheel.schedule(delays[timer], firings.record(static_cast<int>(timer)));
+    }
+
+    CHECK(firings.waitFor(delays.size(), seconds(10)));
+    std::lock_guard<std::mutex> lock(firings.mutex);
+    CHECK(firings.order.size() == delays.size());
+    for (std::size_t i = 0; i < firings.order.size(); ++i) {
+        CHECK(firings.order[i] == static_cast<int>(i));
+        CHECK(firings.times[i] >= due[firings.order[i]]);
+    }
+    CHECK(wheel.getPendingCount() == 0u);
+}
+
+void cancelledTimerNeverFires() {
+    TimingWheel wheel(kTick, 1);
+    Firings firings;
+
+    TimingWheel::TimerId cancelled = wheel.schedule(milliseconds(30), firings.record(0));
+    wheel.schedule(milliseconds(60), firings.record(1));
+    CHECK(cancelled != 0u);
+    CHECK(wheel.getPendingCount() == 2u);
+
+    CHECK(wheel.cancel(cancelled));
+    CHECK(!wheel.cancel(cancelled));
+    CHECK(wheel.getPendingCount() == 1u);
+
+    CHECK(firings.waitFor(1, seconds(10)));
+    firings.waitFor(2, milliseconds(100));
+    std::lock_guard<std::mutex> lock(firings.mutex);
+    CHECK(firings.order == std::vector<int>{1});
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(cascadedTimersFireInOrderAndNeverEarly);
+    RUN_TEST(cancelledTimerNeverFires);
+    return checkFailures() == 0 ? 0 : 1;
+}
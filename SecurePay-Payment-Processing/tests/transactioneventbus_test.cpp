@@ -0,0 +1,168 @@
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "transactioneventbus.h"
+#include "check.h"
+
+namespace {
+
+std::unique_ptr<Transaction> makeTransaction(const Customer& customer, const Merchant& merchant, double amount) {
+    return TransactionFactory::createTransaction(customer, merchant,
+        PaymentMethodFactory::createCreditCard("4111111111111111", "Test Holder", "12/30", "123"), amount);
+}
+
+// Counts deliveries per transaction; optionally holds the dispatch thread inside the first batch
+class RecordingObserver : public TransactionObserver {
+public:
+    explicit RecordingObserver(bool holdFirstBatch = false) : m_holding(holdFirstBatch) {}
+
+    void onTransactionUpdated(const Transaction& transaction) override {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_deliveries[&transaction];
+        m_entered = true;
+        m_condition.notify_all();
+        m_condition.wait(lock, [this]() { return !m_holding; });
+    }
+
+    void onTransactionsUpdated(const std::vector<const Transaction*>& transactions) override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_batchSizes.push_back(transactions.size());
+        }
+        TransactionObserver::onTransactionsUpdated(transactions);
+    }
+
+    void waitUntilEntered() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_entered; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_holding = false;
+        m_condition.notify_all();
+    }
+
+    int deliveries(const Transaction& transaction) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_deliveries[&transaction];
+    }
+
+    std::size_t totalDeliveries() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::size_t total = 0;
+        for (const auto& entry : m_deliveries) {
+            total += entry.second;
+        }
+        return total;
+    }
+
+    std::vector<std::size_t> batchSizes() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_batchSizes;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::map<const Transaction*, int> m_deliveries;
+    std::vector<std::size_t> m_batchSizes;
+    bool m_holding;
+    bool m_entered = false;
+};
+
+const Customer kCustomer("Bus Customer", "bus@example.com", "1 Main Street");
+const Merchant kMerchant("Bus Merchant", "shop@example.com", "2 High Street");
+
+void everyPublishedUpdateIsDeliveredInBoundedBatches() {
+    std::vector<std::unique_ptr<Transaction>> transactions;
+    for (int i = 0; i < 100; ++i) {
+        transactions.push_back(makeTransaction(kCustomer, kMerchant, 10.0 + i));
+    }
+
+    RecordingObserver observer;
+    TransactionEventBus bus(16);
+    bus.subscribe(&observer);
+    for (const auto& transaction : transactions) {
+        bus.publish(*transaction);
+    }
+    bus.flush();
+
+    CHECK(bus.getPendingCount() == 0);
+    for (const auto& transaction : transactions) {
+        CHECK(observer.deliveries(*transaction) == 1);
+    }
+    for (std::size_t size : observer.batchSizes()) {
+        CHECK(size >= 1 && size <= 16);
+    }
+    bus.unsubscribe(&observer);
+}
+
+void updatesWaitingForDeliveryAreCoalesced() {
+    auto first = makeTransaction(kCustomer, kMerchant, 20.0);
+    auto repeated = makeTransaction(kCustomer, kMerchant, 21.0);
+
+    RecordingObserver observer(true);
+    TransactionEventBus bus;
+    bus.subscribe(&observer);
+
+    // The dispatch thread is held inside the first delivery while the second transaction is updated repeatedly
+    bus.publish(*first);
+    observer.waitUntilEntered();
+    for (int i = 0; i < 10; ++i) {
+        bus.publish(*repeated);
+    }
+    CHECK(bus.getPendingCount() == 1);
+
+    observer.release();
+    bus.flush();
+    CHECK(observer.deliveries(*first) == 1);
+    CHECK(observer.deliveries(*repeated) == 1);
+    bus.unsubscribe(&observer);
+}
+
+void unsubscribedObserversAreNotCalled() {
+    auto transaction = makeTransaction(kCustomer, kMerchant, 30.0);
+
+    RecordingObserver kept;
+    RecordingObserver removed;
+    TransactionEventBus bus;
+    bus.subscribe(&kept);
+    bus.subscribe(&removed);
+    bus.unsubscribe(&removed);
+
+    bus.publish(*transaction);
+    bus.flush();
+    CHECK(kept.deliveries(*transaction) == 1);
+    CHECK(removed.totalDeliveries() == 0);
+    bus.unsubscribe(&kept);
+}
+
+void destructorDeliversQueuedUpdates() {
+    std::vector<std::unique_ptr<Transaction>> transactions;
+    for (int i = 0; i < 50; ++i) {
+        transactions.push_back(makeTransaction(kCustomer, kMerchant, 40.0 + i));
+    }
+
+    RecordingObserver observer;
+    {
+        TransactionEventBus bus(4);
+        bus.subscribe(&observer);
+        for (const auto& transaction : transactions) {
+            bus.publish(*transaction);
+        }
+    }
+    CHECK(observer.totalDeliveries() == transactions.size());
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(everyPublishedUpdateIsDeliveredInBoundedBatches);
+    RUN_TEST(updatesWaitingForDeliveryAreCoalesced);
+    RUN_TEST(unsubscribedObserversAreNotCalled);
+    RUN_TEST(destructorDeliversQueuedUpdates);
+    return checkFailures() == 0 ? 0 : 1;
+}
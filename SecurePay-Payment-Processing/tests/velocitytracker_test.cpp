@@ -0,0 +1,112 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "fraudsystem.h"
+#include "velocitytracker.h"
+#include "check.h"
+
+using namespace std::chrono;
+
+namespace {
+
+// On every bucket boundary, so offsets below land in predictable buckets
+const VelocityTracker::Clock::time_point kStart(hours(1000));
+
+void windowsSlideInBucketSteps() {
+    VelocityTracker tracker;
+    tracker.record(VelocityDimension::CUSTOMER, "alice", 100, kStart);
+    tracker.record(VelocityDimension::CUSTOMER, "alice", 200, kStart + seconds(5));
+    VelocitySnapshot activity = tracker.record(VelocityDimension::CUSTOMER, "alice", 300, kStart + seconds(15));
+    CHECK(activity.minute.count == 3 && activity.minute.amountCents == 600);
+    CHECK(activity.hour.count == 3 && activity.day.count == 3);
+
+    // A minute on, the first 10 s bucket has left the minute window but not the others
+    activity = tracker.get(VelocityDimension::CUSTOMER, "alice", kStart + seconds(60));
+    CHECK(activity.minute.count == 1 && activity.minute.amountCents == 300);
+    CHECK(activity.hour.count == 3 && activity.day.amountCents == 600);
+
+    activity = tracker.get(VelocityDimension::CUSTOMER, "alice", kStart + hours(1));
+    CHECK(activity.minute.count == 0 && activity.hour.count == 0 && activity.day.count == 3);
+    activity = tracker.get(VelocityDimension::CUSTOMER, "alice", kStart + hours(24));
+    CHECK(activity.day.count == 0);
+
+    // A ring that wraps onto an old bucket starts it afresh
+    activity = tracker.record(VelocityDimension::CUSTOMER, "alice", 50, kStart + hours(24));
+    CHECK(activity.minute.count == 1 && activity.hour.count == 1 && activity.day.count == 1);
+    CHECK(activity.day.amountCents == 50);
+}
+
+void dimensionsAreKeptApart() {
+    VelocityTracker tracker;
+    tracker.record(VelocityDimension::CUSTOMER, "shared", 100, kStart);
+    tracker.record(VelocityDimension::MERCHANT, "shared", 100, kStart);
+    tracker.record(VelocityDimension::MERCHANT, "shared", 100, kStart);
+
+    CHECK(tracker.get(VelocityDimension::CUSTOMER, "shared", kStart).day.count == 1);
+    CHECK(tracker.get(VelocityDimension::MERCHANT, "shared", kStart).day.count == 2);
+    CHECK(tracker.get(VelocityDimension::CARD, "shared", kStart).day.count == 0);
+    CHECK(tracker.size() == 2);
+}
+
+void leastRecentlyActiveKeyIsEvicted() {
+    VelocityTracker tracker(3, 1);
+    tracker.record(VelocityDimension::CARD, "a", 1, kStart);
+    tracker.record(VelocityDimension::CARD, "b", 1, kStart);
+    tracker.record(VelocityDimension::CARD, "c", 1, kStart);
+    tracker.record(VelocityDimension::CARD, "a", 1, kStart);
+    tracker.record(VelocityDimension::CARD, "d", 1, kStart);
+
+    CHECK(tracker.size() == 3);
+    CHECK(tracker.get(VelocityDimension::CARD, "b", kStart).day.count == 0);
+    CHECK(tracker.get(VelocityDimension::CARD, "a", kStart).day.count == 2);
+    CHECK(tracker.get(VelocityDimension::CARD, "d", kStart).day.count == 1);
+}
+
+void concurrentRecordsAreAllCounted() {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 10000;
+    VelocityTracker tracker;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&tracker] {
+            for (int i = 0; i < kPerThread; ++i) {
+                tracker.record(VelocityDimension::MERCHANT, "busy", 1, kStart);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    VelocitySnapshot activity = tracker.get(VelocityDimension::MERCHANT, "busy", kStart);
+    CHECK(activity.day.count == kThreads * kPerThread);
+    CHECK(activity.day.amountCents == kThreads * kPerThread);
+}
+
+void onlyScreeningCountsATransaction() {
+    FraudSystem& fraudSystem = FraudSystem::getInstance();
+    Customer customer("Velocity Customer", "velocity@example.com", "1 Main Street");
+    Merchant merchant("Velocity Merchant", "shop@example.com", "2 High Street");
+    auto transaction = TransactionFactory::createTransaction(customer, merchant,
+        PaymentMethodFactory::createCreditCard("4111111111111111", "Test Holder", "12/30", "123"), 10.0);
+
+    const VelocityTracker& tracker = fraudSystem.getVelocityTracker();
+    fraudSystem.assessTransaction(*transaction);
+    fraudSystem.assessTransaction(*transaction);
+    CHECK(tracker.get(VelocityDimension::CUSTOMER, customer.getName()).day.count == 0);
+
+    fraudSystem.screenTransaction(*transaction);
+    CHECK(tracker.get(VelocityDimension::CUSTOMER, customer.getName()).day.count == 1);
+    CHECK(tracker.get(VelocityDimension::MERCHANT, merchant.getName()).day.count == 1);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(windowsSlideInBucketSteps);
+    RUN_TEST(dimensionsAreKeptApart);
+    RUN_TEST(leastRecentlyActiveKeyIsEvicted);
+    RUN_TEST(concurrentRecordsAreAllCounted);
+    RUN_TEST(onlyScreeningCountsATransaction);
+    return checkFailures() == 0 ? 0 : 1;
+}